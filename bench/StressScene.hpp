@@ -0,0 +1,330 @@
+#pragma once
+// 大規模シーンの乱数生成（ホストのベンチマーク用）
+//
+// 描画できる全 DrawType（DrawPixel 〜 DrawString）を重なり合う位置・ランダムな zIndex で並べ、
+// タッチ可能なオブジェクトには全 TouchType から重複しないようにプロセスを登録する。
+// 一部は Clip 系（図形と同じ引数）や FlexBox / TableBox にし、コンテナには後続のオブジェクトを
+// 子として数個ずつ入れる（Clip・コンテナはタッチ対象外）。
+// 同じ StressConfig（seed を含む）からは常に同じシーンができる。vt_bench・vt_stress で共用する。
+
+#include <Arduino.h>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include "VisualTouch.h"
+
+struct StressConfig {
+  int pages = 1;
+  int objectsPerPage = 100;
+  uint32_t seed = 1;
+  int untouchablePercent = 10;     // プロセスを持たないオブジェクトの割合
+  int maxProcessesPerObject = 3;   // 1 オブジェクトあたりのプロセス数の上限（1〜）
+  int clipPercent = 3;             // Clip 系にする割合
+  int boxPercent = 2;              // FlexBox / TableBox にする割合（後続の 2〜5 個を子にする）
+  bool batch = false;              // beginVisualUpdate / beginProcessEdit でまとめて登録する
+  int screenW = 320;
+  int screenH = 240;
+};
+
+struct StressCounts {
+  static constexpr size_t DRAW_TYPE_COUNT = size_t(VisualDataSet::DrawType::TableBox) + 1;
+  static constexpr size_t SHAPE_TYPE_COUNT = size_t(VisualDataSet::DrawType::DrawString) + 1;   // 描画する種類
+  static constexpr size_t TOUCH_TYPE_COUNT = size_t(TouchDataSet::TouchType::MultiClicked) + 1;
+
+  size_t objects = 0;
+  size_t processes = 0;
+  size_t rejectedProcesses = 0;    // createProcess が false を返した数
+  size_t drawTypes[DRAW_TYPE_COUNT] = {};
+  size_t touchTypes[TOUCH_TYPE_COUNT] = {};
+};
+
+class StressScene {
+public:
+  using VDS = VisualDataSet;
+  using TDS = TouchDataSet;
+
+  // 計測の区切り（build() の measure に渡される）
+  enum class Op : uint8_t {
+    CreateObject,
+    CreateProcess,
+    Commit          // endVisualUpdate / endProcessEdit / finalizeSetup
+  };
+
+  static constexpr const char* JPG_PATH = "/stress.jpg";
+  static constexpr const char* PNG_PATH = "/stress.png";
+
+  // 再現性のための簡易乱数（シーンのほか、判定座標などベンチ側の乱数にも使う）
+  struct Rng {
+    uint32_t state;
+    explicit Rng(uint32_t seed) : state(seed ? seed : 1) {}
+    uint32_t next() { state = state * 1664525u + 1013904223u; return state >> 8; }
+    int32_t range(int32_t lo, int32_t hi) { return hi > lo ? lo + int32_t(next() % uint32_t(hi - lo)) : lo; }
+  };
+
+  // build() が p 番目に追加するページの名前
+  static String pageName(int p) {
+    return "stress" + String(p);
+  }
+
+  // 画像のヘッダを一時ディレクトリに書き出して SD のルートにする（破棄時に消す）
+  class ImageRoot {
+  public:
+    ImageRoot() {
+      ready = mkdtemp(dir) && writeImageStubs(dir);
+      if (ready) SD.setRoot(dir);
+    }
+    ~ImageRoot() {
+      std::remove((std::string(dir) + JPG_PATH).c_str());
+      std::remove((std::string(dir) + PNG_PATH).c_str());
+      std::remove(dir);
+    }
+    ImageRoot(const ImageRoot&) = delete;
+    ImageRoot& operator=(const ImageRoot&) = delete;
+    bool isReady() const { return ready; }
+
+  private:
+    char dir[24] = "/tmp/vt_stressXXXXXX";
+    bool ready = false;
+  };
+
+  // JPG / PNG オブジェクト用に、サイズだけ読めるヘッダを dir に書き出す
+  // （ホストの drawJpg / drawPng はヘッダのサイズでプレースホルダを描く）
+  static bool writeImageStubs(const std::string& dir) {
+    static const uint8_t png[] = {
+      0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n',
+      0x00, 0x00, 0x00, 0x0D, 'I', 'H', 'D', 'R',
+      0x00, 0x00, 0x00, 0x30, 0x00, 0x00, 0x00, 0x20,   // 48 x 32
+      0x08, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+    };
+    static const uint8_t jpg[] = {
+      0xFF, 0xD8,
+      0xFF, 0xC0, 0x00, 0x11, 0x08, 0x00, 0x18, 0x00, 0x28,   // SOF0 40 x 24
+      0x03, 0x01, 0x22, 0x00, 0x02, 0x11, 0x01, 0x03, 0x11, 0x01,
+      0xFF, 0xD9
+    };
+    return writeFile(dir + PNG_PATH, png, sizeof(png)) && writeFile(dir + JPG_PATH, jpg, sizeof(jpg));
+  }
+
+  // ページを追加してシーンを組み立てる。measure(Op, fn) は fn() を 1 回呼ぶこと
+  template <typename Measure>
+  static StressCounts build(VisualTouch& vt, const StressConfig& cfg, Measure&& measure) {
+    StressCounts counts;
+    Rng rng(cfg.seed);
+
+    for (int p = 0; p < cfg.pages; p++) {
+      String name = pageName(p);
+      vt.vData.addPage(name.c_str());
+      int pageNum = vt.vData.getPageNumByName(name);
+      vt.tData.changeEditPage(pageNum);
+      if (cfg.batch) {
+        vt.vData.beginVisualUpdate();
+        vt.tData.beginProcessEdit();
+      }
+
+      String boxName;       // 子を入れている途中のコンテナ
+      int boxChildren = 0;  // そのコンテナにあと入れる数
+      for (int i = 0; i < cfg.objectsPerPage; i++) {
+        String objectName = "o" + String(i);
+        VDS::ObjectArgs args;
+        VDS::DrawType type = makeArgs(rng, cfg, args);
+        uint8_t zIndex = uint8_t(rng.next() % 16);
+        bool untouchable = int(rng.next() % 100) < cfg.untouchablePercent;
+        uint32_t kind = rng.next() % 100;
+        bool isContainer = false;
+        if (int(kind) < cfg.clipPercent) {
+          // Clip はそれより上の層すべてに効くので、上の数層だけを削るよう高い層に置く
+          type = makeClipArgs(rng, cfg, args);
+          zIndex = uint8_t(12 + rng.next() % 3);
+          untouchable = true;
+        } else if (int(kind) < cfg.clipPercent + cfg.boxPercent && boxChildren == 0) {
+          type = makeBoxArgs(rng, cfg, args);
+          untouchable = true;
+          isContainer = true;
+        }
+        String parentName = isContainer ? String() : boxName;
+        measure(Op::CreateObject, [&] {
+          vt.vData.createOrUpdateObject(type, objectName, args, zIndex, untouchable, false);
+          if (parentName.length() > 0) vt.vData.setParent(objectName, parentName);
+        });
+        counts.objects++;
+        counts.drawTypes[size_t(type)]++;
+        if (isContainer) {
+          boxName = objectName;
+          boxChildren = 2 + int(rng.next() % 4);
+        } else if (boxChildren > 0 && --boxChildren == 0) {
+          boxName = String();
+        }
+        if (untouchable) continue;
+
+        // 先頭の種類をずらしながら、同じオブジェクトに同種のプロセスが重ならないように選ぶ
+        int processCount = 1 + int(rng.next() % uint32_t(cfg.maxProcessesPerObject > 0 ? cfg.maxProcessesPerObject : 1));
+        uint32_t first = rng.next() % StressCounts::TOUCH_TYPE_COUNT;
+        for (int k = 0; k < processCount; k++) {
+          auto touchType = TDS::TouchType((first + uint32_t(k) * 5) % StressCounts::TOUCH_TYPE_COUNT);
+          String processName = objectName + "p" + String(k);
+          bool overBorder = rng.next() & 1;
+          int clicks = touchType == TDS::TouchType::MultiClicked ? 2 + int(rng.next() % 2) : 0;
+          bool created = false;
+          measure(Op::CreateProcess, [&] {
+            created = vt.tData.createProcess(processName, objectName, touchType, overBorder, false, clicks);
+          });
+          if (!created) {
+            counts.rejectedProcesses++;
+            continue;
+          }
+          counts.processes++;
+          counts.touchTypes[size_t(touchType)]++;
+        }
+      }
+
+      if (cfg.batch) {
+        measure(Op::Commit, [&] {
+          vt.vData.endVisualUpdate();
+          vt.tData.endProcessEdit();
+        });
+      }
+    }
+
+    measure(Op::Commit, [&] {
+      vt.vData.finalizeSetup();
+      vt.tData.finalizeSetup();
+    });
+    return counts;
+  }
+
+  static StressCounts build(VisualTouch& vt, const StressConfig& cfg) {
+    return build(vt, cfg, [](Op, auto&& fn) { fn(); });
+  }
+
+private:
+  static bool writeFile(const std::string& path, const uint8_t* data, size_t size) {
+    std::FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) return false;
+    bool ok = std::fwrite(data, 1, size, f) == size;
+    std::fclose(f);
+    return ok;
+  }
+
+  // 画面からはみ出すものも含めて重なり合うように置く
+  static VDS::DrawType makeArgs(Rng& rng, const StressConfig& cfg, VDS::ObjectArgs& args) {
+    static const char* const LABELS[] = { "OK", "Cancel", "12:34", "メニュー", "42%", "Start", "温度 23.5℃", "W" };
+    static const lgfx::IFont* const FONTS[] = { &fonts::Font0, &fonts::Font2, &fonts::Font4, &fonts::lgfxJapanGothic_16 };
+    static const uint16_t BITMAP[8 * 8] = {
+      0xF800, 0xF800, 0x07E0, 0x07E0, 0x001F, 0x001F, 0xFFFF, 0xFFFF,
+      0xF800, 0xF800, 0x07E0, 0x07E0, 0x001F, 0x001F, 0xFFFF, 0xFFFF,
+      0x07E0, 0x07E0, 0x001F, 0x001F, 0xFFFF, 0xFFFF, 0xF800, 0xF800,
+      0x07E0, 0x07E0, 0x001F, 0x001F, 0xFFFF, 0xFFFF, 0xF800, 0xF800,
+      0x001F, 0x001F, 0xFFFF, 0xFFFF, 0xF800, 0xF800, 0x07E0, 0x07E0,
+      0x001F, 0x001F, 0xFFFF, 0xFFFF, 0xF800, 0xF800, 0x07E0, 0x07E0,
+      0xFFFF, 0xFFFF, 0xF800, 0xF800, 0x07E0, 0x07E0, 0x001F, 0x001F,
+      0xFFFF, 0xFFFF, 0xF800, 0xF800, 0x07E0, 0x07E0, 0x001F, 0x001F,
+    };
+
+    int32_t x = rng.range(-20, cfg.screenW);
+    int32_t y = rng.range(-20, cfg.screenH);
+    int32_t w = rng.range(4, 120);
+    int32_t h = rng.range(4, 90);
+    int32_t r = rng.range(2, 50);
+    int color = int(rng.next() & 0xFFFF);
+    int32_t a0 = rng.range(0, 360);
+    int32_t a1 = a0 + rng.range(10, 350);
+
+    auto type = VDS::DrawType(rng.next() % StressCounts::SHAPE_TYPE_COUNT);
+    switch (type) {
+      case VDS::DrawType::DrawPixel:    args = VDS::PixelArgs{ x, y, color }; break;
+      case VDS::DrawType::DrawLine:     args = VDS::LineArgs{ x, y, x + w, y + h, color }; break;
+      case VDS::DrawType::DrawBezier:   args = VDS::BezierArgs{ x, y, x + w / 2, y - h, x + w, y + h, color }; break;
+      case VDS::DrawType::DrawWideLine: args = VDS::WideLineArgs{ x, y, x + w, y + h, rng.range(1, 6), color }; break;
+      case VDS::DrawType::DrawRect:
+      case VDS::DrawType::FillRect:     args = VDS::RectArgs{ x, y, w, h, color }; break;
+      case VDS::DrawType::DrawRoundRect:
+      case VDS::DrawType::FillRoundRect: args = VDS::RoundRectArgs{ x, y, w, h, rng.range(1, 12), color }; break;
+      case VDS::DrawType::DrawTriangle:
+      case VDS::DrawType::FillTriangle: args = VDS::TriangleArgs{ x, y + h, x + w / 2, y, x + w, y + h, color }; break;
+      case VDS::DrawType::DrawCircle:
+      case VDS::DrawType::FillCircle:   args = VDS::CircleArgs{ x, y, r, color }; break;
+      case VDS::DrawType::DrawEllipse:
+      case VDS::DrawType::FillEllipse:  args = VDS::EllipseArgs{ x, y, w / 2 + 1, h / 2 + 1, color }; break;
+      case VDS::DrawType::DrawArc:
+      case VDS::DrawType::FillArc:      args = VDS::ArcArgs{ x, y, r / 2, r, a0, a1, color }; break;
+      case VDS::DrawType::DrawEllipseArc:
+      case VDS::DrawType::FillEllipseArc:
+        args = VDS::EllipseArcArgs{ x, y, w / 4, w / 2 + 1, h / 4, h / 2 + 1, a0, a1, color };
+        break;
+      case VDS::DrawType::DrawJpgFile: {
+        VDS::JpgFileArgs jpg;
+        jpg.path = JPG_PATH;
+        jpg.x = x; jpg.y = y; jpg.w = 40; jpg.h = 24;
+        jpg.scaleX = jpg.scaleY = 1.0f;
+        args = jpg;
+        break;
+      }
+      case VDS::DrawType::DrawPngFile: {
+        VDS::PngFileArgs png;
+        png.path = PNG_PATH;
+        png.x = x; png.y = y; png.w = 48; png.h = 32;
+        png.scaleX = png.scaleY = 1.0f;
+        args = png;
+        break;
+      }
+      case VDS::DrawType::DrawBitmap:   args = VDS::BitmapArgs{ BITMAP, x, y, 8, 8 }; break;
+      default: {
+        VDS::StringArgs s;
+        s.x = x; s.y = y;
+        s.text = LABELS[rng.next() % (sizeof(LABELS) / sizeof(LABELS[0]))];
+        s.color = color;
+        s.bgcolor = (rng.next() & 3) ? -1 : int(rng.next() & 0xFFFF);
+        s.font = FONTS[rng.next() % (sizeof(FONTS) / sizeof(FONTS[0]))];
+        s.datum = textdatum_t(rng.next() % 3);
+        s.textSize = 1 + int(rng.next() % 2);
+        args = s;
+        type = VDS::DrawType::DrawString;
+        break;
+      }
+    }
+    return type;
+  }
+
+  // Clip 系は対応する図形と同じ引数を持つ
+  static VDS::DrawType makeClipArgs(Rng& rng, const StressConfig& cfg, VDS::ObjectArgs& args) {
+    int32_t x = rng.range(-20, cfg.screenW);
+    int32_t y = rng.range(-20, cfg.screenH);
+    int32_t w = rng.range(20, 200);
+    int32_t h = rng.range(20, 150);
+    int32_t r = rng.range(10, 80);
+    int32_t a0 = rng.range(0, 360);
+    int32_t a1 = a0 + rng.range(30, 350);
+
+    auto type = VDS::DrawType(size_t(VDS::DrawType::ClipArc) + rng.next() % 7);
+    switch (type) {
+      case VDS::DrawType::ClipArc:        args = VDS::ArcArgs{ x, y, r / 3, r, a0, a1, 0 }; break;
+      case VDS::DrawType::ClipEllipseArc: args = VDS::EllipseArcArgs{ x, y, w / 6, w / 2, h / 6, h / 2, a0, a1, 0 }; break;
+      case VDS::DrawType::ClipRect:       args = VDS::RectArgs{ x, y, w, h, 0 }; break;
+      case VDS::DrawType::ClipRoundRect:  args = VDS::RoundRectArgs{ x, y, w, h, rng.range(0, 16), 0 }; break;
+      case VDS::DrawType::ClipCircle:     args = VDS::CircleArgs{ x, y, r, 0 }; break;
+      case VDS::DrawType::ClipEllipse:    args = VDS::EllipseArgs{ x, y, w / 2, h / 2, 0 }; break;
+      default:                            args = VDS::TriangleArgs{ x, y + h, x + w / 2, y, x + w, y + h, 0 }; break;
+    }
+    return type;
+  }
+
+  static VDS::DrawType makeBoxArgs(Rng& rng, const StressConfig& cfg, VDS::ObjectArgs& args) {
+    VDS::BoxArgs box;
+    box.x = rng.range(-20, cfg.screenW);
+    box.y = rng.range(-20, cfg.screenH);
+    box.w = rng.range(40, 200);
+    box.h = rng.range(30, 150);
+    box.padding = rng.range(0, 8);
+    box.gap = rng.range(0, 8);
+    box.justify = VDS::BoxAlign(rng.next() % 4);
+    box.align = VDS::BoxAlign(rng.next() % 3);
+    if (rng.next() & 1) {
+      box.direction = (rng.next() & 1) ? VDS::BoxDirection::Row : VDS::BoxDirection::Column;
+      args = box;
+      return VDS::DrawType::FlexBox;
+    }
+    box.columns = rng.range(1, 4);
+    args = box;
+    return VDS::DrawType::TableBox;
+  }
+};
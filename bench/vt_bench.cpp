@@ -0,0 +1,344 @@
+// 描画・タッチ判定・シーン構築のベンチマーク（env:bench / ホスト専用）
+//
+//   pio run -e bench && .pio/build/bench/program --out=vt_bench.json
+//
+// オプション
+//   --objects=10,100,1000  1 ページあたりのオブジェクト数
+//   --pages=1,10,50        ページ数
+//   --iterations=50        描画・判定系の計測回数
+//   --out=path             JSON の出力先（既定 vt_bench.json、- で標準出力）
+//
+// シーンは StressScene で生成する（オブジェクト数・ページ数ごとに種を固定）。
+// 各計測は 1 回あたりの経過時間（ns）と、その間の new の回数・バイト数を出力する。
+// 出力をコミット間で diff すれば退行を確認できる。
+
+#include <Arduino.h>
+#include <M5Unified.h>
+#include "VisualTouch.h"
+#include "StressScene.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <new>
+#include <string>
+#include <vector>
+
+// -------------------- アロケーション計測 --------------------
+// 置き換えた new/delete はどちらも malloc/free なので GCC の不一致警告は誤検知
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+namespace {
+  std::atomic<uint64_t> allocCount{0};
+  std::atomic<uint64_t> allocBytes{0};
+}
+
+void* operator new(size_t size) {
+  allocCount.fetch_add(1, std::memory_order_relaxed);
+  allocBytes.fetch_add(size, std::memory_order_relaxed);
+  void* p = std::malloc(size ? size : 1);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+void* operator new[](size_t size) { return operator new(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+  allocCount.fetch_add(1, std::memory_order_relaxed);
+  allocBytes.fetch_add(size, std::memory_order_relaxed);
+  return std::malloc(size ? size : 1);
+}
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept { return operator new(size, tag); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+namespace {
+
+  using BenchClock = std::chrono::steady_clock;
+
+  constexpr int SCREEN_W = 320;
+  constexpr int SCREEN_H = 240;
+
+  // -------------------- 計測結果 --------------------
+  struct Sample {
+    std::vector<uint64_t> nanos;
+    uint64_t allocs = 0;
+    uint64_t bytes = 0;
+  };
+
+  struct Result {
+    int objects;
+    int pages;
+    std::string op;
+    Sample sample;
+  };
+
+  // 1 回分の計測（計測区間の外でのみ vector を伸ばす）
+  template <typename F>
+  void measure(Sample& s, F&& fn) {
+    uint64_t a0 = allocCount.load(std::memory_order_relaxed);
+    uint64_t b0 = allocBytes.load(std::memory_order_relaxed);
+    auto t0 = BenchClock::now();
+    fn();
+    auto t1 = BenchClock::now();
+    s.allocs += allocCount.load(std::memory_order_relaxed) - a0;
+    s.bytes  += allocBytes.load(std::memory_order_relaxed) - b0;
+    s.nanos.push_back(uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count()));
+  }
+
+  // -------------------- 1 シーン分の計測 --------------------
+  constexpr size_t OPS_PER_SCENE = 8;
+
+  bool runScene(int objectCount, int pageCount, int iterations, std::vector<Result>& results) {
+    // add() が返す参照を保つため先に確保しておく
+    results.reserve(results.size() + OPS_PER_SCENE);
+    auto add = [&](const char* op) -> Sample& {
+      results.push_back(Result{ objectCount, pageCount, op, Sample() });
+      results.back().sample.nanos.reserve(size_t(objectCount) * pageCount + iterations);
+      return results.back().sample;
+    };
+
+    VisualTouch* vt = new VisualTouch(&M5.Display, false, false, false);
+    vt->tData.initJudgeSprite(&M5.Display);
+
+    LGFX_Sprite sprite(&M5.Display);
+    sprite.setColorDepth(16);
+    sprite.createSprite(SCREEN_W, SCREEN_H);
+
+    // シーン構築（StressScene と同じシーン。API の既定の使い方どおり一括モードは使わない）
+    Sample& createObject  = add("VisualData::createOrUpdateObject");
+    Sample& createProcess = add("TouchData::createProcess");
+    StressConfig cfg;
+    cfg.pages = pageCount;
+    cfg.objectsPerPage = objectCount;
+    cfg.seed = uint32_t(objectCount * 7919 + pageCount);
+    cfg.screenW = SCREEN_W;
+    cfg.screenH = SCREEN_H;
+    StressScene::build(*vt, cfg, [&](StressScene::Op op, auto&& fn) {
+      switch (op) {
+        case StressScene::Op::CreateObject:  measure(createObject, fn);  break;
+        case StressScene::Op::CreateProcess: measure(createProcess, fn); break;
+        default:                             fn();                       break;
+      }
+    });
+    std::vector<int> pageNums;
+    for (int p = 0; p < pageCount; p++) pageNums.push_back(vt->vData.getPageNumByName(StressScene::pageName(p)));
+
+    // 判定を測るページ（最後のページ）のオブジェクトには押した瞬間に反応するプロセスを足しておく
+    // （StressScene のプロセスは種類がばらけるため、小さなシーンでは押しても反応するものがない）
+    vt->vData.changeEditPage(pageNums.back());
+    vt->tData.changeEditPage(pageNums.back());
+    for (const auto& obj : vt->vData.getPageDataRef(pageNums.back())->objects) {
+      if (!obj.isUntouchable) vt->tData.createProcess("press" + obj.objectName, obj.objectName, TouchDataSet::TouchType::Press);
+    }
+    vt->tData.commitProcessEdit();
+
+    // 編集ページの切り替え
+    Sample& visualChange = add("VisualData::changeEditPage");
+    Sample& touchChange  = add("TouchData::changeEditPage");
+    for (int i = 0; i < iterations; i++) {
+      int pageNum = pageNums[size_t(i) % pageNums.size()];
+      measure(visualChange, [&] { vt->vData.changeEditPage(pageNum); });
+      measure(touchChange,  [&] { vt->tData.changeEditPage(pageNum); });
+    }
+
+    // 描画（最後に作ったページ）
+    String targetPage = StressScene::pageName(pageCount - 1);
+    Sample& drawPage = add("VisualData::drawPage");
+    for (int i = 0; i < iterations; i++) {
+      measure(drawPage, [&] { vt->vData.drawPage(sprite, targetPage); });
+    }
+    vt->tData.setProcessPage();
+
+    Sample& drawProcess = add("TouchData::drawPageProcess");
+    for (int i = 0; i < iterations; i++) {
+      measure(drawProcess, [&] { vt->tData.drawPageProcess(); });
+    }
+
+    // 判定（オブジェクトの中の固定乱数の座標）
+    // judgeProcess は有効プロセスがないと即座に戻るため、押した直後として有効化してから測る
+    Sample& judge = add("TouchData::judgeProcess");
+    StressScene::Rng touchRng(12345);
+    std::vector<VisualDataSet::Rect> targets;
+    for (const auto& obj : vt->vData.currentPageCopy.objects) {
+      VisualDataSet::Rect bounds;
+      if (obj.isUntouchable || obj.isHidden || !vt->vData.getObjectBounds(sprite, obj, bounds)) continue;
+      // 画面内に収まる部分だけを押す
+      int32_t x0 = std::max<int32_t>(bounds.x, 0), y0 = std::max<int32_t>(bounds.y, 0);
+      int32_t x1 = std::min<int32_t>(bounds.x + bounds.w, SCREEN_W), y1 = std::min<int32_t>(bounds.y + bounds.h, SCREEN_H);
+      if (x1 > x0 && y1 > y0) targets.push_back(VisualDataSet::Rect{ x0, y0, x1 - x0, y1 - y0 });
+    }
+    host::setVirtualClock(true);
+    auto press = [&](int x, int y) {
+      M5.Touch.press(int16_t(x), int16_t(y));
+      host::advanceMillis(16);
+      M5.update();
+      vt->tData.setProcessPage();
+      vt->tData.enableProcess(true);
+    };
+    auto release = [&] {
+      M5.Touch.release();
+      host::advanceMillis(16);
+      M5.update();
+    };
+
+    // 計測の前に、オブジェクトの中を押せば判定が見つかることを確かめる
+    // （線や Clip で削られた形もあるので、外接矩形の中を粗くたどる）
+    bool found = false;
+    for (auto it = targets.rbegin(); it != targets.rend() && !found; ++it) {
+      int32_t step = std::max<int32_t>(1, std::min(it->w, it->h) / 4);
+      for (int32_t y = it->y; y < it->y + it->h && !found; y += step) {
+        for (int32_t x = it->x; x < it->x + it->w && !found; x += step) {
+          press(x, y);
+          found = vt->tData.judgeProcess(x, y);
+          release();
+        }
+      }
+    }
+    if (!found) {
+      std::fprintf(stderr, "bench: judgeProcess found no process inside any object (objects=%d pages=%d)\n", objectCount, pageCount);
+      host::setVirtualClock(false);
+      sprite.deleteSprite();
+      delete vt;
+      return false;
+    }
+
+    int hits = 0;
+    for (int i = 0; i < iterations; i++) {
+      const VisualDataSet::Rect& r = targets[touchRng.next() % targets.size()];
+      int x = r.x + touchRng.range(0, r.w);
+      int y = r.y + touchRng.range(0, r.h);
+      press(x, y);
+      measure(judge, [&] { hits += vt->tData.judgeProcess(x, y); });
+      release();
+    }
+    std::fprintf(stderr, "bench: judgeProcess hit %d / %d\n", hits, iterations);
+
+    // 1 フレーム分の更新（押下 → 押し続け → 離す を繰り返す）
+    Sample& update = add("TouchData::update");
+    for (int i = 0; i < iterations; i++) {
+      switch (i % 4) {
+        case 0:  M5.Touch.press(int16_t(touchRng.range(0, SCREEN_W)), int16_t(touchRng.range(0, SCREEN_H))); break;
+        case 3:  M5.Touch.release(); break;
+        default: break;
+      }
+      host::advanceMillis(16);
+      M5.update();
+      measure(update, [&] { vt->tData.update(); });
+    }
+    M5.Touch.release();
+    host::advanceMillis(16);
+    M5.update();
+    host::setVirtualClock(false);
+
+    sprite.deleteSprite();
+    delete vt;
+    return true;
+  }
+
+  // -------------------- 出力 --------------------
+  std::vector<int> parseList(const char* text) {
+    std::vector<int> values;
+    while (*text) {
+      char* end = nullptr;
+      long v = std::strtol(text, &end, 10);
+      if (end == text) break;
+      if (v > 0) values.push_back(int(v));
+      text = (*end == ',') ? end + 1 : end;
+    }
+    return values;
+  }
+
+  void writeList(std::FILE* out, const std::vector<int>& values) {
+    std::fputc('[', out);
+    for (size_t i = 0; i < values.size(); i++) std::fprintf(out, "%s%d", i ? ", " : "", values[i]);
+    std::fputc(']', out);
+  }
+
+  void writeJson(std::FILE* out, const std::vector<int>& objects, const std::vector<int>& pages, int iterations,
+                 std::vector<Result>& results) {
+    std::fprintf(out, "{\n  \"schema\": 1,\n  \"config\": {\"objects\": ");
+    writeList(out, objects);
+    std::fprintf(out, ", \"pages\": ");
+    writeList(out, pages);
+    std::fprintf(out, ", \"iterations\": %d},\n  \"results\": [\n", iterations);
+
+    for (size_t i = 0; i < results.size(); i++) {
+      Result& r = results[i];
+      std::vector<uint64_t>& n = r.sample.nanos;
+      size_t count = n.size();
+      uint64_t total = 0;
+      for (uint64_t v : n) total += v;
+      std::sort(n.begin(), n.end());
+      double perOp = count ? 1.0 / double(count) : 0.0;
+
+      std::fprintf(out,
+        "    {\"objects\": %d, \"pages\": %d, \"op\": \"%s\", \"count\": %zu, "
+        "\"ns\": {\"min\": %llu, \"median\": %llu, \"mean\": %.1f, \"p99\": %llu, \"max\": %llu}, "
+        "\"allocs_per_op\": %.2f, \"alloc_bytes_per_op\": %.1f}%s\n",
+        r.objects, r.pages, r.op.c_str(), count,
+        (unsigned long long)(count ? n.front() : 0),
+        (unsigned long long)(count ? n[count / 2] : 0),
+        double(total) * perOp,
+        (unsigned long long)(count ? n[(count - 1) * 99 / 100] : 0),
+        (unsigned long long)(count ? n.back() : 0),
+        double(r.sample.allocs) * perOp,
+        double(r.sample.bytes) * perOp,
+        i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(out, "  ]\n}\n");
+  }
+
+} // namespace
+
+int main(int argc, char** argv) {
+  std::vector<int> objects = { 10, 100, 1000 };
+  std::vector<int> pages = { 1, 10, 50 };
+  int iterations = 50;
+  const char* outPath = "vt_bench.json";
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if      (arg.rfind("--objects=", 0) == 0)    objects = parseList(argv[i] + 10);
+    else if (arg.rfind("--pages=", 0) == 0)      pages = parseList(argv[i] + 8);
+    else if (arg.rfind("--iterations=", 0) == 0) iterations = std::max(1, std::atoi(argv[i] + 13));
+    else if (arg.rfind("--out=", 0) == 0)        outPath = argv[i] + 6;
+    else {
+      std::fprintf(stderr, "usage: %s [--objects=10,100,1000] [--pages=1,10,50] [--iterations=50] [--out=path]\n", argv[0]);
+      return 2;
+    }
+  }
+  if (objects.empty() || pages.empty()) {
+    std::fprintf(stderr, "objects / pages must not be empty\n");
+    return 2;
+  }
+
+  M5.begin();
+
+  // JPG / PNG オブジェクト用のファイルを一時ディレクトリに置き、SD のルートにする
+  StressScene::ImageRoot imageRoot;
+  if (!imageRoot.isReady()) {
+    std::fprintf(stderr, "cannot prepare image files\n");
+    return 1;
+  }
+
+  std::vector<Result> results;
+  for (int p : pages) {
+    for (int o : objects) {
+      std::fprintf(stderr, "bench: objects=%d pages=%d\n", o, p);
+      if (!runScene(o, p, iterations, results)) return 1;
+    }
+  }
+
+  // ライブラリの Serial 出力と混ざらないよう既定はファイルに書く
+  bool toStdout = std::strcmp(outPath, "-") == 0;
+  std::FILE* out = toStdout ? stdout : std::fopen(outPath, "w");
+  if (!out) {
+    std::fprintf(stderr, "cannot open %s\n", outPath);
+    return 1;
+  }
+  writeJson(out, objects, pages, iterations, results);
+  if (!toStdout) std::fclose(out);
+  return 0;
+}
@@ -0,0 +1,76 @@
+// UI ブロブのメモリ使用量レポート（env:memreport / ホスト専用）
+//
+//   python3 tools/uiblob.py ui.json ui.bin
+//   pio run -e memreport && .pio/build/memreport/program ui.bin [--budget=bytes]
+//
+// 実機と同じ 320x240 の判定用スプライトを確保し、各ページを描画・判定用に描き直したあとの
+// 使用量をページごとに出力する。--budget を付けるとページキャッシュ経由で読み込む。
+
+#include <Arduino.h>
+#include <M5Unified.h>
+#include "VisualTouch.h"
+
+int main(int argc, char** argv) {
+  const char* path = nullptr;
+  size_t budget = 0;
+  bool lazy = false;
+  for (int i = 1; i < argc; i++) {
+    if (std::strncmp(argv[i], "--budget=", 9) == 0) {
+      budget = size_t(std::strtoul(argv[i] + 9, nullptr, 10));
+      lazy = true;
+    } else if (!path) {
+      path = argv[i];
+    } else {
+      path = nullptr;
+      break;
+    }
+  }
+  if (!path) {
+    std::fprintf(stderr, "usage: %s ui.bin [--budget=bytes]\n", argv[0]);
+    return 2;
+  }
+
+  size_t size = 0;
+  const uint8_t* blob = UiBlobLoader::mapFile(path, &size);
+  if (!blob) {
+    std::fprintf(stderr, "cannot map %s\n", path);
+    return 1;
+  }
+
+  M5.begin();
+  VisualTouch vt(&M5.Display, true, false, false);
+  vt.tData.initJudgeSprite(&M5.Display);
+
+  LGFX_Sprite sprite(&M5.Display);
+  sprite.setColorDepth(16);
+  sprite.createSprite(M5.Display.width(), M5.Display.height());
+
+  bool loaded = lazy ? vt.attachUiBlob(blob, size, budget) : vt.loadUiBlob(blob, size);
+  if (!loaded) {
+    std::fprintf(stderr, "invalid blob: %s\n", path);
+    return 1;
+  }
+
+  // ページ名の一覧（遅延読み込み時は目録から）
+  std::vector<String> pageNames;
+  if (lazy) {
+    for (const auto& e : vt.pageCache.entries) pageNames.push_back(e.pageName);
+  } else {
+    for (const auto& page : vt.vData.visualDataSet.pages) pageNames.push_back(page.pageName);
+  }
+
+  Serial.printf("blob: %s (%u bytes, %u pages)\n", path, unsigned(size), unsigned(pageNames.size()));
+  Serial.printf("screen sprite: %u bytes\n\n", unsigned(sprite.bufferLength()));
+
+  for (const auto& name : pageNames) {
+    vt.vData.drawPage(sprite, name);
+    vt.tData.setProcessPage();
+    vt.tData.drawPageProcess();
+    const MemoryStats& s = vt.getMemoryStats();
+    Serial.printf("after [%s]: total %u bytes\n", name.c_str(), unsigned(s.total.total()));
+  }
+
+  Serial.printf("\n");
+  vt.printMemoryReport();
+  return 0;
+}
@@ -0,0 +1,179 @@
+// 逐次ループと RenderPipeline のスループット比較（env:pipeline / ホスト専用）
+//
+//   pio run -e pipeline && .pio/build/pipeline/program [--objects=400] [--seconds=2] [--bus-mhz=40] [--movers=8]
+//
+// StressScene のページを押しっぱなしのタッチで判定させながら、別スレッドが SceneQueue 経由で
+// movers 個のオブジェクトを 1 ms ごとに動かし続ける。パネルへの転送は bus-mhz の SPI として
+// 時間を模擬する（16 bit / 画素）。
+//   sequential : M5.update → tData.update → apply → redrawDirty → pushSprite を 1 スレッドで回す
+//   pipeline   : 同じ処理を RenderPipeline で回す（描画スレッド + DMA 転送）
+// 描画フレーム数とタッチ判定の回数を 1 秒あたりで出す。
+
+#include <Arduino.h>
+#include <M5Unified.h>
+#include "VisualTouch.h"
+#include "StressScene.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace {
+
+  using Clock = std::chrono::steady_clock;
+
+  struct Result {
+    double seconds = 0;
+    uint32_t frames = 0;
+    uint32_t touchUpdates = 0;
+    uint32_t edits = 0;
+    PipelineStats stats;
+  };
+
+  // 1 ms ごとに動かし続ける（行って戻る）
+  class Mover {
+  public:
+    Mover(SceneQueue& queue, const std::vector<SceneHandle>& handles) : queue(queue), handles(handles) {}
+
+    void start() {
+      running = true;
+      thread = std::thread([this] {
+        int step = 0;
+        while (running) {
+          int32_t dx = (step / 20) % 2 ? -2 : 2;
+          for (const auto& h : handles) {
+            if (queue.move(h, dx, 0)) sent++;
+          }
+          step++;
+          std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+      });
+    }
+    uint32_t stop() {
+      running = false;
+      thread.join();
+      return sent;
+    }
+
+  private:
+    SceneQueue& queue;
+    std::vector<SceneHandle> handles;
+    std::thread thread;
+    std::atomic<bool> running{false};
+    uint32_t sent = 0;
+  };
+
+  bool setupScene(VisualTouch& vt, int objects, std::vector<SceneHandle>& handles, int movers) {
+    StressConfig cfg;
+    cfg.objectsPerPage = objects;
+    cfg.screenW = M5.Display.width();
+    cfg.screenH = M5.Display.height();
+    StressScene::build(vt, cfg);
+    for (int i = 0; i < movers && i < objects; i++) {
+      SceneHandle h = vt.sceneQueue.getHandle("o" + String(i * (objects / movers)), vt.vData.getPageNumByName(StressScene::pageName(0)));
+      if (h.isValid()) handles.push_back(h);
+    }
+    return !handles.empty();
+  }
+
+  Result runSequential(int objects, double seconds, int movers) {
+    VisualTouch vt(&M5.Display, false, false, false);
+    vt.tData.initJudgeSprite(&M5.Display);
+    std::vector<SceneHandle> handles;
+    setupScene(vt, objects, handles, movers);
+
+    LGFX_Sprite sprite(&M5.Display);
+    sprite.setColorDepth(16);
+    sprite.createSprite(M5.Display.width(), M5.Display.height());
+    vt.vData.drawPage(sprite, StressScene::pageName(0));
+    vt.tData.setProcessPage();
+
+    Result r;
+    Mover mover(vt.sceneQueue, handles);
+    mover.start();
+    auto t0 = Clock::now();
+    while (std::chrono::duration<double>(Clock::now() - t0).count() < seconds) {
+      M5.update();
+      vt.tData.update();
+      r.touchUpdates++;
+      vt.sceneQueue.apply(sprite);
+      if (vt.vData.redrawDirty(sprite)) {
+        sprite.pushSprite(&M5.Display, 0, 0);
+        r.frames++;
+      }
+    }
+    r.seconds = std::chrono::duration<double>(Clock::now() - t0).count();
+    r.edits = mover.stop();
+    return r;
+  }
+
+  Result runPipeline(int objects, double seconds, int movers) {
+    VisualTouch vt(&M5.Display, false, false, false);
+    vt.tData.initJudgeSprite(&M5.Display);
+    std::vector<SceneHandle> handles;
+    setupScene(vt, objects, handles, movers);
+
+    vt.pipeline.frameIntervalUs = 0;
+    if (!vt.pipeline.begin(StressScene::pageName(0))) return Result();
+
+    Result r;
+    Mover mover(vt.sceneQueue, handles);
+    mover.start();
+    auto t0 = Clock::now();
+    while (std::chrono::duration<double>(Clock::now() - t0).count() < seconds) {
+      M5.update();
+      vt.pipeline.update();
+      r.touchUpdates++;
+    }
+    r.seconds = std::chrono::duration<double>(Clock::now() - t0).count();
+    r.edits = mover.stop();
+    r.stats = vt.pipeline.getStats();
+    r.frames = r.stats.frames;
+    vt.pipeline.end();
+    return r;
+  }
+
+  void print(const char* name, const Result& r) {
+    Serial.printf("%-10s  frames %7.1f /s  touch %8.1f /s  edits %6u", name, r.frames / r.seconds, r.touchUpdates / r.seconds, unsigned(r.edits));
+    if (r.stats.frames) {
+      Serial.printf("  render %7.1f us  dma wait %7.1f us  scene wait %6.1f ms", r.stats.avgRenderUs(), r.stats.avgDmaWaitUs(), r.stats.sceneWaitUs / 1000.0);
+    }
+    Serial.printf("\n");
+  }
+}
+
+int main(int argc, char** argv) {
+  int objects = 400;
+  double seconds = 2.0;
+  uint32_t busMhz = 40;
+  int movers = 8;
+  for (int i = 1; i < argc; i++) {
+    if (std::strncmp(argv[i], "--objects=", 10) == 0)      objects = std::atoi(argv[i] + 10);
+    else if (std::strncmp(argv[i], "--seconds=", 10) == 0) seconds = std::atof(argv[i] + 10);
+    else if (std::strncmp(argv[i], "--bus-mhz=", 10) == 0) busMhz = uint32_t(std::atoi(argv[i] + 10));
+    else if (std::strncmp(argv[i], "--movers=", 9) == 0)   movers = std::atoi(argv[i] + 9);
+    else {
+      std::fprintf(stderr, "usage: %s [--objects=400] [--seconds=2] [--bus-mhz=40] [--movers=8]\n", argv[0]);
+      return 2;
+    }
+  }
+  if (objects <= 0 || movers <= 0 || seconds <= 0) return 2;
+
+  M5.begin();
+
+  // JPG / PNG オブジェクト用のファイルを一時ディレクトリに置き、SD のルートにする
+  StressScene::ImageRoot imageRoot;
+  if (!imageRoot.isReady()) {
+    std::fprintf(stderr, "cannot prepare image files\n");
+    return 1;
+  }
+  M5GFX::setBusSpeed(busMhz * 1000000);
+  M5.Touch.press(M5.Display.width() / 2, M5.Display.height() / 2);   // 毎回判定させる
+
+  Serial.printf("pipeline bench: %d objects, %d movers, %.1f s, bus %u MHz\n", objects, movers, seconds, unsigned(busMhz));
+  print("sequential", runSequential(objects, seconds, movers));
+  print("pipeline", runPipeline(objects, seconds, movers));
+  return 0;
+}
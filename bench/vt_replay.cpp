@@ -0,0 +1,97 @@
+// タッチスクリプトのリプレイとタッチ遅延の集計（env:replay / ホスト専用）
+//
+//   python3 tools/uiblob.py ui.json ui.bin
+//   pio run -e replay && .pio/build/replay/program ui.bin touch.txt [--page=name] [--frame-ms=16] [--verbose]
+//
+// 仮想時計で frame-ms ごとに 1 フレーム進め、実機の loop() と同じく
+//   M5.update() → TouchLatency::acquire() → tData.update() → TouchLatency::observe()
+// の順に回す。入力の時刻は仮想時計、遅延は実時間なので、判定処理そのものの遅延が得られる。
+// touch.txt は VT_HOST_TOUCH_SCRIPT と同じ "msec x y" 形式（x < 0 で非接触）。
+
+#include <Arduino.h>
+#include <M5Unified.h>
+#include "VisualTouch.h"
+#include "TouchLatency.hpp"
+
+int main(int argc, char** argv) {
+  const char* blobPath = nullptr;
+  const char* scriptPath = nullptr;
+  String pageName = "";
+  uint32_t frameMs = 16;
+  bool verbose = false;
+  for (int i = 1; i < argc; i++) {
+    if (std::strncmp(argv[i], "--page=", 7) == 0) {
+      pageName = argv[i] + 7;
+    } else if (std::strncmp(argv[i], "--frame-ms=", 11) == 0) {
+      frameMs = uint32_t(std::strtoul(argv[i] + 11, nullptr, 10));
+    } else if (std::strcmp(argv[i], "--verbose") == 0) {
+      verbose = true;
+    } else if (!blobPath) {
+      blobPath = argv[i];
+    } else if (!scriptPath) {
+      scriptPath = argv[i];
+    } else {
+      blobPath = nullptr;
+      break;
+    }
+  }
+  if (!blobPath || !scriptPath || frameMs == 0) {
+    std::fprintf(stderr, "usage: %s ui.bin touch.txt [--page=name] [--frame-ms=16] [--verbose]\n", argv[0]);
+    return 2;
+  }
+
+  size_t size = 0;
+  const uint8_t* blob = UiBlobLoader::mapFile(blobPath, &size);
+  if (!blob) {
+    std::fprintf(stderr, "cannot map %s\n", blobPath);
+    return 1;
+  }
+
+  host::setVirtualClock(true);
+  M5.begin();
+  if (!M5.Touch.loadScript(scriptPath)) {
+    std::fprintf(stderr, "cannot read %s\n", scriptPath);
+    return 1;
+  }
+
+  VisualTouch vt(&M5.Display, true, false, false);
+  vt.tData.initJudgeSprite(&M5.Display);
+  if (!vt.loadUiBlob(blob, size)) {
+    std::fprintf(stderr, "invalid blob: %s\n", blobPath);
+    return 1;
+  }
+  if (pageName == "" && !vt.vData.visualDataSet.pages.empty()) {
+    pageName = vt.vData.visualDataSet.pages.front().pageName;
+  }
+
+  LGFX_Sprite sprite(&M5.Display);
+  sprite.setColorDepth(16);
+  sprite.createSprite(M5.Display.width(), M5.Display.height());
+  if (!vt.vData.drawPage(sprite, pageName)) {
+    std::fprintf(stderr, "page not found: %s\n", pageName.c_str());
+    return 1;
+  }
+  vt.tData.setProcessPage();
+
+  // スクリプトを読み終え、指を離したあとの 1 フレームまで回す
+  uint32_t frames = 0;
+  while (true) {
+    bool finished = M5.Touch.isScriptFinished();
+    M5.update();
+    TouchLatency::acquire();
+    if (vt.tData.update()) {
+      if (verbose && vt.tData.currentProcessName != "") {
+        Serial.printf("%8u ms  %s\n", unsigned(millis()), vt.tData.currentProcessName.c_str());
+      }
+      TouchLatency::observe();
+    }
+    sprite.pushSprite(&M5.Display, 0, 0);
+    frames++;
+    if (finished) break;
+    host::advanceMillis(frameMs);
+  }
+
+  Serial.printf("replay: %s on [%s], %u frames of %u ms\n", scriptPath, pageName.c_str(), unsigned(frames), unsigned(frameMs));
+  TouchLatency::dump();
+  return 0;
+}
@@ -0,0 +1,274 @@
+// 大規模シーンでのスケーリング計測（env:stress / ホスト専用）
+//
+//   pio run -e stress && .pio/build/stress/program --out=vt_stress.csv
+//
+// オプション
+//   --objects=100,200,400,800,1600,3200  1 ページあたりのオブジェクト数（倍々にすると傾きが読みやすい）
+//   --pages=1,8                          ページ数
+//   --iterations=15                      描画・判定の計測回数（中央値を使う）
+//   --seed=1                             シーンの乱数の種
+//   --batch                              beginVisualUpdate / beginProcessEdit でまとめて登録する
+//   --max-build-ms=20000                 構築がこれを超えたら、そのページ数ではより大きなシーンを打ち切る
+//   --out=path                           CSV の出力先（既定 vt_stress.csv、- で標準出力）
+//
+// StressScene で生成したシーンについて、構築・描画・判定・メモリがオブジェクト数に対して
+// どう伸びるかを 1 行 1 シーンの CSV に書き、最後に隣り合うサイズ間の傾き
+// （log(時間比) / log(個数比)。1 で線形、2 で二乗）を標準エラーに出す。
+
+#include <Arduino.h>
+#include <M5Unified.h>
+#include "VisualTouch.h"
+#include "StressScene.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace {
+
+  using Clock = std::chrono::steady_clock;
+  using Op = StressScene::Op;
+
+  double elapsedUs(Clock::time_point t0) {
+    return std::chrono::duration<double, std::micro>(Clock::now() - t0).count();
+  }
+
+  template <typename F>
+  double medianUs(int iterations, F&& fn) {
+    std::vector<double> samples;
+    samples.reserve(size_t(iterations));
+    for (int i = 0; i < iterations; i++) {
+      auto t0 = Clock::now();
+      fn();
+      samples.push_back(elapsedUs(t0));
+    }
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+  }
+
+  // 1 シーン分の結果
+  struct Row {
+    int pages = 0;
+    int objectsPerPage = 0;
+    size_t objects = 0;
+    size_t processes = 0;
+    double buildMs = 0;
+    double createObjectUs = 0;     // 1 回あたりの平均
+    double createProcessUs = 0;
+    double commitMs = 0;
+    double drawPageUs = 0;         // 中央値
+    double drawPageProcessUs = 0;
+    double judgeProcessUs = 0;
+    double updateUs = 0;
+    size_t memoryBytes = 0;
+  };
+
+  Row runScene(const StressConfig& cfg, int iterations) {
+    Row row;
+    row.pages = cfg.pages;
+    row.objectsPerPage = cfg.objectsPerPage;
+
+    VisualTouch* vt = new VisualTouch(&M5.Display, false, false, false);
+    vt->tData.initJudgeSprite(&M5.Display);
+    LGFX_Sprite sprite(&M5.Display);
+    sprite.setColorDepth(16);
+    sprite.createSprite(cfg.screenW, cfg.screenH);
+
+    // -------------------- 構築 --------------------
+    double opUs[3] = {};
+    size_t opCount[3] = {};
+    auto buildStart = Clock::now();
+    StressCounts counts = StressScene::build(*vt, cfg, [&](Op op, auto&& fn) {
+      auto t0 = Clock::now();
+      fn();
+      opUs[size_t(op)] += elapsedUs(t0);
+      opCount[size_t(op)]++;
+    });
+    row.buildMs = elapsedUs(buildStart) / 1000.0;
+    row.objects = counts.objects;
+    row.processes = counts.processes;
+    auto avg = [&](Op op) { size_t n = opCount[size_t(op)]; return n ? opUs[size_t(op)] / n : 0.0; };
+    row.createObjectUs = avg(Op::CreateObject);
+    row.createProcessUs = avg(Op::CreateProcess);
+    row.commitMs = opUs[size_t(Op::Commit)] / 1000.0;
+
+    // -------------------- 描画・判定（最後のページ） --------------------
+    String pageName = StressScene::pageName(cfg.pages - 1);
+    row.drawPageUs = medianUs(iterations, [&] { vt->vData.drawPage(sprite, pageName); });
+    vt->tData.setProcessPage();
+    row.drawPageProcessUs = medianUs(iterations, [&] { vt->tData.drawPageProcess(); });
+
+    // judgeProcess は有効プロセスがないと即座に戻るため、押下中として有効化してから測る
+    StressScene::Rng touchRng(12345);
+    auto nextCoord = [&](int limit) { return int(touchRng.range(0, limit)); };
+    std::vector<double> judgeSamples;
+    for (int i = 0; i < iterations; i++) {
+      int x = nextCoord(cfg.screenW);
+      int y = nextCoord(cfg.screenH);
+      vt->tData.setProcessPage();
+      vt->tData.enableProcess(true);
+      auto t0 = Clock::now();
+      vt->tData.judgeProcess(x, y);
+      judgeSamples.push_back(elapsedUs(t0));
+    }
+    std::sort(judgeSamples.begin(), judgeSamples.end());
+    row.judgeProcessUs = judgeSamples[judgeSamples.size() / 2];
+
+    // 1 フレーム分の更新（押下 → 押し続け → 離す）
+    host::setVirtualClock(true);
+    std::vector<double> updateSamples;
+    for (int i = 0; i < iterations; i++) {
+      switch (i % 4) {
+        case 0:  M5.Touch.press(int16_t(nextCoord(cfg.screenW)), int16_t(nextCoord(cfg.screenH))); break;
+        case 3:  M5.Touch.release(); break;
+        default: break;
+      }
+      host::advanceMillis(16);
+      M5.update();
+      auto t0 = Clock::now();
+      vt->tData.update();
+      updateSamples.push_back(elapsedUs(t0));
+    }
+    M5.Touch.release();
+    host::advanceMillis(16);
+    M5.update();
+    host::setVirtualClock(false);
+    std::sort(updateSamples.begin(), updateSamples.end());
+    row.updateUs = updateSamples[updateSamples.size() / 2];
+
+    row.memoryBytes = vt->getMemoryStats().total.total();
+
+    sprite.deleteSprite();
+    delete vt;
+    return row;
+  }
+
+  // -------------------- 出力 --------------------
+  std::vector<int> parseList(const char* text) {
+    std::vector<int> values;
+    while (*text) {
+      char* end = nullptr;
+      long v = std::strtol(text, &end, 10);
+      if (end == text) break;
+      if (v > 0) values.push_back(int(v));
+      text = (*end == ',') ? end + 1 : end;
+    }
+    return values;
+  }
+
+  void writeCsv(std::FILE* out, const std::vector<Row>& rows) {
+    std::fprintf(out, "pages,objects_per_page,objects,processes,build_ms,create_object_us,create_process_us,commit_ms,"
+                      "draw_page_us,draw_page_process_us,judge_process_us,update_us,memory_bytes\n");
+    for (const Row& r : rows) {
+      std::fprintf(out, "%d,%d,%zu,%zu,%.2f,%.3f,%.3f,%.2f,%.1f,%.1f,%.1f,%.1f,%zu\n",
+                   r.pages, r.objectsPerPage, r.objects, r.processes, r.buildMs, r.createObjectUs, r.createProcessUs,
+                   r.commitMs, r.drawPageUs, r.drawPageProcessUs, r.judgeProcessUs, r.updateUs, r.memoryBytes);
+    }
+  }
+
+  // 同じページ数の隣り合うシーン間の傾き
+  void printSlopes(const std::vector<Row>& rows) {
+    struct Metric { const char* name; double (*get)(const Row&); };
+    const Metric metrics[] = {
+      { "build",           [](const Row& r) { return r.buildMs; } },
+      { "createObject",    [](const Row& r) { return r.createObjectUs; } },
+      { "createProcess",   [](const Row& r) { return r.createProcessUs; } },
+      { "drawPage",        [](const Row& r) { return r.drawPageUs; } },
+      { "drawPageProcess", [](const Row& r) { return r.drawPageProcessUs; } },
+      { "judgeProcess",    [](const Row& r) { return r.judgeProcessUs; } },
+      { "update",          [](const Row& r) { return r.updateUs; } },
+      { "memory",          [](const Row& r) { return double(r.memoryBytes); } },
+    };
+
+    std::fprintf(stderr, "\nscaling exponent vs objects per page (1 = linear, 2 = quadratic)\n");
+    for (size_t i = 1; i < rows.size(); i++) {
+      const Row& a = rows[i - 1];
+      const Row& b = rows[i];
+      if (a.pages != b.pages || b.objectsPerPage <= a.objectsPerPage) continue;
+      double n = std::log(double(b.objectsPerPage) / a.objectsPerPage);
+      std::fprintf(stderr, "  pages %3d  %5d -> %5d :", b.pages, a.objectsPerPage, b.objectsPerPage);
+      for (const Metric& m : metrics) {
+        double va = m.get(a), vb = m.get(b);
+        if (va > 0 && vb > 0) std::fprintf(stderr, "  %s %5.2f", m.name, std::log(vb / va) / n);
+        else                  std::fprintf(stderr, "  %s   n/a", m.name);
+      }
+      std::fprintf(stderr, "\n");
+    }
+  }
+
+} // namespace
+
+int main(int argc, char** argv) {
+  std::vector<int> objects = { 100, 200, 400, 800, 1600, 3200 };
+  std::vector<int> pages = { 1, 8 };
+  int iterations = 15;
+  uint32_t seed = 1;
+  bool batch = false;
+  double maxBuildMs = 20000;
+  const char* outPath = "vt_stress.csv";
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if      (arg.rfind("--objects=", 0) == 0)      objects = parseList(argv[i] + 10);
+    else if (arg.rfind("--pages=", 0) == 0)        pages = parseList(argv[i] + 8);
+    else if (arg.rfind("--iterations=", 0) == 0)   iterations = std::max(1, std::atoi(argv[i] + 13));
+    else if (arg.rfind("--seed=", 0) == 0)         seed = uint32_t(std::strtoul(argv[i] + 7, nullptr, 10));
+    else if (arg == "--batch")                     batch = true;
+    else if (arg.rfind("--max-build-ms=", 0) == 0) maxBuildMs = std::atof(argv[i] + 15);
+    else if (arg.rfind("--out=", 0) == 0)          outPath = argv[i] + 6;
+    else {
+      std::fprintf(stderr, "usage: %s [--objects=100,200,...] [--pages=1,8] [--iterations=15] [--seed=1] [--batch] "
+                           "[--max-build-ms=20000] [--out=path]\n", argv[0]);
+      return 2;
+    }
+  }
+  if (objects.empty() || pages.empty()) {
+    std::fprintf(stderr, "objects / pages must not be empty\n");
+    return 2;
+  }
+  std::sort(objects.begin(), objects.end());
+
+  M5.begin();
+
+  // JPG / PNG オブジェクト用のファイルを一時ディレクトリに置き、SD のルートにする
+  StressScene::ImageRoot imageRoot;
+  if (!imageRoot.isReady()) {
+    std::fprintf(stderr, "cannot prepare image files\n");
+    return 1;
+  }
+
+  std::vector<Row> rows;
+  for (int p : pages) {
+    for (int o : objects) {
+      StressConfig cfg;
+      cfg.pages = p;
+      cfg.objectsPerPage = o;
+      cfg.seed = seed;
+      cfg.batch = batch;
+      Row row = runScene(cfg, iterations);
+      std::fprintf(stderr, "stress: pages=%d objects=%d processes=%zu build %.1f ms, draw %.0f us, judge %.0f us, %zu bytes\n",
+                   p, o, row.processes, row.buildMs, row.drawPageUs, row.judgeProcessUs, row.memoryBytes);
+      rows.push_back(row);
+      if (maxBuildMs > 0 && row.buildMs > maxBuildMs) {
+        std::fprintf(stderr, "stress: build exceeded %.0f ms, skipping larger scenes for pages=%d\n", maxBuildMs, p);
+        break;
+      }
+    }
+  }
+
+  // ライブラリの Serial 出力と混ざらないよう既定はファイルに書く
+  bool toStdout = std::strcmp(outPath, "-") == 0;
+  std::FILE* out = toStdout ? stdout : std::fopen(outPath, "w");
+  if (!out) {
+    std::fprintf(stderr, "cannot open %s\n", outPath);
+    return 1;
+  }
+  writeCsv(out, rows);
+  if (!toStdout) std::fclose(out);
+
+  printSlopes(rows);
+  return 0;
+}
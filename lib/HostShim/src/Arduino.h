@@ -0,0 +1,150 @@
+#pragma once
+
+// ホストビルド用 Arduino 互換レイヤ
+// VisualData / TouchData が使用する範囲のみを実装している
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdarg>
+#include <cmath>
+#include <climits>
+#include <string>
+#include <algorithm>
+
+#ifndef PROGMEM
+#define PROGMEM
+#endif
+
+#define F(str) (str)
+
+using std::min;
+using std::max;
+
+// -------------------- 時間 --------------------
+namespace host {
+  // 仮想時計モード（true の間は delay()/advanceMillis() でのみ時間が進む）
+  void setVirtualClock(bool enable);
+  bool isVirtualClock();
+  void advanceMillis(uint32_t ms);
+  // 仮想時計モードで micros() を読むたびに進める時間 [us]（処理時間の上限を決まった回数で超えさせるテスト用）
+  void setMicrosPerRead(uint32_t us);
+}
+
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void yield();
+
+// -------------------- String --------------------
+class String {
+public:
+  String() {}
+  String(const char* s) : str(s ? s : "") {}
+  String(const std::string& s) : str(s) {}
+  String(char c) : str(1, c) {}
+  String(int v)                { str = std::to_string(v); }
+  String(unsigned int v)       { str = std::to_string(v); }
+  String(long v)               { str = std::to_string(v); }
+  String(unsigned long v)      { str = std::to_string(v); }
+  String(long long v)          { str = std::to_string(v); }
+  String(unsigned long long v) { str = std::to_string(v); }
+  String(float v, unsigned int decimals = 2)  { setFloat(v, decimals); }
+  String(double v, unsigned int decimals = 2) { setFloat(v, decimals); }
+  String(bool v) : str(v ? "1" : "0") {}
+
+  const char* c_str() const { return str.c_str(); }
+  unsigned int length() const { return str.length(); }
+  bool isEmpty() const { return str.empty(); }
+  bool reserve(unsigned int size) { str.reserve(size); return true; }
+
+  bool equals(const String& s) const { return str == s.str; }
+  bool startsWith(const String& s) const { return str.compare(0, s.str.size(), s.str) == 0; }
+  int indexOf(char c, unsigned int from = 0) const {
+    auto p = str.find(c, from);
+    return p == std::string::npos ? -1 : int(p);
+  }
+  String substring(unsigned int from) const { return from < str.size() ? String(str.substr(from)) : String(); }
+  String substring(unsigned int from, unsigned int to) const {
+    if (from >= str.size() || to <= from) return String();
+    return String(str.substr(from, to - from));
+  }
+  long toInt() const { return std::strtol(str.c_str(), nullptr, 10); }
+  float toFloat() const { return std::strtof(str.c_str(), nullptr); }
+
+  char operator[](unsigned int i) const { return i < str.size() ? str[i] : 0; }
+
+  String& operator+=(const String& s) { str += s.str; return *this; }
+  String& operator+=(const char* s)   { if (s) str += s; return *this; }
+  String& operator+=(char c)          { str += c; return *this; }
+  String& operator+=(int v)           { str += std::to_string(v); return *this; }
+
+  bool operator==(const String& s) const { return str == s.str; }
+  bool operator!=(const String& s) const { return str != s.str; }
+  bool operator==(const char* s) const { return str == (s ? s : ""); }
+  bool operator!=(const char* s) const { return !(*this == s); }
+  bool operator<(const String& s) const { return str < s.str; }
+
+  const std::string& std_str() const { return str; }
+
+private:
+  std::string str;
+
+  void setFloat(double v, unsigned int decimals) {
+    char buf[64];
+    std::snprintf(buf, sizeof(buf), "%.*f", int(decimals), v);
+    str = buf;
+  }
+};
+
+inline String operator+(const String& a, const String& b) { String r(a); r += b; return r; }
+inline String operator+(const String& a, const char* b)   { String r(a); r += b; return r; }
+inline String operator+(const char* a, const String& b)   { String r(a); r += b; return r; }
+inline String operator+(const String& a, char b)          { String r(a); r += b; return r; }
+inline String operator+(const String& a, int b)           { String r(a); r += String(b); return r; }
+inline String operator+(const String& a, unsigned int b)  { String r(a); r += String(b); return r; }
+inline String operator+(const String& a, long b)          { String r(a); r += String(b); return r; }
+inline String operator+(const String& a, unsigned long b) { String r(a); r += String(b); return r; }
+inline String operator+(const String& a, float b)         { String r(a); r += String(b); return r; }
+inline String operator+(const String& a, double b)        { String r(a); r += String(b); return r; }
+
+// -------------------- Serial --------------------
+class HardwareSerial {
+public:
+  void begin(unsigned long) {}
+  void end() {}
+  operator bool() const { return true; }
+
+  size_t print(const String& s)   { return std::fputs(s.c_str(), stdout) < 0 ? 0 : s.length(); }
+  size_t print(const char* s)     { return s ? std::fputs(s, stdout) < 0 ? 0 : std::strlen(s) : 0; }
+  size_t print(char c)            { return std::fputc(c, stdout) < 0 ? 0 : 1; }
+  size_t print(int v)             { return std::printf("%d", v); }
+  size_t print(unsigned int v)    { return std::printf("%u", v); }
+  size_t print(long v)            { return std::printf("%ld", v); }
+  size_t print(unsigned long v)   { return std::printf("%lu", v); }
+  size_t print(double v, int d = 2) { return std::printf("%.*f", d, v); }
+
+  size_t println()                { return print('\n'); }
+  template <typename T>
+  size_t println(const T& v)      { size_t n = print(v); return n + println(); }
+
+  size_t printf(const char* fmt, ...) __attribute__((format(printf, 2, 3))) {
+    va_list ap;
+    va_start(ap, fmt);
+    int n = std::vprintf(fmt, ap);
+    va_end(ap);
+    return n < 0 ? 0 : size_t(n);
+  }
+
+  size_t write(const uint8_t* buf, size_t len) { return std::fwrite(buf, 1, len, stdout); }
+  size_t write(uint8_t c) { return print(char(c)); }
+  void flush() { std::fflush(stdout); }
+};
+
+extern HardwareSerial Serial;
+
+// -------------------- Arduino エントリポイント --------------------
+void setup();
+void loop();
@@ -0,0 +1,135 @@
+#include <Arduino.h>
+#include <FS.h>
+#include <SD.h>
+#include <SPIFFS.h>
+#include <LittleFS.h>
+
+#include <chrono>
+#include <thread>
+#include <sys/stat.h>
+#include <unistd.h>
+
+HardwareSerial Serial;
+
+// -------------------- 時間 --------------------
+namespace {
+  using Clock = std::chrono::steady_clock;
+  const Clock::time_point bootTime = Clock::now();
+
+  bool virtualClock = false;
+  uint64_t virtualMicros = 0;
+  uint32_t microsPerRead = 0;
+
+  uint64_t realMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - bootTime).count();
+  }
+}
+
+void host::setVirtualClock(bool enable) {
+  if (enable && !virtualClock) virtualMicros = realMicros();
+  virtualClock = enable;
+}
+bool host::isVirtualClock() {
+  return virtualClock;
+}
+void host::advanceMillis(uint32_t ms) {
+  virtualMicros += uint64_t(ms) * 1000;
+}
+void host::setMicrosPerRead(uint32_t us) {
+  microsPerRead = us;
+}
+
+uint32_t millis() {
+  return uint32_t((virtualClock ? virtualMicros : realMicros()) / 1000);
+}
+uint32_t micros() {
+  if (!virtualClock) return uint32_t(realMicros());
+  uint32_t now = uint32_t(virtualMicros);
+  virtualMicros += microsPerRead;
+  return now;
+}
+void delay(uint32_t ms) {
+  if (virtualClock) {
+    host::advanceMillis(ms);
+  } else {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+  }
+}
+void yield() {
+  std::this_thread::yield();
+}
+
+// -------------------- ファイルシステム --------------------
+namespace {
+  const char* envOr(const char* name, const char* fallback) {
+    const char* v = std::getenv(name);
+    return (v && *v) ? v : fallback;
+  }
+}
+
+fs::SDFS SD;
+fs::SPIFFSFS SPIFFS;
+fs::LittleFSFS LittleFS;
+
+fs::SDFS::SDFS() : FS(envOr("VT_HOST_SD_ROOT", ".")) {}
+fs::SPIFFSFS::SPIFFSFS() : FS(envOr("VT_HOST_SPIFFS_ROOT", ".")) {}
+fs::LittleFSFS::LittleFSFS() : FS(envOr("VT_HOST_LITTLEFS_ROOT", ".")) {}
+
+size_t fs::File::size() const {
+  if (!handle) return 0;
+  struct stat st;
+  if (fstat(fileno(handle.get()), &st) != 0) return 0;
+  return size_t(st.st_size);
+}
+
+String fs::FS::resolve(const char* path) const {
+  String p = path ? path : "";
+  if (!p.startsWith("/")) p = "/" + p;
+  return root + p;
+}
+
+// create は実機と同じく、書き込みで開くときに途中のディレクトリを作る
+fs::File fs::FS::open(const char* path, const char* mode, bool create) {
+  String full = resolve(path);
+  bool isWrite = std::strcmp(mode, FILE_WRITE) == 0;
+  bool isAppend = std::strcmp(mode, FILE_APPEND) == 0;
+  if (create && (isWrite || isAppend)) {
+    for (int slash = full.indexOf('/', root.length() + 1); slash >= 0; slash = full.indexOf('/', slash + 1)) {
+      ::mkdir(full.substring(0, slash).c_str(), 0755);
+    }
+  }
+  const char* m = isWrite ? "wb" : isAppend ? "ab" : "rb";
+  std::FILE* fp = std::fopen(full.c_str(), m);
+  if (!fp) return File();
+  return File(fp, path);
+}
+
+bool fs::FS::exists(const char* path) {
+  struct stat st;
+  return stat(resolve(path).c_str(), &st) == 0;
+}
+
+bool fs::FS::remove(const char* path) {
+  return ::unlink(resolve(path).c_str()) == 0;
+}
+
+bool fs::FS::mkdir(const char* path) {
+  return ::mkdir(resolve(path).c_str(), 0755) == 0;
+}
+
+// -------------------- エントリポイント --------------------
+// テストやベンチマークが独自の main() を持つ場合はそちらが優先される
+// VT_HOST_LOOPS でスケッチの loop() 呼び出し回数を指定できる（既定 1）
+__attribute__((weak)) void setup();
+__attribute__((weak)) void loop();
+
+__attribute__((weak)) int main() {
+  if (!setup || !loop) return 0;
+  setup();
+  long loops = std::strtol(envOr("VT_HOST_LOOPS", "1"), nullptr, 10);
+  for (long i = 0; loops <= 0 || i < loops; i++) {
+    loop();
+  }
+  std::fflush(stdout);
+  return 0;
+}
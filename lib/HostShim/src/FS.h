@@ -0,0 +1,79 @@
+#pragma once
+
+// ホストビルド用ファイルシステム互換レイヤ
+// ルートディレクトリ以下の実ファイルを fs::File として扱う
+
+#include <Arduino.h>
+#include <memory>
+
+#define FILE_READ   "r"
+#define FILE_WRITE  "w"
+#define FILE_APPEND "a"
+
+namespace fs {
+
+class File {
+public:
+  File() {}
+  File(std::FILE* fp, const String& path) : handle(fp, &std::fclose), filePath(path) {}
+
+  operator bool() const { return (bool)handle; }
+
+  size_t size() const;
+  size_t position() const { return handle ? size_t(std::ftell(handle.get())) : 0; }
+  bool seek(uint32_t pos) { return handle && std::fseek(handle.get(), long(pos), SEEK_SET) == 0; }
+  int available() const { return handle ? int(size() - position()) : 0; }
+
+  int read() {
+    if (!handle) return -1;
+    int c = std::fgetc(handle.get());
+    return c == EOF ? -1 : c;
+  }
+  size_t read(uint8_t* buf, size_t len) { return handle ? std::fread(buf, 1, len, handle.get()) : 0; }
+  size_t readBytes(char* buf, size_t len) { return read(reinterpret_cast<uint8_t*>(buf), len); }
+
+  size_t write(const uint8_t* buf, size_t len) { return handle ? std::fwrite(buf, 1, len, handle.get()) : 0; }
+  size_t write(uint8_t c) { return write(&c, 1); }
+
+  void flush() { if (handle) std::fflush(handle.get()); }
+  void close() { handle.reset(); }
+
+  const char* path() const { return filePath.c_str(); }
+  const char* name() const {
+    const char* p = std::strrchr(filePath.c_str(), '/');
+    return p ? p + 1 : filePath.c_str();
+  }
+
+private:
+  std::shared_ptr<std::FILE> handle;
+  String filePath;
+};
+
+class FS {
+public:
+  explicit FS(const char* defaultRoot = ".") : root(defaultRoot) {}
+
+  bool begin(...) { return true; }
+  void end() {}
+
+  // 実ファイルを置くディレクトリを設定する
+  void setRoot(const String& dir) { root = dir; }
+  const String& getRoot() const { return root; }
+
+  File open(const char* path, const char* mode = FILE_READ, bool create = false);
+  File open(const String& path, const char* mode = FILE_READ, bool create = false) { return open(path.c_str(), mode, create); }
+  bool exists(const char* path);
+  bool exists(const String& path) { return exists(path.c_str()); }
+  bool remove(const char* path);
+  bool mkdir(const char* path);
+
+private:
+  String root;
+
+  String resolve(const char* path) const;
+};
+
+} // namespace fs
+
+using fs::File;
+using fs::FS;
@@ -0,0 +1,39 @@
+#pragma once
+
+// ホストビルド用 JPEGDecoder 互換レイヤ
+// 画像サイズの取得（SOF マーカーの読み取り）のみを行う
+
+#include <Arduino.h>
+#include <FS.h>
+
+class JPEGDecoder {
+public:
+  int width = 0;
+  int height = 0;
+
+  int decodeSdFile(File& file) {
+    width = height = 0;
+    if (!file) return 0;
+    file.seek(0);
+    if (file.read() != 0xFF || file.read() != 0xD8) return 0;
+    for (;;) {
+      int m = file.read();
+      if (m < 0) return 0;
+      if (m != 0xFF) continue;
+      int type = file.read();
+      while (type == 0xFF) type = file.read();
+      if (type < 0) return 0;
+      int len = (file.read() << 8) | file.read();
+      if (type >= 0xC0 && type <= 0xC3) {
+        file.read();
+        height = (file.read() << 8) | file.read();
+        width  = (file.read() << 8) | file.read();
+        return (width > 0 && height > 0) ? 1 : 0;
+      }
+      file.seek(uint32_t(file.position() + len - 2));
+    }
+  }
+  int decodeFsFile(File& file) { return decodeSdFile(file); }
+};
+
+extern JPEGDecoder JpegDec;
@@ -0,0 +1,3 @@
+#include <JPEGDecoder.h>
+
+JPEGDecoder JpegDec;
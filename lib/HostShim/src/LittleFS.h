@@ -0,0 +1,16 @@
+#pragma once
+
+// ホストビルド用 LittleFS 互換レイヤ
+// 既定のルートは環境変数 VT_HOST_LITTLEFS_ROOT、未設定ならカレントディレクトリ
+
+#include "FS.h"
+
+namespace fs {
+class LittleFSFS : public FS {
+public:
+  LittleFSFS();
+  bool format() { return true; }
+};
+}
+
+extern fs::LittleFSFS LittleFS;
@@ -0,0 +1,332 @@
+#pragma once
+
+// ホストビルド用 M5GFX / LovyanGFX 互換レイヤ
+// 画面・スプライトはすべて RGB565 のメモリバッファとして扱う（パネルはヘッドレス）
+// 図形は LovyanGFX と同じ座標規約で素朴にラスタライズし、文字と画像は
+// 外接矩形を保ったブロック表示で代用する
+
+#include <Arduino.h>
+#include <FS.h>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <type_traits>
+
+namespace lgfx {
+
+  // -------------------- フォント --------------------
+  struct FontMetrics {
+    int16_t width;
+    int16_t x_advance;
+    int16_t x_offset;
+    int16_t height;
+    int16_t y_advance;
+    int16_t y_offset;
+    int16_t baseline;
+  };
+
+  // ホスト版では 1 文字の送り幅と高さだけを持つ（ベースラインは上から高さの 3/4）
+  struct IFont {
+    uint8_t width;
+    uint8_t height;
+    constexpr IFont(uint8_t w, uint8_t h) : width(w), height(h) {}
+    void getDefaultMetric(FontMetrics* metrics) const {
+      *metrics = FontMetrics{ width, width, 0, height, height, 0, int16_t(height * 3 / 4) };
+    }
+  };
+
+  namespace fonts {
+    extern const IFont Font0;
+    extern const IFont Font2;
+    extern const IFont Font4;
+    extern const IFont lgfxJapanGothic_12;
+    extern const IFont lgfxJapanGothic_16;
+    extern const IFont lgfxJapanGothic_20;
+    extern const IFont lgfxJapanGothic_24;
+    extern const IFont lgfxJapanGothic_28;
+    extern const IFont lgfxJapanGothic_32;
+    extern const IFont lgfxJapanGothic_36;
+    extern const IFont lgfxJapanGothic_40;
+    extern const IFont efontJA_16;
+    extern const IFont DejaVu12;
+    extern const IFont DejaVu24;
+  }
+
+  namespace textdatum {
+    enum textdatum_t : uint8_t {
+      top_left        = 0x00,
+      top_center      = 0x01,
+      top_centre      = 0x01,
+      top_right       = 0x02,
+      middle_left     = 0x04,
+      middle_center   = 0x05,
+      middle_centre   = 0x05,
+      middle_right    = 0x06,
+      bottom_left     = 0x08,
+      bottom_center   = 0x09,
+      bottom_centre   = 0x09,
+      bottom_right    = 0x0A,
+      baseline_left   = 0x10,
+      baseline_center = 0x11,
+      baseline_centre = 0x11,
+      baseline_right  = 0x12
+    };
+  }
+  using namespace textdatum;
+
+  // -------------------- 色変換 --------------------
+  // LovyanGFX と同じく uint8_t = RGB332, uint32_t = RGB888, それ以外 (int, uint16_t) = RGB565
+  inline uint16_t color888to565(uint32_t c) {
+    return uint16_t(((c >> 8) & 0xF800) | ((c >> 5) & 0x07E0) | ((c >> 3) & 0x001F));
+  }
+  inline uint16_t color332to565(uint8_t c) {
+    uint8_t r = (c >> 5) & 7, g = (c >> 2) & 7, b = c & 3;
+    return uint16_t(((r * 31 / 7) << 11) | ((g * 63 / 7) << 5) | (b * 31 / 3));
+  }
+  template <typename T>
+  inline uint16_t toColor565(T c) {
+    if (std::is_same<T, uint8_t>::value) return color332to565(uint8_t(c));
+    if (std::is_same<T, uint32_t>::value || std::is_same<T, unsigned long>::value) return color888to565(uint32_t(c));
+    return uint16_t(c);
+  }
+
+  // スプライトのバッファ形式（実機はバイトスワップ済み RGB565、ホスト版はそのままの RGB565）
+  struct swap565_t { uint16_t raw; };
+
+  // -------------------- 描画面 --------------------
+  class LovyanGFX {
+  public:
+    LovyanGFX() {}
+    virtual ~LovyanGFX() {}
+
+    int32_t width() const  { return _width; }
+    int32_t height() const { return _height; }
+    uint8_t getColorDepth() const { return _colorDepth; }
+
+    void startWrite() { _writeDepth++; }
+    void endWrite()   { if (_writeDepth) _writeDepth--; }
+
+    // クリップ
+    void setClipRect(int32_t x, int32_t y, int32_t w, int32_t h);
+    void getClipRect(int32_t* x, int32_t* y, int32_t* w, int32_t* h) const;
+    void clearClipRect();
+
+    // 基本図形
+    template <typename T> void fillScreen(const T& c) { fillRectRaw(0, 0, _width, _height, toColor565(c)); }
+    template <typename T> void drawPixel(int32_t x, int32_t y, const T& c) { writePixel(x, y, toColor565(c)); }
+    template <typename T> void drawFastHLine(int32_t x, int32_t y, int32_t w, const T& c) { fillRectRaw(x, y, w, 1, toColor565(c)); }
+    template <typename T> void drawFastVLine(int32_t x, int32_t y, int32_t h, const T& c) { fillRectRaw(x, y, 1, h, toColor565(c)); }
+    template <typename T> void drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, const T& c) { lineRaw(x0, y0, x1, y1, toColor565(c)); }
+    template <typename T> void drawBezier(int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t x2, int32_t y2, const T& c) { bezierRaw(x0, y0, x1, y1, x2, y2, toColor565(c)); }
+    template <typename T> void drawWideLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, float r, const T& c) { wideLineRaw(x0, y0, x1, y1, r, toColor565(c)); }
+
+    template <typename T> void drawRect(int32_t x, int32_t y, int32_t w, int32_t h, const T& c) { rectRaw(x, y, w, h, toColor565(c)); }
+    template <typename T> void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, const T& c) { fillRectRaw(x, y, w, h, toColor565(c)); }
+    template <typename T> void drawRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t r, const T& c) { roundRectRaw(x, y, w, h, r, toColor565(c), false); }
+    template <typename T> void fillRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t r, const T& c) { roundRectRaw(x, y, w, h, r, toColor565(c), true); }
+
+    template <typename T> void drawCircle(int32_t x, int32_t y, int32_t r, const T& c) { ellipseRaw(x, y, r, r, toColor565(c), false); }
+    template <typename T> void fillCircle(int32_t x, int32_t y, int32_t r, const T& c) { ellipseRaw(x, y, r, r, toColor565(c), true); }
+    template <typename T> void drawEllipse(int32_t x, int32_t y, int32_t rx, int32_t ry, const T& c) { ellipseRaw(x, y, rx, ry, toColor565(c), false); }
+    template <typename T> void fillEllipse(int32_t x, int32_t y, int32_t rx, int32_t ry, const T& c) { ellipseRaw(x, y, rx, ry, toColor565(c), true); }
+    template <typename T> void drawTriangle(int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t x2, int32_t y2, const T& c) {
+      uint16_t c565 = toColor565(c);
+      lineRaw(x0, y0, x1, y1, c565); lineRaw(x1, y1, x2, y2, c565); lineRaw(x2, y2, x0, y0, c565);
+    }
+    template <typename T> void fillTriangle(int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t x2, int32_t y2, const T& c) { fillTriangleRaw(x0, y0, x1, y1, x2, y2, toColor565(c)); }
+
+    template <typename T> void drawArc(int32_t x, int32_t y, int32_t r0, int32_t r1, float a0, float a1, const T& c) { ellipseArcRaw(x, y, r0, r1, r0, r1, a0, a1, toColor565(c), false); }
+    template <typename T> void fillArc(int32_t x, int32_t y, int32_t r0, int32_t r1, float a0, float a1, const T& c) { ellipseArcRaw(x, y, r0, r1, r0, r1, a0, a1, toColor565(c), true); }
+    template <typename T> void drawEllipseArc(int32_t x, int32_t y, int32_t r0x, int32_t r1x, int32_t r0y, int32_t r1y, float a0, float a1, const T& c) { ellipseArcRaw(x, y, r0x, r1x, r0y, r1y, a0, a1, toColor565(c), false); }
+    template <typename T> void fillEllipseArc(int32_t x, int32_t y, int32_t r0x, int32_t r1x, int32_t r0y, int32_t r1y, float a0, float a1, const T& c) { ellipseArcRaw(x, y, r0x, r1x, r0y, r1y, a0, a1, toColor565(c), true); }
+
+    // 画像（ホスト版はヘッダからサイズを読み、外接矩形をプレースホルダ色で塗る）
+    void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data);
+    // DMA 転送（基底クラスは同期コピー、パネルは M5GFX で別スレッド）。waitDMA() までは data を書き換えないこと
+    virtual void pushImageDMA(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data) { pushImage(x, y, w, h, data); }
+    void pushImageDMA(int32_t x, int32_t y, int32_t w, int32_t h, const swap565_t* data) { pushImageDMA(x, y, w, h, reinterpret_cast<const uint16_t*>(data)); }
+    virtual void waitDMA() {}
+    bool drawJpg(fs::File* file, int32_t x = 0, int32_t y = 0, int32_t maxWidth = 0, int32_t maxHeight = 0,
+                 int32_t offX = 0, int32_t offY = 0, float scaleX = 1.0f, float scaleY = 0.0f);
+    bool drawPng(fs::File* file, int32_t x = 0, int32_t y = 0, int32_t maxWidth = 0, int32_t maxHeight = 0,
+                 int32_t offX = 0, int32_t offY = 0, float scaleX = 1.0f, float scaleY = 0.0f);
+
+    // 文字
+    void setFont(const IFont* font) { _font = font ? font : &fonts::Font0; }
+    const IFont* getFont() const { return _font; }
+    void setTextDatum(textdatum_t datum) { _datum = datum; }
+    textdatum_t getTextDatum() const { return _datum; }
+    template <typename T> void setTextColor(T fg) { _textFg = toColor565(fg); _textBgOpaque = false; }
+    template <typename T, typename U> void setTextColor(T fg, U bg) { _textFg = toColor565(fg); _textBg = toColor565(bg); _textBgOpaque = true; }
+    void setTextSize(float size) { _textSizeX = _textSizeY = size > 0 ? size : 1; }
+    void setTextSize(float sx, float sy) { _textSizeX = sx > 0 ? sx : 1; _textSizeY = sy > 0 ? sy : 1; }
+    void setTextWrap(bool wrapX, bool wrapY = false) { _textWrapX = wrapX; _textWrapY = wrapY; }
+    int32_t fontHeight() const { return int32_t(_font->height * _textSizeY); }
+    int32_t textWidth(const char* text) const;
+    int32_t drawString(const char* text, int32_t x, int32_t y);
+    int32_t drawString(const String& text, int32_t x, int32_t y) { return drawString(text.c_str(), x, y); }
+
+    void setCursor(int32_t x, int32_t y) { _cursorX = x; _cursorY = y; }
+    size_t print(const char* text);
+    size_t print(const String& text) { return print(text.c_str()); }
+    size_t println(const char* text = "") { size_t n = print(text); return n + print("\n"); }
+    size_t printf(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+
+    // 読み出し（RGB565）
+    uint16_t readPixel(int32_t x, int32_t y) const;
+    void readRect(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t* out) const;
+
+    // ホスト版専用：フレームバッファへの直接アクセス
+    const uint16_t* framebuffer() const { return _buffer.empty() ? nullptr : _buffer.data(); }
+
+  protected:
+    friend class LGFX_Sprite;
+
+    int32_t _width = 0;
+    int32_t _height = 0;
+    uint8_t _colorDepth = 16;
+    std::vector<uint16_t> _buffer;
+
+    int32_t _clipL = 0, _clipT = 0, _clipR = -1, _clipB = -1;
+    uint32_t _writeDepth = 0;
+
+    const IFont* _font = &fonts::Font0;
+    textdatum_t _datum = top_left;
+    uint16_t _textFg = 0xFFFF;
+    uint16_t _textBg = 0x0000;
+    bool _textBgOpaque = false;
+    float _textSizeX = 1, _textSizeY = 1;
+    bool _textWrapX = true, _textWrapY = false;
+    int32_t _cursorX = 0, _cursorY = 0;
+
+    void resizeBuffer(int32_t w, int32_t h);
+
+    void writePixel(int32_t x, int32_t y, uint16_t c) {
+      if (x < _clipL || x > _clipR || y < _clipT || y > _clipB) return;
+      _buffer[size_t(y) * _width + x] = c;
+    }
+    void fillRectRaw(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t c);
+    void lineRaw(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint16_t c);
+    void bezierRaw(int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint16_t c);
+    void wideLineRaw(int32_t x0, int32_t y0, int32_t x1, int32_t y1, float r, uint16_t c);
+    void rectRaw(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t c);
+    void roundRectRaw(int32_t x, int32_t y, int32_t w, int32_t h, int32_t r, uint16_t c, bool fill);
+    void ellipseRaw(int32_t x, int32_t y, int32_t rx, int32_t ry, uint16_t c, bool fill);
+    void fillTriangleRaw(int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint16_t c);
+    void ellipseArcRaw(int32_t x, int32_t y, int32_t r0x, int32_t r1x, int32_t r0y, int32_t r1y, float a0, float a1, uint16_t c, bool fill);
+    bool drawImagePlaceholder(int32_t imgW, int32_t imgH, int32_t x, int32_t y, int32_t maxWidth, int32_t maxHeight,
+                              float scaleX, float scaleY, uint16_t c);
+  };
+
+  // -------------------- スプライト --------------------
+  class LGFX_Sprite : public LovyanGFX {
+  public:
+    LGFX_Sprite() {}
+    LGFX_Sprite(LovyanGFX* parent) : _parent(parent) {}
+
+    void setPsram(bool enable) { _psram = enable; }
+    bool getPsram() const { return _psram; }
+    void setColorDepth(uint8_t depth) { _colorDepth = depth; }
+    void setPivot(float x, float y) { _pivotX = x; _pivotY = y; }
+
+    void* createSprite(int32_t w, int32_t h);
+    void deleteSprite();
+    void* getBuffer() const { return _buffer.empty() ? nullptr : (void*)_buffer.data(); }
+    // 実機で確保されるバイト数（ホスト版は内部的に常に RGB565 で保持する）
+    size_t bufferLength() const { return (size_t(_width) * _height * _colorDepth + 7) / 8; }
+
+    template <typename T> void fillSprite(const T& c) { fillScreen(c); }
+
+    void pushSprite(int32_t x, int32_t y) { if (_parent) pushSprite(_parent, x, y); }
+    void pushSprite(LovyanGFX* dst, int32_t x, int32_t y);
+    template <typename T> void pushSprite(LovyanGFX* dst, int32_t x, int32_t y, const T& transp) { pushSpriteRaw(dst, x, y, true, toColor565(transp)); }
+
+  private:
+    LovyanGFX* _parent = nullptr;
+    bool _psram = false;
+    float _pivotX = 0, _pivotY = 0;
+
+    void pushSpriteRaw(LovyanGFX* dst, int32_t x, int32_t y, bool useTransp, uint16_t transp);
+  };
+
+} // namespace lgfx
+
+using lgfx::LovyanGFX;
+using lgfx::LGFX_Sprite;
+using lgfx::textdatum_t;
+namespace fonts = lgfx::fonts;
+
+// -------------------- ヘッドレスパネル --------------------
+class M5GFX : public lgfx::LovyanGFX {
+public:
+  M5GFX() {}
+  ~M5GFX() { waitDMA(); }
+  bool begin();
+  bool init() { return begin(); }
+  void setBrightness(uint8_t brightness) { _brightness = brightness; }
+  uint8_t getBrightness() const { return _brightness; }
+  void setRotation(uint8_t) {}
+
+  using LovyanGFX::pushImageDMA;
+  void pushImageDMA(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data) override;
+  void waitDMA() override;
+
+  // 転送回数（ホスト版のみ）。pushSprite / pushImageDMA のたびに増える
+  uint32_t getPushCount() const { return _pushCount; }
+  void notifyPush(size_t pixels = 0);
+
+  // パネルへの転送速度（ホスト版のみ、bit/s）。0 以外なら転送した画素数に応じて待つ
+  static void setBusSpeed(uint32_t bitsPerSecond) { busSpeed = bitsPerSecond; }
+
+  // パネルサイズ（ホスト版のみ）。begin() 前に設定する
+  static void setPanelSize(int32_t w, int32_t h) { panelWidth = w; panelHeight = h; }
+
+private:
+  uint8_t _brightness = 0;
+  std::atomic<uint32_t> _pushCount{0};
+  std::thread _dma;
+  static uint32_t busSpeed;
+  static int32_t panelWidth;
+  static int32_t panelHeight;
+};
+
+// -------------------- 色定義 --------------------
+static constexpr int TFT_BLACK       = 0x0000;
+static constexpr int TFT_NAVY        = 0x000F;
+static constexpr int TFT_DARKGREEN   = 0x03E0;
+static constexpr int TFT_DARKCYAN    = 0x03EF;
+static constexpr int TFT_MAROON      = 0x7800;
+static constexpr int TFT_PURPLE      = 0x780F;
+static constexpr int TFT_OLIVE       = 0x7BE0;
+static constexpr int TFT_LIGHTGREY   = 0xD69A;
+static constexpr int TFT_DARKGREY    = 0x7BEF;
+static constexpr int TFT_BLUE        = 0x001F;
+static constexpr int TFT_GREEN       = 0x07E0;
+static constexpr int TFT_CYAN        = 0x07FF;
+static constexpr int TFT_RED         = 0xF800;
+static constexpr int TFT_MAGENTA     = 0xF81F;
+static constexpr int TFT_YELLOW      = 0xFFE0;
+static constexpr int TFT_WHITE       = 0xFFFF;
+static constexpr int TFT_ORANGE      = 0xFDA0;
+static constexpr int TFT_GREENYELLOW = 0xB7E0;
+static constexpr int TFT_PINK        = 0xFE19;
+
+#define BLACK       TFT_BLACK
+#define NAVY        TFT_NAVY
+#define DARKGREEN   TFT_DARKGREEN
+#define DARKCYAN    TFT_DARKCYAN
+#define MAROON      TFT_MAROON
+#define PURPLE      TFT_PURPLE
+#define OLIVE       TFT_OLIVE
+#define LIGHTGREY   TFT_LIGHTGREY
+#define DARKGREY    TFT_DARKGREY
+#define BLUE        TFT_BLUE
+#define GREEN       TFT_GREEN
+#define CYAN        TFT_CYAN
+#define RED         TFT_RED
+#define MAGENTA     TFT_MAGENTA
+#define YELLOW      TFT_YELLOW
+#define WHITE       TFT_WHITE
+#define ORANGE      TFT_ORANGE
+#define GREENYELLOW TFT_GREENYELLOW
+#define PINK        TFT_PINK
@@ -0,0 +1,426 @@
+#include <M5GFX.h>
+#include <cmath>
+#include <chrono>
+
+namespace lgfx {
+
+  namespace fonts {
+    const IFont Font0(6, 8);
+    const IFont Font2(8, 16);
+    const IFont Font4(14, 26);
+    const IFont lgfxJapanGothic_12(6, 12);
+    const IFont lgfxJapanGothic_16(8, 16);
+    const IFont lgfxJapanGothic_20(10, 20);
+    const IFont lgfxJapanGothic_24(12, 24);
+    const IFont lgfxJapanGothic_28(14, 28);
+    const IFont lgfxJapanGothic_32(16, 32);
+    const IFont lgfxJapanGothic_36(18, 36);
+    const IFont lgfxJapanGothic_40(20, 40);
+    const IFont efontJA_16(8, 16);
+    const IFont DejaVu12(7, 12);
+    const IFont DejaVu24(14, 24);
+  }
+
+  // -------------------- バッファ・クリップ --------------------
+  void LovyanGFX::resizeBuffer(int32_t w, int32_t h) {
+    _width = w > 0 ? w : 0;
+    _height = h > 0 ? h : 0;
+    _buffer.assign(size_t(_width) * _height, 0);
+    clearClipRect();
+  }
+
+  void LovyanGFX::setClipRect(int32_t x, int32_t y, int32_t w, int32_t h) {
+    _clipL = std::max<int32_t>(0, x);
+    _clipT = std::max<int32_t>(0, y);
+    _clipR = std::min<int32_t>(_width - 1, x + w - 1);
+    _clipB = std::min<int32_t>(_height - 1, y + h - 1);
+  }
+
+  void LovyanGFX::getClipRect(int32_t* x, int32_t* y, int32_t* w, int32_t* h) const {
+    *x = _clipL;
+    *y = _clipT;
+    *w = std::max<int32_t>(0, _clipR - _clipL + 1);
+    *h = std::max<int32_t>(0, _clipB - _clipT + 1);
+  }
+
+  void LovyanGFX::clearClipRect() {
+    _clipL = 0;
+    _clipT = 0;
+    _clipR = _width - 1;
+    _clipB = _height - 1;
+  }
+
+  // -------------------- 図形 --------------------
+  void LovyanGFX::fillRectRaw(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t c) {
+    if (w < 0) { x += w + 1; w = -w; }
+    if (h < 0) { y += h + 1; h = -h; }
+    int32_t l = std::max(x, _clipL), t = std::max(y, _clipT);
+    int32_t r = std::min(x + w - 1, _clipR), b = std::min(y + h - 1, _clipB);
+    for (int32_t yy = t; yy <= b; yy++) {
+      uint16_t* row = &_buffer[size_t(yy) * _width];
+      for (int32_t xx = l; xx <= r; xx++) row[xx] = c;
+    }
+  }
+
+  void LovyanGFX::lineRaw(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint16_t c) {
+    int32_t dx = std::abs(x1 - x0), sx = x0 < x1 ? 1 : -1;
+    int32_t dy = -std::abs(y1 - y0), sy = y0 < y1 ? 1 : -1;
+    int32_t err = dx + dy;
+    for (;;) {
+      writePixel(x0, y0, c);
+      if (x0 == x1 && y0 == y1) break;
+      int32_t e2 = 2 * err;
+      if (e2 >= dy) { err += dy; x0 += sx; }
+      if (e2 <= dx) { err += dx; y0 += sy; }
+    }
+  }
+
+  void LovyanGFX::bezierRaw(int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint16_t c) {
+    int32_t len = std::abs(x1 - x0) + std::abs(y1 - y0) + std::abs(x2 - x1) + std::abs(y2 - y1);
+    int32_t steps = std::max<int32_t>(2, len / 2);
+    int32_t px = x0, py = y0;
+    for (int32_t i = 1; i <= steps; i++) {
+      float t = float(i) / steps, u = 1.0f - t;
+      int32_t qx = int32_t(std::lround(u * u * x0 + 2 * u * t * x1 + t * t * x2));
+      int32_t qy = int32_t(std::lround(u * u * y0 + 2 * u * t * y1 + t * t * y2));
+      lineRaw(px, py, qx, qy, c);
+      px = qx; py = qy;
+    }
+  }
+
+  void LovyanGFX::wideLineRaw(int32_t x0, int32_t y0, int32_t x1, int32_t y1, float r, uint16_t c) {
+    int32_t ri = int32_t(std::ceil(r));
+    int32_t l = std::min(x0, x1) - ri, t = std::min(y0, y1) - ri;
+    int32_t rr = std::max(x0, x1) + ri, b = std::max(y0, y1) + ri;
+    float vx = float(x1 - x0), vy = float(y1 - y0);
+    float len2 = vx * vx + vy * vy;
+    for (int32_t y = t; y <= b; y++) {
+      for (int32_t x = l; x <= rr; x++) {
+        float px = float(x - x0), py = float(y - y0);
+        float k = len2 > 0 ? std::min(1.0f, std::max(0.0f, (px * vx + py * vy) / len2)) : 0.0f;
+        float ex = px - k * vx, ey = py - k * vy;
+        if (ex * ex + ey * ey <= r * r) writePixel(x, y, c);
+      }
+    }
+  }
+
+  void LovyanGFX::rectRaw(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t c) {
+    if (w <= 0 || h <= 0) return;
+    fillRectRaw(x, y, w, 1, c);
+    fillRectRaw(x, y + h - 1, w, 1, c);
+    fillRectRaw(x, y, 1, h, c);
+    fillRectRaw(x + w - 1, y, 1, h, c);
+  }
+
+  void LovyanGFX::roundRectRaw(int32_t x, int32_t y, int32_t w, int32_t h, int32_t r, uint16_t c, bool fill) {
+    if (w <= 0 || h <= 0) return;
+    r = std::max<int32_t>(0, std::min(r, std::min(w, h) / 2));
+    auto inside = [&](int32_t px, int32_t py) {
+      int32_t cx = px < x + r ? x + r : (px > x + w - 1 - r ? x + w - 1 - r : px);
+      int32_t cy = py < y + r ? y + r : (py > y + h - 1 - r ? y + h - 1 - r : py);
+      int32_t dx = px - cx, dy = py - cy;
+      return dx * dx + dy * dy <= r * r;
+    };
+    for (int32_t py = y; py < y + h; py++) {
+      for (int32_t px = x; px < x + w; px++) {
+        if (!inside(px, py)) continue;
+        if (fill || !inside(px - 1, py) || !inside(px + 1, py) || !inside(px, py - 1) || !inside(px, py + 1)
+            || px == x || px == x + w - 1 || py == y || py == y + h - 1) {
+          writePixel(px, py, c);
+        }
+      }
+    }
+  }
+
+  void LovyanGFX::ellipseRaw(int32_t x, int32_t y, int32_t rx, int32_t ry, uint16_t c, bool fill) {
+    if (rx < 0 || ry < 0) return;
+    if (rx == 0 || ry == 0) { fillRectRaw(x - rx, y - ry, rx * 2 + 1, ry * 2 + 1, c); return; }
+    auto inside = [&](int32_t dx, int32_t dy) {
+      return int64_t(dx) * dx * ry * ry + int64_t(dy) * dy * rx * rx <= int64_t(rx) * rx * ry * ry + (int64_t(rx) * ry);
+    };
+    for (int32_t dy = -ry; dy <= ry; dy++) {
+      for (int32_t dx = -rx; dx <= rx; dx++) {
+        if (!inside(dx, dy)) continue;
+        if (fill || !inside(dx - 1, dy) || !inside(dx + 1, dy) || !inside(dx, dy - 1) || !inside(dx, dy + 1)) {
+          writePixel(x + dx, y + dy, c);
+        }
+      }
+    }
+  }
+
+  void LovyanGFX::fillTriangleRaw(int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint16_t c) {
+    int32_t l = std::min({x0, x1, x2}), r = std::max({x0, x1, x2});
+    int32_t t = std::min({y0, y1, y2}), b = std::max({y0, y1, y2});
+    auto edge = [](int64_t ax, int64_t ay, int64_t bx, int64_t by, int64_t px, int64_t py) {
+      return (bx - ax) * (py - ay) - (by - ay) * (px - ax);
+    };
+    int64_t area = edge(x0, y0, x1, y1, x2, y2);
+    if (area == 0) { lineRaw(x0, y0, x1, y1, c); lineRaw(x1, y1, x2, y2, c); return; }
+    for (int32_t py = t; py <= b; py++) {
+      for (int32_t px = l; px <= r; px++) {
+        int64_t w0 = edge(x1, y1, x2, y2, px, py);
+        int64_t w1 = edge(x2, y2, x0, y0, px, py);
+        int64_t w2 = edge(x0, y0, x1, y1, px, py);
+        bool in = area > 0 ? (w0 >= 0 && w1 >= 0 && w2 >= 0) : (w0 <= 0 && w1 <= 0 && w2 <= 0);
+        if (in) writePixel(px, py, c);
+      }
+    }
+  }
+
+  void LovyanGFX::ellipseArcRaw(int32_t x, int32_t y, int32_t r0x, int32_t r1x, int32_t r0y, int32_t r1y,
+                                float a0, float a1, uint16_t c, bool fill) {
+    float ix = float(std::min(r0x, r1x)), ox = float(std::max(r0x, r1x));
+    float iy = float(std::min(r0y, r1y)), oy = float(std::max(r0y, r1y));
+    if (ox <= 0 || oy <= 0) return;
+    float start = std::fmod(a0, 360.0f); if (start < 0) start += 360.0f;
+    float sweep = a1 - a0;
+    if (sweep < 0) sweep = std::fmod(sweep, 360.0f) + 360.0f;
+    bool full = sweep >= 360.0f;
+
+    auto inside = [&](int32_t dx, int32_t dy) {
+      float fx = float(dx), fy = float(dy);
+      float outer = (fx * fx) / ((ox + 0.5f) * (ox + 0.5f)) + (fy * fy) / ((oy + 0.5f) * (oy + 0.5f));
+      if (outer > 1.0f) return false;
+      if (ix > 0 && iy > 0) {
+        float inner = (fx * fx) / ((ix - 0.5f) * (ix - 0.5f)) + (fy * fy) / ((iy - 0.5f) * (iy - 0.5f));
+        if (inner < 1.0f) return false;
+      }
+      if (full) return true;
+      float ang = std::atan2(fy, fx) * 180.0f / float(M_PI);
+      if (ang < 0) ang += 360.0f;
+      float rel = ang - start;
+      if (rel < 0) rel += 360.0f;
+      return rel <= sweep;
+    };
+
+    int32_t ex = int32_t(ox) + 1, ey = int32_t(oy) + 1;
+    for (int32_t dy = -ey; dy <= ey; dy++) {
+      for (int32_t dx = -ex; dx <= ex; dx++) {
+        if (!inside(dx, dy)) continue;
+        if (fill || !inside(dx - 1, dy) || !inside(dx + 1, dy) || !inside(dx, dy - 1) || !inside(dx, dy + 1)) {
+          writePixel(x + dx, y + dy, c);
+        }
+      }
+    }
+  }
+
+  // -------------------- 画像 --------------------
+  void LovyanGFX::pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data) {
+    if (!data) return;
+    for (int32_t yy = 0; yy < h; yy++) {
+      for (int32_t xx = 0; xx < w; xx++) writePixel(x + xx, y + yy, data[size_t(yy) * w + xx]);
+    }
+  }
+
+  bool LovyanGFX::drawImagePlaceholder(int32_t imgW, int32_t imgH, int32_t x, int32_t y, int32_t maxWidth, int32_t maxHeight,
+                                       float scaleX, float scaleY, uint16_t c) {
+    if (imgW <= 0 || imgH <= 0) return false;
+    if (scaleX <= 0) scaleX = 1.0f;
+    if (scaleY <= 0) scaleY = scaleX;
+    int32_t w = int32_t(imgW * scaleX), h = int32_t(imgH * scaleY);
+    if (maxWidth > 0)  w = std::min(w, maxWidth);
+    if (maxHeight > 0) h = std::min(h, maxHeight);
+    fillRectRaw(x, y, w, h, c);
+    return true;
+  }
+
+  namespace {
+    bool readJpgSize(fs::File* f, int32_t& w, int32_t& h) {
+      f->seek(0);
+      if (f->read() != 0xFF || f->read() != 0xD8) return false;
+      for (;;) {
+        int m = f->read();
+        if (m < 0) return false;
+        if (m != 0xFF) continue;
+        int type = f->read();
+        while (type == 0xFF) type = f->read();
+        if (type < 0) return false;
+        int len = (f->read() << 8) | f->read();
+        if (type >= 0xC0 && type <= 0xC3) {
+          f->read();
+          h = (f->read() << 8) | f->read();
+          w = (f->read() << 8) | f->read();
+          return w > 0 && h > 0;
+        }
+        f->seek(uint32_t(f->position() + len - 2));
+      }
+    }
+
+    bool readPngSize(fs::File* f, int32_t& w, int32_t& h) {
+      uint8_t hdr[24];
+      f->seek(0);
+      if (f->read(hdr, sizeof(hdr)) != sizeof(hdr)) return false;
+      if (hdr[1] != 'P' || hdr[2] != 'N' || hdr[3] != 'G') return false;
+      w = int32_t((uint32_t(hdr[16]) << 24) | (uint32_t(hdr[17]) << 16) | (uint32_t(hdr[18]) << 8) | hdr[19]);
+      h = int32_t((uint32_t(hdr[20]) << 24) | (uint32_t(hdr[21]) << 16) | (uint32_t(hdr[22]) << 8) | hdr[23]);
+      return w > 0 && h > 0;
+    }
+  }
+
+  bool LovyanGFX::drawJpg(fs::File* file, int32_t x, int32_t y, int32_t maxWidth, int32_t maxHeight,
+                          int32_t, int32_t, float scaleX, float scaleY) {
+    int32_t w = 0, h = 0;
+    if (!file || !*file || !readJpgSize(file, w, h)) return false;
+    return drawImagePlaceholder(w, h, x, y, maxWidth, maxHeight, scaleX, scaleY, 0x8410);
+  }
+
+  bool LovyanGFX::drawPng(fs::File* file, int32_t x, int32_t y, int32_t maxWidth, int32_t maxHeight,
+                          int32_t, int32_t, float scaleX, float scaleY) {
+    int32_t w = 0, h = 0;
+    if (!file || !*file || !readPngSize(file, w, h)) return false;
+    return drawImagePlaceholder(w, h, x, y, maxWidth, maxHeight, scaleX, scaleY, 0x4208);
+  }
+
+  // -------------------- 文字 --------------------
+  namespace {
+    // UTF-8 の 1 文字あたりの桁数（全角は 2 桁扱い）
+    int32_t countColumns(const char* text) {
+      int32_t cols = 0;
+      for (const unsigned char* p = (const unsigned char*)text; *p; p++) {
+        if ((*p & 0xC0) == 0x80) continue;
+        cols += (*p >= 0xE0) ? 2 : 1;
+      }
+      return cols;
+    }
+  }
+
+  int32_t LovyanGFX::textWidth(const char* text) const {
+    if (!text) return 0;
+    return int32_t(countColumns(text) * _font->width * _textSizeX);
+  }
+
+  int32_t LovyanGFX::drawString(const char* text, int32_t x, int32_t y) {
+    if (!text) return 0;
+    int32_t w = textWidth(text);
+    int32_t h = fontHeight();
+
+    if (_datum & 0x01) x -= w / 2;
+    else if (_datum & 0x02) x -= w;
+    if (_datum & 0x04) y -= h / 2;
+    else if (_datum & 0x08) y -= h;
+    else if (_datum & 0x10) {
+      FontMetrics metrics;
+      _font->getDefaultMetric(&metrics);
+      y -= int32_t(metrics.baseline * _textSizeY);
+    }
+
+    // 文字は 1 文字ずつ内側に 1px 余白を持つブロックで表す
+    // 横の折り返しが有効なら、右端を越える文字から左端（x = 0）の次の行へ送る
+    int32_t cx = x;
+    int32_t unit = int32_t(_font->width * _textSizeX);
+    for (const unsigned char* p = (const unsigned char*)text; *p; p++) {
+      if ((*p & 0xC0) == 0x80) continue;
+      int32_t cw = unit * ((*p >= 0xE0) ? 2 : 1);
+      if (_textWrapX && cx + cw > _width) {
+        cx = 0;
+        y += h;
+      }
+      if (_textBgOpaque) fillRectRaw(cx, y, cw, h, _textBg);
+      if (*p != ' ') fillRectRaw(cx + 1, y + 1, cw - 2, h - 2, _textFg);
+      cx += cw;
+    }
+    return w;
+  }
+
+  size_t LovyanGFX::print(const char* text) {
+    if (!text) return 0;
+    size_t n = 0;
+    const char* line = text;
+    textdatum_t saved = _datum;
+    _datum = top_left;
+    while (*line) {
+      const char* nl = std::strchr(line, '\n');
+      std::string part = nl ? std::string(line, nl - line) : std::string(line);
+      _cursorX += drawString(part.c_str(), _cursorX, _cursorY);
+      n += part.size();
+      if (!nl) break;
+      _cursorX = 0;
+      _cursorY += fontHeight();
+      n++;
+      line = nl + 1;
+    }
+    _datum = saved;
+    return n;
+  }
+
+  size_t LovyanGFX::printf(const char* fmt, ...) {
+    char buf[256];
+    va_list ap;
+    va_start(ap, fmt);
+    std::vsnprintf(buf, sizeof(buf), fmt, ap);
+    va_end(ap);
+    return print(buf);
+  }
+
+  // -------------------- 読み出し --------------------
+  uint16_t LovyanGFX::readPixel(int32_t x, int32_t y) const {
+    if (x < 0 || y < 0 || x >= _width || y >= _height) return 0;
+    return _buffer[size_t(y) * _width + x];
+  }
+
+  void LovyanGFX::readRect(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t* out) const {
+    for (int32_t yy = 0; yy < h; yy++) {
+      for (int32_t xx = 0; xx < w; xx++) *out++ = readPixel(x + xx, y + yy);
+    }
+  }
+
+  // -------------------- スプライト --------------------
+  void* LGFX_Sprite::createSprite(int32_t w, int32_t h) {
+    resizeBuffer(w, h);
+    return getBuffer();
+  }
+
+  void LGFX_Sprite::deleteSprite() {
+    _buffer.clear();
+    _buffer.shrink_to_fit();
+    _width = _height = 0;
+    clearClipRect();
+  }
+
+  void LGFX_Sprite::pushSprite(LovyanGFX* dst, int32_t x, int32_t y) {
+    pushSpriteRaw(dst, x, y, false, 0);
+  }
+
+  void LGFX_Sprite::pushSpriteRaw(LovyanGFX* dst, int32_t x, int32_t y, bool useTransp, uint16_t transp) {
+    if (!dst || _buffer.empty()) return;
+    for (int32_t yy = 0; yy < _height; yy++) {
+      for (int32_t xx = 0; xx < _width; xx++) {
+        uint16_t c = _buffer[size_t(yy) * _width + xx];
+        if (useTransp && c == transp) continue;
+        dst->writePixel(x + xx, y + yy, c);
+      }
+    }
+    if (M5GFX* panel = dynamic_cast<M5GFX*>(dst)) panel->notifyPush(size_t(_width) * _height);
+  }
+
+} // namespace lgfx
+
+uint32_t M5GFX::busSpeed = 0;
+int32_t M5GFX::panelWidth = 320;
+int32_t M5GFX::panelHeight = 240;
+
+bool M5GFX::begin() {
+  if (_buffer.empty()) resizeBuffer(panelWidth, panelHeight);
+  return true;
+}
+
+// 転送時間の模擬（16 bit / 画素）
+void M5GFX::notifyPush(size_t pixels) {
+  if (busSpeed && pixels) {
+    std::this_thread::sleep_for(std::chrono::microseconds(uint64_t(pixels) * 16 * 1000000 / busSpeed));
+  }
+  _pushCount++;
+}
+
+// 実機の DMA と同じく呼び出し元を待たせず、転送は別スレッドで行う
+void M5GFX::pushImageDMA(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data) {
+  waitDMA();
+  _dma = std::thread([this, x, y, w, h, data] {
+    pushImage(x, y, w, h, data);
+    notifyPush(size_t(w) * h);
+  });
+}
+
+void M5GFX::waitDMA() {
+  if (_dma.joinable()) _dma.join();
+}
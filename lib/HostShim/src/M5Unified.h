@@ -0,0 +1,150 @@
+#pragma once
+
+// ホストビルド用 M5Unified 互換レイヤ
+// M5.Touch はスクリプトで入力を与える偽物で、状態遷移は M5Unified の Touch_Class に合わせている
+
+#include <Arduino.h>
+#include <M5GFX.h>
+#include <vector>
+
+namespace m5 {
+
+  enum touch_state_t : uint8_t {
+    none         = 0b0000,
+    touch        = 0b0001,
+    touch_end    = 0b0010,
+    touch_begin  = 0b0011,
+    hold         = 0b0101,
+    hold_end     = 0b0110,
+    hold_begin   = 0b0111,
+    flick        = 0b1001,
+    flick_end    = 0b1010,
+    flick_begin  = 0b1011,
+    drag         = 0b1101,
+    drag_end     = 0b1110,
+    drag_begin   = 0b1111,
+
+    mask_touch   = 0b0001,
+    mask_change  = 0b0010,
+    mask_holding = 0b0100,
+    mask_moving  = 0b1000
+  };
+
+  struct touch_detail_t {
+    uint32_t base_msec = 0;
+    union {
+      uint32_t prev = 0;
+      struct { int16_t prev_x; int16_t prev_y; };
+    };
+    touch_state_t state = none;
+    uint8_t size = 0;
+    int16_t x = -1;
+    int16_t y = -1;
+    int16_t base_x = -1;
+    int16_t base_y = -1;
+    uint8_t click_count = 0;
+    uint8_t id = 0;
+
+    int deltaX() const { return x - prev_x; }
+    int deltaY() const { return y - prev_y; }
+    int distanceX() const { return x - base_x; }
+    int distanceY() const { return y - base_y; }
+    bool isPressed() const     { return state & mask_touch; }
+    bool wasPressed() const    { return state == touch_begin; }
+    bool wasClicked() const    { return state == touch_end; }
+    bool isReleased() const    { return !(state & mask_touch); }
+    bool wasReleased() const   { return (state & (mask_touch | mask_change)) == mask_change; }
+    bool isHolding() const     { return (state & (mask_touch | mask_holding)) == (mask_touch | mask_holding); }
+    bool wasHold() const       { return state == hold_begin; }
+    bool wasFlickStart() const { return state == flick_begin; }
+    bool isFlicking() const    { return (state & drag) == flick; }
+    bool wasFlicked() const    { return state == flick_end; }
+    bool wasDragStart() const  { return state == drag_begin; }
+    bool isDragging() const    { return (state & drag) == drag; }
+    bool wasDragged() const    { return state == drag_end; }
+    uint8_t getClickCount() const { return click_count; }
+  };
+
+  // スクリプト入力の 1 サンプル（msec 時点以降の生入力。x < 0 で非接触）
+  struct TouchSample {
+    uint32_t msec;
+    int16_t x;
+    int16_t y;
+  };
+
+  class Touch_Class {
+  public:
+    bool isEnabled() const { return enabled; }
+    void setEnabled(bool enable) { enabled = enable; }
+
+    uint8_t getCount() const { return detail.isPressed() ? 1 : 0; }
+    const touch_detail_t& getDetail(size_t index = 0) const { (void)index; return detail; }
+
+    void setHoldThresh(uint16_t msec) { holdMsec = msec; }
+    void setFlickThresh(uint16_t distance) { flickThresh = distance; }
+
+    // 生入力を直接与える（次の update() で反映）
+    void press(int16_t x, int16_t y) { rawX = x; rawY = y; rawPressed = true; }
+    void release() { rawPressed = false; }
+
+    // 時刻付きサンプル列で入力を与える
+    void setScript(const std::vector<TouchSample>& samples) { script = samples; scriptPos = 0; }
+    // "msec x y" 形式（x < 0 で非接触、# 以降はコメント）のファイルを読み込む
+    bool loadScript(const char* path);
+    bool isScriptFinished() const { return scriptPos >= script.size() && !rawPressed; }
+
+    void update(uint32_t msec);
+
+  private:
+    bool enabled = true;
+    touch_detail_t detail;
+    uint16_t holdMsec = 500;
+    uint16_t flickThresh = 8;
+    uint32_t lastClickMsec = 0;
+
+    bool rawPressed = false;
+    int16_t rawX = -1, rawY = -1;
+    std::vector<TouchSample> script;
+    size_t scriptPos = 0;
+  };
+
+  class Button_Class {
+  public:
+    bool isPressed() const   { return pressed; }
+    bool isReleased() const  { return !pressed; }
+    bool wasPressed() const  { return pressed && !prevPressed; }
+    bool wasReleased() const { return !pressed && prevPressed; }
+
+    void setRawState(bool state) { raw = state; }
+    void update() { prevPressed = pressed; pressed = raw; }
+
+  private:
+    bool raw = false;
+    bool pressed = false;
+    bool prevPressed = false;
+  };
+
+  struct config_t {
+    uint32_t serial_baudrate = 115200;
+  };
+
+  class M5Unified {
+  public:
+    M5GFX Display;
+    M5GFX& Lcd = Display;
+    Touch_Class Touch;
+    Button_Class BtnA, BtnB, BtnC;
+
+    config_t config() const { return config_t(); }
+    // 環境変数 VT_HOST_TOUCH_SCRIPT があればタッチスクリプトとして読み込む
+    void begin(const config_t& = config_t());
+    void update() {
+      uint32_t msec = millis();
+      Touch.update(msec);
+      BtnA.update(); BtnB.update(); BtnC.update();
+    }
+  };
+
+} // namespace m5
+
+extern m5::M5Unified M5;
@@ -0,0 +1,92 @@
+#include <M5Unified.h>
+
+m5::M5Unified M5;
+
+namespace m5 {
+
+  void M5Unified::begin(const config_t&) {
+    Display.begin();
+    const char* script = std::getenv("VT_HOST_TOUCH_SCRIPT");
+    if (script && *script && !Touch.loadScript(script)) {
+      std::fprintf(stderr, "touch script not found: %s\n", script);
+    }
+  }
+
+  bool Touch_Class::loadScript(const char* path) {
+    std::FILE* fp = std::fopen(path, "r");
+    if (!fp) return false;
+    std::vector<TouchSample> samples;
+    char line[128];
+    while (std::fgets(line, sizeof(line), fp)) {
+      char* hash = std::strchr(line, '#');
+      if (hash) *hash = '\0';
+      unsigned long msec;
+      int x, y;
+      if (std::sscanf(line, "%lu %d %d", &msec, &x, &y) == 3) {
+        samples.push_back({ uint32_t(msec), int16_t(x), int16_t(y) });
+      }
+    }
+    std::fclose(fp);
+    setScript(samples);
+    return true;
+  }
+
+  void Touch_Class::update(uint32_t msec) {
+    // スクリプトの該当時刻までのサンプルを生入力に反映
+    while (scriptPos < script.size() && script[scriptPos].msec <= msec) {
+      const auto& s = script[scriptPos++];
+      if (s.x < 0) release();
+      else press(s.x, s.y);
+    }
+
+    detail.prev_x = detail.x;
+    detail.prev_y = detail.y;
+
+    if (rawPressed) {
+      detail.x = rawX;
+      detail.y = rawY;
+      if (!(detail.state & mask_touch)) {
+        // 押し始め
+        if (msec - lastClickMsec > holdMsec
+            || std::abs(rawX - detail.base_x) > flickThresh
+            || std::abs(rawY - detail.base_y) > flickThresh) {
+          detail.click_count = 0;
+        }
+        detail.state = touch_begin;
+        detail.base_x = rawX;
+        detail.base_y = rawY;
+        detail.base_msec = msec;
+        detail.prev_x = rawX;
+        detail.prev_y = rawY;
+        return;
+      }
+
+      uint8_t s = detail.state & ~mask_change;
+      if (!(s & mask_moving)) {
+        if (std::abs(detail.distanceX()) > flickThresh || std::abs(detail.distanceY()) > flickThresh) {
+          s = (s & mask_holding) ? drag_begin : flick_begin;
+        } else if (!(s & mask_holding) && msec - detail.base_msec >= holdMsec) {
+          s = hold_begin;
+        }
+      }
+      detail.state = touch_state_t(s);
+      return;
+    }
+
+    if (detail.state & mask_touch) {
+      // 離した瞬間
+      detail.state = touch_state_t((detail.state & ~mask_touch) | mask_change);
+      if (detail.state == touch_end) {
+        detail.click_count++;
+        lastClickMsec = msec;
+      } else {
+        detail.click_count = 0;
+      }
+      return;
+    }
+
+    detail.state = none;
+    if (msec - lastClickMsec > holdMsec) detail.click_count = 0;
+  }
+
+} // namespace m5
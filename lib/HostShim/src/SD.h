@@ -0,0 +1,16 @@
+#pragma once
+
+// ホストビルド用 SD 互換レイヤ（ディレクトリをカードとして扱う）
+// 既定のルートは環境変数 VT_HOST_SD_ROOT、未設定ならカレントディレクトリ
+
+#include "FS.h"
+
+namespace fs {
+class SDFS : public FS {
+public:
+  SDFS();
+  uint64_t cardSize() const { return 0; }
+};
+}
+
+extern fs::SDFS SD;
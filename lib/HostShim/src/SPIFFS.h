@@ -0,0 +1,16 @@
+#pragma once
+
+// ホストビルド用 SPIFFS 互換レイヤ
+// 既定のルートは環境変数 VT_HOST_SPIFFS_ROOT、未設定ならカレントディレクトリ
+
+#include "FS.h"
+
+namespace fs {
+class SPIFFSFS : public FS {
+public:
+  SPIFFSFS();
+  bool format() { return true; }
+};
+}
+
+extern fs::SPIFFSFS SPIFFS;
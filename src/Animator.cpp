@@ -0,0 +1,288 @@
+#include "Animator.hpp"
+#include "FrameProfiler.hpp"
+#include <cmath>
+#include <cstring>
+
+Animator::Animator (VisualData* vData, bool enableErrorLog, bool enableInfoLog, bool enableSuccessLog){
+  this->vData = vData;
+  debugLog.setDebug(enableErrorLog, enableInfoLog, enableSuccessLog);
+}
+
+// t は 0 ~ 1（戻り値は OutBack のみ 1 を少し超える）
+float Animator::ease (Easing easing, float t) {
+  switch (easing) {
+    case Easing::InQuad:     return t * t;
+    case Easing::OutQuad:    return t * (2 - t);
+    case Easing::InOutQuad:  return t < 0.5f ? 2 * t * t : 1 - 2 * (1 - t) * (1 - t);
+    case Easing::InCubic:    return t * t * t;
+    case Easing::OutCubic:   { float u = 1 - t; return 1 - u * u * u; }
+    case Easing::InOutCubic: { float u = 1 - t; return t < 0.5f ? 4 * t * t * t : 1 - 4 * u * u * u; }
+    case Easing::OutBack: {
+      const float c1 = 1.70158f;
+      const float c3 = c1 + 1;
+      float u = t - 1;
+      return 1 + c3 * u * u * u + c1 * u * u;
+    }
+    case Easing::OutBounce: {
+      const float n1 = 7.5625f;
+      const float d1 = 2.75f;
+      if (t < 1 / d1)   return n1 * t * t;
+      if (t < 2 / d1)   { t -= 1.5f / d1;  return n1 * t * t + 0.75f; }
+      if (t < 2.5 / d1) { t -= 2.25f / d1; return n1 * t * t + 0.9375f; }
+      t -= 2.625f / d1;
+      return n1 * t * t + 0.984375f;
+    }
+    default:                 return t;
+  }
+}
+
+int32_t Animator::lerpColor (int32_t from, int32_t to, float t) {
+  auto channel = [t](int32_t a, int32_t b, int32_t max) {
+    int32_t v = a + int32_t(lroundf(float(b - a) * t));
+    return v < 0 ? 0 : (v > max ? max : v);
+  };
+  int32_t r = channel((from >> 11) & 0x1F, (to >> 11) & 0x1F, 0x1F);
+  int32_t g = channel((from >> 5) & 0x3F,  (to >> 5) & 0x3F,  0x3F);
+  int32_t b = channel(from & 0x1F,         to & 0x1F,         0x1F);
+  return (r << 11) | (g << 5) | b;
+}
+
+// 対象のオブジェクト（描画中のページなら currentPageCopy の、動いている途中の値を持つもの）
+const VisualDataSet::ObjectData* Animator::findTarget (const String& objectName, int pageNum) {
+  int targetPage = (pageNum < 0) ? vData->editingPage.pageNum : pageNum;
+  int objectNum = vData->getObjectNumByName(objectName, pageNum);
+  const VDS::PageData& page = (targetPage == vData->currentPageCopy.pageNum) ? vData->currentPageCopy : vData->getPageData(targetPage);
+  for (const auto& obj : page.objects) {
+    if (obj.objectNum == objectNum) return &obj;
+  }
+  VT_LOG_ERROR(debugLog, "[%s] does not exist (instances cannot be animated).", objectName.c_str());
+  return nullptr;
+}
+
+// 同じオブジェクト・項目のスロットを再利用し、なければ空きを使う
+// 文字列を指させているスロットは、そのページを描いている間は空きにしない
+Animator::Animation* Animator::add (int targetPage, int objectNum, VDS::BindProperty property) {
+  Animation* slot = nullptr;
+  for (auto& anim : slots) {
+    if (anim.pageNum == targetPage && anim.objectNum == objectNum && anim.property == property && (anim.isActive || anim.holdsText)) {
+      slot = &anim;
+      break;
+    }
+  }
+  for (size_t i = 0; !slot && i < CAPACITY; i++) {
+    Animation& anim = slots[i];
+    bool textInUse = anim.holdsText && anim.pageNum == vData->currentPageCopy.pageNum;
+    if (!anim.isActive && !textInUse) slot = &anim;
+  }
+  if (!slot) {
+    VT_LOG_ERROR(debugLog, "Animator: no free slot (VT_ANIMATION_SLOTS=%u).", unsigned(CAPACITY));
+    return nullptr;
+  }
+
+  // オブジェクトが指している文字列は、次に反映するまでそのまま残す
+  bool keepText = slot->holdsText && slot->objectNum == objectNum && slot->pageNum == targetPage;
+  char text[TEXT_SIZE];
+  if (keepText) memcpy(text, slot->text, TEXT_SIZE);
+  *slot = Animation();
+  slot->pageNum = targetPage;
+  slot->objectNum = objectNum;
+  slot->property = property;
+  slot->holdsText = keepText;
+  if (keepText) memcpy(slot->text, text, TEXT_SIZE);
+  return slot;
+}
+
+bool Animator::animate (const String& objectName, VDS::BindProperty property, int32_t to, uint32_t durationMs, Easing easing, uint32_t delayMs, int pageNum) {
+  if (property == VDS::BindProperty::Text) {
+    VT_LOG_ERROR(debugLog, "Use animateText() for text animations. !%s", objectName.c_str());
+    return false;
+  }
+  // 今の値を始点にする（置き換える場合は動いている途中の値から）
+  const VDS::ObjectData* target = findTarget(objectName, pageNum);
+  if (!target) return false;
+  int32_t from = 0;
+  if (!vData->getProperty(target->type, target->objectArgs, property, from)) {
+    VT_LOG_ERROR(debugLog, "[%s] has no such property to animate.", objectName.c_str());
+    return false;
+  }
+  return animate(objectName, property, from, to, durationMs, easing, delayMs, pageNum);
+}
+
+bool Animator::animate (const String& objectName, VDS::BindProperty property, int32_t from, int32_t to, uint32_t durationMs, Easing easing, uint32_t delayMs, int pageNum) {
+  if (property == VDS::BindProperty::Text) {
+    VT_LOG_ERROR(debugLog, "Use animateText() for text animations. !%s", objectName.c_str());
+    return false;
+  }
+  const VDS::ObjectData* target = findTarget(objectName, pageNum);
+  if (!target) return false;
+
+  // その種類に項目があるかを事前に確認
+  VDS::ObjectArgs probe = target->objectArgs;
+  if (!vData->applyProperty(target->type, probe, property, from, nullptr)) {
+    VT_LOG_ERROR(debugLog, "[%s] has no such property to animate.", objectName.c_str());
+    return false;
+  }
+  Animation* anim = add(pageNum < 0 ? vData->editingPage.pageNum : pageNum, target->objectNum, property);
+  if (!anim) return false;
+
+  anim->easing = easing;
+  anim->from = from;
+  anim->to = to;
+  anim->delayMs = delayMs;
+  anim->durationMs = durationMs;
+  anim->isActive = true;
+  return true;
+}
+
+bool Animator::animateText (const String& objectName, int32_t from, int32_t to, uint32_t durationMs, const char* format, Easing easing, uint32_t delayMs, int pageNum) {
+  const VDS::ObjectData* target = findTarget(objectName, pageNum);
+  if (!target) return false;
+  if (target->type != VDS::DrawType::DrawString) {
+    VT_LOG_ERROR(debugLog, "[%s] is not a DrawString.", objectName.c_str());
+    return false;
+  }
+  Animation* anim = add(pageNum < 0 ? vData->editingPage.pageNum : pageNum, target->objectNum, VDS::BindProperty::Text);
+  if (!anim) return false;
+
+  anim->easing = easing;
+  anim->from = from;
+  anim->to = to;
+  anim->delayMs = delayMs;
+  anim->durationMs = durationMs;
+  anim->format = format ? format : "%d";
+  anim->isActive = true;
+  return true;
+}
+
+bool Animator::stop (const String& objectName, int pageNum) {
+  int targetPage = (pageNum < 0) ? vData->editingPage.pageNum : pageNum;
+  int objectNum = vData->getObjectNumByName(objectName, pageNum);
+  bool found = false;
+  for (auto& anim : slots) {
+    if (!anim.isActive || anim.pageNum != targetPage || anim.objectNum != objectNum) continue;
+    anim.isActive = false;
+    found = true;
+  }
+  return found;
+}
+
+void Animator::stopAll () {
+  for (auto& anim : slots) anim.isActive = false;
+}
+
+bool Animator::isAnimating (const String& objectName, int pageNum) const {
+  int targetPage = (pageNum < 0) ? vData->editingPage.pageNum : pageNum;
+  int objectNum = vData->getObjectNumByName(objectName, pageNum);
+  for (const auto& anim : slots) {
+    if (anim.isActive && anim.pageNum == targetPage && anim.objectNum == objectNum) return true;
+  }
+  return false;
+}
+
+size_t Animator::getActiveCount () const {
+  size_t count = 0;
+  for (const auto& anim : slots) {
+    if (anim.isActive) count++;
+  }
+  return count;
+}
+
+bool Animator::isIdle () const {
+  for (const auto& anim : slots) {
+    if (anim.isActive && anim.pageNum == vData->currentPageCopy.pageNum) return false;
+  }
+  return true;
+}
+
+size_t Animator::getLastApplied () const {
+  return lastApplied;
+}
+
+size_t Animator::getLastDeferred () const {
+  return lastDeferred;
+}
+
+int Animator::update (LGFX_Sprite &sprite) {
+  return update(sprite, millis());
+}
+
+// 描画中ページのアニメーションを進める。budgetUs を使い切ったら残りは次のフレームに回し、
+// 次はそこから始める（後ろのスロットばかり遅れないように）
+int Animator::update (LGFX_Sprite &sprite, uint32_t nowMs) {
+  lastApplied = 0;
+  lastDeferred = 0;
+  if (vData->currentPageCopy.isEmpty()) return 0;
+  VT_PROFILE_SCOPE(FrameStats::Stage::Animation);
+
+  uint32_t t0 = micros();
+  int changed = 0;
+  size_t first = cursor;
+  for (size_t n = 0; n < CAPACITY; n++) {
+    size_t i = (first + n) % CAPACITY;
+    Animation& anim = slots[i];
+    if (!anim.isActive || anim.pageNum != vData->currentPageCopy.pageNum) continue;
+
+    // 少なくとも 1 つは進める
+    if (budgetUs && lastApplied > 0 && micros() - t0 >= budgetUs) {
+      if (lastDeferred++ == 0) cursor = i;
+      continue;
+    }
+
+    if (!anim.isStarted) {
+      anim.startMs = nowMs + anim.delayMs;
+      anim.isStarted = true;
+    }
+    if (int32_t(nowMs - anim.startMs) < 0) continue;   // 開始待ち
+
+    uint32_t elapsed = nowMs - anim.startMs;
+    bool isDone = elapsed >= anim.durationMs;
+    float t = ease(anim.easing, isDone ? 1.0f : float(elapsed) / float(anim.durationMs));
+    int32_t value = (anim.property == VDS::BindProperty::Color)
+                  ? lerpColor(anim.from, anim.to, t)
+                  : anim.from + int32_t(lroundf(float(anim.to - anim.from) * t));
+    lastApplied++;
+
+    if (!anim.hasLast || anim.last != value) {
+      if (apply(sprite, anim, value)) changed++;
+      else                            anim.isActive = false;   // 対象が消えた
+    }
+    if (isDone) anim.isActive = false;
+  }
+  if (!lastDeferred) cursor = 0;
+
+  // 動いた親の子・大きさの変わった子のコンテナを追従させる
+  if (changed) vData->tree.update(vData->currentPageCopy, true);
+  return changed;
+}
+
+// 値を反映し、変化前後の範囲を再描画対象にする（VisualData::updateBindings() と同じ）
+bool Animator::apply (LGFX_Sprite &sprite, Animation& anim, int32_t value) {
+  VDS::ObjectData* obj = vData->getObjectDataRef(&vData->currentPageCopy, anim.objectNum);
+  if (!obj) return false;
+
+  const char* text = nullptr;
+  if (anim.property == VDS::BindProperty::Text) {
+    snprintf(anim.text, TEXT_SIZE, anim.format, int(value));
+    anim.holdsText = true;
+    text = anim.text;
+  }
+
+  VDS::Rect before, after;
+  bool hasBefore = obj->isHidden || vData->getObjectBounds(sprite, *obj, before);
+  if (!vData->applyProperty(obj->type, obj->objectArgs, anim.property, value, text)) return false;
+  vData->updateBounds(*obj);
+  vData->pageRevision++;
+  bool hasAfter = obj->isHidden || vData->getObjectBounds(sprite, *obj, after);
+
+  if (!obj->isHidden) {
+    if (hasBefore && hasAfter) {
+      vData->markDirty(before);
+      vData->markDirty(after);
+    } else {
+      vData->markDirty(VDS::Rect{ 0, 0, sprite.width(), sprite.height() });
+    }
+  }
+  anim.last = value;
+  anim.hasLast = true;
+  return true;
+}
@@ -0,0 +1,108 @@
+#pragma once
+#include <Arduino.h>
+#include "VisualData.hpp"
+
+// 同時に動かせるアニメーションの数（build_flags の -DVT_ANIMATION_SLOTS=n で変更）
+#ifndef VT_ANIMATION_SLOTS
+#define VT_ANIMATION_SLOTS 16
+#endif
+
+// 1 フレームでアニメーションの反映に使う時間の目安 [us]（0 で制限なし）
+#ifndef VT_ANIMATION_BUDGET_US
+#define VT_ANIMATION_BUDGET_US 2000
+#endif
+
+// 描画中ページのオブジェクトの項目を時間で補間する
+//
+//   vt.animator.animate("gauge", VDS::BindProperty::Angle1, 300, 800, Animator::Easing::OutCubic);
+//   vt.animator.animate("panel", VDS::BindProperty::X, 120, 400);      // 子も親に追従する
+//   vt.animator.animateText("count", 0, 100, 1000, "%d%%");
+//   void loop() {
+//     vt.animator.update(sprite);      // 描画ループ（1 フレームに 1 回）
+//     vt.vData.redrawDirty(sprite);
+//   }
+//
+// 項目はバインドと同じ BindProperty（位置・大きさ・色・円弧の角度）と、数値を書式化した文字列。
+// 値は経過時間から毎回求めるので、フレームが飛んでも終了時刻には必ず目標の値になる。
+// 値が前のフレームから変わったオブジェクトだけ、変化前後の範囲を再描画対象にして pageRevision を
+// 進める（判定用の命令列も作り直され、タッチ判定も動いた後の形で行われる）。
+// update() は budgetUs を使い切ったら残りを次のフレームへ回し、次は続きから反映する。
+// 反映先は currentPageCopy だけで、保存済みページは変えない（バインドと同じ）。
+// 描画中でないページのアニメーションは、そのページが描かれてから始まる（delayMs もそこから数える）。
+class Animator {
+public:
+  Debug debugLog;
+  using VDS = VisualDataSet;
+
+  static constexpr size_t CAPACITY = VT_ANIMATION_SLOTS;
+
+  enum class Easing : uint8_t {
+    Linear,
+    InQuad, OutQuad, InOutQuad,
+    InCubic, OutCubic, InOutCubic,
+    OutBack,     // 少し行き過ぎて戻る
+    OutBounce    // 終点で跳ねる
+  };
+
+  VisualData* vData;
+  uint32_t budgetUs = VT_ANIMATION_BUDGET_US;
+
+  Animator(VisualData* vData, bool enableErrorLog, bool enableInfoLog, bool enableSuccessLog);
+
+  // 今の値から to へ（同じオブジェクト・項目の動作中のアニメーションは置き換える）
+  // pageNum = -1 は編集ページ（バインドと同じ）。戻り値は登録できたかどうか
+  bool animate(const String& objectName, VDS::BindProperty property, int32_t to, uint32_t durationMs,
+               Easing easing = Easing::OutQuad, uint32_t delayMs = 0, int pageNum = -1);
+  bool animate(const String& objectName, VDS::BindProperty property, int32_t from, int32_t to, uint32_t durationMs,
+               Easing easing = Easing::OutQuad, uint32_t delayMs = 0, int pageNum = -1);
+  // DrawString の文字列を from → to の数値で書き換える（format は printf 形式で int32_t を 1 つ）
+  bool animateText(const String& objectName, int32_t from, int32_t to, uint32_t durationMs,
+                   const char* format = "%d", Easing easing = Easing::Linear, uint32_t delayMs = 0, int pageNum = -1);
+
+  bool stop(const String& objectName, int pageNum = -1);   // 今の値のまま止める
+  void stopAll();
+  bool isAnimating(const String& objectName, int pageNum = -1) const;
+  size_t getActiveCount() const;
+  bool isIdle() const;                 // 描画中ページに動作中（開始待ちを含む）のアニメーションがない
+
+  // 描画ループから 1 フレームに 1 回呼ぶ（戻り値は値を変えたオブジェクトの数）
+  int update(LGFX_Sprite &sprite);
+  int update(LGFX_Sprite &sprite, uint32_t nowMs);
+
+  size_t getLastApplied() const;       // 直前の update() で反映したアニメーションの数
+  size_t getLastDeferred() const;      // 直前の update() で時間が足りず次へ回した数
+
+  static float ease(Easing easing, float t);
+  static int32_t lerpColor(int32_t from, int32_t to, float t);   // RGB565 の成分ごとに補間
+
+private:
+  static constexpr size_t TEXT_SIZE = 24;
+
+  struct Animation {
+    bool isActive = false;
+    int pageNum = -1;
+    int objectNum = -1;
+    VDS::BindProperty property = VDS::BindProperty::X;
+    Easing easing = Easing::Linear;
+    int32_t from = 0;
+    int32_t to = 0;
+    int32_t last = 0;                 // 最後に反映した値
+    bool hasLast = false;
+    uint32_t delayMs = 0;
+    uint32_t durationMs = 0;
+    uint32_t startMs = 0;
+    bool isStarted = false;           // 開始時刻は最初に進めた update() の時刻 + delayMs
+    const char* format = nullptr;     // Text のみ
+    char text[TEXT_SIZE] = {};        // 反映中の文字列（オブジェクトが指すので、そのページを描いている間は他に使わない）
+    bool holdsText = false;
+  };
+
+  Animation slots[CAPACITY];
+  size_t cursor = 0;                  // 次の update() で最初に見るスロット
+  size_t lastApplied = 0;
+  size_t lastDeferred = 0;
+
+  const VDS::ObjectData* findTarget(const String& objectName, int pageNum);
+  Animation* add(int targetPage, int objectNum, VDS::BindProperty property);
+  bool apply(LGFX_Sprite &sprite, Animation& anim, int32_t value);
+};
@@ -0,0 +1,256 @@
+#include "ClipStack.hpp"
+#include "VisualData.hpp"
+#include "FrameProfiler.hpp"
+#include <cstring>
+
+namespace {
+  using VDS = VisualDataSet;
+
+  // 形を決める引数だけを比べる（Args はすべて int32_t / int の並びで詰め物は無い）
+  bool isSameShape (VDS::DrawType type, const VDS::ObjectArgs& a, const VDS::ObjectArgs& b) {
+    switch (type) {
+      case VDS::DrawType::ClipRect:       return std::memcmp(&a.rect,       &b.rect,       sizeof(a.rect)) == 0;
+      case VDS::DrawType::ClipRoundRect:  return std::memcmp(&a.roundRect,  &b.roundRect,  sizeof(a.roundRect)) == 0;
+      case VDS::DrawType::ClipCircle:     return std::memcmp(&a.circle,     &b.circle,     sizeof(a.circle)) == 0;
+      case VDS::DrawType::ClipEllipse:    return std::memcmp(&a.ellipse,    &b.ellipse,    sizeof(a.ellipse)) == 0;
+      case VDS::DrawType::ClipTriangle:   return std::memcmp(&a.triangle,   &b.triangle,   sizeof(a.triangle)) == 0;
+      case VDS::DrawType::ClipArc:        return std::memcmp(&a.arc,        &b.arc,        sizeof(a.arc)) == 0;
+      case VDS::DrawType::ClipEllipseArc: return std::memcmp(&a.ellipseArc, &b.ellipseArc, sizeof(a.ellipseArc)) == 0;
+      default:                            return false;
+    }
+  }
+}
+
+
+// =========================
+// ClipMaskCache
+// =========================
+// 形を 1 bit のスプライト（vData.clipSprite）に塗ってからビット列に写す
+std::shared_ptr<const ClipMask> ClipMaskCache::get (VisualData& vData, VDS::DrawType type, const VDS::ObjectArgs& args, const VDS::Rect& bounds) {
+  for (size_t i = 0; i < masks.size(); i++) {
+    if (masks[i]->type != type || !isSameShape(type, masks[i]->args, args)) continue;
+    std::rotate(masks.begin(), masks.begin() + i, masks.begin() + i + 1);
+    return masks[0];
+  }
+  if (bounds.isEmpty()) return nullptr;
+
+  VT_PROFILE_SCOPE(FrameStats::Stage::ClipMask);
+  LGFX_Sprite& sprite = vData.clipSprite;
+  sprite.setColorDepth(1);
+  if (!sprite.createSprite(bounds.w, bounds.h)) {
+    VT_LOG_ERROR(vData.debugLog, "ClipMaskCache: failed to allocate %dx%d mask.", int(bounds.w), int(bounds.h));
+    return nullptr;
+  }
+  sprite.fillSprite(BLACK);
+
+  VDS::DrawType shape = ClipStack::shapeTypeOf(type);
+  VDS::ObjectArgs local = args;
+  vData.translateArgs(shape, local, -bounds.x, -bounds.y);
+  vData.setArgsColor(shape, local, WHITE);
+  vData.drawObject(sprite, shape, local);
+
+  auto mask = std::make_shared<ClipMask>();
+  mask->type = type;
+  mask->args = args;
+  mask->bounds = bounds;
+  size_t stride = size_t((bounds.w + 7) / 8);
+  mask->bits.assign(stride * size_t(bounds.h), 0);
+  for (int32_t y = 0; y < bounds.h; y++) {
+    uint8_t* row = &mask->bits[size_t(y) * stride];
+    for (int32_t x = 0; x < bounds.w; x++) {
+      if (sprite.readPixel(x, y)) row[x / 8] |= uint8_t(0x80 >> (x & 7));
+    }
+  }
+  sprite.deleteSprite();
+  builtCount++;
+
+  if (masks.size() >= size_t(VT_CLIP_MASK_CACHE > 0 ? VT_CLIP_MASK_CACHE : 1)) masks.pop_back();
+  masks.insert(masks.begin(), mask);
+  return mask;
+}
+
+void ClipMaskCache::clear () {
+  masks.clear();
+}
+
+size_t ClipMaskCache::getBuiltCount () const {
+  return builtCount;
+}
+
+size_t ClipMaskCache::getBytes () const {
+  size_t bytes = masks.capacity() * sizeof(masks[0]);
+  for (const auto& mask : masks) bytes += sizeof(ClipMask) + mask->bits.capacity();
+  return bytes;
+}
+
+
+// =========================
+// ClipStack
+// =========================
+ClipStack::ClipStack (VisualData* vData) {
+  this->vData = vData;
+}
+
+bool ClipStack::isClipType (VDS::DrawType type) {
+  switch (type) {
+    case VDS::DrawType::ClipArc:
+    case VDS::DrawType::ClipEllipseArc:
+    case VDS::DrawType::ClipRect:
+    case VDS::DrawType::ClipRoundRect:
+    case VDS::DrawType::ClipCircle:
+    case VDS::DrawType::ClipEllipse:
+    case VDS::DrawType::ClipTriangle:
+      return true;
+    default:
+      return false;
+  }
+}
+
+VDS::DrawType ClipStack::shapeTypeOf (VDS::DrawType type) {
+  switch (type) {
+    case VDS::DrawType::ClipArc:        return VDS::DrawType::FillArc;
+    case VDS::DrawType::ClipEllipseArc: return VDS::DrawType::FillEllipseArc;
+    case VDS::DrawType::ClipRoundRect:  return VDS::DrawType::FillRoundRect;
+    case VDS::DrawType::ClipCircle:     return VDS::DrawType::FillCircle;
+    case VDS::DrawType::ClipEllipse:    return VDS::DrawType::FillEllipse;
+    case VDS::DrawType::ClipTriangle:   return VDS::DrawType::FillTriangle;
+    default:                            return VDS::DrawType::FillRect;
+  }
+}
+
+void ClipStack::begin (LGFX_Sprite* target, int32_t originX, int32_t originY) {
+  entries.clear();
+  this->target = target;
+  this->originX = originX;
+  this->originY = originY;
+  if (target) {
+    target->getClipRect(&baseClip.x, &baseClip.y, &baseClip.w, &baseClip.h);
+    baseClip = baseClip.intersected(VDS::Rect{ 0, 0, target->width(), target->height() });
+  }
+  activeDepth = 0;
+  activeSerial = 0;
+  activeVisible = true;
+  activeMasked = false;
+  activeBounds = VDS::Rect();
+  maskRun = false;
+}
+
+// 同じ層かそれより上の Clip を外してから積む
+void ClipStack::push (VDS::DrawType type, const VDS::ObjectArgs& args, uint8_t zIndex) {
+  while (!entries.empty() && entries.back().zIndex >= zIndex) entries.pop_back();
+
+  Entry entry;
+  entry.type = type;
+  entry.args = args;
+  entry.zIndex = zIndex;
+  entry.serial = ++nextSerial;
+  entry.isMasked = type != VDS::DrawType::ClipRect && !(type == VDS::DrawType::ClipRoundRect && args.roundRect.r <= 0);
+
+  VDS::Rect own;
+  if (!vData || !vData->getObjectBounds(vData->boundsSprite, shapeTypeOf(type), args, own)) own = VDS::Rect();
+  entry.bounds = entries.empty() ? own : own.intersected(entries.back().bounds);
+  entries.push_back(entry);
+}
+
+bool ClipStack::enter (uint8_t zIndex) {
+  size_t depth = entries.size();
+  while (depth > 0 && entries[depth - 1].zIndex >= zIndex) depth--;
+  uint32_t serial = depth ? entries[depth - 1].serial : 0;
+  if (depth == activeDepth && serial == activeSerial) return activeVisible;
+
+  finishRun();
+  activeDepth = depth;
+  activeSerial = serial;
+  activeVisible = true;
+  activeMasked = false;
+  activeBounds = VDS::Rect();
+  if (depth == 0) {
+    if (target) target->setClipRect(baseClip.x, baseClip.y, baseClip.w, baseClip.h);
+    return true;
+  }
+
+  activeBounds = entries[depth - 1].bounds;
+  for (size_t i = 0; i < depth; i++) activeMasked |= entries[i].isMasked;
+  if (!target) {
+    activeVisible = !activeBounds.isEmpty();
+    return activeVisible;
+  }
+
+  VDS::Rect rect = VDS::Rect{ activeBounds.x - originX, activeBounds.y - originY, activeBounds.w, activeBounds.h }.intersected(baseClip);
+  if (rect.isEmpty()) {
+    activeVisible = false;
+    return false;
+  }
+
+  // マスクは初めて描くときに用意する（作れなければ外接矩形で制限する）
+  runMasks.clear();
+  for (size_t i = 0; i < depth; i++) {
+    Entry& e = entries[i];
+    if (!e.isMasked) continue;
+    if (!e.mask) {
+      VDS::Rect own;
+      if (vData->getObjectBounds(vData->boundsSprite, shapeTypeOf(e.type), e.args, own)) e.mask = vData->clipMasks.get(*vData, e.type, e.args, own);
+    }
+    if (e.mask) runMasks.push_back(e.mask);
+  }
+
+  target->setClipRect(rect.x, rect.y, rect.w, rect.h);
+  if (!runMasks.empty()) {
+    runRect = rect;
+    saved.resize(size_t(rect.w) * size_t(rect.h));
+    target->readRect(rect.x, rect.y, rect.w, rect.h, saved.data());
+    maskRun = true;
+  }
+  return true;
+}
+
+// マスクの外側に描かれた画素を元に戻す（連続する画素はまとめて書く）
+void ClipStack::finishRun () {
+  if (!maskRun) return;
+  maskRun = false;
+
+  for (int32_t y = 0; y < runRect.h; y++) {
+    int32_t py = runRect.y + y + originY;
+    const uint16_t* row = &saved[size_t(y) * size_t(runRect.w)];
+    int32_t start = -1;
+    for (int32_t x = 0; x <= runRect.w; x++) {
+      bool outside = false;
+      if (x < runRect.w) {
+        int32_t px = runRect.x + x + originX;
+        for (const auto& mask : runMasks) {
+          if (!mask->covers(px, py)) {
+            outside = true;
+            break;
+          }
+        }
+      }
+      if (outside && start < 0) start = x;
+      if (!outside && start >= 0) {
+        target->pushImage(runRect.x + start, runRect.y + y, x - start, 1, row + start);
+        start = -1;
+      }
+    }
+  }
+  runMasks.clear();
+}
+
+void ClipStack::end () {
+  finishRun();
+  if (target) target->setClipRect(baseClip.x, baseClip.y, baseClip.w, baseClip.h);
+  entries.clear();
+  activeDepth = 0;
+  activeSerial = 0;
+  activeVisible = true;
+  activeMasked = false;
+  target = nullptr;
+}
+
+bool ClipStack::getActiveBounds (VDS::Rect& bounds) const {
+  if (activeDepth == 0) return false;
+  bounds = activeBounds;
+  return true;
+}
+
+bool ClipStack::isActiveMasked () const {
+  return activeMasked;
+}
@@ -0,0 +1,112 @@
+#pragma once
+#include <Arduino.h>
+#include <M5Unified.h>
+#include <memory>
+#include <vector>
+#include "VisualDataSet.h"
+
+// 形を覚えておく Clip マスクの数（build_flags の -DVT_CLIP_MASK_CACHE=n で変更）
+#ifndef VT_CLIP_MASK_CACHE
+#define VT_CLIP_MASK_CACHE 4
+#endif
+
+class VisualData;
+
+// 矩形以外の Clip の覆う画素（1 bit / 画素、ページ座標）
+struct ClipMask {
+  VisualDataSet::DrawType type = VisualDataSet::DrawType::ClipRect;
+  VisualDataSet::ObjectArgs args;
+  VisualDataSet::Rect bounds;
+  std::vector<uint8_t> bits;        // 1 行 (w + 7) / 8 バイト、左の画素が上位ビット
+
+  bool covers(int32_t x, int32_t y) const {
+    x -= bounds.x;
+    y -= bounds.y;
+    if (x < 0 || y < 0 || x >= bounds.w || y >= bounds.h) return false;
+    return bits[size_t(y) * size_t((bounds.w + 7) / 8) + size_t(x / 8)] & (0x80 >> (x & 7));
+  }
+};
+
+// 同じ形のマスクを作り直さないための置き場（使わなくなったものから捨てる）
+class ClipMaskCache {
+public:
+  using VDS = VisualDataSet;
+
+  std::shared_ptr<const ClipMask> get(VisualData& vData, VDS::DrawType type, const VDS::ObjectArgs& args, const VDS::Rect& bounds);
+  void clear();
+  size_t getBuiltCount() const;     // マスクを作った回数
+  size_t getBytes() const;
+
+private:
+  std::vector<std::shared_ptr<ClipMask>> masks;   // 先頭ほど最近使ったもの
+  size_t builtCount = 0;
+};
+
+// Clip 系オブジェクトによる描画範囲の制限（描画順にたどりながら使う）
+//
+//   clip.begin(&sprite);
+//   for (各要素を z 順に) {
+//     if (ClipStack::isClipType(type)) { clip.push(type, args, zIndex); continue; }
+//     if (clip.enter(zIndex)) drawObject(sprite, type, args);
+//   }
+//   clip.end();
+//
+// Clip はそれより後に描く、zIndex がより大きい（上の層の）要素に効き、入れ子の Clip は重なる部分に
+// 絞り込む。同じ層かそれより下の層の Clip が来たら外れる。
+// ClipRect（と角の無い ClipRoundRect）は setClipRect だけで済ませる。それ以外は外接矩形を
+// setClipRect したうえで、その範囲の元の画素を取っておき、範囲内を描き終えたらマスクの外側だけ
+// 書き戻す。マスクは ClipMaskCache に残し、形が変わらない限り作り直さない。
+// target を渡さずに begin() すると範囲の計算だけを行う（cullItems で使用）。
+class ClipStack {
+public:
+  using VDS = VisualDataSet;
+
+  VisualData* vData;
+
+  ClipStack(VisualData* vData = nullptr);
+
+  static bool isClipType(VDS::DrawType type);
+  static VDS::DrawType shapeTypeOf(VDS::DrawType type);   // 同じ形を塗る Fill 系の種類
+
+  // origin は target の左上に当たるページ座標（タイル・帯に描くとき）
+  void begin(LGFX_Sprite* target = nullptr, int32_t originX = 0, int32_t originY = 0);
+  void push(VDS::DrawType type, const VDS::ObjectArgs& args, uint8_t zIndex);
+  bool enter(uint8_t zIndex);         // その層の要素を描く前に呼ぶ（描ける範囲が無ければ false）
+  void end();
+
+  bool getActiveBounds(VDS::Rect& bounds) const;   // 直前の enter() で効いている範囲（ページ座標）
+  bool isActiveMasked() const;
+
+private:
+  struct Entry {
+    VDS::DrawType type = VDS::DrawType::ClipRect;
+    VDS::ObjectArgs args;
+    uint8_t zIndex = 0;
+    uint32_t serial = 0;
+    VDS::Rect bounds;                 // 下の Clip と重なる部分（ページ座標）
+    bool isMasked = false;
+    std::shared_ptr<const ClipMask> mask;
+  };
+
+  std::vector<Entry> entries;         // zIndex の小さい順
+  uint32_t nextSerial = 0;
+
+  LGFX_Sprite* target = nullptr;
+  int32_t originX = 0;
+  int32_t originY = 0;
+  VDS::Rect baseClip;                 // begin() 時点の target のクリップ範囲
+
+  // 直前の enter() の結果（その後の push() で entries が変わっても残す）
+  size_t activeDepth = 0;             // 効いている Clip の数（entries の先頭から）
+  uint32_t activeSerial = 0;
+  bool activeVisible = true;
+  bool activeMasked = false;
+  VDS::Rect activeBounds;
+
+  bool maskRun = false;               // マスクの外側を書き戻す必要がある
+  VDS::Rect runRect;                  // target 座標
+  std::vector<uint16_t> saved;        // runRect の描く前の画素
+  std::vector<std::shared_ptr<const ClipMask>> runMasks;
+
+  void finishRun();
+};
@@ -0,0 +1,324 @@
+#include "DisplayList.hpp"
+#include "VisualData.hpp"
+#include "ClipStack.hpp"
+#include "FrameProfiler.hpp"
+
+void DisplayList::clear () {
+  code.clear();
+  refs.clear();
+  objects.clear();
+  lastHeader = SIZE_MAX;
+  commandCount = 0;
+  drawCount = 0;
+  elidedStates = 0;
+  knownStates = 0;
+  stateFont = nullptr;
+  hasClips = false;
+  layer = -1;
+  compiled = false;
+}
+
+void DisplayList::setSource (uint64_t key, const VDS::Rect& visible) {
+  sourceKey = key;
+  sourceVisible = visible;
+  compiled = true;
+  compileCount++;
+}
+
+bool DisplayList::isCompiled (uint64_t key, const VDS::Rect& visible) const {
+  return compiled && sourceKey == key && sourceVisible.x == visible.x && sourceVisible.y == visible.y &&
+         sourceVisible.w == visible.w && sourceVisible.h == visible.h;
+}
+
+size_t DisplayList::getCommandCount () const {
+  return commandCount;
+}
+
+size_t DisplayList::getDrawCount () const {
+  return drawCount;
+}
+
+size_t DisplayList::getElidedStates () const {
+  return elidedStates;
+}
+
+size_t DisplayList::getCompileCount () const {
+  return compileCount;
+}
+
+size_t DisplayList::getCodeBytes () const {
+  return code.capacity() * sizeof(int32_t) + refs.capacity() * sizeof(const void*) + objects.capacity() * sizeof(objects[0]);
+}
+
+// 命令 1 件あたりの引数の数（描かずに読み飛ばすときに使う）
+size_t DisplayList::operandCount (Op op) {
+  switch (op) {
+    case Op::Pixel:          return 3;
+    case Op::Line:           return 5;
+    case Op::Bezier:         return 7;
+    case Op::WideLine:       return 6;
+    case Op::Rect:
+    case Op::FillRect:       return 5;
+    case Op::RoundRect:
+    case Op::FillRoundRect:  return 6;
+    case Op::Circle:
+    case Op::FillCircle:     return 4;
+    case Op::Ellipse:
+    case Op::FillEllipse:    return 5;
+    case Op::Triangle:
+    case Op::FillTriangle:   return 7;
+    case Op::FillArc:        return 7;
+    case Op::FillEllipseArc: return 9;
+    case Op::Image:          return 5;
+    case Op::Text:           return 3;
+    case Op::Object:         return 1;
+    default:                 return 2;   // 状態・Clip・Layer
+  }
+}
+
+// 直前のヘッダと同じ図形ならその件数を増やし、違えば新しいヘッダを置く
+void DisplayList::emit (Op op, std::initializer_list<int32_t> operands) {
+  bool isState = op <= Op::SetTextColor;
+  if (!isState && lastHeader != SIZE_MAX && Op(code[lastHeader] & 0xFF) == op) {
+    code[lastHeader] += 1 << 8;
+  } else {
+    lastHeader = isState ? SIZE_MAX : code.size();
+    code.push_back(int32_t(op) | (1 << 8));
+    commandCount++;
+  }
+  code.insert(code.end(), operands.begin(), operands.end());
+  if (!isState && op <= Op::Object) drawCount++;
+}
+
+int32_t DisplayList::ref (const void* p) {
+  refs.push_back(p);
+  return int32_t(refs.size() - 1);
+}
+
+void DisplayList::setState (Op op, int32_t a, int32_t b) {
+  uint8_t bit = uint8_t(1u << size_t(op));
+  int32_t (&v)[2] = stateValues[size_t(op)];
+  if ((knownStates & bit) && v[0] == a && v[1] == b) {
+    elidedStates++;
+    return;
+  }
+  knownStates |= bit;
+  v[0] = a;
+  v[1] = b;
+  emit(op, { a, b });
+}
+
+// フォントは指定があるときだけ設定する（drawObject と同じく、無ければ直前のフォントのまま）
+void DisplayList::setTextState (const VDS::StringArgs& text, int fg, int bg) {
+  if (text.font) {
+    uint8_t bit = uint8_t(1u << size_t(Op::SetFont));
+    if ((knownStates & bit) && stateFont == text.font) {
+      elidedStates++;
+    } else {
+      knownStates |= bit;
+      stateFont = text.font;
+      emit(Op::SetFont, { ref(text.font), 0 });
+    }
+  }
+  setState(Op::SetTextDatum, int32_t(text.datum));
+  setState(Op::SetTextSize, int32_t(text.textSize));
+  setState(Op::SetTextWrap, text.textWrap ? 1 : 0);
+  setState(Op::SetTextColor, fg, bg);
+}
+
+bool DisplayList::append (VDS::DrawType type, const VDS::ObjectArgs& args) {
+  using T = VDS::DrawType;
+  const auto& a = args;
+  switch (type) {
+    case T::DrawPixel:      emit(Op::Pixel,    { a.pixel.x, a.pixel.y, a.pixel.color }); break;
+    case T::DrawLine:       emit(Op::Line,     { a.line.x0, a.line.y0, a.line.x1, a.line.y1, a.line.color }); break;
+    case T::DrawBezier:     emit(Op::Bezier,   { a.bezier.x0, a.bezier.y0, a.bezier.x1, a.bezier.y1, a.bezier.x2, a.bezier.y2, a.bezier.color }); break;
+    case T::DrawWideLine:   emit(Op::WideLine, { a.wideLine.x0, a.wideLine.y0, a.wideLine.x1, a.wideLine.y1, a.wideLine.r, a.wideLine.color }); break;
+    case T::DrawRect:       emit(Op::Rect,     { a.rect.x, a.rect.y, a.rect.w, a.rect.h, a.rect.color }); break;
+    case T::FillRect:       emit(Op::FillRect, { a.rect.x, a.rect.y, a.rect.w, a.rect.h, a.rect.color }); break;
+    case T::DrawRoundRect:  emit(Op::RoundRect,     { a.roundRect.x, a.roundRect.y, a.roundRect.w, a.roundRect.h, a.roundRect.r, a.roundRect.color }); break;
+    case T::FillRoundRect:  emit(Op::FillRoundRect, { a.roundRect.x, a.roundRect.y, a.roundRect.w, a.roundRect.h, a.roundRect.r, a.roundRect.color }); break;
+    case T::DrawCircle:     emit(Op::Circle,      { a.circle.x, a.circle.y, a.circle.r, a.circle.color }); break;
+    case T::FillCircle:     emit(Op::FillCircle,  { a.circle.x, a.circle.y, a.circle.r, a.circle.color }); break;
+    case T::DrawEllipse:    emit(Op::Ellipse,     { a.ellipse.x, a.ellipse.y, a.ellipse.rx, a.ellipse.ry, a.ellipse.color }); break;
+    case T::FillEllipse:    emit(Op::FillEllipse, { a.ellipse.x, a.ellipse.y, a.ellipse.rx, a.ellipse.ry, a.ellipse.color }); break;
+    case T::DrawTriangle:   emit(Op::Triangle,     { a.triangle.x0, a.triangle.y0, a.triangle.x1, a.triangle.y1, a.triangle.x2, a.triangle.y2, a.triangle.color }); break;
+    case T::FillTriangle:   emit(Op::FillTriangle, { a.triangle.x0, a.triangle.y0, a.triangle.x1, a.triangle.y1, a.triangle.x2, a.triangle.y2, a.triangle.color }); break;
+    case T::FillArc:        emit(Op::FillArc, { a.arc.x, a.arc.y, a.arc.r0, a.arc.r1, a.arc.angle0, a.arc.angle1, a.arc.color }); break;
+    case T::FillEllipseArc:
+      emit(Op::FillEllipseArc, { a.ellipseArc.x, a.ellipseArc.y, a.ellipseArc.r0x, a.ellipseArc.r1x, a.ellipseArc.r0y, a.ellipseArc.r1y,
+                                 a.ellipseArc.angle0, a.ellipseArc.angle1, a.ellipseArc.color });
+      break;
+
+    case T::DrawBitmap:
+      if (a.bitmap.data) emit(Op::Image, { a.bitmap.x, a.bitmap.y, a.bitmap.w, a.bitmap.h, ref(a.bitmap.data) });
+      break;
+
+    case T::DrawString:
+      setTextState(a.text, a.text.color, a.text.bgcolor);
+      emit(Op::Text, { ref(a.text.text), a.text.x, a.text.y });
+      break;
+
+    // Clip 系は appendClip() で積む。コンテナは何も描かない
+    case T::ClipArc:
+    case T::ClipEllipseArc:
+    case T::ClipRect:
+    case T::ClipRoundRect:
+    case T::ClipCircle:
+    case T::ClipEllipse:
+    case T::ClipTriangle:
+    case T::FlexBox:
+    case T::TableBox:
+      return false;
+
+    // 画像ファイルなどは描画時に VisualData へ任せる
+    default:
+      objects.emplace_back(type, args);
+      emit(Op::Object, { int32_t(objects.size() - 1) });
+      break;
+  }
+  return true;
+}
+
+// 枠線は塗りつぶし、画像は矩形として判定色で塗る（TouchData::drawObjectProcess と同じ）
+bool DisplayList::appendJudge (VDS::DrawType type, const VDS::ObjectArgs& args, int color) {
+  using T = VDS::DrawType;
+  const auto& a = args;
+  switch (type) {
+    case T::DrawPixel:      emit(Op::Pixel,    { a.pixel.x, a.pixel.y, color }); break;
+    case T::DrawLine:       emit(Op::Line,     { a.line.x0, a.line.y0, a.line.x1, a.line.y1, color }); break;
+    case T::DrawBezier:     emit(Op::Bezier,   { a.bezier.x0, a.bezier.y0, a.bezier.x1, a.bezier.y1, a.bezier.x2, a.bezier.y2, color }); break;
+    case T::DrawWideLine:   emit(Op::WideLine, { a.wideLine.x0, a.wideLine.y0, a.wideLine.x1, a.wideLine.y1, a.wideLine.r, color }); break;
+    case T::DrawRect:
+    case T::FillRect:       emit(Op::FillRect, { a.rect.x, a.rect.y, a.rect.w, a.rect.h, color }); break;
+    case T::DrawRoundRect:
+    case T::FillRoundRect:  emit(Op::FillRoundRect, { a.roundRect.x, a.roundRect.y, a.roundRect.w, a.roundRect.h, a.roundRect.r, color }); break;
+    case T::DrawCircle:
+    case T::FillCircle:     emit(Op::FillCircle,  { a.circle.x, a.circle.y, a.circle.r, color }); break;
+    case T::DrawEllipse:
+    case T::FillEllipse:    emit(Op::FillEllipse, { a.ellipse.x, a.ellipse.y, a.ellipse.rx, a.ellipse.ry, color }); break;
+    case T::DrawTriangle:
+    case T::FillTriangle:   emit(Op::FillTriangle, { a.triangle.x0, a.triangle.y0, a.triangle.x1, a.triangle.y1, a.triangle.x2, a.triangle.y2, color }); break;
+    case T::FillArc:        emit(Op::FillArc, { a.arc.x, a.arc.y, a.arc.r0, a.arc.r1, a.arc.angle0, a.arc.angle1, color }); break;
+    case T::FillEllipseArc:
+      emit(Op::FillEllipseArc, { a.ellipseArc.x, a.ellipseArc.y, a.ellipseArc.r0x, a.ellipseArc.r1x, a.ellipseArc.r0y, a.ellipseArc.r1y,
+                                 a.ellipseArc.angle0, a.ellipseArc.angle1, color });
+      break;
+
+    case T::DrawJpgFile:    emit(Op::FillRect, { a.jpg.x, a.jpg.y, a.jpg.w, a.jpg.h, color }); break;
+    case T::DrawPngFile:    emit(Op::FillRect, { a.png.x, a.png.y, a.png.w, a.png.h, color }); break;
+    case T::DrawBitmap:     emit(Op::FillRect, { a.bitmap.x, a.bitmap.y, a.bitmap.w, a.bitmap.h, color }); break;
+
+    // 背景色で文字の枠を塗ってから、文字色で字形を塗る
+    case T::DrawString:
+      setTextState(a.text, BLACK, color);
+      emit(Op::Text, { ref(a.text.text), a.text.x, a.text.y });
+      setTextState(a.text, color, color);
+      emit(Op::Text, { ref(a.text.text), a.text.x, a.text.y });
+      break;
+
+    // Clip 系（appendClip() で積む）・コンテナは判定用スプライトに何も塗らない
+    case T::ClipArc:
+    case T::ClipEllipseArc:
+    case T::ClipRect:
+    case T::ClipRoundRect:
+    case T::ClipCircle:
+    case T::ClipEllipse:
+    case T::ClipTriangle:
+    case T::FlexBox:
+    case T::TableBox:
+      break;
+
+    default:
+      return false;
+  }
+  return true;
+}
+
+void DisplayList::appendClip (VDS::DrawType type, const VDS::ObjectArgs& args, uint8_t zIndex) {
+  objects.emplace_back(type, args);
+  emit(Op::Clip, { int32_t(objects.size() - 1), zIndex });
+  hasClips = true;
+  layer = -1;   // 同じ層の要素にも効き方が変わるので次の要素の前に置き直す
+}
+
+void DisplayList::setLayer (uint8_t zIndex) {
+  if (!hasClips || layer == zIndex) return;
+  layer = zIndex;
+  emit(Op::Layer, { zIndex, 0 });
+}
+
+// 命令列を先頭から順に実行する（ヘッダ 1 つにつき種類の分岐は 1 回）
+// Clip の外になった層の図形は引数を読み飛ばす（文字列の状態命令は実行する）
+void DisplayList::play (LGFX_Sprite& gfx, VisualData* vData, ClipStack* clip) const {
+  VT_PROFILE_SCOPE(FrameStats::Stage::ListReplay);
+  const int32_t* pc = code.data();
+  const int32_t* end = pc + code.size();
+  bool skip = false;
+  if (hasClips && clip) clip->begin(&gfx);
+  while (pc < end) {
+    Op op = Op(*pc & 0xFF);
+    int32_t n = *pc >> 8;
+    const int32_t* a = pc + 1;
+
+    if (skip && op >= Op::Pixel && op <= Op::Object) {
+      pc = a + size_t(n) * operandCount(op);
+      continue;
+    }
+
+    switch (op) {
+      case Op::SetFont:      gfx.setFont(static_cast<const lgfx::IFont*>(refs[a[0]])); a += 2; break;
+      case Op::SetTextDatum: gfx.setTextDatum(textdatum_t(a[0])); a += 2; break;
+      case Op::SetTextSize:  gfx.setTextSize(a[0]); a += 2; break;
+      case Op::SetTextWrap:  gfx.setTextWrap(a[0] != 0, false); a += 2; break;
+      case Op::SetTextColor: gfx.setTextColor(int(a[0]), int(a[1])); a += 2; break;
+
+      case Op::Pixel:          for (; n > 0; n--, a += 3) gfx.drawPixel(a[0], a[1], int(a[2])); break;
+      case Op::Line:           for (; n > 0; n--, a += 5) gfx.drawLine(a[0], a[1], a[2], a[3], int(a[4])); break;
+      case Op::Bezier:         for (; n > 0; n--, a += 7) gfx.drawBezier(a[0], a[1], a[2], a[3], a[4], a[5], int(a[6])); break;
+      case Op::WideLine:       for (; n > 0; n--, a += 6) gfx.drawWideLine(a[0], a[1], a[2], a[3], a[4], int(a[5])); break;
+      case Op::Rect:           for (; n > 0; n--, a += 5) gfx.drawRect(a[0], a[1], a[2], a[3], int(a[4])); break;
+      case Op::FillRect:       for (; n > 0; n--, a += 5) gfx.fillRect(a[0], a[1], a[2], a[3], int(a[4])); break;
+      case Op::RoundRect:      for (; n > 0; n--, a += 6) gfx.drawRoundRect(a[0], a[1], a[2], a[3], a[4], int(a[5])); break;
+      case Op::FillRoundRect:  for (; n > 0; n--, a += 6) gfx.fillRoundRect(a[0], a[1], a[2], a[3], a[4], int(a[5])); break;
+      case Op::Circle:         for (; n > 0; n--, a += 4) gfx.drawCircle(a[0], a[1], a[2], int(a[3])); break;
+      case Op::FillCircle:     for (; n > 0; n--, a += 4) gfx.fillCircle(a[0], a[1], a[2], int(a[3])); break;
+      case Op::Ellipse:        for (; n > 0; n--, a += 5) gfx.drawEllipse(a[0], a[1], a[2], a[3], int(a[4])); break;
+      case Op::FillEllipse:    for (; n > 0; n--, a += 5) gfx.fillEllipse(a[0], a[1], a[2], a[3], int(a[4])); break;
+      case Op::Triangle:       for (; n > 0; n--, a += 7) gfx.drawTriangle(a[0], a[1], a[2], a[3], a[4], a[5], int(a[6])); break;
+      case Op::FillTriangle:   for (; n > 0; n--, a += 7) gfx.fillTriangle(a[0], a[1], a[2], a[3], a[4], a[5], int(a[6])); break;
+      case Op::FillArc:        for (; n > 0; n--, a += 7) gfx.fillArc(a[0], a[1], a[2], a[3], a[4], a[5], int(a[6])); break;
+      case Op::FillEllipseArc: for (; n > 0; n--, a += 9) gfx.fillEllipseArc(a[0], a[1], a[2], a[3], a[4], a[5], a[6], a[7], int(a[8])); break;
+
+      case Op::Image:
+        for (; n > 0; n--, a += 5) gfx.pushImage(a[0], a[1], a[2], a[3], static_cast<const uint16_t*>(refs[a[4]]));
+        break;
+
+      case Op::Text:
+        for (; n > 0; n--, a += 3) gfx.drawString(static_cast<const char*>(refs[a[0]]), a[1], a[2]);
+        break;
+
+      case Op::Object:
+        for (; n > 0; n--, a += 1) {
+          if (vData) vData->drawObject(gfx, objects[a[0]].first, objects[a[0]].second);
+        }
+        break;
+
+      case Op::Clip:
+        for (; n > 0; n--, a += 2) {
+          if (clip) clip->push(objects[a[0]].first, objects[a[0]].second, uint8_t(a[1]));
+        }
+        break;
+
+      case Op::Layer:
+        for (; n > 0; n--, a += 2) skip = clip && !clip->enter(uint8_t(a[0]));
+        break;
+
+      default:
+        pc = end;
+        continue;
+    }
+    pc = a;
+  }
+  if (hasClips && clip) clip->end();
+}
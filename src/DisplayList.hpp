@@ -0,0 +1,84 @@
+#pragma once
+#include <Arduino.h>
+#include <M5Unified.h>
+#include <vector>
+#include "VisualDataSet.h"
+
+class VisualData;
+class ClipStack;
+
+// ページを z 順の平らな命令列にしたもの（ページが変わったときだけ作り直して何度も再生する）
+//
+//   vt.vData.compileDisplayList(list, sprite);   // drawPage() が内部で行う
+//   list.play(sprite, &vt.vData);
+//
+// 命令は [ヘッダ（Op | 件数 << 8）][引数 × 件数] の int32_t 列で、同じ Op の図形が続く間は
+// 1 つのヘッダにまとめる。文字列のフォント・基準位置・色・サイズ・折り返しは変わるときだけ
+// 状態命令を積む。フォント・文字列・画像データのポインタは refs に置き、添字で参照する。
+// 命令にできない種類（JPG / PNG など）は Object 命令として VisualData::drawObject() に任せる。
+// 判定用スプライト向けには appendJudge() で TouchData::drawObjectProcess() と同じ塗り方の命令を積む。
+// Clip 系の要素は appendClip() で Clip 命令として積み、それ以降は zIndex が変わるたびに Layer 命令を
+// 置いて、再生時に ClipStack へ渡す（Clip の無いページには Layer 命令も積まない）。
+class DisplayList {
+public:
+  using VDS = VisualDataSet;
+
+  enum class Op : uint8_t {
+    // 状態（変わるときだけ積む）
+    SetFont, SetTextDatum, SetTextSize, SetTextWrap, SetTextColor,
+    // 図形（続く間は 1 つにまとめる）
+    Pixel, Line, Bezier, WideLine,
+    Rect, FillRect, RoundRect, FillRoundRect,
+    Circle, FillCircle, Ellipse, FillEllipse,
+    Triangle, FillTriangle, FillArc, FillEllipseArc,
+    Image, Text,
+    Object,     // VisualData::drawObject() に任せる
+    // 範囲制限（ClipStack に渡す）
+    Clip, Layer,
+    Count
+  };
+
+  void clear();
+  bool append(VDS::DrawType type, const VDS::ObjectArgs& args);              // VisualData::drawObject() と同じ見た目
+  bool appendJudge(VDS::DrawType type, const VDS::ObjectArgs& args, int color); // 判定色で塗る
+  void appendClip(VDS::DrawType type, const VDS::ObjectArgs& args, uint8_t zIndex);
+  void setLayer(uint8_t zIndex);     // 次に積む要素の zIndex（append / appendJudge の前に呼ぶ）
+  void play(LGFX_Sprite& sprite, VisualData* vData = nullptr, ClipStack* clip = nullptr) const;
+
+  // 作り直しが要るかどうか（key はページの版など、visible は作ったときの描画範囲）
+  void setSource(uint64_t key, const VDS::Rect& visible);
+  bool isCompiled(uint64_t key, const VDS::Rect& visible) const;
+
+  size_t getCommandCount() const;    // ヘッダの数（まとめた後）
+  size_t getDrawCount() const;       // 図形・文字列の数
+  size_t getElidedStates() const;    // 積まずに済んだ状態命令の数
+  size_t getCodeBytes() const;      // 命令列・参照・任せる要素の ObjectArgs の写し（確保済み容量）
+  size_t getCompileCount() const;    // setSource() した（作り直した）回数
+
+private:
+  std::vector<int32_t> code;
+  std::vector<const void*> refs;
+  std::vector<std::pair<VDS::DrawType, VDS::ObjectArgs>> objects;
+  size_t lastHeader = SIZE_MAX;
+  size_t commandCount = 0;
+  size_t drawCount = 0;
+  size_t elidedStates = 0;
+  bool hasClips = false;
+  int layer = -1;                    // 直前の Layer 命令の zIndex（-1 は未設定）
+
+  bool compiled = false;
+  size_t compileCount = 0;
+  uint64_t sourceKey = 0;
+  VDS::Rect sourceVisible;
+
+  // 直前に積んだ文字列の状態（knownStates のビットが立っているものだけ有効、再生開始時は不明）
+  const void* stateFont = nullptr;
+  int32_t stateValues[size_t(Op::SetTextColor) + 1][2] = {};
+  uint8_t knownStates = 0;
+
+  static size_t operandCount(Op op);
+  void emit(Op op, std::initializer_list<int32_t> operands);
+  int32_t ref(const void* p);
+  void setState(Op op, int32_t a, int32_t b = 0);
+  void setTextState(const VDS::StringArgs& text, int fg, int bg);
+};
@@ -0,0 +1,161 @@
+#include "FramePacer.hpp"
+#include "FrameProfiler.hpp"
+
+FramePacer::FramePacer (VisualData* vData, SceneQueue* sceneQueue, Animator* animator, LovyanGFX* lcd, bool enableErrorLog, bool enableInfoLog, bool enableSuccessLog){
+  this->vData = vData;
+  this->sceneQueue = sceneQueue;
+  this->animator = animator;
+  this->lcd = lcd;
+  debugLog.setDebug(enableErrorLog, enableInfoLog, enableSuccessLog);
+}
+
+void FramePacer::setTargetFps (uint32_t fps) {
+  frameIntervalUs = fps ? 1000000 / fps : 0;
+  hasNextFrame = false;
+}
+
+bool FramePacer::showPage (LGFX_Sprite &sprite, const String& pageName) {
+  if (!vData->drawPage(sprite, pageName)) {
+    VT_LOG_ERROR(debugLog, "FramePacer: page [%s] not found.", pageName.c_str());
+    return false;
+  }
+  needsFullPush = true;
+  return true;
+}
+
+void FramePacer::invalidate () {
+  needsFullPush = true;
+}
+
+bool FramePacer::isIdle () const {
+  return !needsFullPush && vData->dirtyRects.empty() && sceneQueue->isEmpty() && animator->isIdle();
+}
+
+const PacingStats& FramePacer::getStats () const {
+  return stats;
+}
+
+void FramePacer::resetStats () {
+  stats = PacingStats();
+}
+
+// 次のフレームの時刻になっていれば、その次の時刻へ進めて true を返す
+bool FramePacer::takeFrame (uint32_t nowUs) {
+  if (!frameIntervalUs) return true;
+  if (!hasNextFrame) {
+    nextFrameUs = nowUs;
+    hasNextFrame = true;
+  }
+  int32_t late = int32_t(nowUs - nextFrameUs);
+  if (late < 0) return false;
+
+  if (uint32_t(late) >= frameIntervalUs) {
+    // 変化のない間に過ぎた時刻は数えない
+    if (lastTickPushed) stats.lateFrames++;
+    nextFrameUs = nowUs + frameIntervalUs;
+  } else {
+    nextFrameUs += frameIntervalUs;
+  }
+  return true;
+}
+
+bool FramePacer::update (LGFX_Sprite &sprite) {
+  uint32_t t0 = micros();
+  if (!takeFrame(t0)) return false;
+
+  sceneQueue->apply(sprite);
+  animator->update(sprite);
+  vData->updateBindings(sprite);
+  bool drawn = !vData->dirtyRects.empty() && vData->redrawDirty(sprite);
+  if (!drawn && !needsFullPush) {
+    stats.idleTicks++;
+    lastTickPushed = false;
+    return false;
+  }
+
+  uint32_t t1 = micros();
+  uint32_t pixels = push(sprite, needsFullPush);
+  uint32_t t2 = micros();
+
+  stats.frames++;
+  stats.pushedPixels += pixels;
+  stats.renderUs += t1 - t0;
+  stats.pushUs += t2 - t1;
+  stats.lastFrameUs = t2 - t0;
+  if (stats.lastFrameUs > stats.maxFrameUs) stats.maxFrameUs = stats.lastFrameUs;
+  if (lastTickPushed) {
+    stats.lastIntervalUs = t0 - lastPushUs;
+    if (stats.lastIntervalUs > stats.maxIntervalUs) stats.maxIntervalUs = stats.lastIntervalUs;
+  }
+  lastPushUs = t0;
+  lastTickPushed = true;
+  return true;
+}
+
+// 描き直した範囲だけをパネルへ送る（合計が画面の半分を超えたら 1 回で全体を送る）
+// スプライトは画面の左上 (0, 0) に置く前提。戻り値は送った画素数
+uint32_t FramePacer::push (LGFX_Sprite &sprite, bool full) {
+  VT_PROFILE_SCOPE(FrameStats::Stage::PushSprite);
+  VDS::Rect screen{ 0, 0, sprite.width(), sprite.height() };
+  uint32_t screenPixels = uint32_t(screen.w) * uint32_t(screen.h);
+
+  uint32_t pixels = 0;
+  if (!full) {
+    for (const auto& rect : vData->getFlushedRects()) {
+      VDS::Rect area = rect.intersected(screen);
+      if (!area.isEmpty()) pixels += uint32_t(area.w) * uint32_t(area.h);
+    }
+    full = pixels * 2 >= screenPixels;
+  }
+
+  if (full) {
+    sprite.pushSprite(lcd, 0, 0);
+    needsFullPush = false;
+    stats.fullFrames++;
+    return screenPixels;
+  }
+
+  // パネル側のクリップで範囲外の転送を省く（トランザクションは 1 回にまとめる）
+  lcd->startWrite();
+  for (const auto& rect : vData->getFlushedRects()) {
+    VDS::Rect area = rect.intersected(screen);
+    if (area.isEmpty()) continue;
+    lcd->setClipRect(area.x, area.y, area.w, area.h);
+    sprite.pushSprite(lcd, 0, 0);
+  }
+  lcd->clearClipRect();
+  lcd->endWrite();
+  return pixels;
+}
+
+// delay() で他のタスク（IDLE を含む）に CPU を渡す。ms 単位に切り上げるので開始は最大 1 ms 遅れるが、
+// 時刻は frameIntervalUs ずつ進めるため間隔の平均は変わらない（1 ms 未満を空回りして待つより安い）
+void FramePacer::sleepUntil (uint32_t targetUs) {
+  uint32_t t0 = micros();
+  int32_t remaining = int32_t(targetUs - t0);
+  if (remaining <= 0) {
+    yield();
+    return;
+  }
+  delay((uint32_t(remaining) + 999) / 1000);
+  stats.sleepUs += micros() - t0;
+}
+
+void FramePacer::wait () {
+  if (isIdle()) {
+    uint32_t t0 = micros();
+    delay(idleSleepMs);
+    stats.sleepUs += micros() - t0;
+    return;
+  }
+  if (!frameIntervalUs || !hasNextFrame) {
+    yield();
+    return;
+  }
+  sleepUntil(nextFrameUs);
+}
+
+void FramePacer::waitFrame () {
+  while (!takeFrame(micros())) sleepUntil(nextFrameUs);
+  lastTickPushed = false;
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include <Arduino.h>
+#include "VisualData.hpp"
+#include "SceneQueue.hpp"
+#include "Animator.hpp"
+#include "PacingStats.h"
+
+// 目標のフレームレート（build_flags の -DVT_TARGET_FPS=n で変更）
+#ifndef VT_TARGET_FPS
+#define VT_TARGET_FPS 60
+#endif
+
+// 変化のないときに wait() が CPU を返す時間 [ms]（タッチの取得間隔の上限にもなる）
+#ifndef VT_IDLE_SLEEP_MS
+#define VT_IDLE_SLEEP_MS 10
+#endif
+
+// 描画ループのフレームの間隔を揃え、変化のあったフレームだけ描いて転送する
+//
+//   vt.framePacer.showPage(sprite, "page1");
+//   void loop() {
+//     M5.update();
+//     if (vt.tData.update()) handle(vt.tData.currentProcessName);
+//     vt.framePacer.update(sprite);    // フレームの時刻になっていれば反映・描画・転送
+//     vt.framePacer.wait();            // 次のフレームまで（変化がなければ VT_IDLE_SLEEP_MS）CPU を返す
+//   }
+//
+// update() はフレームの時刻ごとに SceneQueue・アニメーション・バインドを反映し、再描画範囲が
+// あるときだけ redrawDirty() して、その範囲だけをパネルへ送る（変化がなければ描画も SPI も使わない）。
+// 時刻は frameIntervalUs ずつ進めるので、描画が間に合っている間は一定の間隔で転送され、
+// 1 フレーム以上遅れたときは詰めて描かずに今から数え直す。
+// RenderPipeline / TileRenderer を使う場合はそちらが描画と転送を行うので、併用しないこと。
+class FramePacer {
+public:
+  Debug debugLog;
+  using VDS = VisualDataSet;
+
+  VisualData* vData;
+  SceneQueue* sceneQueue;
+  Animator* animator;
+  LovyanGFX* lcd;
+
+  uint32_t frameIntervalUs = 1000000 / VT_TARGET_FPS;
+  uint32_t idleSleepMs = VT_IDLE_SLEEP_MS;
+
+  FramePacer(VisualData* vData, SceneQueue* sceneQueue, Animator* animator, LovyanGFX* lcd, bool enableErrorLog, bool enableInfoLog, bool enableSuccessLog);
+
+  void setTargetFps(uint32_t fps);       // 0 で上限なし
+
+  // ページを描き、次のフレームで画面全体を送る（戻り値はページがあったかどうか）
+  bool showPage(LGFX_Sprite &sprite, const String& pageName);
+  void invalidate();                     // 次のフレームで画面全体を送り直す（他の描画がパネルを上書きした後など）
+
+  // 描画ループから毎回呼ぶ（戻り値は転送したかどうか）
+  bool update(LGFX_Sprite &sprite);
+  void wait();                           // 次のフレームの時刻まで、変化がなければ idleSleepMs だけ CPU を返す
+  void waitFrame();                      // 変化の有無によらず次のフレームの時刻まで待ち、その時刻を使う（自前で描く画面用）
+
+  bool isIdle() const;                   // 反映・描画・転送するものが何もない
+  const PacingStats& getStats() const;
+  void resetStats();
+
+private:
+  uint32_t nextFrameUs = 0;
+  bool hasNextFrame = false;
+  bool needsFullPush = false;
+  bool lastTickPushed = false;
+  uint32_t lastPushUs = 0;
+  PacingStats stats;
+
+  bool takeFrame(uint32_t nowUs);
+  void sleepUntil(uint32_t targetUs);
+  uint32_t push(LGFX_Sprite &sprite, bool full);
+};
@@ -0,0 +1,185 @@
+#include "FrameProfiler.hpp"
+
+#if VT_PROFILE
+#include <algorithm>
+#if !defined(ESP_PLATFORM)
+#include <chrono>
+#endif
+
+namespace {
+
+  // 1 区間ぶんのフレーム合計と、直近フレームの窓
+  struct Track {
+    uint32_t window[VT_PROFILE_WINDOW];
+    uint16_t count = 0;
+    uint16_t head = 0;
+    uint32_t frameTicks = 0;
+    uint32_t frameCalls = 0;
+    uint32_t lastCalls = 0;
+
+    void push(uint32_t ticks) {
+      window[head] = ticks;
+      head = uint16_t((head + 1) % VT_PROFILE_WINDOW);
+      if (count < VT_PROFILE_WINDOW) count++;
+    }
+    // 実行されなかったフレームは窓に積まない（平均が 0 に引きずられないように）
+    void closeFrame() {
+      lastCalls = frameCalls;
+      if (frameCalls) push(frameTicks);
+      frameTicks = 0;
+      frameCalls = 0;
+    }
+  };
+
+  // フレームごとの件数（0 のフレームも数える）
+  struct CounterTrack {
+    uint32_t frameValue = 0;
+    FrameStats::CounterStats stats;
+
+    void closeFrame(uint32_t frames) {
+      stats.last = frameValue;
+      stats.total += frameValue;
+      if (frameValue > stats.max) stats.max = frameValue;
+      stats.avg = float(double(stats.total) / frames);
+      frameValue = 0;
+    }
+  };
+
+  Track frameTrack;
+  Track stageTracks[FrameStats::STAGE_COUNT];
+  Track drawTracks[FrameStats::DRAW_TYPE_COUNT];
+  CounterTrack counterTracks[FrameStats::COUNTER_COUNT];
+  FrameStats stats;
+  uint32_t frameCount = 0;
+  uint32_t lastFrameTick = 0;
+  bool hasLastFrame = false;
+  uint32_t dumpIntervalMs = 0;
+  uint32_t lastDumpMs = 0;
+
+  float ticksPerUs() {
+#if defined(ESP_PLATFORM)
+    return float(ESP.getCpuFreqMHz());
+#else
+    return 1000.0f;
+#endif
+  }
+
+  void summarize(const Track& track, FrameStats::StageStats& out, float perUs) {
+    out = FrameStats::StageStats();
+    out.lastCalls = track.lastCalls;
+    out.frames = track.count;
+    if (!track.count) return;
+
+    uint32_t sorted[VT_PROFILE_WINDOW];
+    std::copy(track.window, track.window + track.count, sorted);
+    std::sort(sorted, sorted + track.count);
+
+    uint64_t total = 0;
+    for (uint16_t i = 0; i < track.count; i++) total += sorted[i];
+
+    out.minUs = sorted[0] / perUs;
+    out.maxUs = sorted[track.count - 1] / perUs;
+    out.avgUs = float(total) / track.count / perUs;
+    out.p99Us = sorted[(track.count * 99 + 99) / 100 - 1] / perUs;  // 切り上げ（少数サンプルでは最大値）
+  }
+
+  void printStats(const char* name, const FrameStats::StageStats& s) {
+    Serial.printf("  %-14s min %8.1f avg %8.1f p99 %8.1f max %8.1f us (%u frames, %u calls)\n",
+                  name, s.minUs, s.avgUs, s.p99Us, s.maxUs, unsigned(s.frames), unsigned(s.lastCalls));
+  }
+}
+
+uint32_t FrameProfiler::now() {
+#if defined(ESP_PLATFORM)
+  return ESP.getCycleCount();
+#else
+  using Clock = std::chrono::steady_clock;
+  return uint32_t(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count());
+#endif
+}
+
+void FrameProfiler::add(Stage stage, uint32_t ticks) {
+  Track& t = stageTracks[size_t(stage)];
+  t.frameTicks += ticks;
+  t.frameCalls++;
+}
+
+void FrameProfiler::addDraw(DrawType type, uint32_t ticks) {
+  add(Stage::DrawObject, ticks);
+  Track& t = drawTracks[size_t(type)];
+  t.frameTicks += ticks;
+  t.frameCalls++;
+}
+
+void FrameProfiler::count(Counter counter, uint32_t n) {
+  counterTracks[size_t(counter)].frameValue += n;
+}
+
+void FrameProfiler::endFrame() {
+  uint32_t tick = now();
+  if (hasLastFrame) {
+    frameTrack.frameTicks = tick - lastFrameTick;
+    frameTrack.frameCalls = 1;
+  }
+  frameTrack.closeFrame();
+  lastFrameTick = tick;
+  hasLastFrame = true;
+
+  for (auto& t : stageTracks) t.closeFrame();
+  for (auto& t : drawTracks)  t.closeFrame();
+  frameCount++;
+  for (auto& t : counterTracks) t.closeFrame(frameCount);
+
+  if (dumpIntervalMs && millis() - lastDumpMs >= dumpIntervalMs) {
+    lastDumpMs = millis();
+    dump();
+  }
+}
+
+const FrameStats& FrameProfiler::getFrameStats() {
+  float perUs = ticksPerUs();
+  summarize(frameTrack, stats.frame, perUs);
+  for (size_t i = 0; i < FrameStats::STAGE_COUNT; i++)     summarize(stageTracks[i], stats.stages[i], perUs);
+  for (size_t i = 0; i < FrameStats::DRAW_TYPE_COUNT; i++) summarize(drawTracks[i], stats.drawTypes[i], perUs);
+  for (size_t i = 0; i < FrameStats::COUNTER_COUNT; i++)   stats.counters[i] = counterTracks[i].stats;
+  stats.frameCount = frameCount;
+  return stats;
+}
+
+void FrameProfiler::reset() {
+  frameTrack = Track();
+  for (auto& t : stageTracks) t = Track();
+  for (auto& t : drawTracks)  t = Track();
+  for (auto& t : counterTracks) t = CounterTrack();
+  stats = FrameStats();
+  frameCount = 0;
+  hasLastFrame = false;
+}
+
+void FrameProfiler::setDumpInterval(uint32_t ms) {
+  dumpIntervalMs = ms;
+  lastDumpMs = millis();
+}
+
+void FrameProfiler::dump() {
+  const FrameStats& s = getFrameStats();
+  Serial.printf("[FrameStats] frames=%u\n", unsigned(s.frameCount));
+  if (!s.frame.isEmpty()) printStats("Frame", s.frame);
+  for (size_t i = 0; i < FrameStats::STAGE_COUNT; i++) {
+    if (!s.stages[i].isEmpty()) printStats(FrameStats::stageName(Stage(i)), s.stages[i]);
+  }
+  for (size_t i = 0; i < FrameStats::DRAW_TYPE_COUNT; i++) {
+    if (s.drawTypes[i].isEmpty()) continue;
+    char name[16];
+    snprintf(name, sizeof(name), "DrawType[%u]", unsigned(i));
+    printStats(name, s.drawTypes[i]);
+  }
+  for (size_t i = 0; i < FrameStats::COUNTER_COUNT; i++) {
+    const FrameStats::CounterStats& c = s.counters[i];
+    if (!c.total) continue;
+    Serial.printf("  %-14s last %6u avg %8.1f max %6u (total %llu)\n", FrameStats::counterName(Counter(i)),
+                  unsigned(c.last), c.avg, unsigned(c.max), (unsigned long long)c.total);
+  }
+}
+
+#endif
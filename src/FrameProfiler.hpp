@@ -0,0 +1,69 @@
+#pragma once
+#include <Arduino.h>
+#include "FrameStats.h"
+
+// パイプライン各段の処理時間を数える軽量プロファイラ
+// 計測値はフレーム単位で合計し、endFrame() で直近 VT_PROFILE_WINDOW フレームの窓に積む。
+// VT_PROFILE = 0 のときはすべて空の inline 関数になる。
+class FrameProfiler {
+public:
+  using Stage = FrameStats::Stage;
+  using Counter = FrameStats::Counter;
+  using DrawType = VisualDataSet::DrawType;
+
+#if VT_PROFILE
+  static uint32_t now();                       // 実機はサイクル数、ホストは ns
+  static void add(Stage stage, uint32_t ticks);
+  static void addDraw(DrawType type, uint32_t ticks);
+  static void count(Counter counter, uint32_t n);
+  static void endFrame();                      // TouchData::update() の末尾でも呼ばれる
+  static const FrameStats& getFrameStats();    // 呼び出し時点の窓から集計
+  static void reset();
+  static void setDumpInterval(uint32_t ms);    // endFrame() 時に Serial へ出力（0 で無効）
+  static void dump();
+
+  // スコープを抜けた時点で経過時間を加算する
+  class Scope {
+  public:
+    explicit Scope(Stage stage) : stage(stage), start(now()) {}
+    ~Scope() { add(stage, now() - start); }
+  private:
+    Stage stage;
+    uint32_t start;
+  };
+
+  class DrawScope {
+  public:
+    explicit DrawScope(DrawType type) : type(type), start(now()) {}
+    ~DrawScope() { addDraw(type, now() - start); }
+  private:
+    DrawType type;
+    uint32_t start;
+  };
+#else
+  static uint32_t now() { return 0; }
+  static void add(Stage, uint32_t) {}
+  static void addDraw(DrawType, uint32_t) {}
+  static void count(Counter, uint32_t) {}
+  static void endFrame() {}
+  static const FrameStats& getFrameStats() { static const FrameStats empty; return empty; }
+  static void reset() {}
+  static void setDumpInterval(uint32_t) {}
+  static void dump() {}
+#endif
+};
+
+#define VT_PROFILE_CONCAT_(a, b) a##b
+#define VT_PROFILE_CONCAT(a, b) VT_PROFILE_CONCAT_(a, b)
+
+#if VT_PROFILE
+#define VT_PROFILE_SCOPE(stage)     FrameProfiler::Scope VT_PROFILE_CONCAT(vtProfileScope_, __LINE__)(stage)
+#define VT_PROFILE_DRAW_SCOPE(type) FrameProfiler::DrawScope VT_PROFILE_CONCAT(vtProfileDraw_, __LINE__)(type)
+#define VT_PROFILE_END_FRAME()      FrameProfiler::endFrame()
+#define VT_PROFILE_COUNT(counter, n) FrameProfiler::count(counter, n)
+#else
+#define VT_PROFILE_SCOPE(stage)     ((void)0)
+#define VT_PROFILE_DRAW_SCOPE(type) ((void)0)
+#define VT_PROFILE_END_FRAME()      ((void)0)
+#define VT_PROFILE_COUNT(counter, n) ((void)0)
+#endif
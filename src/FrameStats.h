@@ -0,0 +1,111 @@
+#pragma once
+#include <Arduino.h>
+#include "VisualDataSet.h"
+
+// フレーム計測の有効化（build_flags に -DVT_PROFILE=1）
+// 0 のときは計測スコープがすべて空になり、コードもデータも残らない
+#ifndef VT_PROFILE
+#define VT_PROFILE 0
+#endif
+
+// 集計に使う直近フレーム数
+#ifndef VT_PROFILE_WINDOW
+#define VT_PROFILE_WINDOW 64
+#endif
+
+struct FrameStats {
+  // 計測区間（入れ子になるものもあるため合計はフレーム時間と一致しない）
+  enum class Stage : uint8_t {
+    PageResolve,    // 描画ページの解決（drawPage / setProcessPage）
+    JudgeRebuild,   // 判定用スプライトの再描画
+    JudgeLookup,    // 判定用スプライトの readPixel
+    CandidateSort,  // 判定候補の優先度ソート
+    DrawObject,     // オブジェクト 1 個の描画（種類別は drawTypes）
+    ImageDecode,    // JPG / PNG の展開・サイズ取得
+    PushSprite,     // スプライト転送（FramePacer 以外で転送する場合はアプリ側で VT_PROFILE_SCOPE を置く）
+    ListCompile,    // ページを命令列（DisplayList）にする
+    ListReplay,     // 命令列の再生
+    ClipMask,       // 矩形以外の Clip のマスク作成
+    Layout,         // 子の親への追従・コンテナ（FlexBox / TableBox）の子の配置
+    Animation,      // アニメーションの補間と反映
+    Count
+  };
+  static constexpr size_t STAGE_COUNT = size_t(Stage::Count);
+
+  // フレームごとの件数（時間ではなく数を数えるもの）
+  enum class Counter : uint8_t {
+    OffscreenDraw,  // 描画先の外・面積 0 で描かなかった要素
+    OccludedDraw,   // 前面に覆われて描かなかった要素
+    OffscreenJudge, // 同上（判定用スプライト）
+    OccludedJudge,
+    Count
+  };
+  static constexpr size_t COUNTER_COUNT = size_t(Counter::Count);
+  static constexpr size_t DRAW_TYPE_COUNT = size_t(VisualDataSet::DrawType::TableBox) + 1;
+
+  // 1 フレーム内の合計時間を、実行されたフレームだけで集計したもの
+  struct StageStats {
+    float minUs = 0;
+    float avgUs = 0;
+    float maxUs = 0;
+    float p99Us = 0;
+    uint32_t frames = 0;     // 集計窓内で実行されたフレーム数
+    uint32_t lastCalls = 0;  // 直前のフレームでの呼び出し回数
+
+    bool isEmpty() const {
+      return frames == 0;
+    }
+  };
+
+  // 件数は数えなかったフレームも 0 として集計する
+  struct CounterStats {
+    uint32_t last = 0;       // 直前のフレーム
+    uint32_t max = 0;
+    float avg = 0;           // 計測開始からのフレームあたり
+    uint64_t total = 0;
+  };
+
+  StageStats frame;                        // endFrame() の間隔
+  StageStats stages[STAGE_COUNT];
+  StageStats drawTypes[DRAW_TYPE_COUNT];   // DrawType ごとの DrawObject
+  CounterStats counters[COUNTER_COUNT];
+  uint32_t frameCount = 0;                 // 計測開始からのフレーム数
+
+  const StageStats& stage(Stage s) const {
+    return stages[size_t(s)];
+  }
+  const StageStats& drawType(VisualDataSet::DrawType type) const {
+    return drawTypes[size_t(type)];
+  }
+  const CounterStats& counter(Counter c) const {
+    return counters[size_t(c)];
+  }
+
+  static const char* stageName(Stage s) {
+    switch (s) {
+      case Stage::PageResolve:   return "PageResolve";
+      case Stage::JudgeRebuild:  return "JudgeRebuild";
+      case Stage::JudgeLookup:   return "JudgeLookup";
+      case Stage::CandidateSort: return "CandidateSort";
+      case Stage::DrawObject:    return "DrawObject";
+      case Stage::ImageDecode:   return "ImageDecode";
+      case Stage::PushSprite:    return "PushSprite";
+      case Stage::ListCompile:   return "ListCompile";
+      case Stage::ListReplay:    return "ListReplay";
+      case Stage::ClipMask:      return "ClipMask";
+      case Stage::Layout:        return "Layout";
+      case Stage::Animation:     return "Animation";
+      default:                   return "?";
+    }
+  }
+
+  static const char* counterName(Counter c) {
+    switch (c) {
+      case Counter::OffscreenDraw:  return "OffscreenDraw";
+      case Counter::OccludedDraw:   return "OccludedDraw";
+      case Counter::OffscreenJudge: return "OffscreenJudge";
+      case Counter::OccludedJudge:  return "OccludedJudge";
+      default:                      return "?";
+    }
+  }
+};
@@ -0,0 +1,80 @@
+#pragma once
+#include <Arduino.h>
+
+// タッチ遅延計測の有効化（build_flags に -DVT_LATENCY=0 で組み込まない）
+// 1 回のタッチ判定につき時刻を 3 回取るだけなので既定で有効
+#ifndef VT_LATENCY
+#define VT_LATENCY 1
+#endif
+
+// タッチ 1 サンプルの「取得 → judgeProcess() で解決 → アプリが結果を受け取る」までの遅延
+struct LatencyStats {
+  enum class Segment : uint8_t {
+    AcquireToResolve,   // 取得（M5.update() 直後）から judgeProcess() がプロセスを確定するまで
+    ResolveToObserve,   // 確定からアプリが結果を処理し終えるまで
+    AcquireToObserve,   // 取得からアプリが結果を処理し終えるまで（体感の遅延）
+    Count
+  };
+  static constexpr size_t SEGMENT_COUNT = size_t(Segment::Count);
+
+  // ヒストグラムの各バケットの上限（us、最後は上限なし）
+  static constexpr size_t BUCKET_COUNT = 12;
+  static constexpr uint32_t BUCKET_UPPER_US[BUCKET_COUNT] = {
+    100, 200, 500, 1000, 2000, 5000, 10000, 20000, 50000, 100000, 200000, UINT32_MAX
+  };
+
+  struct Histogram {
+    uint32_t count = 0;
+    uint32_t minUs = 0;
+    uint32_t maxUs = 0;
+    uint64_t totalUs = 0;
+    uint32_t buckets[BUCKET_COUNT] = {};
+
+    void add(uint32_t us) {
+      if (!count || us < minUs) minUs = us;
+      if (us > maxUs) maxUs = us;
+      totalUs += us;
+      count++;
+      size_t i = 0;
+      while (i < BUCKET_COUNT - 1 && us >= BUCKET_UPPER_US[i]) i++;
+      buckets[i]++;
+    }
+
+    bool isEmpty() const {
+      return count == 0;
+    }
+    float avgUs() const {
+      return count ? float(totalUs) / count : 0.0f;
+    }
+
+    // p（0〜100）パーセンタイルが入るバケットの上限（最後のバケットは maxUs）
+    uint32_t percentileUs(float p) const {
+      if (!count) return 0;
+      uint32_t rank = uint32_t(count * p / 100.0f + 0.999f);
+      if (rank < 1) rank = 1;
+      uint32_t seen = 0;
+      for (size_t i = 0; i < BUCKET_COUNT; i++) {
+        seen += buckets[i];
+        if (seen >= rank) return (i == BUCKET_COUNT - 1 || BUCKET_UPPER_US[i] > maxUs) ? maxUs : BUCKET_UPPER_US[i];
+      }
+      return maxUs;
+    }
+  };
+
+  Histogram segments[SEGMENT_COUNT];
+  uint32_t resolved = 0;     // judgeProcess() がプロセスを確定した回数
+  uint32_t unobserved = 0;   // 結果が受け取られないまま次のサンプルに進んだ回数
+
+  const Histogram& segment(Segment s) const {
+    return segments[size_t(s)];
+  }
+
+  static const char* segmentName(Segment s) {
+    switch (s) {
+      case Segment::AcquireToResolve: return "AcquireToResolve";
+      case Segment::ResolveToObserve: return "ResolveToObserve";
+      case Segment::AcquireToObserve: return "AcquireToObserve";
+      default:                        return "?";
+    }
+  }
+};
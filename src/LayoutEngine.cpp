@@ -0,0 +1,204 @@
+#include "LayoutEngine.hpp"
+#include "VisualData.hpp"
+#include <algorithm>
+#include <cstring>
+
+LayoutEngine::LayoutEngine (VisualData* vData) {
+  this->vData = vData;
+}
+
+bool LayoutEngine::isContainerType (VDS::DrawType type) {
+  return type == VDS::DrawType::FlexBox || type == VDS::DrawType::TableBox;
+}
+
+void LayoutEngine::beginPass (const VDS::PageData& page) {
+  lastRelaid = 0;
+  lastMoved = 0;
+  for (auto& box : boxes) {
+    if (box.pageNum == page.pageNum) box.isUsed = false;
+  }
+}
+
+// 入力が前回と変わっていれば並べ直す
+size_t LayoutEngine::updateBox (VDS::PageData& page, size_t index, bool markDirty) {
+  if (!vData || index >= page.objects.size()) return 0;
+  const VDS::ObjectData& container = page.objects[index];
+  if (!isContainerType(container.type) || container.isHidden) return 0;
+
+  VDS::DrawType type = container.type;
+  VDS::BoxArgs args = container.objectArgs.box;
+  Box& box = findBox(page.pageNum, container.objectNum);
+  box.isUsed = true;
+
+  collectChildren(page, container.objectNum);
+  if (isClean(box, type, args)) return 0;
+
+  if (type == VDS::DrawType::FlexBox) placeFlex(args);
+  else                                 placeTable(args);
+  size_t moved = moveChildren(page, markDirty);
+  if (moved) vData->pageRevision++;
+  lastMoved += moved;
+  lastRelaid++;
+
+  box.type = type;
+  box.args = args;
+  box.slots = scratch;
+  return moved;
+}
+
+void LayoutEngine::endPass (const VDS::PageData& page) {
+  boxes.erase(std::remove_if(boxes.begin(), boxes.end(), [&page](const Box& b) { return b.pageNum == page.pageNum && !b.isUsed; }), boxes.end());
+  if (lastRelaid) VT_LOG_INFO(vData->debugLog, "Layout: %u boxes relaid, %u children moved.", unsigned(lastRelaid), unsigned(lastMoved));
+}
+
+void LayoutEngine::clear () {
+  boxes.clear();
+}
+
+size_t LayoutEngine::getLastRelaidCount () const {
+  return lastRelaid;
+}
+
+size_t LayoutEngine::getLastMovedCount () const {
+  return lastMoved;
+}
+
+size_t LayoutEngine::getBytes () const {
+  size_t bytes = boxes.capacity() * sizeof(Box) + scratch.capacity() * sizeof(Slot) + targets.capacity() * sizeof(Point);
+  for (const auto& box : boxes) bytes += box.slots.capacity() * sizeof(Slot);
+  return bytes;
+}
+
+LayoutEngine::Box& LayoutEngine::findBox (int pageNum, int objectNum) {
+  for (auto& box : boxes) {
+    if (box.pageNum == pageNum && box.objectNum == objectNum) return box;
+  }
+  Box box;
+  box.pageNum = pageNum;
+  box.objectNum = objectNum;
+  boxes.push_back(box);
+  return boxes.back();
+}
+
+// 子をページ内の並び順（オブジェクト → インスタンス）に集め、今の外接矩形を記録する
+// 範囲が分からない子・非表示の子は並べない
+void LayoutEngine::collectChildren (const VDS::PageData& page, int containerNum) {
+  scratch.clear();
+  VDS::Rect bounds;
+  for (const auto& obj : page.objects) {
+    if (obj.parentNum != containerNum || obj.isHidden) continue;
+    if (!vData->getObjectBounds(vData->boundsSprite, obj, bounds)) continue;
+    scratch.push_back(Slot{ obj.objectNum, false, bounds.w, bounds.h, bounds.x, bounds.y });
+  }
+  for (const auto& inst : page.instances) {
+    if (inst.parentNum != containerNum) continue;
+    const VDS::TemplateData& tmpl = vData->getTemplateData(inst.templateNum);
+    if (tmpl.isEmpty() || !vData->getObjectBounds(vData->boundsSprite, tmpl.type, vData->resolveInstance(tmpl, inst), bounds)) continue;
+    scratch.push_back(Slot{ inst.objectNum, true, bounds.w, bounds.h, bounds.x, bounds.y });
+  }
+}
+
+// コンテナの引数・子の並びと大きさが前回と同じで、子が前回置いた位置にあれば並べ直さない
+bool LayoutEngine::isClean (const Box& box, VDS::DrawType type, const VDS::BoxArgs& args) const {
+  if (box.type != type || std::memcmp(&box.args, &args, sizeof(args)) != 0) return false;
+  if (box.slots.size() != scratch.size()) return false;
+  for (size_t i = 0; i < scratch.size(); i++) {
+    const Slot& a = box.slots[i];
+    const Slot& b = scratch[i];
+    if (a.objectNum != b.objectNum || a.isInstance != b.isInstance || a.w != b.w || a.h != b.h || a.x != b.x || a.y != b.y) return false;
+  }
+  return true;
+}
+
+int32_t LayoutEngine::alignIn (VDS::BoxAlign align, int32_t space, int32_t size) {
+  switch (align) {
+    case VDS::BoxAlign::Center: return (space - size) / 2;
+    case VDS::BoxAlign::End:    return space - size;
+    default:                    return 0;
+  }
+}
+
+// 主軸に大きさ + gap で詰め、余りを justify に従って前・間・後ろに振り分ける
+void LayoutEngine::placeFlex (const VDS::BoxArgs& args) {
+  bool row = args.direction == VDS::BoxDirection::Row;
+  int32_t innerX = args.x + args.padding;
+  int32_t innerY = args.y + args.padding;
+  int32_t mainLen  = (row ? args.w : args.h) - args.padding * 2;
+  int32_t crossLen = (row ? args.h : args.w) - args.padding * 2;
+  size_t n = scratch.size();
+
+  int64_t total = n ? int64_t(args.gap) * int64_t(n - 1) : 0;
+  for (const auto& s : scratch) total += row ? s.w : s.h;
+  int32_t space = int32_t(mainLen - total);
+
+  int32_t pos = 0;
+  bool spread = false;
+  switch (args.justify) {
+    case VDS::BoxAlign::Center:       pos = space / 2; break;
+    case VDS::BoxAlign::End:          pos = space;     break;
+    case VDS::BoxAlign::SpaceBetween: spread = n > 1 && space > 0; break;
+    default:                          break;
+  }
+
+  targets.resize(n);
+  for (size_t i = 0; i < n; i++) {
+    const Slot& s = scratch[i];
+    int32_t offset = pos + (spread ? int32_t(int64_t(space) * int64_t(i) / int64_t(n - 1)) : 0);
+    int32_t cross = alignIn(args.align, crossLen, row ? s.h : s.w);
+    targets[i] = row ? Point{ innerX + offset, innerY + cross } : Point{ innerX + cross, innerY + offset };
+    pos += (row ? s.w : s.h) + args.gap;
+  }
+}
+
+// 範囲を等分したセルに行順で 1 つずつ置く（rows を超えた子は下へはみ出して続ける）
+void LayoutEngine::placeTable (const VDS::BoxArgs& args) {
+  size_t n = scratch.size();
+  int32_t columns = std::max<int32_t>(args.columns, 1);
+  int32_t rows = args.rows > 0 ? args.rows : std::max<int32_t>(int32_t((n + columns - 1) / columns), 1);
+  int32_t cellW = (args.w - args.padding * 2 - args.gap * (columns - 1)) / columns;
+  int32_t cellH = (args.h - args.padding * 2 - args.gap * (rows - 1)) / rows;
+
+  targets.resize(n);
+  for (size_t i = 0; i < n; i++) {
+    const Slot& s = scratch[i];
+    int32_t column = int32_t(i % columns);
+    int32_t row = int32_t(i / columns);
+    int32_t x = args.x + args.padding + column * (cellW + args.gap);
+    int32_t y = args.y + args.padding + row * (cellH + args.gap);
+    targets[i] = Point{ x + alignIn(args.justify, cellW, s.w), y + alignIn(args.align, cellH, s.h) };
+  }
+}
+
+// 置く位置が変わった子だけを動かし、前後の範囲を再描画対象にする
+size_t LayoutEngine::moveChildren (VDS::PageData& page, bool markDirty) {
+  size_t moved = 0;
+  for (size_t i = 0; i < scratch.size(); i++) {
+    Slot& s = scratch[i];
+    int32_t dx = targets[i].x - s.x;
+    int32_t dy = targets[i].y - s.y;
+    if (dx == 0 && dy == 0) continue;
+
+    if (s.isInstance) {
+      for (auto& inst : page.instances) {
+        if (inst.objectNum != s.objectNum) continue;
+        inst.dx += dx;
+        inst.dy += dy;
+        break;
+      }
+    } else {
+      VDS::ObjectData* obj = vData->getObjectDataRef(&page, s.objectNum);
+      if (!obj) continue;
+      vData->translateArgs(obj->type, obj->objectArgs, dx, dy);
+      vData->updateBounds(*obj);
+    }
+
+    if (markDirty) {
+      vData->markDirty(VDS::Rect{ s.x, s.y, s.w, s.h });
+      vData->markDirty(VDS::Rect{ targets[i].x, targets[i].y, s.w, s.h });
+    }
+    s.x = targets[i].x;
+    s.y = targets[i].y;
+    moved++;
+  }
+  return moved;
+}
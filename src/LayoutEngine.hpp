@@ -0,0 +1,79 @@
+#pragma once
+#include <Arduino.h>
+#include <vector>
+#include "VisualDataSet.h"
+
+class VisualData;
+
+// コンテナ（FlexBox / TableBox）の子オブジェクトの配置
+//
+//   vt.vData.setFlexBoxObject("bar", 0, 200, 320, 40, VDS::BoxDirection::Row, 8, 4);
+//   vt.vData.setFillRectObject("ok", 0, 0, 80, 32, GREEN);
+//   vt.vData.setLayoutParent("ok", "bar");     // 座標はコンテナが決める
+//
+// 子の位置は外接矩形の左上を動かして決め、引数（インスタンスは dx / dy）に書き戻す。
+// コンテナごとに「コンテナの引数・子の並びと大きさ・置いた位置」を覚えておき、
+// どれかが変わったコンテナだけを並べ直す。動いた子は前後の範囲を再描画対象にし、
+// pageRevision を進めて判定用の命令列も作り直させる（動かない子・他のコンテナには触れない）。
+// 呼び出しは SceneTree が親から順に行うので、親が動かしたコンテナの中身も同じ更新で追従する。
+// コンテナの大きさは引数の w / h で固定（子の大きさで伸び縮みはしない）。
+class LayoutEngine {
+public:
+  using VDS = VisualDataSet;
+
+  VisualData* vData;
+
+  LayoutEngine(VisualData* vData = nullptr);
+
+  static bool isContainerType(VDS::DrawType type);
+
+  // page の更新 1 回分を beginPass() と endPass() で挟み、その間にコンテナごとに updateBox() を呼ぶ
+  // markDirty が false のときは再描画範囲を積まない（ページ全体を描き直す直前など）
+  void beginPass(const VDS::PageData& page);
+  size_t updateBox(VDS::PageData& page, size_t index, bool markDirty);   // 動かした子の数
+  void endPass(const VDS::PageData& page);   // 見つからなかったコンテナの配置を捨てる
+  void clear();                         // 覚えている配置を捨てる（次の更新ですべて並べ直す）
+
+  size_t getLastRelaidCount() const;    // 直前の更新で並べ直したコンテナの数
+  size_t getLastMovedCount() const;     // 直前の更新で動かした子の数
+  size_t getBytes() const;
+
+private:
+  // 子 1 つ分の大きさと置いた位置（外接矩形の左上）
+  struct Slot {
+    int objectNum = -1;
+    bool isInstance = false;
+    int32_t w = 0;
+    int32_t h = 0;
+    int32_t x = 0;
+    int32_t y = 0;
+  };
+
+  struct Box {
+    int pageNum = -1;
+    int objectNum = -1;
+    VDS::DrawType type = VDS::DrawType::FlexBox;
+    VDS::BoxArgs args;
+    std::vector<Slot> slots;
+    bool isUsed = false;                // 直前の更新で見つかった
+  };
+
+  struct Point {
+    int32_t x = 0;
+    int32_t y = 0;
+  };
+
+  std::vector<Box> boxes;
+  std::vector<Slot> scratch;            // 子の並びと今の位置（作業用）
+  std::vector<Point> targets;           // scratch の各子を置く位置（作業用）
+  size_t lastRelaid = 0;
+  size_t lastMoved = 0;
+
+  Box& findBox(int pageNum, int objectNum);
+  void collectChildren(const VDS::PageData& page, int containerNum);
+  bool isClean(const Box& box, VDS::DrawType type, const VDS::BoxArgs& args) const;
+  void placeFlex(const VDS::BoxArgs& args);
+  void placeTable(const VDS::BoxArgs& args);
+  size_t moveChildren(VDS::PageData& page, bool markDirty);
+  static int32_t alignIn(VDS::BoxAlign align, int32_t space, int32_t size);
+};
@@ -0,0 +1,196 @@
+#include "MemoryReport.hpp"
+#include "PageCache.hpp"
+#include "RenderPipeline.hpp"
+#include "TileRenderer.hpp"
+
+#if defined(ESP_PLATFORM)
+#if __has_include(<esp_memory_utils.h>)
+#include <esp_memory_utils.h>
+#else
+#include <soc/soc_memory_layout.h>
+#endif
+#endif
+
+using VDS = VisualDataSet;
+using TDS = TouchDataSet;
+
+MemoryReport::MemoryReport (VisualData* vData, TouchData* tData, PageCache* pageCache,
+                            RenderPipeline* pipeline, TileRenderer* tileRenderer)
+  : vData(vData), tData(tData), pageCache(pageCache), pipeline(pipeline), tileRenderer(tileRenderer) {}
+
+// スプライトのバッファ（実機はアドレスから PSRAM かどうかを判定）
+size_t MemoryReport::spriteBytes (const LGFX_Sprite& sprite, bool& inPsram) {
+  const void* buffer = sprite.getBuffer();
+  inPsram = false;
+  if (!buffer) return 0;
+#if defined(ESP_PLATFORM)
+  inPsram = esp_ptr_external_ram(buffer);
+#else
+  inPsram = sprite.getPsram();
+#endif
+  return sprite.bufferLength();
+}
+
+size_t MemoryReport::stringBytes (const String& s) {
+  return s.length() ? s.length() + 1 : 0;
+}
+
+size_t MemoryReport::visualPageBytes (const VDS::PageData& page, size_t& names) {
+  names += stringBytes(page.pageName);
+  for (const auto& obj : page.objects)    names += stringBytes(obj.objectName);
+  for (const auto& inst : page.instances) names += stringBytes(inst.objectName);
+  return page.objects.capacity() * sizeof(VDS::ObjectData)
+       + page.instances.capacity() * sizeof(VDS::InstanceData);
+}
+
+size_t MemoryReport::touchPageBytes (const TDS::PageData& page, size_t& names) {
+  for (const auto& proc : page.processes) names += stringBytes(proc.processName);
+  return page.processes.capacity() * sizeof(TDS::ProcessData);
+}
+
+const MemoryStats& MemoryReport::sample () {
+  MemoryStats s;
+  bool inPsram = false;
+
+  // -------------------- スプライト --------------------
+  size_t bytes = spriteBytes(tData->judgeSprite, inPsram);
+  s.judgeSprite.add(bytes, inPsram);
+  bytes = spriteBytes(vData->clipSprite, inPsram);
+  s.clipSprite.add(bytes, inPsram);
+
+  // -------------------- ページ --------------------
+  const VDS& vds = vData->visualDataSet;
+  const TDS& tds = tData->touchDataSet;
+  s.pages.reserve(vds.pages.size());
+  size_t totalNames = 0;
+
+  for (const auto& vPage : vds.pages) {
+    MemoryStats::PageUsage usage;
+    usage.pageNum = vPage.pageNum;
+    usage.pageName = vPage.pageName;
+    usage.objects = sizeof(VDS::PageData) + visualPageBytes(vPage, usage.names);
+    for (const auto& tPage : tds.pages) {
+      if (tPage.pageNum != vPage.pageNum) continue;
+      usage.processes = sizeof(TDS::PageData) + touchPageBytes(tPage, usage.names);
+      break;
+    }
+    s.objects.add(usage.objects);
+    s.processes.add(usage.processes);
+    totalNames += usage.names;
+    s.pages.push_back(usage);
+  }
+  s.objects.add(vds.pages.capacity() * sizeof(VDS::PageData) - vds.pages.size() * sizeof(VDS::PageData));
+  s.processes.add(tds.pages.capacity() * sizeof(TDS::PageData) - tds.pages.size() * sizeof(TDS::PageData));
+  s.names.add(totalNames);
+
+  // -------------------- 判定色テーブル --------------------
+  bytes = tds.ocPages.capacity() * sizeof(TDS::ocPageData);
+  for (const auto& oc : tds.ocPages) bytes += oc.objectColors.capacity() * sizeof(TDS::objectColor);
+  s.colorTables.add(bytes);
+
+  // -------------------- 作業用コピー --------------------
+  size_t copyNames = 0;
+  bytes  = visualPageBytes(vData->editingPage, copyNames);
+  bytes += visualPageBytes(vData->currentPageCopy, copyNames);
+  bytes += touchPageBytes(tData->editingPage, copyNames);
+  bytes += touchPageBytes(tData->currentPageProcess, copyNames);
+  s.workingCopies.add(bytes + copyNames);
+
+  // -------------------- テンプレート・値連動 --------------------
+  bytes = vds.templates.capacity() * sizeof(VDS::TemplateData);
+  for (const auto& tmpl : vds.templates) bytes += stringBytes(tmpl.templateName);
+  bytes += vds.bindings.capacity() * sizeof(VDS::BindingData);
+  s.templates.add(bytes);
+
+  // -------------------- キャッシュ・作業領域 --------------------
+  bytes  = (vData->dirtyRects.capacity() + vData->flushedRects.capacity()) * sizeof(VDS::Rect);
+  bytes += tData->enabledProcess.capacity() * sizeof(int);
+  bytes += tData->currentProcessNameVector.capacity() * sizeof(String);
+  for (const auto& name : tData->currentProcessNameVector) bytes += stringBytes(name);
+  if (pageCache) bytes += pageCache->entries.capacity() * sizeof(PageCache::Entry);
+  bytes += vData->layout.getBytes() + vData->tree.getBytes();
+  // 命令列（任せる要素の ObjectArgs はページの写しと重複して持つ）と Clip のマスク
+  bytes += vData->displayList.getCodeBytes() + tData->judgeList.getCodeBytes();
+  bytes += vData->clipMasks.getBytes();
+  if (tileRenderer) bytes += tileRenderer->getBytes();
+  s.caches.add(bytes);
+
+  // 描画経路のスプライト（begin() していなければ 0）
+  if (pipeline) {
+    for (const auto& sprite : pipeline->sprites) {
+      bytes = spriteBytes(sprite, inPsram);
+      s.caches.add(bytes, inPsram);
+    }
+  }
+  if (tileRenderer) {
+    for (const auto& tile : tileRenderer->tiles) {
+      bytes = spriteBytes(tile, inPsram);
+      s.caches.add(bytes, inPsram);
+    }
+  }
+
+  s.logRing.add(VT_LOG_RING_SIZE);
+
+  // -------------------- システム --------------------
+#if defined(ESP_PLATFORM)
+  s.freeHeap     = ESP.getFreeHeap();
+  s.minFreeHeap  = ESP.getMinFreeHeap();
+  s.freePsram    = ESP.getFreePsram();
+  s.minFreePsram = ESP.getMinFreePsram();
+#endif
+
+  s.sumTotal();
+  peak.keepMax(s);
+  last = std::move(s);
+  return last;
+}
+
+const MemoryStats& MemoryReport::getLast () const {
+  return last;
+}
+
+const MemoryStats& MemoryReport::getPeak () const {
+  return peak;
+}
+
+void MemoryReport::resetPeak () {
+  peak = MemoryStats();
+}
+
+namespace {
+  void printUsage(const char* name, const MemoryStats::Usage& now, const MemoryStats::Usage& max) {
+    Serial.printf("  %-14s heap %8u  psram %8u  (peak %8u / %8u)\n", name,
+                  unsigned(now.heap), unsigned(now.psram), unsigned(max.heap), unsigned(max.psram));
+  }
+}
+
+void MemoryReport::print (bool withPages) {
+  const MemoryStats& s = sample();
+  const MemoryStats& p = peak;
+
+  Serial.printf("[Memory] bytes\n");
+  printUsage("judgeSprite",   s.judgeSprite,   p.judgeSprite);
+  printUsage("clipSprite",    s.clipSprite,    p.clipSprite);
+  printUsage("objects",       s.objects,       p.objects);
+  printUsage("processes",     s.processes,     p.processes);
+  printUsage("names",         s.names,         p.names);
+  printUsage("colorTables",   s.colorTables,   p.colorTables);
+  printUsage("workingCopies", s.workingCopies, p.workingCopies);
+  printUsage("templates",     s.templates,     p.templates);
+  printUsage("caches",        s.caches,        p.caches);
+  printUsage("logRing",       s.logRing,       p.logRing);
+  printUsage("total",         s.total,         p.total);
+
+  if (withPages) {
+    for (const auto& page : s.pages) {
+      Serial.printf("  page %3d %-16s objects %7u  processes %7u  names %6u\n",
+                    page.pageNum, page.pageName.c_str(),
+                    unsigned(page.objects), unsigned(page.processes), unsigned(page.names));
+    }
+  }
+
+#if defined(ESP_PLATFORM)
+  Serial.printf("  system heap free %u (min %u) / psram free %u (min %u)\n",
+                unsigned(s.freeHeap), unsigned(s.minFreeHeap), unsigned(s.freePsram), unsigned(s.minFreePsram));
+#endif
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include "VisualData.hpp"
+#include "TouchData.hpp"
+#include "MemoryStats.h"
+
+class PageCache;
+class RenderPipeline;
+class TileRenderer;
+
+// VisualData / TouchData / PageCache と描画経路（RenderPipeline / TileRenderer）の使用メモリを集計し、最大値を記録する
+class MemoryReport {
+public:
+  using VDS = VisualDataSet;
+  using TDS = TouchDataSet;
+
+  VisualData* vData;
+  TouchData* tData;
+  PageCache* pageCache;
+  RenderPipeline* pipeline;
+  TileRenderer* tileRenderer;
+
+  MemoryReport(VisualData* vData, TouchData* tData, PageCache* pageCache,
+               RenderPipeline* pipeline = nullptr, TileRenderer* tileRenderer = nullptr);
+
+  // 現在の使用量を集計し、最大値も更新する
+  const MemoryStats& sample();
+  const MemoryStats& getLast() const;
+  const MemoryStats& getPeak() const;
+  void resetPeak();
+
+  // sample() した結果を Serial に表形式で出力
+  void print(bool withPages = true);
+
+  static size_t spriteBytes(const LGFX_Sprite& sprite, bool& inPsram);
+  static size_t stringBytes(const String& s);
+  static size_t visualPageBytes(const VDS::PageData& page, size_t& names);
+  static size_t touchPageBytes(const TDS::PageData& page, size_t& names);
+
+private:
+  MemoryStats last;
+  MemoryStats peak;
+};
@@ -0,0 +1,79 @@
+#pragma once
+#include <Arduino.h>
+#include <vector>
+
+// コンポーネントごとのメモリ使用量（バイト）
+// スプライト以外は要素数ではなく確保済み容量（capacity）と文字列長からの概算
+struct MemoryStats {
+  struct Usage {
+    size_t heap = 0;    // 内蔵 RAM
+    size_t psram = 0;   // 外部 PSRAM
+
+    size_t total() const {
+      return heap + psram;
+    }
+    void add(size_t bytes, bool inPsram = false) {
+      (inPsram ? psram : heap) += bytes;
+    }
+    void add(const Usage& other) {
+      heap += other.heap;
+      psram += other.psram;
+    }
+    void keepMax(const Usage& other) {
+      if (other.heap > heap)   heap = other.heap;
+      if (other.psram > psram) psram = other.psram;
+    }
+  };
+
+  // ページごとの内訳
+  struct PageUsage {
+    int pageNum = -1;
+    String pageName = "";
+    size_t objects = 0;     // ObjectData / InstanceData
+    size_t processes = 0;   // ProcessData
+    size_t names = 0;       // ページ名・オブジェクト名・プロセス名
+  };
+
+  Usage judgeSprite;     // TouchData::judgeSprite
+  Usage clipSprite;      // VisualData::clipSprite
+  Usage objects;         // 全ページのオブジェクト・インスタンス
+  Usage processes;       // 全ページのプロセス
+  Usage names;           // 名前文字列
+  Usage colorTables;     // ocPages
+  Usage workingCopies;   // 編集中・描画中・判定中のページのコピー
+  Usage templates;       // テンプレートと値連動
+  Usage caches;          // ページキャッシュの目録・再描画範囲・判定作業領域・命令列・Clip マスク・描画経路のスプライトとタイル
+  Usage logRing;         // VT_LOG_RING_SIZE
+  Usage total;
+
+  std::vector<PageUsage> pages;
+
+  // システム全体（実機のみ。ホストでは 0）
+  size_t freeHeap = 0;
+  size_t minFreeHeap = 0;    // 起動からの最小値
+  size_t freePsram = 0;
+  size_t minFreePsram = 0;
+
+  // total と各項目を合計し直す
+  void sumTotal() {
+    total = Usage();
+    const Usage* parts[] = { &judgeSprite, &clipSprite, &objects, &processes, &names,
+                             &colorTables, &workingCopies, &templates, &caches, &logRing };
+    for (const Usage* part : parts) total.add(*part);
+  }
+
+  // 項目ごとの最大値を残す（ページ内訳は対象外）
+  void keepMax(const MemoryStats& other) {
+    judgeSprite.keepMax(other.judgeSprite);
+    clipSprite.keepMax(other.clipSprite);
+    objects.keepMax(other.objects);
+    processes.keepMax(other.processes);
+    names.keepMax(other.names);
+    colorTables.keepMax(other.colorTables);
+    workingCopies.keepMax(other.workingCopies);
+    templates.keepMax(other.templates);
+    caches.keepMax(other.caches);
+    logRing.keepMax(other.logRing);
+    total.keepMax(other.total);
+  }
+};
@@ -0,0 +1,25 @@
+#pragma once
+#include <Arduino.h>
+
+// FramePacer の稼働状況（時間はすべて us）
+struct PacingStats {
+  uint32_t frames = 0;          // パネルへ転送したフレーム数
+  uint32_t fullFrames = 0;      // うち画面全体を転送したフレーム数
+  uint32_t idleTicks = 0;       // フレームの時刻になったが変化がなく、描画も転送もしなかった回数
+  uint32_t lateFrames = 0;      // 1 フレーム以上遅れ、次の時刻を今から数え直した回数
+  uint64_t pushedPixels = 0;    // 転送した画素数の累計
+  uint64_t renderUs = 0;        // 反映 + ラスタライズの累計
+  uint64_t pushUs = 0;          // 転送の累計
+  uint64_t sleepUs = 0;         // wait() で CPU を返した時間の累計
+  uint32_t lastFrameUs = 0;     // 直前のフレームの描画 + 転送
+  uint32_t maxFrameUs = 0;
+  uint32_t lastIntervalUs = 0;  // 続けて転送したフレームの間隔（間に変化のない時刻を挟んだら数えない）
+  uint32_t maxIntervalUs = 0;
+
+  float avgFrameUs() const {
+    return frames ? float(renderUs + pushUs) / frames : 0.0f;
+  }
+  float avgPushedPixels() const {
+    return frames ? float(pushedPixels) / frames : 0.0f;
+  }
+};
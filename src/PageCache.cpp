@@ -0,0 +1,237 @@
+#include "PageCache.hpp"
+using VDS = VisualDataSet;
+using TDS = TouchDataSet;
+
+// コンストラクタ
+PageCache::PageCache (VisualData* vData, TouchData* tData, UiBlobLoader* loader, bool enableErrorLog, bool enableInfoLog, bool enableSuccessLog){
+  this->vData = vData;
+  this->tData = tData;
+  this->loader = loader;
+  debugLog.setDebug(enableErrorLog, enableInfoLog, enableSuccessLog);
+}
+
+
+// ページ目録を作る（展開は require() まで遅延）
+bool PageCache::attach (const uint8_t* blob, size_t size, size_t budgetBytes) {
+  if (!loader || !loader->validate(blob, size)) return false;
+
+  detach();
+  this->blob = blob;
+  this->blobSize = size;
+  this->budgetBytes = budgetBytes;
+
+  const auto& h = *reinterpret_cast<const UiBlob::Header*>(blob);
+  const auto* pages = reinterpret_cast<const UiBlob::PageRecord*>(blob + h.pageTableOffset);
+
+  entries.reserve(h.pageCount);
+  for (uint16_t i = 0; i < h.pageCount; i++) {
+    Entry e;
+    e.pageNum = pages[i].pageNum;
+    e.pageName = UiBlobLoader::stringAt(blob, pages[i].nameOffset);
+    e.recordIndex = i;
+    entries.push_back(e);
+
+    // addPage() の自動採番と衝突しないようにする
+    if (e.pageNum > vData->lastAssignedPageNum) vData->lastAssignedPageNum = e.pageNum;
+  }
+
+  vData->pageCache = this;
+  tData->pageCache = this;
+
+  VT_LOG_SUCCESS(debugLog, "PageCache attached. pages=%u budget=%u", unsigned(h.pageCount), unsigned(budgetBytes));
+  return true;
+}
+
+// 目録を外す（展開済みのページは visualDataSet に残る）
+void PageCache::detach () {
+  entries.clear();
+  blob = nullptr;
+  blobSize = 0;
+  residentBytes = 0;
+  if (vData && vData->pageCache == this) vData->pageCache = nullptr;
+  if (tData && tData->pageCache == this) tData->pageCache = nullptr;
+}
+
+bool PageCache::isAttached () const {
+  return blob != nullptr;
+}
+
+void PageCache::setBudget (size_t bytes) {
+  budgetBytes = bytes;
+  evictToBudget();
+}
+
+// 固定したページは予算を超えても破棄しない
+bool PageCache::pinPage (int pageNum, bool pinned) {
+  Entry* e = findEntry(pageNum);
+  if (!e) return false;
+  e->isPinned = pinned;
+  if (!pinned) evictToBudget();
+  return true;
+}
+
+
+PageCache::Entry* PageCache::findEntry (int pageNum) {
+  for (auto& e : entries) {
+    if (e.pageNum == pageNum) return &e;
+  }
+  return nullptr;
+}
+const PageCache::Entry* PageCache::findEntry (int pageNum) const {
+  for (const auto& e : entries) {
+    if (e.pageNum == pageNum) return &e;
+  }
+  return nullptr;
+}
+
+bool PageCache::hasPage (int pageNum) const {
+  return findEntry(pageNum) != nullptr;
+}
+
+bool PageCache::hasPageName (const String& name) const {
+  return getPageNumByName(name) >= 0;
+}
+
+int PageCache::getPageNumByName (const String& name) const {
+  for (const auto& e : entries) {
+    if (e.pageName && name == e.pageName) return e.pageNum;
+  }
+  return -1;
+}
+
+
+// 展開済みでなければブロブから展開し、予算を超えた分を破棄する
+bool PageCache::require (int pageNum) {
+  Entry* e = findEntry(pageNum);
+  if (!e) return false;
+
+  e->lastUse = ++useCounter;
+  if (e->isResident) return true;
+
+  const auto& h = *reinterpret_cast<const UiBlob::Header*>(blob);
+  const auto& rec = reinterpret_cast<const UiBlob::PageRecord*>(blob + h.pageTableOffset)[e->recordIndex];
+
+  vData->visualDataSet.pages.emplace_back();
+  tData->touchDataSet.pages.emplace_back();
+  tData->touchDataSet.ocPages.emplace_back();
+  loader->decodePage(blob, rec,
+                     vData->visualDataSet.pages.back(),
+                     tData->touchDataSet.pages.back(),
+                     tData->touchDataSet.ocPages.back());
+
+  for (const auto& proc : tData->touchDataSet.pages.back().processes) {
+    if (proc.processNum > tData->lastAssignedProcessNum) tData->lastAssignedProcessNum = proc.processNum;
+  }
+
+  e->isResident = true;
+  e->bytes = estimatePageBytes(pageNum);
+  residentBytes += e->bytes;
+
+  VT_LOG_INFO(debugLog, "PageCache: loaded [%s] %u bytes.", e->pageName, unsigned(e->bytes));
+
+  evictToBudget(pageNum);
+  return true;
+}
+
+// 描画中・編集中・判定中のページは破棄できない
+bool PageCache::isProtected (const Entry& entry) const {
+  return entry.isPinned
+      || vData->currentPageCopy.pageNum == entry.pageNum
+      || vData->editingPage.pageNum == entry.pageNum
+      || tData->editingPage.pageNum == entry.pageNum
+      || tData->currentPageProcess.pageNum == entry.pageNum;
+}
+
+bool PageCache::evictPage (int pageNum) {
+  Entry* e = findEntry(pageNum);
+  if (!e || !e->isResident || isProtected(*e)) return false;
+
+  auto& vPages = vData->visualDataSet.pages;
+  vPages.erase(std::remove_if(vPages.begin(), vPages.end(),
+               [pageNum](const VDS::PageData& p) { return p.pageNum == pageNum; }), vPages.end());
+
+  auto& tPages = tData->touchDataSet.pages;
+  tPages.erase(std::remove_if(tPages.begin(), tPages.end(),
+               [pageNum](const TDS::PageData& p) { return p.pageNum == pageNum; }), tPages.end());
+
+  auto& ocPages = tData->touchDataSet.ocPages;
+  ocPages.erase(std::remove_if(ocPages.begin(), ocPages.end(),
+                [pageNum](const TDS::ocPageData& p) { return p.pageNum == pageNum; }), ocPages.end());
+  tData->colorRevision++;
+
+  residentBytes -= e->bytes;
+  e->bytes = 0;
+  e->isResident = false;
+
+  VT_LOG_INFO(debugLog, "PageCache: evicted [%s].", e->pageName);
+  return true;
+}
+
+// 目録からページを外す（deletePage 用。展開済みのデータは呼び出し側で削除する）
+bool PageCache::forgetPage (int pageNum) {
+  for (auto it = entries.begin(); it != entries.end(); ++it) {
+    if (it->pageNum == pageNum) {
+      residentBytes -= it->bytes;
+      entries.erase(it);
+      return true;
+    }
+  }
+  return false;
+}
+
+// 最後に使われたのが古いページから順に、予算内に収まるまで破棄する
+void PageCache::evictToBudget (int keepPageNum) {
+  if (budgetBytes == 0) return;
+
+  while (residentBytes > budgetBytes) {
+    Entry* victim = nullptr;
+    for (auto& e : entries) {
+      if (!e.isResident || e.pageNum == keepPageNum || isProtected(e)) continue;
+      if (!victim || e.lastUse < victim->lastUse) victim = &e;
+    }
+    if (!victim) {
+      VT_LOG_INFO(debugLog, "PageCache: over budget, but every resident page is in use or pinned.");
+      return;
+    }
+    evictPage(victim->pageNum);
+  }
+}
+
+size_t PageCache::getResidentBytes () const {
+  return residentBytes;
+}
+
+size_t PageCache::getResidentCount () const {
+  size_t count = 0;
+  for (const auto& e : entries) {
+    if (e.isResident) count++;
+  }
+  return count;
+}
+
+// 展開したページが占める RAM の推定値（ベクタ容量と名前文字列を含む）
+size_t PageCache::estimatePageBytes (int pageNum) const {
+  size_t bytes = 0;
+
+  const VDS::PageData& vPage = vData->getPageData(pageNum);
+  if (!vPage.isEmpty()) {
+    bytes += sizeof(VDS::PageData) + vPage.pageName.length() + 1;
+    bytes += vPage.objects.capacity() * sizeof(VDS::ObjectData);
+    for (const auto& obj : vPage.objects) bytes += obj.objectName.length() + 1;
+    bytes += vPage.instances.capacity() * sizeof(VDS::InstanceData);
+    for (const auto& inst : vPage.instances) bytes += inst.objectName.length() + 1;
+  }
+
+  const TDS::PageData* tPage = tData->getPageData(pageNum);
+  if (tPage) {
+    bytes += sizeof(TDS::PageData) + tPage->processes.capacity() * sizeof(TDS::ProcessData);
+    for (const auto& proc : tPage->processes) bytes += proc.processName.length() + 1;
+  }
+
+  for (const auto& oc : tData->touchDataSet.ocPages) {
+    if (oc.pageNum == pageNum) {
+      bytes += sizeof(TDS::ocPageData) + oc.objectColors.capacity() * sizeof(TDS::objectColor);
+    }
+  }
+  return bytes;
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include "VisualData.hpp"
+#include "TouchData.hpp"
+#include "UiBlobLoader.hpp"
+
+// ページ定義をブロブ（フラッシュ等）に置いたまま、必要になったページだけを
+// visualDataSet / touchDataSet に展開するキャッシュ
+// 展開済みページの合計が予算を超えると、最後に使われた時刻が古い順に破棄する
+// 破棄したページは次に使うときブロブから展開し直すので、確定した編集も元に戻る
+// （描画中・編集中のページは破棄しない。編集を残したいページは pinPage() で固定する）
+class PageCache {
+public:
+  Debug debugLog;
+  using VDS = VisualDataSet;
+  using TDS = TouchDataSet;
+
+  struct Entry {
+    int pageNum = -1;
+    const char* pageName = nullptr;   // ブロブ内の文字列
+    uint16_t recordIndex = 0;         // PageRecord の位置
+    bool isResident = false;          // 展開済みか
+    bool isPinned = false;            // 予算超過でも破棄しない
+    uint32_t lastUse = 0;
+    size_t bytes = 0;                 // 展開時の推定使用量
+  };
+
+  VisualData* vData;
+  TouchData* tData;
+  UiBlobLoader* loader;
+
+  const uint8_t* blob = nullptr;
+  size_t blobSize = 0;
+  size_t budgetBytes = 0;             // 0 = 無制限
+  size_t residentBytes = 0;
+  uint32_t useCounter = 0;
+  std::vector<Entry> entries;
+
+  PageCache(VisualData* vData, TouchData* tData, UiBlobLoader* loader, bool enableErrorLog, bool enableInfoLog, bool enableSuccessLog);
+
+  // ページ目録だけを作成する（ページの中身はまだ展開しない）
+  bool attach(const uint8_t* blob, size_t size, size_t budgetBytes = 0);
+  void detach();
+  bool isAttached() const;
+
+  void setBudget(size_t bytes);
+  bool pinPage(int pageNum, bool pinned = true);
+
+  bool hasPage(int pageNum) const;
+  bool hasPageName(const String& name) const;
+  int getPageNumByName(const String& name) const;
+
+  // 指定ページを展開済みにする（既に展開済みなら使用時刻だけ更新）
+  bool require(int pageNum);
+  bool evictPage(int pageNum);
+  bool forgetPage(int pageNum);
+  void evictToBudget(int keepPageNum = -1);
+
+  size_t getResidentBytes() const;
+  size_t getResidentCount() const;
+
+  Entry* findEntry(int pageNum);
+  const Entry* findEntry(int pageNum) const;
+  bool isProtected(const Entry& entry) const;
+  size_t estimatePageBytes(int pageNum) const;
+};
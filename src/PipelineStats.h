@@ -0,0 +1,19 @@
+#pragma once
+#include <Arduino.h>
+
+// RenderPipeline の稼働状況（時間はすべて us の累計）
+struct PipelineStats {
+  uint32_t frames = 0;          // パネルへ転送したフレーム数
+  uint32_t idleFrames = 0;      // 描画コアが起きたが再描画範囲がなかった回数
+  uint32_t handoffs = 0;        // シーンをタッチ側から描画側へ渡した回数
+  uint64_t renderUs = 0;        // 描画側がシーンを持っていた時間（反映 + ラスタライズ）
+  uint64_t dmaWaitUs = 0;       // 前フレームの転送完了待ち
+  uint64_t sceneWaitUs = 0;     // タッチ側が描画側からシーンが戻るのを待った時間
+
+  float avgRenderUs() const {
+    return frames ? float(renderUs) / frames : 0.0f;
+  }
+  float avgDmaWaitUs() const {
+    return frames ? float(dmaWaitUs) / frames : 0.0f;
+  }
+};
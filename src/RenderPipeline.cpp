@@ -0,0 +1,214 @@
+#include "RenderPipeline.hpp"
+
+#include <chrono>
+#if defined(ESP_PLATFORM)
+#include <esp_timer.h>
+#include <esp_pthread.h>
+#endif
+
+RenderPipeline::RenderPipeline (VisualData* vData, TouchData* tData, SceneQueue* sceneQueue, Animator* animator, LovyanGFX* lcd, bool enableErrorLog, bool enableInfoLog, bool enableSuccessLog){
+  this->vData = vData;
+  this->tData = tData;
+  this->sceneQueue = sceneQueue;
+  this->animator = animator;
+  this->lcd = lcd;
+  debugLog.setDebug(enableErrorLog, enableInfoLog, enableSuccessLog);
+}
+
+RenderPipeline::~RenderPipeline () {
+  end();
+}
+
+uint32_t RenderPipeline::now () {
+#if defined(ESP_PLATFORM)
+  return uint32_t(esp_timer_get_time());
+#else
+  using Clock = std::chrono::steady_clock;
+  return uint32_t(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now().time_since_epoch()).count());
+#endif
+}
+
+// 画面サイズのスプライトを 2 枚確保し、描画スレッドを renderCore に立てる（ホストでは renderCore は無視）
+bool RenderPipeline::begin (const String& pageName, int renderCore, bool usePsram) {
+  if (isRunning()) {
+    VT_LOG_ERROR(debugLog, "RenderPipeline is already running.");
+    return false;
+  }
+
+  for (auto& sprite : sprites) {
+    sprite.setColorDepth(16);
+    sprite.setPsram(usePsram);
+    if (!sprite.createSprite(lcd->width(), lcd->height())) {
+      VT_LOG_ERROR(debugLog, "RenderPipeline: failed to allocate %dx%d sprites.", int(lcd->width()), int(lcd->height()));
+      for (auto& s : sprites) s.deleteSprite();
+      return false;
+    }
+  }
+
+  pendingPage = pageName;
+  staleRects.clear();
+  backIndex = 0;
+  dmaPending = false;
+  dmaWaitCarryUs = 0;
+  stats = PipelineStats();
+  owner.store(Owner::Touch);
+  renderWaiting.store(false);
+  running.store(true);
+
+#if defined(ESP_PLATFORM)
+  esp_pthread_cfg_t cfg = esp_pthread_get_default_config();
+  cfg.pin_to_core = renderCore;
+  cfg.stack_size = 8192;
+  cfg.thread_name = "vt_render";
+  esp_pthread_set_cfg(&cfg);
+  worker = std::thread(&RenderPipeline::renderLoop, this);
+  cfg = esp_pthread_get_default_config();
+  esp_pthread_set_cfg(&cfg);
+#else
+  (void)renderCore;
+  worker = std::thread(&RenderPipeline::renderLoop, this);
+#endif
+
+  VT_LOG_SUCCESS(debugLog, "RenderPipeline started on [%s].", pageName.c_str());
+  return true;
+}
+
+void RenderPipeline::end () {
+  if (!worker.joinable()) return;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    running.store(false);
+  }
+  ownerChanged.notify_all();
+  worker.join();
+
+  for (auto& sprite : sprites) sprite.deleteSprite();
+  owner.store(Owner::Touch);
+}
+
+bool RenderPipeline::isRunning () const {
+  return running.load();
+}
+
+// 所有権を渡して相手を起こす（ミューテックスは待ち合わせのためだけに使う）
+void RenderPipeline::handOver (Owner to) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    owner.store(to, std::memory_order_release);
+  }
+  ownerChanged.notify_all();
+}
+
+void RenderPipeline::waitFor (Owner who) {
+  if (owner.load(std::memory_order_acquire) == who) return;
+  std::unique_lock<std::mutex> lock(mutex);
+  ownerChanged.wait(lock, [this, who] { return owner.load(std::memory_order_acquire) == who || !running.load(); });
+}
+
+void RenderPipeline::waitScene () {
+  if (owner.load(std::memory_order_acquire) == Owner::Touch) return;
+  uint32_t t0 = now();
+  waitFor(Owner::Touch);
+  stats.sceneWaitUs += now() - t0;
+}
+
+bool RenderPipeline::update () {
+  waitScene();
+  bool judged = tData->update();
+
+  // 描画側が次のフレームを待っていればシーンを渡す（戻るまでタッチ側は vData / tData に触れない）
+  if (isRunning() && renderWaiting.load()) {
+    renderWaiting.store(false);
+    stats.handoffs++;
+    handOver(Owner::Render);
+  }
+  return judged;
+}
+
+// 次に描画側がシーンを持ったときに描き直す
+void RenderPipeline::showPage (const String& pageName) {
+  waitScene();
+  pendingPage = pageName;
+}
+
+PipelineStats RenderPipeline::getStats () {
+  waitScene();
+  return stats;
+}
+
+void RenderPipeline::renderLoop () {
+  uint32_t nextFrameUs = now();
+  while (running.load()) {
+    if (frameIntervalUs) {
+      int32_t wait = int32_t(nextFrameUs - now());
+      if (wait > 0) std::this_thread::sleep_for(std::chrono::microseconds(wait));
+      nextFrameUs += frameIntervalUs;
+      if (int32_t(now() - nextFrameUs) > int32_t(frameIntervalUs)) nextFrameUs = now();  // 大きく遅れたら追いかけない
+    }
+
+    renderWaiting.store(true);
+    waitFor(Owner::Render);
+    if (!running.load()) break;
+
+    LGFX_Sprite& back = sprites[backIndex];
+    bool drawn = renderFrame(back);
+    handOver(Owner::Touch);
+
+    // シーンを返してから転送する（タッチ側の判定と転送が重なる）
+    if (drawn) {
+      flush(back);
+      backIndex ^= 1;
+    }
+  }
+
+  if (dmaPending) {
+    lcd->waitDMA();
+    lcd->endWrite();
+    dmaPending = false;
+  }
+}
+
+// 裏のバッファへ描く。前のフレームで表にだけ描いた範囲も合わせて描き直す
+bool RenderPipeline::renderFrame (LGFX_Sprite &back) {
+  uint32_t t0 = now();
+  stats.dmaWaitUs += dmaWaitCarryUs;
+  dmaWaitCarryUs = 0;
+  sceneQueue->apply(back);
+  animator->update(back);
+  vData->updateBindings(back);
+
+  bool drawn = false;
+  if (pendingPage != "") {
+    drawn = vData->drawPage(back, pendingPage);
+    if (drawn) staleRects.assign(1, VDS::Rect{ 0, 0, back.width(), back.height() });
+    else       VT_LOG_ERROR(debugLog, "RenderPipeline: page [%s] not found.", pendingPage.c_str());
+    pendingPage = "";
+  } else if (!vData->dirtyRects.empty()) {
+    std::vector<VDS::Rect> fresh = vData->dirtyRects;
+    for (const auto& rect : staleRects) vData->markDirty(rect);
+    drawn = vData->redrawDirty(back);
+    staleRects.swap(fresh);
+  }
+
+  if (drawn) stats.frames++;
+  else       stats.idleFrames++;
+  stats.renderUs += now() - t0;
+  return drawn;
+}
+
+// 前のフレームの転送を待ってから DMA を開始する（完了は次のフレームで待つ）
+void RenderPipeline::flush (LGFX_Sprite &back) {
+  uint32_t t0 = now();
+  if (dmaPending) {
+    lcd->waitDMA();
+    lcd->endWrite();
+  }
+  uint32_t waited = now() - t0;
+
+  lcd->startWrite();
+  lcd->pushImageDMA(0, 0, back.width(), back.height(), static_cast<const lgfx::swap565_t*>(back.getBuffer()));
+  dmaPending = true;
+
+  // 統計はシーンと同じくタッチ側と共有しているので、次にシーンを持ったときに足す
+  dmaWaitCarryUs += waited;
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "VisualData.hpp"
+#include "TouchData.hpp"
+#include "SceneQueue.hpp"
+#include "Animator.hpp"
+#include "PipelineStats.h"
+
+// タッチ判定と描画を別コアで回すパイプライン
+//
+//   vt.pipeline.begin("page1");          // 描画コア（既定 0）にスレッドを立てる
+//   void loop() {
+//     M5.update();                       // タッチの取得は描画と並行に進む
+//     if (vt.pipeline.update()) handle(vt.tData.currentProcessName);
+//   }
+//
+// シーン（vData / tData が読む currentPageCopy など）はロックで守らず、所有権をタッチ側と
+// 描画側で受け渡す。描画側は次のフレームを描くときだけシーンを借り、SceneQueue の反映・
+// アニメーションとバインドの更新・ラスタライズを済ませたらすぐに返す。タッチ側はシーンを持っている間
+// （update() の中、waitScene() の後）だけ vData / tData / animator を直接触ってよい。
+// スプライトは 2 枚を交互に使い、一方を DMA で転送している間にもう一方へ次のフレームを描く。
+// DMA 転送中は LCD のトランザクションを開いたままにするため、同じ SPI バスの SD から
+// 画像を描くページでは使わないこと。
+class RenderPipeline {
+public:
+  Debug debugLog;
+  using VDS = VisualDataSet;
+
+  VisualData* vData;
+  TouchData* tData;
+  SceneQueue* sceneQueue;
+  Animator* animator;
+  LovyanGFX* lcd;
+
+  LGFX_Sprite sprites[2];
+  uint32_t frameIntervalUs = 16000;   // 描画コアがシーンを借りに行く間隔（0 で待たない）
+
+  RenderPipeline(VisualData* vData, TouchData* tData, SceneQueue* sceneQueue, Animator* animator, LovyanGFX* lcd, bool enableErrorLog, bool enableInfoLog, bool enableSuccessLog);
+  ~RenderPipeline();
+
+  bool begin(const String& pageName, int renderCore = 0, bool usePsram = true);
+  void end();
+  bool isRunning() const;
+
+  // タッチ側（loop() のスレッド）から呼ぶ
+  bool update();                      // シーンを受け取って tData.update()、描画側が待っていれば渡す
+  void waitScene();                   // 描画側が持っている間だけ待つ
+  void showPage(const String& pageName);
+  PipelineStats getStats();
+
+private:
+  enum class Owner : uint8_t { Touch, Render };
+
+  std::thread worker;
+  std::mutex mutex;                   // 待ち合わせ用（データは所有権で守る）
+  std::condition_variable ownerChanged;
+  std::atomic<Owner> owner{Owner::Touch};
+  std::atomic<bool> renderWaiting{false};
+  std::atomic<bool> running{false};
+
+  // シーンを持っている側だけが触る
+  String pendingPage = "";
+  PipelineStats stats;
+
+  // 描画スレッドだけが触る
+  std::vector<VDS::Rect> staleRects;  // 表のバッファにだけ描いた範囲（次に裏へ描くときに描き直す）
+  int backIndex = 0;
+  bool dmaPending = false;
+  uint64_t dmaWaitCarryUs = 0;
+
+  static uint32_t now();
+  void handOver(Owner to);
+  void waitFor(Owner who);
+  void renderLoop();
+  bool renderFrame(LGFX_Sprite &back);
+  void flush(LGFX_Sprite &back);
+};
@@ -0,0 +1,34 @@
+#pragma once
+#include "VisualDataSet.h"
+
+// 描画ループ以外のタスクから送る編集対象（SceneQueue::getHandle で描画側のスレッドで取得しておく）
+struct SceneHandle {
+  int pageNum = -1;
+  int objectNum = -1;
+
+  bool isValid() const {
+    return pageNum >= 0 && objectNum >= 0;
+  }
+};
+
+// SceneQueue に積む編集コマンド（String を持たないので別タスクでもヒープを触らずに作れる）
+struct SceneCommand {
+  using VDS = VisualDataSet;
+
+  enum class Kind : uint8_t {
+    SetArgs,      // 引数をまるごと置き換える（種類は変えない）
+    SetProperty,  // 1 項目だけ書き換える（項目はバインドと同じ）
+    Move,         // 相対移動
+    Hide,
+    Show,
+    Delete
+  };
+
+  Kind kind = Kind::SetArgs;
+  SceneHandle target;
+  VDS::BindProperty property = VDS::BindProperty::Color;
+  int32_t value = 0;            // SetProperty の値 / Move の dx
+  int32_t value2 = 0;           // Move の dy
+  const char* text = nullptr;   // BindProperty::Text の文字列（反映後も保持すること）
+  VDS::ObjectArgs args;         // SetArgs
+};
@@ -0,0 +1,269 @@
+#include "SceneQueue.hpp"
+#include "PageCache.hpp"
+
+SceneQueue::SceneQueue (VisualData* vData, bool enableErrorLog, bool enableInfoLog, bool enableSuccessLog){
+  this->vData = vData;
+  debugLog.setDebug(enableErrorLog, enableInfoLog, enableSuccessLog);
+  for (uint32_t i = 0; i < CAPACITY; i++) slots[i].sequence.store(i, std::memory_order_relaxed);
+  pending.reserve(CAPACITY);
+}
+
+SceneHandle SceneQueue::getHandle (const String& objectName, int pageNum) {
+  SceneHandle handle;
+  handle.pageNum = (pageNum < 0) ? vData->editingPage.pageNum : pageNum;
+  handle.objectNum = vData->getObjectNumByName(objectName, pageNum);
+  if (!handle.isValid()) {
+    VT_LOG_ERROR(debugLog, "[%s] does not exist.", objectName.c_str());
+    return SceneHandle();
+  }
+  return handle;
+}
+
+// 空きスロットを CAS で確保してから書き込み、連番を進めて公開する
+bool SceneQueue::push (const SceneCommand& command) {
+  if (!command.target.isValid()) return false;
+
+  uint32_t pos = enqueuePos.load(std::memory_order_relaxed);
+  Slot* slot;
+  while (true) {
+    slot = &slots[pos & (CAPACITY - 1)];
+    uint32_t seq = slot->sequence.load(std::memory_order_acquire);
+    int32_t diff = int32_t(seq - pos);
+    if (diff == 0) {
+      if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+    } else if (diff < 0) {
+      // 描画ループが追いついていない（待たずに破棄）
+      dropped.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    } else {
+      pos = enqueuePos.load(std::memory_order_relaxed);
+    }
+  }
+
+  slot->command = command;
+  slot->sequence.store(pos + 1, std::memory_order_release);
+  return true;
+}
+
+bool SceneQueue::setArgs (SceneHandle target, const VDS::ObjectArgs& args) {
+  SceneCommand command;
+  command.kind = SceneCommand::Kind::SetArgs;
+  command.target = target;
+  command.args = args;
+  return push(command);
+}
+
+bool SceneQueue::setProperty (SceneHandle target, VDS::BindProperty property, int32_t value) {
+  SceneCommand command;
+  command.kind = SceneCommand::Kind::SetProperty;
+  command.target = target;
+  command.property = property;
+  command.value = value;
+  return push(command);
+}
+
+bool SceneQueue::setText (SceneHandle target, const char* text) {
+  SceneCommand command;
+  command.kind = SceneCommand::Kind::SetProperty;
+  command.target = target;
+  command.property = VDS::BindProperty::Text;
+  command.text = text;
+  return push(command);
+}
+
+bool SceneQueue::move (SceneHandle target, int32_t dx, int32_t dy) {
+  SceneCommand command;
+  command.kind = SceneCommand::Kind::Move;
+  command.target = target;
+  command.value = dx;
+  command.value2 = dy;
+  return push(command);
+}
+
+bool SceneQueue::hide (SceneHandle target) {
+  SceneCommand command;
+  command.kind = SceneCommand::Kind::Hide;
+  command.target = target;
+  return push(command);
+}
+
+bool SceneQueue::show (SceneHandle target) {
+  SceneCommand command;
+  command.kind = SceneCommand::Kind::Show;
+  command.target = target;
+  return push(command);
+}
+
+bool SceneQueue::remove (SceneHandle target) {
+  SceneCommand command;
+  command.kind = SceneCommand::Kind::Delete;
+  command.target = target;
+  return push(command);
+}
+
+uint32_t SceneQueue::getDropped () const {
+  return dropped.load(std::memory_order_relaxed);
+}
+
+bool SceneQueue::isEmpty () const {
+  return enqueuePos.load(std::memory_order_acquire) == dequeuePos;
+}
+
+// 書き込み途中のスロットに当たったら、そこから先は次のフレームに回す
+bool SceneQueue::pop (SceneCommand& command) {
+  Slot& slot = slots[dequeuePos & (CAPACITY - 1)];
+  uint32_t seq = slot.sequence.load(std::memory_order_acquire);
+  if (int32_t(seq - (dequeuePos + 1)) < 0) return false;
+
+  command = slot.command;
+  slot.sequence.store(dequeuePos + CAPACITY, std::memory_order_release);
+  dequeuePos++;
+  return true;
+}
+
+// 同じオブジェクトへの編集を 1 つにまとめる（後から来たものが優先）
+void SceneQueue::coalesce (const SceneCommand& command) {
+  Pending* p = nullptr;
+  for (auto& entry : pending) {
+    if (entry.target.pageNum == command.target.pageNum && entry.target.objectNum == command.target.objectNum) {
+      p = &entry;
+      break;
+    }
+  }
+  if (!p) {
+    pending.emplace_back();
+    p = &pending.back();
+    p->target = command.target;
+  }
+  if (p->isDeleted) return;
+
+  switch (command.kind) {
+    case SceneCommand::Kind::SetArgs:
+      // 引数を置き換えるとそれまでの項目の変更・移動は意味がなくなる
+      p->hasArgs = true;
+      p->args = command.args;
+      p->propertyMask = 0;
+      p->dx = p->dy = 0;
+      break;
+
+    case SceneCommand::Kind::SetProperty: {
+      size_t index = size_t(command.property);
+      if (index >= PROPERTY_COUNT) break;
+      p->propertyMask |= uint16_t(1u << index);
+      p->values[index] = command.value;
+      if (command.property == VDS::BindProperty::Text) p->text = command.text;
+      // 位置の指定はそれ以前の移動を上書きする
+      if (command.property == VDS::BindProperty::X) p->dx = 0;
+      if (command.property == VDS::BindProperty::Y) p->dy = 0;
+      break;
+    }
+
+    case SceneCommand::Kind::Move:
+      p->dx += command.value;
+      p->dy += command.value2;
+      break;
+
+    case SceneCommand::Kind::Hide: p->visible = 0; break;
+    case SceneCommand::Kind::Show: p->visible = 1; break;
+
+    case SceneCommand::Kind::Delete:
+      p->isDeleted = true;
+      break;
+  }
+}
+
+// 引数 → 項目 → 移動 → 表示の順に反映
+// 親を持つ子は動いた分だけ相対位置もずらす（表示中でないページでも、次に描くとき同じ位置に置かれる）
+void SceneQueue::modify (VDS::ObjectData& obj, const Pending& p) const {
+  int32_t x0 = 0, y0 = 0;
+  bool hasOrigin = obj.parentNum >= 0 && vData->getArgsOrigin(obj.type, obj.objectArgs, x0, y0);
+  if (p.hasArgs) obj.objectArgs = p.args;
+  for (size_t i = 0; i < PROPERTY_COUNT; i++) {
+    if (!(p.propertyMask & (1u << i))) continue;
+    vData->applyProperty(obj.type, obj.objectArgs, VDS::BindProperty(i), p.values[i], p.text);
+  }
+  if (p.dx || p.dy) vData->translateArgs(obj.type, obj.objectArgs, p.dx, p.dy);
+  if (p.visible >= 0) obj.isHidden = (p.visible == 0);
+  int32_t x1, y1;
+  if (hasOrigin && vData->getArgsOrigin(obj.type, obj.objectArgs, x1, y1)) {
+    obj.localX += x1 - x0;
+    obj.localY += y1 - y0;
+  }
+  vData->updateBounds(obj);
+}
+
+bool SceneQueue::applyToPage (VDS::PageData& page, const Pending& p) {
+  auto& objs = page.objects;
+  for (size_t i = 0; i < objs.size(); i++) {
+    if (objs[i].objectNum != p.target.objectNum) continue;
+    if (p.isDeleted) objs.erase(objs.begin() + i);
+    else             modify(objs[i], p);
+    return true;
+  }
+  return false;
+}
+
+// 表示中のページは変化前後の範囲を再描画対象にする
+bool SceneQueue::applyToDisplay (LGFX_Sprite &sprite, const Pending& p) {
+  VDS::ObjectData* obj = vData->getObjectDataRef(&vData->currentPageCopy, p.target.objectNum);
+  if (!obj) return false;
+
+  VDS::Rect before, after;
+  bool hasBefore = obj->isHidden || vData->getObjectBounds(sprite, *obj, before);
+  if (p.isDeleted) {
+    applyToPage(vData->currentPageCopy, p);
+  } else {
+    modify(*obj, p);
+  }
+  bool hasAfter = p.isDeleted || obj->isHidden || vData->getObjectBounds(sprite, *obj, after);
+  vData->pageRevision++;
+
+  if (hasBefore && hasAfter) {
+    vData->markDirty(before);
+    vData->markDirty(after);
+  } else {
+    vData->markDirty(VDS::Rect{ 0, 0, sprite.width(), sprite.height() });
+  }
+  return true;
+}
+
+// キューを空にしてまとめた編集を反映する（追い越されないよう最大 CAPACITY 件まで）
+int SceneQueue::apply (LGFX_Sprite &sprite) {
+  pending.clear();
+  SceneCommand command;
+  for (uint32_t n = 0; n < CAPACITY && pop(command); n++) coalesce(command);
+  if (pending.empty()) return 0;
+
+  int changed = 0;
+  for (const auto& p : pending) {
+    int pageNum = p.target.pageNum;
+    bool found = false;
+
+    // 未展開のページは展開してから編集する
+    if (vData->pageCache) vData->pageCache->require(pageNum);
+    VDS::PageData* stored = vData->getPageDataRef(pageNum);
+    if (stored && applyToPage(*stored, p)) {
+      found = true;
+      vData->dataRevision++;   // 保存済みページを変えたので、次の drawPage() で命令列を作り直す
+    }
+    if (vData->editingPage.pageNum == pageNum) found |= applyToPage(vData->editingPage, p);
+    if (vData->currentPageCopy.pageNum == pageNum) found |= applyToDisplay(sprite, p);
+
+    if (!found) {
+      VT_LOG_ERROR(debugLog, "[SceneQueue] object %d on page %d does not exist.", p.target.objectNum, pageNum);
+      continue;
+    }
+    if (p.isDeleted) {
+      auto& bindings = vData->visualDataSet.bindings;
+      bindings.erase(std::remove_if(bindings.begin(), bindings.end(),
+                     [&p](const VDS::BindingData& b) { return b.pageNum == p.target.pageNum && b.objectNum == p.target.objectNum; }),
+                     bindings.end());
+    }
+    changed++;
+  }
+
+  // 動いた親の子・動いた・大きさの変わった子のコンテナを追従させる（変わらない部分木は飛ばす）
+  if (changed) vData->tree.update(vData->currentPageCopy, true);
+  VT_LOG_INFO(debugLog, "[SceneQueue] %d objects updated.", changed);
+  return changed;
+}
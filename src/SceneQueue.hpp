@@ -0,0 +1,88 @@
+#pragma once
+#include <atomic>
+#include "VisualData.hpp"
+#include "SceneCommand.h"
+
+// キューの段数（2 のべき乗）。1 フレームに届く編集の数より大きくしておく
+#ifndef VT_SCENE_QUEUE_SIZE
+#define VT_SCENE_QUEUE_SIZE 32
+#endif
+
+// 別タスク（センサー・通信など）から描画中のシーンを編集するための固定長キュー
+//
+//   // 描画側（setup など）
+//   SceneHandle temp = vt.sceneQueue.getHandle("temp");
+//   // 別タスク（満杯なら待たずに false、シーンには触れない）
+//   vt.sceneQueue.setProperty(temp, VDS::BindProperty::Color, RED);
+//   // 描画ループ（1 フレームに 1 回）
+//   vt.sceneQueue.apply(sprite);
+//   vt.vData.redrawDirty(sprite);
+//
+// 書き込みは複数タスク、読み出しは描画ループのみ（スロットごとの連番で排他するロックフリーのリング）。
+// apply() は同じオブジェクトへの編集をまとめてから currentPageCopy・保存済みページ・編集ページへ反映し、
+// 表示中ページなら変化前後の範囲を再描画対象にする。インスタンスは対象外。
+class SceneQueue {
+public:
+  Debug debugLog;
+  using VDS = VisualDataSet;
+
+  static constexpr uint32_t CAPACITY = VT_SCENE_QUEUE_SIZE;
+  static_assert(CAPACITY >= 2 && (CAPACITY & (CAPACITY - 1)) == 0, "VT_SCENE_QUEUE_SIZE must be a power of two");
+
+  VisualData* vData;
+
+  SceneQueue(VisualData* vData, bool enableErrorLog, bool enableInfoLog, bool enableSuccessLog);
+
+  // 名前から編集対象を引く（シーンを読むため描画側のスレッドで呼ぶこと、pageNum = -1 で編集ページ）
+  SceneHandle getHandle(const String& objectName, int pageNum = -1);
+
+  // 以下は任意のタスクから呼べる（満杯なら false を返して破棄）
+  bool push(const SceneCommand& command);
+  bool setArgs(SceneHandle target, const VDS::ObjectArgs& args);
+  bool setProperty(SceneHandle target, VDS::BindProperty property, int32_t value);
+  bool setText(SceneHandle target, const char* text);
+  bool move(SceneHandle target, int32_t dx, int32_t dy);
+  bool hide(SceneHandle target);
+  bool show(SceneHandle target);
+  bool remove(SceneHandle target);
+
+  // 描画ループから 1 フレームに 1 回呼ぶ（戻り値は変更したオブジェクトの数）
+  int apply(LGFX_Sprite &sprite);
+
+  uint32_t getDropped() const;
+  bool isEmpty() const;                // apply() を待つ編集がない（描画ループから呼ぶ）
+
+private:
+  static constexpr size_t PROPERTY_COUNT = size_t(VDS::BindProperty::Angle1) + 1;
+
+  struct Slot {
+    std::atomic<uint32_t> sequence;   // == 位置: 空き / == 位置 + 1: 書き込み済み
+    SceneCommand command;
+  };
+
+  // 1 フレーム分をまとめた、オブジェクトごとの編集内容
+  struct Pending {
+    SceneHandle target;
+    bool hasArgs = false;
+    VDS::ObjectArgs args;
+    uint16_t propertyMask = 0;
+    int32_t values[PROPERTY_COUNT] = {};
+    const char* text = nullptr;
+    int32_t dx = 0;
+    int32_t dy = 0;
+    int8_t visible = -1;              // -1: 変更なし / 0: 非表示 / 1: 表示
+    bool isDeleted = false;
+  };
+
+  Slot slots[CAPACITY];
+  std::atomic<uint32_t> enqueuePos{0};
+  uint32_t dequeuePos = 0;            // 描画ループのみが触る
+  std::atomic<uint32_t> dropped{0};
+  std::vector<Pending> pending;
+
+  bool pop(SceneCommand& command);
+  void coalesce(const SceneCommand& command);
+  void modify(VDS::ObjectData& obj, const Pending& p) const;
+  bool applyToPage(VDS::PageData& page, const Pending& p);
+  bool applyToDisplay(LGFX_Sprite &sprite, const Pending& p);
+};
@@ -0,0 +1,204 @@
+#include "SceneTree.hpp"
+#include "VisualData.hpp"
+#include "FrameProfiler.hpp"
+#include <algorithm>
+
+SceneTree::SceneTree (VisualData* vData) {
+  this->vData = vData;
+}
+
+void SceneTree::invalidate () {
+  isValid = false;
+}
+
+void SceneTree::clear () {
+  nodes.clear();
+  cachedPage = nullptr;
+  isValid = false;
+}
+
+size_t SceneTree::getNodeCount () const {
+  return nodes.size();
+}
+
+size_t SceneTree::getLastUpdatedCount () const {
+  return lastUpdated;
+}
+
+size_t SceneTree::getBytes () const {
+  return nodes.capacity() * sizeof(Node);
+}
+
+// 親から順に、親の基準座標・色が変わった子だけを追従させる
+int SceneTree::update (VDS::PageData& page, bool markDirty) {
+  if (!vData || page.isEmpty()) return 0;
+  VT_PROFILE_SCOPE(FrameStats::Stage::Layout);
+  if (!isCached(page)) rebuild(page);
+
+  lastUpdated = 0;
+  size_t followed = 0;
+  vData->layout.beginPass(page);
+  for (auto& node : nodes) {
+    if (node.parentIndex >= 0) {
+      bool changed = false;
+      if (!node.parentIsContainer) changed |= resolvePosition(page, node, markDirty);
+      if (page.objects[size_t(node.index)].inheritColor) changed |= resolveColor(page, node, markDirty);
+      if (changed) followed++;
+    }
+    // 自分の位置が決まってから中身を並べる
+    if (LayoutEngine::isContainerType(page.objects[size_t(node.index)].type)) {
+      lastUpdated += vData->layout.updateBox(page, size_t(node.index), markDirty);
+    }
+  }
+  vData->layout.endPass(page);
+
+  if (followed) {
+    vData->pageRevision++;
+    VT_LOG_INFO(vData->debugLog, "SceneTree: %u children followed their parents.", unsigned(followed));
+  }
+  lastUpdated += followed;
+  return int(lastUpdated);
+}
+
+// 前回と同じページで、並び順・親子関係が変わっていなければ覚えた並びをそのまま使う
+bool SceneTree::isCached (const VDS::PageData& page) const {
+  if (!isValid || cachedPage != &page || cachedPageNum != page.pageNum || cachedObjects != page.objects.size()) return false;
+  for (const auto& node : nodes) {
+    const VDS::ObjectData& obj = page.objects[size_t(node.index)];
+    if (obj.objectNum != node.objectNum || obj.parentNum != node.parentNum) return false;
+    if (node.parentIndex < 0) continue;
+    const VDS::ObjectData& parent = page.objects[size_t(node.parentIndex)];
+    if (parent.objectNum != node.parentNum || LayoutEngine::isContainerType(parent.type) != node.parentIsContainer) return false;
+  }
+  return true;
+}
+
+// 親を持つオブジェクトとコンテナを深さ順に並べる（同じページなら覚えた親の座標は引き継ぐ）
+void SceneTree::rebuild (const VDS::PageData& page) {
+  std::vector<Node> previous;
+  if (cachedPage == &page && cachedPageNum == page.pageNum) previous.swap(nodes);
+  nodes.clear();
+
+  std::vector<std::pair<int, int>> lookup;   // objectNum → page.objects 内の位置
+  lookup.reserve(page.objects.size());
+  for (size_t i = 0; i < page.objects.size(); i++) lookup.emplace_back(page.objects[i].objectNum, int(i));
+  std::sort(lookup.begin(), lookup.end());
+  auto indexOf = [&lookup](int objectNum) {
+    auto it = std::lower_bound(lookup.begin(), lookup.end(), std::make_pair(objectNum, INT_MIN));
+    return (it != lookup.end() && it->first == objectNum) ? it->second : -1;
+  };
+
+  for (size_t i = 0; i < page.objects.size(); i++) {
+    const VDS::ObjectData& obj = page.objects[i];
+    if (obj.parentNum < 0 && !LayoutEngine::isContainerType(obj.type)) continue;
+
+    Node node;
+    node.index = int(i);
+    node.objectNum = obj.objectNum;
+    node.parentNum = obj.parentNum;
+    node.parentIndex = obj.parentNum >= 0 ? indexOf(obj.parentNum) : -1;
+    if (node.parentIndex >= 0) node.parentIsContainer = LayoutEngine::isContainerType(page.objects[size_t(node.parentIndex)].type);
+
+    // 循環していれば親を持たないものとして扱う
+    size_t depth = 0;
+    for (int p = node.parentIndex; p >= 0 && depth <= page.objects.size(); depth++) {
+      int parentNum = page.objects[size_t(p)].parentNum;
+      p = parentNum >= 0 ? indexOf(parentNum) : -1;
+    }
+    if (depth > page.objects.size()) {
+      VT_LOG_ERROR(vData->debugLog, "SceneTree: [%s] has a parent cycle.", obj.objectName.c_str());
+      node.parentIndex = -1;
+      depth = 0;
+    }
+    node.depth = int(depth);
+
+    for (const auto& old : previous) {
+      if (old.objectNum != node.objectNum || old.parentNum != node.parentNum || !old.isResolved) continue;
+      node.isResolved = true;
+      node.parentX = old.parentX;
+      node.parentY = old.parentY;
+      break;
+    }
+    nodes.push_back(node);
+  }
+  std::stable_sort(nodes.begin(), nodes.end(), [](const Node& a, const Node& b) { return a.depth < b.depth; });
+
+  cachedPage = &page;
+  cachedPageNum = page.pageNum;
+  cachedObjects = page.objects.size();
+  isValid = true;
+}
+
+// 親の基準座標 + localX / localY に置く
+// 前回から子の引数が直接動かされていれば、その位置を新しい相対位置にする
+bool SceneTree::resolvePosition (VDS::PageData& page, Node& node, bool markDirty) {
+  VDS::ObjectData& obj = page.objects[size_t(node.index)];
+  const VDS::ObjectData& parent = page.objects[size_t(node.parentIndex)];
+  int32_t px, py, cx, cy;
+  if (!vData->getArgsOrigin(parent.type, parent.objectArgs, px, py) || !vData->getArgsOrigin(obj.type, obj.objectArgs, cx, cy)) return false;
+
+  if (node.isResolved) {
+    obj.localX = cx - node.parentX;
+    obj.localY = cy - node.parentY;
+  }
+  node.parentX = px;
+  node.parentY = py;
+  node.isResolved = true;
+
+  int32_t dx = px + obj.localX - cx;
+  int32_t dy = py + obj.localY - cy;
+  if (dx == 0 && dy == 0) return false;
+  moveObject(obj, dx, dy, markDirty);
+  return true;
+}
+
+bool SceneTree::resolveColor (VDS::PageData& page, const Node& node, bool markDirty) {
+  VDS::ObjectData& obj = page.objects[size_t(node.index)];
+  int color, current;
+  if (!findColor(page, node.parentNum, color) || !vData->getArgsColor(obj.type, obj.objectArgs, current)) return false;
+  if (current == color) return false;
+
+  vData->setArgsColor(obj.type, obj.objectArgs, color);
+  if (markDirty) markBounds(obj);
+  return true;
+}
+
+// 色を持つ最も近い先祖の色（親は先に解決済みなので、受け継いだ色もそのまま使える）
+bool SceneTree::findColor (const VDS::PageData& page, int objectNum, int& color) const {
+  for (size_t n = 0; objectNum >= 0 && n <= page.objects.size(); n++) {
+    const VDS::ObjectData& obj = vData->getObjectData(page, objectNum);
+    if (obj.isEmpty()) return false;
+    if (vData->getArgsColor(obj.type, obj.objectArgs, color)) return true;
+    objectNum = obj.parentNum;
+  }
+  return false;
+}
+
+void SceneTree::moveObject (VDS::ObjectData& obj, int32_t dx, int32_t dy, bool markDirty) {
+  if (markDirty) markBounds(obj);
+  vData->translateArgs(obj.type, obj.objectArgs, dx, dy);
+  vData->updateBounds(obj);
+  if (markDirty) markBounds(obj);
+}
+
+// 範囲の分からないもの（折り返す文字列など）は画面全体を描き直す
+void SceneTree::markBounds (const VDS::ObjectData& obj) {
+  VDS::Rect bounds;
+  if (!vData->getObjectBounds(vData->boundsSprite, obj, bounds)) {
+    bounds = VDS::Rect{ 0, 0, vData->display ? vData->display->width() : 0, vData->display ? vData->display->height() : 0 };
+  }
+  vData->markDirty(bounds);
+}
+
+// 親がコンテナ以外の子について、今の絶対座標から親からの位置を求める
+void SceneTree::captureLocal (VDS::PageData& page) const {
+  for (auto& obj : page.objects) {
+    if (obj.parentNum < 0) continue;
+    const VDS::ObjectData& parent = vData->getObjectData(page, obj.parentNum);
+    if (parent.isEmpty() || LayoutEngine::isContainerType(parent.type)) continue;
+    int32_t px, py, cx, cy;
+    if (!vData->getArgsOrigin(parent.type, parent.objectArgs, px, py) || !vData->getArgsOrigin(obj.type, obj.objectArgs, cx, cy)) continue;
+    obj.localX = cx - px;
+    obj.localY = cy - py;
+  }
+}
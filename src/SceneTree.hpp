@@ -0,0 +1,71 @@
+#pragma once
+#include <Arduino.h>
+#include <vector>
+#include "VisualDataSet.h"
+
+class VisualData;
+
+// オブジェクトの親子関係（子の位置は親からの相対、色は親から受け継げる）
+//
+//   vt.vData.setDrawRoundRectObject("panel", 40, 40, 200, 120, 8, ORANGE);
+//   vt.vData.setFillRectObject("stripe", 8, 8, 184, 6, 0);
+//   vt.vData.setParent("stripe", "panel", true);   // (48, 48) に置かれ、ORANGE を受け継ぐ
+//   vt.vData.setDrawRoundRectObject("panel", 60, 40, 200, 120, 8, CYAN, 0, false, true);
+//   // → 次の update() で stripe も (68, 48) へ動き CYAN になる
+//
+// 引数の座標は絶対座標のまま持ち（描画・判定・範囲計算はそのまま使う）、親からの位置は
+// ObjectData::localX / localY に持つ。update() は親から順に子を見て、親の基準座標・色が
+// 前回覚えたものから変わった子だけを動かし・塗り替え、前後の範囲を再描画対象にする。
+// 変わらない子は比べるだけで引数にも再描画範囲にも触れないので、40 個の部品を載せた親を
+// 動かしても書き換えるのは親の引数 1 つで、更新はその下の部分木だけに及ぶ。
+// 子の引数が直接書き換えられた（バインディング・SceneQueue など）場合はその位置を新しい相対位置として取り込む。
+// 親がコンテナ（FlexBox / TableBox）の子の位置は LayoutEngine が決める（色は同じく受け継げる）。
+class SceneTree {
+public:
+  using VDS = VisualDataSet;
+
+  VisualData* vData;
+
+  SceneTree(VisualData* vData = nullptr);
+
+  // page の子を親に追従させる（戻り値は動かした・塗り替えた子の数）
+  // markDirty が false のときは再描画範囲を積まない（ページ全体を描き直す直前など）
+  int update(VDS::PageData& page, bool markDirty);
+  void invalidate();                    // 親子関係・並び順が変わった（次の update() で並びを作り直す）
+  void clear();                         // 覚えた親の座標も捨てる（ページを読み直したとき。次は localX / localY を正とする）
+
+  // 引数の絶対座標から localX / localY を求め直す（ブロブから読んだページなど）
+  void captureLocal(VDS::PageData& page) const;
+
+  size_t getNodeCount() const;          // 親を持つ・コンテナのオブジェクトの数
+  size_t getLastUpdatedCount() const;   // 直前の update() で動かした・塗り替えた子の数
+  size_t getBytes() const;
+
+private:
+  struct Node {
+    int index = -1;                     // page.objects 内の位置
+    int objectNum = -1;
+    int parentNum = -1;
+    int parentIndex = -1;
+    int depth = 0;
+    bool parentIsContainer = false;
+    bool isResolved = false;            // parentX / parentY を覚えている（false なら localX / localY を正とする）
+    int32_t parentX = 0;                // 前回追従させたときの親の基準座標
+    int32_t parentY = 0;
+  };
+
+  std::vector<Node> nodes;              // 親から順（深さ順）
+  const VDS::PageData* cachedPage = nullptr;
+  int cachedPageNum = -1;
+  size_t cachedObjects = 0;
+  bool isValid = false;
+  size_t lastUpdated = 0;
+
+  bool isCached(const VDS::PageData& page) const;
+  void rebuild(const VDS::PageData& page);
+  bool resolvePosition(VDS::PageData& page, Node& node, bool markDirty);
+  bool resolveColor(VDS::PageData& page, const Node& node, bool markDirty);
+  bool findColor(const VDS::PageData& page, int objectNum, int& color) const;
+  void moveObject(VDS::ObjectData& obj, int32_t dx, int32_t dy, bool markDirty);
+  void markBounds(const VDS::ObjectData& obj);
+};
@@ -1,10 +1,104 @@
 #pragma once
 
 #include <Arduino.h>
+#include <stdarg.h>
+
+// コンパイル時のログレベル（build_flags に -DVT_LOG_LEVEL=n）
+//   0 : なし / 1 : error / 2 : error + success / 3 : すべて（info を含む）
+// レベル外の VT_LOG_* は空になり、引数の評価も文字列の組み立ても行われない
+#ifndef VT_LOG_LEVEL
+#define VT_LOG_LEVEL 1
+#endif
+
+// 1 行の最大長（超えた分は切り捨て）
+#ifndef VT_LOG_LINE_MAX
+#define VT_LOG_LINE_MAX 160
+#endif
+
+// リングバッファ出力のバイト数（0 でリングバッファを持たない）
+#ifndef VT_LOG_RING_SIZE
+#define VT_LOG_RING_SIZE 0
+#endif
+
+#if VT_LOG_RING_SIZE > 0
+// 整形済みのログを [時刻, 種類, 長さ, 本文] の固定長ヘッダ付きで溜めるリングバッファ
+// 満杯になると古いレコードから捨てる（Serial に流せない状況の事後確認用）
+class LogRing {
+public:
+  struct Header {
+    uint32_t ms;
+    uint8_t type;
+    uint8_t len;
+  };
+
+  void write(uint8_t type, const char* text, size_t len) {
+    if (len > 255) len = 255;
+    size_t need = sizeof(Header) + len;
+    if (need > sizeof(buffer)) return;
+    while (sizeof(buffer) - used < need) dropOldest();
+
+    Header h{ millis(), type, uint8_t(len) };
+    put(reinterpret_cast<const uint8_t*>(&h), sizeof(h));
+    put(reinterpret_cast<const uint8_t*>(text), len);
+    count++;
+  }
+
+  // 古い順に fn(header, text, len) を呼ぶ
+  template <typename F>
+  void forEach(F fn) const {
+    size_t pos = tail;
+    char text[256];
+    for (size_t i = 0; i < count; i++) {
+      Header h;
+      pos = get(pos, reinterpret_cast<uint8_t*>(&h), sizeof(h));
+      pos = get(pos, reinterpret_cast<uint8_t*>(text), h.len);
+      text[h.len] = '\0';
+      fn(h, text, size_t(h.len));
+    }
+  }
+
+  void clear() { head = tail = used = count = 0; dropped = 0; }
+  size_t size() const { return count; }
+  size_t getDropped() const { return dropped; }
+
+private:
+  uint8_t buffer[VT_LOG_RING_SIZE];
+  size_t head = 0;
+  size_t tail = 0;
+  size_t used = 0;
+  size_t count = 0;
+  size_t dropped = 0;
+
+  void put(const uint8_t* src, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+      buffer[head] = src[i];
+      head = (head + 1) % sizeof(buffer);
+    }
+    used += len;
+  }
+  size_t get(size_t pos, uint8_t* dst, size_t len) const {
+    for (size_t i = 0; i < len; i++) {
+      dst[i] = buffer[pos];
+      pos = (pos + 1) % sizeof(buffer);
+    }
+    return pos;
+  }
+  void dropOldest() {
+    Header h;
+    get(tail, reinterpret_cast<uint8_t*>(&h), sizeof(h));
+    size_t len = sizeof(Header) + h.len;
+    tail = (tail + len) % sizeof(buffer);
+    used -= len;
+    count--;
+    dropped++;
+  }
+};
+#endif
 
 class Debug{
 private:
   bool enableDebugLog, enableErrorLog, enableInfoLog, enableSuccessLog;
+  uint8_t sinks = SinkSerial;
 
 public:
   enum LogType{
@@ -14,6 +108,12 @@ public:
     success
   };
 
+  // 出力先（VT_LOG_* のみ。printLog / printlnLog は常に Serial）
+  enum Sink : uint8_t {
+    SinkSerial = 1 << 0,
+    SinkRing   = 1 << 1   // VT_LOG_RING_SIZE > 0 のときのみ有効
+  };
+
   Debug(bool enableError = false, bool enableInfo = false, bool enableSuccess = false)
     : enableErrorLog(enableError), enableInfoLog(enableInfo), enableSuccessLog(enableSuccess) {
       if(enableError || enableInfo || enableSuccess) enableDebugLog = true;
@@ -27,6 +127,29 @@ public:
     enableSuccessLog = enableSuccess;
   }
 
+  void setSinks(uint8_t sinkMask){
+    sinks = sinkMask;
+  }
+
+  bool isEnabled(LogType type) const {
+    switch (type) {
+      case none:
+      case error:   return enableErrorLog;
+      case info:    return enableInfoLog;
+      case success: return enableSuccessLog;
+    }
+    return false;
+  }
+
+  static const char* prefix(LogType type) {
+    switch (type) {
+      case error:   return "error : ";
+      case info:    return "info : ";
+      case success: return "success : ";
+      default:      return "";
+    }
+  }
+
   // デバッグメッセージ出力関数
   void printLog(LogType type, String message){
     if(type == none && enableErrorLog){
@@ -58,4 +181,62 @@ public:
       Serial.println(message);
     }
   }
-};
\ No newline at end of file
+
+  // printf 形式の出力（VT_LOG_* から有効確認後に呼ばれる）
+  __attribute__((format(printf, 3, 4)))
+  void printfLog(LogType type, const char* format, ...) {
+    char line[VT_LOG_LINE_MAX];
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    if (len < 0) return;
+    if (size_t(len) >= sizeof(line)) len = sizeof(line) - 1;
+
+    if (sinks & SinkSerial) {
+      Serial.print(prefix(type));
+      Serial.println(line);
+    }
+#if VT_LOG_RING_SIZE > 0
+    if (sinks & SinkRing) ring().write(uint8_t(type), line, size_t(len));
+#endif
+  }
+
+#if VT_LOG_RING_SIZE > 0
+  // 全インスタンス共通のリングバッファ
+  static LogRing& ring() {
+    static LogRing instance;
+    return instance;
+  }
+
+  // リングバッファの内容を古い順に Serial へ出力
+  static void dumpRing() {
+    ring().forEach([](const LogRing::Header& h, const char* text, size_t) {
+      Serial.printf("[%lu] %s%s\n", (unsigned long)h.ms, prefix(LogType(h.type)), text);
+    });
+    if (ring().getDropped()) Serial.printf("(%u dropped)\n", unsigned(ring().getDropped()));
+  }
+#endif
+};
+
+// 実行時の有効確認を通ったときだけ引数を評価して整形する
+#define VT_LOG_AT(logger, type, ...) \
+  do { if ((logger).isEnabled(type)) (logger).printfLog(type, __VA_ARGS__); } while (0)
+
+#if VT_LOG_LEVEL >= 1
+#define VT_LOG_ERROR(logger, ...) VT_LOG_AT(logger, Debug::error, __VA_ARGS__)
+#else
+#define VT_LOG_ERROR(logger, ...) ((void)0)
+#endif
+
+#if VT_LOG_LEVEL >= 2
+#define VT_LOG_SUCCESS(logger, ...) VT_LOG_AT(logger, Debug::success, __VA_ARGS__)
+#else
+#define VT_LOG_SUCCESS(logger, ...) ((void)0)
+#endif
+
+#if VT_LOG_LEVEL >= 3
+#define VT_LOG_INFO(logger, ...) VT_LOG_AT(logger, Debug::info, __VA_ARGS__)
+#else
+#define VT_LOG_INFO(logger, ...) ((void)0)
+#endif
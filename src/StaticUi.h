@@ -0,0 +1,286 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "VisualDataSet.h"
+#include "TouchDataSet.h"
+
+// ビルド時に内容が決まる画面を const テーブル（フラッシュ）として定義する
+// VisualData::drawStaticPage() と TouchData の判定はテーブルを直接参照するため、
+// visualDataSet へのコピー・String の確保・起動時の登録処理が発生しない
+//
+//   constexpr StaticUi::Object homeObjects[] = {
+//     StaticUi::fillRect("bg",  0, 0, 320, 240, NAVY),
+//     StaticUi::fillRoundRect("ok", 20, 180, 120, 40, 8, GREEN, 1),
+//   };
+//   constexpr StaticUi::Process homeProcesses[] = {
+//     StaticUi::process("okPress", "ok", TouchDataSet::TouchType::Press),
+//   };
+//   VT_STATIC_PAGE(homePage, "home", homeObjects, homeProcesses);
+//
+//   vt.vData.drawStaticPage(sprite, homePage);
+//
+// 名前の重複・存在しないオブジェクトへのプロセス・引数と DrawType の不一致は
+// VT_STATIC_PAGE の static_assert でコンパイルエラーになる
+namespace StaticUi {
+  using VDS = VisualDataSet;
+  using TDS = TouchDataSet;
+
+  // ObjectArgs のどのメンバを使っているか（DrawType との整合チェック用）
+  enum class ArgsKind : uint8_t {
+    Pixel, Line, Bezier, WideLine, Rect, RoundRect, Circle, Ellipse, Triangle,
+    Arc, EllipseArc, Jpg, Png, Bitmap, Text, None
+  };
+
+  constexpr ArgsKind argsKindOf (const VDS::PixelArgs&)      { return ArgsKind::Pixel; }
+  constexpr ArgsKind argsKindOf (const VDS::LineArgs&)       { return ArgsKind::Line; }
+  constexpr ArgsKind argsKindOf (const VDS::BezierArgs&)     { return ArgsKind::Bezier; }
+  constexpr ArgsKind argsKindOf (const VDS::WideLineArgs&)   { return ArgsKind::WideLine; }
+  constexpr ArgsKind argsKindOf (const VDS::RectArgs&)       { return ArgsKind::Rect; }
+  constexpr ArgsKind argsKindOf (const VDS::RoundRectArgs&)  { return ArgsKind::RoundRect; }
+  constexpr ArgsKind argsKindOf (const VDS::CircleArgs&)     { return ArgsKind::Circle; }
+  constexpr ArgsKind argsKindOf (const VDS::EllipseArgs&)    { return ArgsKind::Ellipse; }
+  constexpr ArgsKind argsKindOf (const VDS::TriangleArgs&)   { return ArgsKind::Triangle; }
+  constexpr ArgsKind argsKindOf (const VDS::ArcArgs&)        { return ArgsKind::Arc; }
+  constexpr ArgsKind argsKindOf (const VDS::EllipseArcArgs&) { return ArgsKind::EllipseArc; }
+  constexpr ArgsKind argsKindOf (const VDS::JpgFileArgs&)    { return ArgsKind::Jpg; }
+  constexpr ArgsKind argsKindOf (const VDS::PngFileArgs&)    { return ArgsKind::Png; }
+  constexpr ArgsKind argsKindOf (const VDS::BitmapArgs&)     { return ArgsKind::Bitmap; }
+  constexpr ArgsKind argsKindOf (const VDS::StringArgs&)     { return ArgsKind::Text; }
+
+  // DrawType が要求する引数の種類
+  constexpr ArgsKind argsKindFor (VDS::DrawType type) {
+    switch (type) {
+      case VDS::DrawType::DrawPixel:      return ArgsKind::Pixel;
+      case VDS::DrawType::DrawLine:       return ArgsKind::Line;
+      case VDS::DrawType::DrawBezier:     return ArgsKind::Bezier;
+      case VDS::DrawType::DrawWideLine:   return ArgsKind::WideLine;
+      case VDS::DrawType::DrawRect:
+      case VDS::DrawType::ClipRect:
+      case VDS::DrawType::FillRect:       return ArgsKind::Rect;
+      case VDS::DrawType::DrawRoundRect:
+      case VDS::DrawType::ClipRoundRect:
+      case VDS::DrawType::FillRoundRect:  return ArgsKind::RoundRect;
+      case VDS::DrawType::DrawCircle:
+      case VDS::DrawType::ClipCircle:
+      case VDS::DrawType::FillCircle:     return ArgsKind::Circle;
+      case VDS::DrawType::DrawEllipse:
+      case VDS::DrawType::ClipEllipse:
+      case VDS::DrawType::FillEllipse:    return ArgsKind::Ellipse;
+      case VDS::DrawType::DrawTriangle:
+      case VDS::DrawType::ClipTriangle:
+      case VDS::DrawType::FillTriangle:   return ArgsKind::Triangle;
+      case VDS::DrawType::DrawArc:
+      case VDS::DrawType::ClipArc:
+      case VDS::DrawType::FillArc:        return ArgsKind::Arc;
+      case VDS::DrawType::DrawEllipseArc:
+      case VDS::DrawType::ClipEllipseArc:
+      case VDS::DrawType::FillEllipseArc: return ArgsKind::EllipseArc;
+      case VDS::DrawType::DrawJpgFile:    return ArgsKind::Jpg;
+      case VDS::DrawType::DrawPngFile:    return ArgsKind::Png;
+      case VDS::DrawType::DrawBitmap:     return ArgsKind::Bitmap;
+      case VDS::DrawType::DrawString:     return ArgsKind::Text;
+      default:                            return ArgsKind::None;
+    }
+  }
+
+  struct Object {
+    const char* name;
+    VDS::DrawType type;
+    VDS::ObjectArgs args;
+    ArgsKind argsKind;
+    uint8_t zIndex;
+    bool isUntouchable;
+  };
+
+  struct Process {
+    const char* name;
+    const char* objectName;
+    TDS::TouchType type;
+    bool enableOverBorder;
+    bool returnCurrentOver;
+    int multiClickCount;
+  };
+
+  // 描画・判定側が受け取るビュー（テーブルへのポインタのみ）
+  struct Page {
+    const char* name = nullptr;
+    const Object* objects = nullptr;
+    const uint16_t* drawOrder = nullptr;      // zIndex 昇順（同じ z は定義順）
+    uint16_t objectCount = 0;
+    const Process* processes = nullptr;
+    const uint16_t* processObject = nullptr;  // 各プロセスが対象とするオブジェクトの添字
+    uint16_t processCount = 0;
+
+    bool isEmpty() const {
+      return name == nullptr;
+    }
+  };
+
+  enum class Error : uint8_t {
+    None,
+    DuplicateObjectName,
+    DuplicateProcessName,
+    UnknownObject,
+    DuplicateProcessType,
+    UntouchableTarget,
+    ArgsMismatch
+  };
+
+  constexpr bool sameName (const char* a, const char* b) {
+    while (*a && *a == *b) { a++; b++; }
+    return *a == *b;
+  }
+
+  // makePage() の結果。N / M はオブジェクト数 / プロセス数（0 のときも配列長は 1 にする）
+  template <size_t N, size_t M>
+  struct PageDef {
+    const char* name = nullptr;
+    const Object* objects = nullptr;
+    const Process* processes = nullptr;
+    uint16_t drawOrder[N ? N : 1] = {};
+    uint16_t processObject[M ? M : 1] = {};
+    Error error = Error::None;
+
+    constexpr operator Page () const {
+      return Page{ name, objects, drawOrder, uint16_t(N), processes, processObject, uint16_t(M) };
+    }
+  };
+
+  template <size_t N, size_t M>
+  constexpr PageDef<N, M> buildPage (const char* name, const Object* objects, const Process* processes) {
+    static_assert(N < 0xFFFF && M < 0xFFFF, "StaticUi: too many objects or processes");
+    PageDef<N, M> def{};
+    def.name = name;
+    def.objects = objects;
+    def.processes = processes;
+
+    for (size_t i = 0; i < N; i++) {
+      if (objects[i].argsKind != argsKindFor(objects[i].type)) def.error = Error::ArgsMismatch;
+      for (size_t j = 0; j < i; j++) {
+        if (sameName(objects[i].name, objects[j].name)) def.error = Error::DuplicateObjectName;
+      }
+    }
+
+    // zIndex の安定挿入ソート
+    for (size_t i = 0; i < N; i++) {
+      size_t k = i;
+      while (k > 0 && objects[def.drawOrder[k - 1]].zIndex > objects[i].zIndex) {
+        def.drawOrder[k] = def.drawOrder[k - 1];
+        k--;
+      }
+      def.drawOrder[k] = uint16_t(i);
+    }
+
+    for (size_t i = 0; i < M; i++) {
+      size_t target = N;
+      for (size_t j = 0; j < N; j++) {
+        if (sameName(processes[i].objectName, objects[j].name)) target = j;
+      }
+      if (target == N) { def.error = Error::UnknownObject; continue; }
+      if (objects[target].isUntouchable) def.error = Error::UntouchableTarget;
+      def.processObject[i] = uint16_t(target);
+
+      for (size_t j = 0; j < i; j++) {
+        if (sameName(processes[i].name, processes[j].name)) def.error = Error::DuplicateProcessName;
+        if (def.processObject[j] == target && processes[j].type == processes[i].type) def.error = Error::DuplicateProcessType;
+      }
+    }
+    return def;
+  }
+
+  template <size_t N, size_t M>
+  constexpr PageDef<N, M> makePage (const char* name, const Object (&objects)[N], const Process (&processes)[M]) {
+    return buildPage<N, M>(name, objects, processes);
+  }
+  template <size_t N>
+  constexpr PageDef<N, 0> makePage (const char* name, const Object (&objects)[N]) {
+    return buildPage<N, 0>(name, objects, nullptr);
+  }
+
+  // -------------------- オブジェクト --------------------
+  template <class Args>
+  constexpr Object object (const char* name, VDS::DrawType type, const Args& args, uint8_t zIndex = 0, bool isUntouchable = false) {
+    return Object{ name, type, VDS::ObjectArgs(args), argsKindOf(args), zIndex, isUntouchable };
+  }
+
+  constexpr Object drawPixel (const char* name, int32_t x, int32_t y, int color, uint8_t zIndex = 0, bool isUntouchable = false) {
+    return object(name, VDS::DrawType::DrawPixel, VDS::PixelArgs{ x, y, color }, zIndex, isUntouchable);
+  }
+  constexpr Object drawLine (const char* name, int32_t x0, int32_t y0, int32_t x1, int32_t y1, int color, uint8_t zIndex = 0, bool isUntouchable = false) {
+    return object(name, VDS::DrawType::DrawLine, VDS::LineArgs{ x0, y0, x1, y1, color }, zIndex, isUntouchable);
+  }
+  constexpr Object drawWideLine (const char* name, int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t r, int color, uint8_t zIndex = 0, bool isUntouchable = false) {
+    return object(name, VDS::DrawType::DrawWideLine, VDS::WideLineArgs{ x0, y0, x1, y1, r, color }, zIndex, isUntouchable);
+  }
+  constexpr Object drawBezier (const char* name, int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t x2, int32_t y2, int color, uint8_t zIndex = 0, bool isUntouchable = false) {
+    return object(name, VDS::DrawType::DrawBezier, VDS::BezierArgs{ x0, y0, x1, y1, x2, y2, color }, zIndex, isUntouchable);
+  }
+
+  constexpr Object drawRect (const char* name, int32_t x, int32_t y, int32_t w, int32_t h, int color, uint8_t zIndex = 0, bool isUntouchable = false) {
+    return object(name, VDS::DrawType::DrawRect, VDS::RectArgs{ x, y, w, h, color }, zIndex, isUntouchable);
+  }
+  constexpr Object fillRect (const char* name, int32_t x, int32_t y, int32_t w, int32_t h, int color, uint8_t zIndex = 0, bool isUntouchable = false) {
+    return object(name, VDS::DrawType::FillRect, VDS::RectArgs{ x, y, w, h, color }, zIndex, isUntouchable);
+  }
+  constexpr Object drawRoundRect (const char* name, int32_t x, int32_t y, int32_t w, int32_t h, int32_t r, int color, uint8_t zIndex = 0, bool isUntouchable = false) {
+    return object(name, VDS::DrawType::DrawRoundRect, VDS::RoundRectArgs{ x, y, w, h, r, color }, zIndex, isUntouchable);
+  }
+  constexpr Object fillRoundRect (const char* name, int32_t x, int32_t y, int32_t w, int32_t h, int32_t r, int color, uint8_t zIndex = 0, bool isUntouchable = false) {
+    return object(name, VDS::DrawType::FillRoundRect, VDS::RoundRectArgs{ x, y, w, h, r, color }, zIndex, isUntouchable);
+  }
+
+  constexpr Object drawCircle (const char* name, int32_t x, int32_t y, int32_t r, int color, uint8_t zIndex = 0, bool isUntouchable = false) {
+    return object(name, VDS::DrawType::DrawCircle, VDS::CircleArgs{ x, y, r, color }, zIndex, isUntouchable);
+  }
+  constexpr Object fillCircle (const char* name, int32_t x, int32_t y, int32_t r, int color, uint8_t zIndex = 0, bool isUntouchable = false) {
+    return object(name, VDS::DrawType::FillCircle, VDS::CircleArgs{ x, y, r, color }, zIndex, isUntouchable);
+  }
+  constexpr Object drawEllipse (const char* name, int32_t x, int32_t y, int32_t rx, int32_t ry, int color, uint8_t zIndex = 0, bool isUntouchable = false) {
+    return object(name, VDS::DrawType::DrawEllipse, VDS::EllipseArgs{ x, y, rx, ry, color }, zIndex, isUntouchable);
+  }
+  constexpr Object fillEllipse (const char* name, int32_t x, int32_t y, int32_t rx, int32_t ry, int color, uint8_t zIndex = 0, bool isUntouchable = false) {
+    return object(name, VDS::DrawType::FillEllipse, VDS::EllipseArgs{ x, y, rx, ry, color }, zIndex, isUntouchable);
+  }
+  constexpr Object drawTriangle (const char* name, int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t x2, int32_t y2, int color, uint8_t zIndex = 0, bool isUntouchable = false) {
+    return object(name, VDS::DrawType::DrawTriangle, VDS::TriangleArgs{ x0, y0, x1, y1, x2, y2, color }, zIndex, isUntouchable);
+  }
+  constexpr Object fillTriangle (const char* name, int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t x2, int32_t y2, int color, uint8_t zIndex = 0, bool isUntouchable = false) {
+    return object(name, VDS::DrawType::FillTriangle, VDS::TriangleArgs{ x0, y0, x1, y1, x2, y2, color }, zIndex, isUntouchable);
+  }
+
+  constexpr Object drawArc (const char* name, int32_t x, int32_t y, int32_t r0, int32_t r1, int32_t angle0, int32_t angle1, int color, uint8_t zIndex = 0, bool isUntouchable = false) {
+    return object(name, VDS::DrawType::DrawArc, VDS::ArcArgs{ x, y, r0, r1, angle0, angle1, color }, zIndex, isUntouchable);
+  }
+  constexpr Object fillArc (const char* name, int32_t x, int32_t y, int32_t r0, int32_t r1, int32_t angle0, int32_t angle1, int color, uint8_t zIndex = 0, bool isUntouchable = false) {
+    return object(name, VDS::DrawType::FillArc, VDS::ArcArgs{ x, y, r0, r1, angle0, angle1, color }, zIndex, isUntouchable);
+  }
+
+  constexpr Object drawBitmap (const char* name, const uint16_t* bitmap, int32_t x, int32_t y, int32_t w, int32_t h, uint8_t zIndex = 0, bool isUntouchable = false) {
+    return object(name, VDS::DrawType::DrawBitmap, VDS::BitmapArgs{ bitmap, x, y, w, h }, zIndex, isUntouchable);
+  }
+
+  constexpr Object drawString (const char* name, int32_t x, int32_t y, const char* text, int color = WHITE, int bgcolor = -1,
+                               const lgfx::IFont* font = &fonts::lgfxJapanGothic_40, textdatum_t datum = textdatum_t::top_left,
+                               int textSize = 1, bool textWrap = true, uint8_t zIndex = 0, bool isUntouchable = false) {
+    return object(name, VDS::DrawType::DrawString, VDS::StringArgs{ x, y, text, color, bgcolor, font, datum, textSize, textWrap }, zIndex, isUntouchable);
+  }
+
+  // -------------------- プロセス --------------------
+  constexpr Process process (const char* name, const char* objectName, TDS::TouchType type,
+                             bool enableOverBorder = false, bool returnCurrentOver = false, int multiClickCount = 0) {
+    return Process{ name, objectName, type, enableOverBorder, returnCurrentOver, multiClickCount };
+  }
+}
+
+// 静的ページを定義し、定義ミスをコンパイル時に検出する
+#define VT_STATIC_PAGE_CHECK(var) \
+  static_assert(var.error != StaticUi::Error::DuplicateObjectName,  "StaticUi: duplicate object name in " #var); \
+  static_assert(var.error != StaticUi::Error::DuplicateProcessName, "StaticUi: duplicate process name in " #var); \
+  static_assert(var.error != StaticUi::Error::UnknownObject,        "StaticUi: process refers to an unknown object in " #var); \
+  static_assert(var.error != StaticUi::Error::DuplicateProcessType, "StaticUi: same touch type set twice on one object in " #var); \
+  static_assert(var.error != StaticUi::Error::UntouchableTarget,    "StaticUi: process on an untouchable object in " #var); \
+  static_assert(var.error != StaticUi::Error::ArgsMismatch,         "StaticUi: args do not match DrawType in " #var)
+
+#define VT_STATIC_PAGE(var, pageName, ...) \
+  constexpr auto var = StaticUi::makePage(pageName, __VA_ARGS__); \
+  VT_STATIC_PAGE_CHECK(var)
@@ -0,0 +1,250 @@
+#include "TileRenderer.hpp"
+
+TileRenderer::TileRenderer (VisualData* vData, LovyanGFX* lcd, bool enableErrorLog, bool enableInfoLog, bool enableSuccessLog){
+  this->vData = vData;
+  this->lcd = lcd;
+  debugLog.setDebug(enableErrorLog, enableInfoLog, enableSuccessLog);
+}
+
+// タイル用スプライト 2 枚（既定 32x32x16bit で計 4 KB）を確保する
+bool TileRenderer::begin (bool usePsram) {
+  for (auto& tile : tiles) {
+    tile.setColorDepth(16);
+    tile.setPsram(usePsram);
+    if (!tile.createSprite(TILE_SIZE, TILE_SIZE)) {
+      VT_LOG_ERROR(debugLog, "TileRenderer: failed to allocate %dx%d tile.", int(TILE_SIZE), int(TILE_SIZE));
+      end();
+      return false;
+    }
+  }
+  columns = (lcd->width() + TILE_SIZE - 1) / TILE_SIZE;
+  rows = (lcd->height() + TILE_SIZE - 1) / TILE_SIZE;
+  dirtyTiles.assign(size_t(columns * rows), 0);
+  current = 0;
+  dmaPending = false;
+  return true;
+}
+
+void TileRenderer::end () {
+  for (auto& tile : tiles) tile.deleteSprite();
+  items.clear();
+  binStart.clear();
+  binItems.clear();
+  dirtyTiles.clear();
+  columns = rows = 0;
+  binned = false;
+}
+
+int32_t TileRenderer::getTileColumns () const {
+  return columns;
+}
+
+int32_t TileRenderer::getTileRows () const {
+  return rows;
+}
+
+size_t TileRenderer::getLastDrawnTiles () const {
+  return lastDrawnTiles;
+}
+
+size_t TileRenderer::getBinnedItems () const {
+  return binItems.size();
+}
+
+size_t TileRenderer::getBinCount () const {
+  return binCount;
+}
+
+size_t TileRenderer::getBytes () const {
+  return items.capacity() * sizeof(VisualData::DrawItem) + binStart.capacity() * sizeof(uint32_t) +
+         binItems.capacity() * sizeof(uint16_t) + dirtyTiles.capacity();
+}
+
+bool TileRenderer::drawPage (const String& pageName) {
+  if (dirtyTiles.empty()) {
+    VT_LOG_ERROR(debugLog, "TileRenderer: begin() has not been called.");
+    return false;
+  }
+  if (!vData->setDrawingPage(pageName)) return false;
+
+  if (!isBinned()) bin();
+  std::fill(dirtyTiles.begin(), dirtyTiles.end(), 1);
+  return flushDirty();
+}
+
+void TileRenderer::markDirty (const VDS::Rect& rect) {
+  if (rect.isEmpty() || dirtyTiles.empty()) return;
+  int32_t c0 = std::max<int32_t>(rect.x, 0) / TILE_SIZE;
+  int32_t r0 = std::max<int32_t>(rect.y, 0) / TILE_SIZE;
+  int32_t c1 = std::min<int32_t>((rect.x + rect.w - 1) / TILE_SIZE, columns - 1);
+  int32_t r1 = std::min<int32_t>((rect.y + rect.h - 1) / TILE_SIZE, rows - 1);
+  for (int32_t r = r0; r <= r1; r++) {
+    for (int32_t c = c0; c <= c1; c++) dirtyTiles[size_t(r * columns + c)] = 1;
+  }
+}
+
+// updateBindings() や SceneQueue が積んだ範囲をタイルに読み替えてから描き直す
+bool TileRenderer::redrawDirty () {
+  vData->flushedRects.clear();
+  if (dirtyTiles.empty() || vData->currentPageCopy.isEmpty()) return false;
+
+  for (const auto& rect : vData->dirtyRects) markDirty(rect);
+  vData->flushedRects.swap(vData->dirtyRects);
+
+  if (std::find(dirtyTiles.begin(), dirtyTiles.end(), 1) == dirtyTiles.end()) return false;
+  if (!isBinned()) bin();
+  return flushDirty();
+}
+
+// 直前の bin() から描画ページが変わっていないか（items は currentPageCopy の要素を指すので、
+// 版が同じでも写しの置き場所が変わっていれば作り直す）
+bool TileRenderer::isBinned () const {
+  return binned && binnedPageNum == vData->currentPageCopy.pageNum &&
+         binnedRevision == vData->pageRevision && binnedDataRevision == vData->dataRevision &&
+         binnedObjects == vData->currentPageCopy.objects.data();
+}
+
+// タイルごとに、掛かるオブジェクトの添字を z 順のまま並べる（数えてから詰める 2 パス）
+void TileRenderer::bin () {
+  vData->collectDrawOrder(vData->currentPageCopy, items);
+  vData->cullItems(tiles[0], vData->getVisibleRect(*lcd), items, false);
+  if (items.size() > UINT16_MAX) {
+    VT_LOG_ERROR(debugLog, "TileRenderer: too many objects (%u).", unsigned(items.size()));
+    items.resize(UINT16_MAX);
+  }
+
+  struct Span { int16_t c0, r0, c1, r1; };
+  std::vector<Span> spans(items.size());
+  size_t tileCount = size_t(columns * rows);
+  binStart.assign(tileCount + 1, 0);
+
+  for (size_t i = 0; i < items.size(); i++) {
+    VDS::Rect bounds;
+    // 範囲が分からないもの（Clip 系を含む）はすべてのタイルに入れる
+    if (!vData->getItemBounds(tiles[0], items[i], bounds)) bounds = VDS::Rect{ 0, 0, lcd->width(), lcd->height() };
+
+    Span& s = spans[i];
+    if (bounds.isEmpty() || bounds.x >= lcd->width() || bounds.y >= lcd->height() ||
+        bounds.x + bounds.w <= 0 || bounds.y + bounds.h <= 0) {
+      s = Span{ 0, 0, -1, -1 };
+      continue;
+    }
+    s.c0 = int16_t(std::max<int32_t>(bounds.x, 0) / TILE_SIZE);
+    s.r0 = int16_t(std::max<int32_t>(bounds.y, 0) / TILE_SIZE);
+    s.c1 = int16_t(std::min<int32_t>((bounds.x + bounds.w - 1) / TILE_SIZE, columns - 1));
+    s.r1 = int16_t(std::min<int32_t>((bounds.y + bounds.h - 1) / TILE_SIZE, rows - 1));
+    for (int32_t r = s.r0; r <= s.r1; r++) {
+      for (int32_t c = s.c0; c <= s.c1; c++) binStart[size_t(r * columns + c) + 1]++;
+    }
+  }
+
+  for (size_t t = 0; t < tileCount; t++) binStart[t + 1] += binStart[t];
+  binItems.resize(binStart[tileCount]);
+
+  std::vector<uint32_t> cursor(binStart.begin(), binStart.end() - 1);
+  for (size_t i = 0; i < items.size(); i++) {
+    const Span& s = spans[i];
+    for (int32_t r = s.r0; r <= s.r1; r++) {
+      for (int32_t c = s.c0; c <= s.c1; c++) binItems[cursor[size_t(r * columns + c)]++] = uint16_t(i);
+    }
+  }
+
+  binned = true;
+  binnedPageNum = vData->currentPageCopy.pageNum;
+  binnedRevision = vData->pageRevision;
+  binnedDataRevision = vData->dataRevision;
+  binnedObjects = vData->currentPageCopy.objects.data();
+  binCount++;
+}
+
+// タイルの左上が原点になるよう引数をずらして描き、DMA で送る
+void TileRenderer::drawTile (int32_t column, int32_t row) {
+  LGFX_Sprite& tile = tiles[current];
+  int32_t x0 = column * TILE_SIZE;
+  int32_t y0 = row * TILE_SIZE;
+  size_t t = size_t(row * columns + column);
+
+  tile.fillSprite(BLACK);
+  ClipStack& clip = vData->clipStack;
+  clip.begin(&tile, x0, y0);
+  for (uint32_t k = binStart[t]; k < binStart[t + 1]; k++) {
+    const VisualData::DrawItem& item = items[binItems[k]];
+    VDS::DrawType type;
+    VDS::ObjectArgs args;
+    if (!vData->resolveItem(item, type, args)) continue;
+    if (ClipStack::isClipType(type)) {
+      clip.push(type, args, item.zIndex);
+      continue;
+    }
+    if (!clip.enter(item.zIndex)) continue;
+    if (type == VDS::DrawType::DrawString && args.text.textWrap && args.text.text && drawWrappedString(tile, args.text, x0, y0)) continue;
+    vData->translateArgs(type, args, -x0, -y0);
+    if (type == VDS::DrawType::DrawString) args.text.textWrap = false;
+    vData->drawObject(tile, type, args);
+  }
+  clip.end();
+
+  if (dmaPending) lcd->waitDMA();
+  int32_t h = std::min<int32_t>(TILE_SIZE, lcd->height() - y0);
+  lcd->pushImageDMA(x0, y0, TILE_SIZE, h, static_cast<const lgfx::swap565_t*>(tile.getBuffer()));
+  dmaPending = true;
+  current ^= 1;
+}
+
+// 画面の右端を越える折り返し付きの文字列を、全画面に描いたときと同じ位置で折り返して描く
+// （タイルの幅で折り返さないよう、1 文字ずつ折り返しを無効にして置く。右端を越えないなら false）
+bool TileRenderer::drawWrappedString (LGFX_Sprite& tile, const VDS::StringArgs& text, int32_t x0, int32_t y0) {
+  if (text.font) tile.setFont(text.font);
+  tile.setTextSize(text.textSize);
+  int32_t w = tile.textWidth(text.text);
+  int32_t x = text.x;
+  if (text.datum & 0x01) x -= w / 2;
+  else if (text.datum & 0x02) x -= w;
+  if (x + w <= lcd->width()) return false;
+
+  // 横の基準は左端に直して渡し、縦の基準（上・中央・下・ベースライン）はそのまま使う
+  tile.setTextDatum(textdatum_t(text.datum & ~0x03));
+  tile.setTextColor(text.color, text.bgcolor);
+  tile.setTextWrap(false, false);
+  int32_t y = text.y;
+  int32_t lineHeight = tile.fontHeight();
+  char ch[5];
+  for (const char* p = text.text; *p; ) {
+    size_t n = 1;
+    while (n < 4 && (uint8_t(p[n]) & 0xC0) == 0x80) n++;
+    std::memcpy(ch, p, n);
+    ch[n] = '\0';
+    p += n;
+
+    int32_t cw = tile.textWidth(ch);
+    if (x + cw > lcd->width()) {
+      x = 0;
+      y += lineHeight;
+    }
+    tile.drawString(ch, x - x0, y - y0);
+    x += cw;
+  }
+  return true;
+}
+
+bool TileRenderer::flushDirty () {
+  lastDrawnTiles = 0;
+  lcd->startWrite();
+  for (int32_t r = 0; r < rows; r++) {
+    for (int32_t c = 0; c < columns; c++) {
+      uint8_t& dirty = dirtyTiles[size_t(r * columns + c)];
+      if (!dirty) continue;
+      drawTile(c, r);
+      dirty = 0;
+      lastDrawnTiles++;
+    }
+  }
+  if (dmaPending) {
+    lcd->waitDMA();
+    dmaPending = false;
+  }
+  lcd->endWrite();
+
+  VT_LOG_INFO(debugLog, "TileRenderer: %u tiles drawn.", unsigned(lastDrawnTiles));
+  return lastDrawnTiles > 0;
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include "VisualData.hpp"
+
+// タイル 1 辺の画素数（build_flags の -DVT_TILE_SIZE=n で変更）
+#ifndef VT_TILE_SIZE
+#define VT_TILE_SIZE 32
+#endif
+
+// 画面を固定サイズのタイルに分けて描く描画経路（全画面スプライトを持たない）
+//
+//   vt.tileRenderer.begin();
+//   vt.tileRenderer.drawPage("page1");     // 全タイルを描いてパネルへ送る
+//   vt.tData.setProcessPage();
+//   ...
+//   vt.vData.updateBindings(vt.tileRenderer.tiles[0]);   // 範囲の計算用（描画はしない）
+//   vt.tileRenderer.redrawDirty();          // 再描画範囲に掛かるタイルだけを描き直す
+//
+// 各タイルには、そのタイルに掛かるオブジェクトの添字を z 順に並べたリストを持たせ（ビニング）、
+// リストは描画ページか pageRevision / dataRevision が変わったときだけ作り直す。
+// 小さなタイル用スプライトへ座標をずらして描いてから転送する。タイル用スプライトは 2 枚を
+// 交互に使い、一方を DMA で送っている間にもう一方を描く。
+// 文字列はタイルの幅で折り返さないよう textWrap を無効にして描き、画面の右端を越える折り返し付きの
+// 文字列は画面の幅で折り返す位置を求めて 1 文字ずつ置く（全画面スプライトに描いたときと同じ見た目）。
+class TileRenderer {
+public:
+  Debug debugLog;
+  using VDS = VisualDataSet;
+
+  static constexpr int32_t TILE_SIZE = VT_TILE_SIZE;
+
+  VisualData* vData;
+  LovyanGFX* lcd;
+  LGFX_Sprite tiles[2];
+
+  TileRenderer(VisualData* vData, LovyanGFX* lcd, bool enableErrorLog, bool enableInfoLog, bool enableSuccessLog);
+
+  bool begin(bool usePsram = false);
+  void end();
+
+  bool drawPage(const String& pageName);
+  void markDirty(const VDS::Rect& rect);
+  bool redrawDirty();                      // vData の再描画範囲も取り込む
+
+  int32_t getTileColumns() const;
+  int32_t getTileRows() const;
+  size_t getLastDrawnTiles() const;
+  size_t getBinnedItems() const;           // 全タイルのリストの長さの合計
+  size_t getBinCount() const;              // bin() した（リストを作り直した）回数
+  size_t getBytes() const;                 // タイルのリストと描き直すタイルの印（タイル用スプライトを除く）
+
+private:
+  int32_t columns = 0;
+  int32_t rows = 0;
+  std::vector<VisualData::DrawItem> items;
+  std::vector<uint32_t> binStart;          // タイル t のリストは binItems[binStart[t] .. binStart[t + 1])
+  std::vector<uint16_t> binItems;          // items の添字（z 順）
+  std::vector<uint8_t> dirtyTiles;
+  size_t lastDrawnTiles = 0;
+  int current = 0;                         // 次に描くタイル用スプライト
+  bool dmaPending = false;
+
+  // 直前の bin() の時点の描画ページ（ページと版が同じなら redrawDirty() でリストを作り直さない）
+  bool binned = false;
+  int binnedPageNum = 0;
+  uint32_t binnedRevision = 0;
+  uint32_t binnedDataRevision = 0;
+  const VDS::ObjectData* binnedObjects = nullptr;
+  size_t binCount = 0;
+
+  bool isBinned() const;
+  void bin();
+  void drawTile(int32_t column, int32_t row);
+  bool drawWrappedString(LGFX_Sprite& tile, const VDS::StringArgs& text, int32_t x0, int32_t y0);
+  bool flushDirty();
+};
@@ -1,4 +1,7 @@
 #include "TouchData.hpp"
+#include "PageCache.hpp"
+#include "FrameProfiler.hpp"
+#include "TouchLatency.hpp"
 using VDS = VisualDataSet;
 using TDS = TouchDataSet;
 
@@ -8,6 +11,7 @@ using TDS = TouchDataSet;
 // =========================
 TouchData::TouchData (VisualData* vData, bool enableErrorLog, bool enableInfoLog, bool enableSuccessLog){
   this->vData = vData;
+  judgeClip.vData = vData;
 
   debugLog.setDebug(enableErrorLog, enableInfoLog, enableSuccessLog);
 }
@@ -187,29 +191,31 @@ int TouchData::createOrGetObjectColor(int pageNum, int objectNum, bool getOnly)
         }
       }
       // オブジェクトが存在しない場合
-      debugLog.printlnLog(debugLog.info, "oc : objectData no exists. !" + vData->getObjectData(vData->getPageData(pageNum), objectNum).objectName);
+      VT_LOG_INFO(debugLog, "oc : objectData no exists. !%s", vData->getObjectData(vData->getPageData(pageNum), objectNum).objectName.c_str());
       if (getOnly) return 0x000000; // BLACK
       TDS::objectColor oc;
       oc.objectNum = objectNum;
       oc.colorCode = generateNewColor(ocPage);
       ocPage.objectColors.push_back(oc);
-      Serial.println("created objectColor.");
+      colorRevision++;
+      VT_LOG_INFO(debugLog, "created objectColor.");
       return oc.colorCode;
     }
   }
 
   // ページが存在しない場合
-  debugLog.printlnLog(debugLog.info, "oc : pageData no exists. !" + vData->getPageData(pageNum).pageName);
+  VT_LOG_INFO(debugLog, "oc : pageData no exists. !%s", vData->getPageData(pageNum).pageName.c_str());
   if (getOnly) return 0x000000; // BLACK
   touchDataSet.ocPages.push_back({});
   auto& newPage = touchDataSet.ocPages.back();
-  Serial.println("created ocPageData.");
+  VT_LOG_INFO(debugLog, "created ocPageData.");
   newPage.pageNum = pageNum;
   TDS::objectColor oc;
   oc.objectNum = objectNum;
   oc.colorCode = generateNewColor(newPage);
   newPage.objectColors.push_back(oc);
-  Serial.println("created objectColor.");
+  colorRevision++;
+  VT_LOG_INFO(debugLog, "created objectColor.");
   return oc.colorCode;
 }
 
@@ -221,10 +227,14 @@ bool TouchData::changeEditPage(int pageNum) {
   // まず現在の編集内容を確定
   commitProcessEdit();
 
+  // 未展開のページならここで展開（編集ページの間は破棄しない）
+  if (pageCache) pageCache->require(pageNum);
+
   // 既存ページがあれば編集ページに取り込む
   TDS::PageData* p = getPageData(pageNum);
   if (p) {
     editingPage = *p;
+    if (pageCache) pageCache->evictToBudget();   // 前の編集ページが破棄可能になる
     return true;
   }
 
@@ -232,6 +242,7 @@ bool TouchData::changeEditPage(int pageNum) {
   if(vData->isExistsPage(pageNum)){
     editingPage = TDS::PageData();
     editingPage.pageNum = pageNum;
+    if (pageCache) pageCache->evictToBudget();
     return true;
   }
   return false;
@@ -260,6 +271,7 @@ bool TouchData::deleteProcess(const String& processName, int pageNum, bool onDis
         }),
         ocPage.objectColors.end()
       );
+      colorRevision++;
     }
   }
 
@@ -300,6 +312,7 @@ void TouchData::defragProcesses(int pageNum, bool onDisplay)
         }),
         ocPage.objectColors.end()
       );
+      colorRevision++;
     }
   }
 
@@ -321,19 +334,22 @@ bool TouchData::createProcess ( const String& processName, String objectName, TD
   // オブジェクト取得
   const auto& obj = vData->getObjectData(vData->getPageData(targetPage->pageNum), objectNum);
 
+  const auto* inst = vData->getInstanceData(vData->getPageData(targetPage->pageNum), objectNum);
+
   // isUntouchable チェック
-  if (obj.isUntouchable) {
-    debugLog.printlnLog(debugLog.error, "The object is untouchable. Cannot create process. !" + obj.objectName);
+  if (obj.isUntouchable || (inst && inst->isUntouchable)) {
+    VT_LOG_ERROR(debugLog, "The object is untouchable. Cannot create process. !%s", objectName.c_str());
     return false;  // 強制終了
   }
 
   int pageNum = onDisplay ? currentPageProcess.pageNum : editingPage.pageNum;
   if (isExistsProcessType(objectNum, type, pageNum)) {
-    debugLog.printlnLog(debugLog.error, "this processData exists. !" + vData->getObjectData(vData->getPageData(pageNum), objectNum).objectName +", "+ int(type) +", "+ vData->getPageData(pageNum).pageName);
+    VT_LOG_ERROR(debugLog, "this processData exists. !%s, %d, %s",
+      vData->getObjectData(vData->getPageData(pageNum), objectNum).objectName.c_str(), int(type), vData->getPageData(pageNum).pageName.c_str());
     return false;
   }
   if (isExistsProcessName(processName, onDisplay ? -1 : editingPage.pageNum)) {
-    debugLog.printlnLog(debugLog.error, "this processName exists. !" + processName);
+    VT_LOG_ERROR(debugLog, "this processName exists. !%s", processName.c_str());
     return false;
   }
 
@@ -464,49 +480,64 @@ void TouchData::endProcessEdit() {
 
 bool TouchData::enableProcess(bool isPress) {
   enabledProcess.clear();
+
+  // 静的ページはプロセスの添字を番号として扱う
+  if (vData->isStaticPageDrawing()) {
+    const StaticUi::Page& page = vData->currentStaticPage;
+    for (uint16_t i = 0; i < page.processCount; i++) {
+      if (isEnabledType(page.processes[i].type, isPress)) enabledProcess.push_back(i);
+    }
+    return true;
+  }
+
   const auto& page = currentPageProcess; // 表示中ページ
   for (const auto& proc : page.processes) {
-    if (isPress) {
-      switch(proc.type) {
-        case TDS::TouchType::Press:
-        case TDS::TouchType::Pressing:
-        case TDS::TouchType::Pressed:
-        case TDS::TouchType::Hold:
-        case TDS::TouchType::Holding:
-        case TDS::TouchType::Held:
-        case TDS::TouchType::Drag:
-        case TDS::TouchType::Dragging:
-        case TDS::TouchType::Dragged:
-        case TDS::TouchType::Flick:
-        case TDS::TouchType::Flicking:
-        case TDS::TouchType::Flicked:
-        case TDS::TouchType::Clicked:
-        case TDS::TouchType::MultiClicked:
-          enabledProcess.push_back(proc.processNum);
-          break;
-        default: break;
-      }
-    } else { // Release系
-      switch(proc.type) {
-        case TDS::TouchType::Release:
-        case TDS::TouchType::Releasing:
-        case TDS::TouchType::Clicked:
-        case TDS::TouchType::MultiClicked:
-        case TDS::TouchType::Flicked:
-        case TDS::TouchType::Dragged:
-          enabledProcess.push_back(proc.processNum);
-          break;
-        default: break;
-      }
-    }
+    if (isEnabledType(proc.type, isPress)) enabledProcess.push_back(proc.processNum);
   }
   return true;
 }
 
+// 押下中 / リリース時に判定対象となる種類か
+bool TouchData::isEnabledType(TDS::TouchType type, bool isPress) const {
+  if (isPress) {
+    switch(type) {
+      case TDS::TouchType::Press:
+      case TDS::TouchType::Pressing:
+      case TDS::TouchType::Pressed:
+      case TDS::TouchType::Hold:
+      case TDS::TouchType::Holding:
+      case TDS::TouchType::Held:
+      case TDS::TouchType::Drag:
+      case TDS::TouchType::Dragging:
+      case TDS::TouchType::Dragged:
+      case TDS::TouchType::Flick:
+      case TDS::TouchType::Flicking:
+      case TDS::TouchType::Flicked:
+      case TDS::TouchType::Clicked:
+      case TDS::TouchType::MultiClicked:
+        return true;
+      default: break;
+    }
+  } else { // Release系
+    switch(type) {
+      case TDS::TouchType::Release:
+      case TDS::TouchType::Releasing:
+      case TDS::TouchType::Clicked:
+      case TDS::TouchType::MultiClicked:
+      case TDS::TouchType::Flicked:
+      case TDS::TouchType::Dragged:
+        return true;
+      default: break;
+    }
+  }
+  return false;
+}
+
 bool TouchData::disableProcessType(TDS::TouchType tType) {
   enabledProcess.erase(
     std::remove_if(enabledProcess.begin(), enabledProcess.end(),
       [this, tType](int pNum){
+        if (vData->isStaticPageDrawing()) return vData->currentStaticPage.processes[pNum].type == tType;
         return getProcessType(pNum) == tType;
       }),
     enabledProcess.end()
@@ -519,23 +550,34 @@ void TouchData::clearEnabledProcessList() {
 }
 
 void TouchData::setProcessPage() {
+  VT_PROFILE_SCOPE(FrameStats::Stage::PageResolve);
+  // 静的ページはテーブルを直接参照するため取り込み不要
+  if (vData->isStaticPageDrawing()) {
+    if (currentPageProcess.pageNum != TDS::PageData().pageNum) colorRevision++;
+    currentPageProcess = TDS::PageData();
+    clearEnabledProcessList();
+    return;
+  }
+
   String drawingPageName = vData->getDrawingPage();
   int pageNum = vData->getPageNumByName(drawingPageName);
   // ページ番号を引数から取得
   if (!isExistsPage(pageNum)) {
-    debugLog.printlnLog(debugLog.error, "Page not found. !" + String(pageNum));
+    VT_LOG_ERROR(debugLog, "Page not found. !%d", pageNum);
     return;
   }
 
   // ページデータ取得（存在する場合もここで取得）
+  // 判定色はページ番号で引くので、判定ページが変わったときだけ命令列を作り直させる
+  // （毎フレーム呼ばれても同じページなら判定用の命令列はそのまま使う）
+  if (currentPageProcess.pageNum != pageNum) colorRevision++;
   currentPageProcess = *getPageData(pageNum);
 
   // 有効プロセスリストをクリア
   clearEnabledProcessList();
 
-  debugLog.printlnLog(debugLog.success,
-    "Process page set. PageNum=" + String(currentPageProcess.pageNum) +
-    " / Process count=" + String(currentPageProcess.processes.size()));
+  VT_LOG_SUCCESS(debugLog, "Process page set. PageNum=%d / Process count=%u",
+    currentPageProcess.pageNum, unsigned(currentPageProcess.processes.size()));
 }
 
 
@@ -549,145 +591,149 @@ bool TouchData::drawObjectProcess (const VDS::ObjectData &obj) {
   int objectNum = obj.objectNum;              // objからオブジェクト番号を取得
   int objColor = createOrGetObjectColor(pageNum, objectNum, true); // getOnly = true
 
+  return drawObjectProcess(obj.type, obj.objectArgs, objColor);
+}
 
-  switch (obj.type) {
+// 種類と引数だけで判定色を塗る（ObjectData / 静的テーブルの共通部分）
+bool TouchData::drawObjectProcess (VDS::DrawType type, const VDS::ObjectArgs &args, int objColor) {
+  switch (type) {
 
     // -------------------- 基本描画 --------------------
     case VDS::DrawType::DrawPixel:
-      judgeSprite.drawPixel(obj.objectArgs.pixel.x, obj.objectArgs.pixel.y, objColor);
+      judgeSprite.drawPixel(args.pixel.x, args.pixel.y, objColor);
       break;
 
     case VDS::DrawType::DrawLine:
-      judgeSprite.drawLine(obj.objectArgs.line.x0, obj.objectArgs.line.y0,
-                      obj.objectArgs.line.x1, obj.objectArgs.line.y1,
+      judgeSprite.drawLine(args.line.x0, args.line.y0,
+                      args.line.x1, args.line.y1,
                       objColor);
       break;
 
     case VDS::DrawType::DrawBezier:
-      judgeSprite.drawBezier(obj.objectArgs.bezier.x0, obj.objectArgs.bezier.y0,
-                        obj.objectArgs.bezier.x1, obj.objectArgs.bezier.y1,
-                        obj.objectArgs.bezier.x2, obj.objectArgs.bezier.y2,
+      judgeSprite.drawBezier(args.bezier.x0, args.bezier.y0,
+                        args.bezier.x1, args.bezier.y1,
+                        args.bezier.x2, args.bezier.y2,
                         objColor);
       break;
 
     case VDS::DrawType::DrawWideLine:
-      judgeSprite.drawWideLine(obj.objectArgs.wideLine.x0, obj.objectArgs.wideLine.y0,
-                          obj.objectArgs.wideLine.x1, obj.objectArgs.wideLine.y1,
-                          obj.objectArgs.wideLine.r, objColor);
+      judgeSprite.drawWideLine(args.wideLine.x0, args.wideLine.y0,
+                          args.wideLine.x1, args.wideLine.y1,
+                          args.wideLine.r, objColor);
       break;
 
     case VDS::DrawType::DrawRect:
-      judgeSprite.fillRect(obj.objectArgs.rect.x, obj.objectArgs.rect.y,
-                      obj.objectArgs.rect.w, obj.objectArgs.rect.h,
+      judgeSprite.fillRect(args.rect.x, args.rect.y,
+                      args.rect.w, args.rect.h,
                       objColor);
       break;
 
     case VDS::DrawType::DrawRoundRect:
-      judgeSprite.fillRoundRect(obj.objectArgs.roundRect.x, obj.objectArgs.roundRect.y,
-                            obj.objectArgs.roundRect.w, obj.objectArgs.roundRect.h,
-                            obj.objectArgs.roundRect.r, objColor);
+      judgeSprite.fillRoundRect(args.roundRect.x, args.roundRect.y,
+                            args.roundRect.w, args.roundRect.h,
+                            args.roundRect.r, objColor);
       break;
 
     case VDS::DrawType::DrawCircle:
-      judgeSprite.fillCircle(obj.objectArgs.circle.x, obj.objectArgs.circle.y,
-                        obj.objectArgs.circle.r, objColor);
+      judgeSprite.fillCircle(args.circle.x, args.circle.y,
+                        args.circle.r, objColor);
       break;
 
     case VDS::DrawType::DrawEllipse:
-      judgeSprite.fillEllipse(obj.objectArgs.ellipse.x, obj.objectArgs.ellipse.y,
-                          obj.objectArgs.ellipse.rx, obj.objectArgs.ellipse.ry,
+      judgeSprite.fillEllipse(args.ellipse.x, args.ellipse.y,
+                          args.ellipse.rx, args.ellipse.ry,
                           objColor);
       break;
 
     case VDS::DrawType::DrawTriangle:
-      judgeSprite.fillTriangle(obj.objectArgs.triangle.x0, obj.objectArgs.triangle.y0,
-                          obj.objectArgs.triangle.x1, obj.objectArgs.triangle.y1,
-                          obj.objectArgs.triangle.x2, obj.objectArgs.triangle.y2,
+      judgeSprite.fillTriangle(args.triangle.x0, args.triangle.y0,
+                          args.triangle.x1, args.triangle.y1,
+                          args.triangle.x2, args.triangle.y2,
                           objColor);
       break;
 
     // -------------------- 塗りつぶし --------------------
     case VDS::DrawType::FillRect:
-      judgeSprite.fillRect(obj.objectArgs.rect.x, obj.objectArgs.rect.y,
-                      obj.objectArgs.rect.w, obj.objectArgs.rect.h,
+      judgeSprite.fillRect(args.rect.x, args.rect.y,
+                      args.rect.w, args.rect.h,
                       objColor);
       break;
 
     case VDS::DrawType::FillRoundRect:
-      judgeSprite.fillRoundRect(obj.objectArgs.roundRect.x, obj.objectArgs.roundRect.y,
-                            obj.objectArgs.roundRect.w, obj.objectArgs.roundRect.h,
-                            obj.objectArgs.roundRect.r, objColor);
+      judgeSprite.fillRoundRect(args.roundRect.x, args.roundRect.y,
+                            args.roundRect.w, args.roundRect.h,
+                            args.roundRect.r, objColor);
       break;
 
     case VDS::DrawType::FillCircle:
-      judgeSprite.fillCircle(obj.objectArgs.circle.x, obj.objectArgs.circle.y,
-                        obj.objectArgs.circle.r, objColor);
+      judgeSprite.fillCircle(args.circle.x, args.circle.y,
+                        args.circle.r, objColor);
       break;
 
     case VDS::DrawType::FillTriangle:
-      judgeSprite.fillTriangle(obj.objectArgs.triangle.x0, obj.objectArgs.triangle.y0,
-                          obj.objectArgs.triangle.x1, obj.objectArgs.triangle.y1,
-                          obj.objectArgs.triangle.x2, obj.objectArgs.triangle.y2,
+      judgeSprite.fillTriangle(args.triangle.x0, args.triangle.y0,
+                          args.triangle.x1, args.triangle.y1,
+                          args.triangle.x2, args.triangle.y2,
                           objColor);
       break;
 
     case VDS::DrawType::FillEllipse:
-      judgeSprite.fillEllipse(obj.objectArgs.ellipse.x, obj.objectArgs.ellipse.y,
-                          obj.objectArgs.ellipse.rx, obj.objectArgs.ellipse.ry,
+      judgeSprite.fillEllipse(args.ellipse.x, args.ellipse.y,
+                          args.ellipse.rx, args.ellipse.ry,
                           objColor);
       break;
 
     case VDS::DrawType::FillArc:
-      judgeSprite.fillArc(obj.objectArgs.arc.x, obj.objectArgs.arc.y,
-                      obj.objectArgs.arc.r0, obj.objectArgs.arc.r1,
-                      obj.objectArgs.arc.angle0, obj.objectArgs.arc.angle1,
+      judgeSprite.fillArc(args.arc.x, args.arc.y,
+                      args.arc.r0, args.arc.r1,
+                      args.arc.angle0, args.arc.angle1,
                       objColor);
       break;
 
     case VDS::DrawType::FillEllipseArc:
-      judgeSprite.fillEllipseArc(obj.objectArgs.ellipseArc.x, obj.objectArgs.ellipseArc.y,
-                            obj.objectArgs.ellipseArc.r0x, obj.objectArgs.ellipseArc.r1x,
-                            obj.objectArgs.ellipseArc.r0y, obj.objectArgs.ellipseArc.r1y,
-                            obj.objectArgs.ellipseArc.angle0, obj.objectArgs.ellipseArc.angle1,
+      judgeSprite.fillEllipseArc(args.ellipseArc.x, args.ellipseArc.y,
+                            args.ellipseArc.r0x, args.ellipseArc.r1x,
+                            args.ellipseArc.r0y, args.ellipseArc.r1y,
+                            args.ellipseArc.angle0, args.ellipseArc.angle1,
                             objColor);
       break;
 
     // -------------------- 画像描画 --------------------
     case VDS::DrawType::DrawJpgFile:
-      judgeSprite.fillRect(obj.objectArgs.jpg.x, obj.objectArgs.jpg.y,
-                      obj.objectArgs.jpg.w, obj.objectArgs.jpg.h,
+      judgeSprite.fillRect(args.jpg.x, args.jpg.y,
+                      args.jpg.w, args.jpg.h,
                       objColor);
       break;
 
     case VDS::DrawType::DrawPngFile:
-      judgeSprite.fillRect(obj.objectArgs.png.x, obj.objectArgs.png.y,
-                      obj.objectArgs.png.w, obj.objectArgs.png.h,
+      judgeSprite.fillRect(args.png.x, args.png.y,
+                      args.png.w, args.png.h,
                       objColor);
       break;
 
     case VDS::DrawType::DrawBitmap:
-      judgeSprite.fillRect(obj.objectArgs.bitmap.x, obj.objectArgs.bitmap.y,
-                      obj.objectArgs.bitmap.w, obj.objectArgs.bitmap.h,
+      judgeSprite.fillRect(args.bitmap.x, args.bitmap.y,
+                      args.bitmap.w, args.bitmap.h,
                       objColor);
       break;
 
     // -------------------- 文字描画 --------------------
     case VDS::DrawType::DrawString:
-      if (obj.objectArgs.text.font)
-        judgeSprite.setFont(obj.objectArgs.text.font);
+      if (args.text.font)
+        judgeSprite.setFont(args.text.font);
 
-      judgeSprite.setTextDatum(obj.objectArgs.text.datum);
-      judgeSprite.setTextSize(obj.objectArgs.text.textSize);
-      judgeSprite.setTextWrap(obj.objectArgs.text.textWrap, false);
+      judgeSprite.setTextDatum(args.text.datum);
+      judgeSprite.setTextSize(args.text.textSize);
+      judgeSprite.setTextWrap(args.text.textWrap, false);
 
       judgeSprite.setTextColor(BLACK, objColor);
-      judgeSprite.drawString(obj.objectArgs.text.text,
-                        obj.objectArgs.text.x,
-                        obj.objectArgs.text.y);
+      judgeSprite.drawString(args.text.text,
+                        args.text.x,
+                        args.text.y);
       judgeSprite.setTextColor(objColor, objColor);
-      judgeSprite.drawString(obj.objectArgs.text.text,
-                        obj.objectArgs.text.x,
-                        obj.objectArgs.text.y);
+      judgeSprite.drawString(args.text.text,
+                        args.text.x,
+                        args.text.y);
 
       break;
 
@@ -715,71 +761,127 @@ bool TouchData::drawObjectProcess (const VDS::ObjectData &obj) {
 
 
 bool TouchData::drawPageProcess() {
-  // Z-indexで安定ソート
-  std::vector<VDS::ObjectData> sortedObjects = vData->currentPageCopy.objects;
-  std::stable_sort(sortedObjects.begin(), sortedObjects.end(),
-                    [](const VDS::ObjectData &a, const VDS::ObjectData &b) {
-                      return a.zIndex < b.zIndex;
-                    });
+  VT_PROFILE_SCOPE(FrameStats::Stage::JudgeRebuild);
+  // 描画ページか判定色が変わったときだけ命令列を作り直す
+  uint64_t key = (uint64_t(vData->pageRevision) << 32) | colorRevision;
+  if (!judgeList.isCompiled(key, vData->getVisibleRect(judgeSprite))) compileJudgeList();
 
   judgeSprite.fillSprite(BLACK);
+  judgeList.play(judgeSprite, nullptr, &judgeClip);
+  return true;
+}
 
-  // 描画
-  for (auto &obj : sortedObjects) {
-    drawObjectProcess(obj);
+// 描画中のページを z 順に並べ、判定色で塗る命令列にする（isUntouchable と見えない要素は除く）
+// Clip 系は描画と同じく上の層の要素を制限する（範囲の外は触れても反応しない）
+void TouchData::compileJudgeList() {
+  VT_PROFILE_SCOPE(FrameStats::Stage::ListCompile);
+  VDS::Rect visible = vData->getVisibleRect(judgeSprite);
+  std::vector<VisualData::DrawItem> items;
+  vData->collectDrawOrder(vData->currentPageCopy, items);
+  lastCulled = vData->cullItems(judgeSprite, visible, items, true);
+
+  judgeList.clear();
+  for (const auto& item : items) {
+    VDS::DrawType type;
+    VDS::ObjectArgs args;
+    if (!vData->resolveItem(item, type, args)) continue;
+    if (ClipStack::isClipType(type)) {
+      judgeList.appendClip(type, args, item.zIndex);
+      continue;
+    }
+    judgeList.setLayer(item.zIndex);
+    int objectNum = item.object ? item.object->objectNum : item.instance->objectNum;
+    judgeList.appendJudge(type, args, createOrGetObjectColor(currentPageProcess.pageNum, objectNum, true));
   }
+  judgeList.setSource((uint64_t(vData->pageRevision) << 32) | colorRevision, visible);
+}
+
+// インスタンスはテンプレートの引数を解決してから判定色で塗る
+bool TouchData::drawInstanceProcess (const VDS::InstanceData &inst) {
+  if (inst.isUntouchable) return true;
+
+  const VDS::TemplateData& tmpl = vData->getTemplateData(inst.templateNum);
+  if (tmpl.isEmpty()) return false;
+
+  int objColor = createOrGetObjectColor(currentPageProcess.pageNum, inst.objectNum, true);
+  return drawObjectProcess(tmpl.type, vData->resolveInstance(tmpl, inst), objColor);
+}
+
+// 静的ページはオブジェクトの添字 + 1 を判定色にする（0 は背景）
+bool TouchData::drawStaticPageProcess() {
+  VT_PROFILE_SCOPE(FrameStats::Stage::JudgeRebuild);
+  const StaticUi::Page& page = vData->currentStaticPage;
+
+  judgeSprite.fillSprite(BLACK);
+
+  judgeClip.begin(&judgeSprite);
+  for (uint16_t i = 0; i < page.objectCount; i++) {
+    uint16_t index = page.drawOrder[i];
+    const StaticUi::Object& obj = page.objects[index];
+    if (ClipStack::isClipType(obj.type)) {
+      judgeClip.push(obj.type, obj.args, obj.zIndex);
+      continue;
+    }
+    if (obj.isUntouchable || !judgeClip.enter(obj.zIndex)) continue;
+    drawObjectProcess(obj.type, obj.args, index + 1);
+  }
+  judgeClip.end();
 
   return true;
 }
 
 bool TouchData::judgeProcess(int x, int y) {
-  if (currentPageProcess.isEmpty()) {
-      debugLog.printlnLog(Debug::error, "[ERROR] judgeProcess: currentPageProcess is empty. Cannot judge process.");
+  bool isStatic = vData->isStaticPageDrawing();
+  if (currentPageProcess.isEmpty() && !isStatic) {
+      VT_LOG_ERROR(debugLog, "[ERROR] judgeProcess: currentPageProcess is empty. Cannot judge process.");
       currentPageProcess = TDS::PageData();
       return false;
   }
 
   if (enabledProcess.empty()) {
-      debugLog.printlnLog(Debug::info, "judgeProcess: No enabled processes. currentProcessName cleared.");
+      VT_LOG_INFO(debugLog, "judgeProcess: No enabled processes. currentProcessName cleared.");
       currentPageProcess = TDS::PageData();
       return false;
   }
 
-  drawPageProcess();
-  int color = judgeSprite.readPixel(x, y);
+  if (isStatic) drawStaticPageProcess();
+  else          drawPageProcess();
+  int color;
+  {
+    VT_PROFILE_SCOPE(FrameStats::Stage::JudgeLookup);
+    color = judgeSprite.readPixel(x, y);
+  }
   auto t = M5.Touch.getDetail();
 
-  std::vector<std::pair<String, TDS::TouchType>> candidateProcesses;
+  // プロセス名・種類・対象オブジェクト番号
+  struct Candidate {
+    String name;
+    TDS::TouchType type;
+    int objectNum;
+  };
+  std::vector<Candidate> candidateProcesses;
 
   for (auto procNum : enabledProcess) {
+    if (isStatic) {
+      const StaticUi::Page& page = vData->currentStaticPage;
+      int objectIndex = page.processObject[procNum];
+      if (objectIndex + 1 != color) continue;
+
+      const StaticUi::Process& proc = page.processes[procNum];
+      if (isTouchTypeActive(proc.type, t, proc.multiClickCount)) {
+        candidateProcesses.push_back({ proc.name, proc.type, objectIndex });
+      }
+      continue;
+    }
+
     for (auto& proc : currentPageProcess.processes) {
       if (proc.processNum != procNum) continue;
 
       uint32_t objColor = createOrGetObjectColor(currentPageProcess.pageNum, proc.objectNum, true);
       if (objColor != color) continue;
 
-      bool valid = false;
-      switch(proc.type) {
-        case TDS::TouchType::Press:      valid = t.wasPressed(); break;
-        case TDS::TouchType::Pressing:   valid = t.isPressed(); break;
-        case TDS::TouchType::Pressed:    valid = t.wasReleased(); break;
-        case TDS::TouchType::Release:    valid = t.wasReleased(); break;
-        case TDS::TouchType::Releasing:  valid = t.isReleased(); break;
-        case TDS::TouchType::Hold:       valid = t.wasHold(); break;
-        case TDS::TouchType::Holding:    valid = t.isHolding() && !t.isDragging(); break;
-        case TDS::TouchType::Held:       valid = wasHoldingOld && !t.wasDragged(); break;
-        case TDS::TouchType::Drag:       valid = t.wasDragStart(); break;
-        case TDS::TouchType::Dragging:   valid = t.isDragging(); break;
-        case TDS::TouchType::Dragged:    valid = t.wasDragged(); break;
-        case TDS::TouchType::Flick:      valid = t.wasFlickStart(); break;
-        case TDS::TouchType::Flicking:   valid = t.isFlicking(); break;
-        case TDS::TouchType::Flicked:    valid = t.wasFlicked(); break;
-        case TDS::TouchType::Clicked:    valid = t.wasClicked(); break;
-        case TDS::TouchType::MultiClicked: valid = t.getClickCount() >= proc.multiClickCount; break;
-      }
-
-      if (valid) {
-        candidateProcesses.emplace_back(proc.processName, proc.type);
+      if (isTouchTypeActive(proc.type, t, proc.multiClickCount)) {
+        candidateProcesses.push_back({ proc.processName, proc.type, proc.objectNum });
       }
     }
   }
@@ -808,24 +910,27 @@ bool TouchData::judgeProcess(int x, int y) {
   };
 
   // 優先度でソート（indexが小さいほど優先度高）
-  std::sort(candidateProcesses.begin(), candidateProcesses.end(),
-  [&](const std::pair<String, TDS::TouchType> &a, const std::pair<String, TDS::TouchType> &b) {
-    auto getPriorityIndex = [&](TDS::TouchType tType) -> int {
-      for (size_t i = 0; i < priorityOrder.size(); ++i) {
-        if (priorityOrder[i] == tType) return i;
-      }
-      return INT_MAX;
-    };
-    return getPriorityIndex(a.second) < getPriorityIndex(b.second);
-  });
+  {
+    VT_PROFILE_SCOPE(FrameStats::Stage::CandidateSort);
+    std::sort(candidateProcesses.begin(), candidateProcesses.end(),
+    [&](const Candidate &a, const Candidate &b) {
+      auto getPriorityIndex = [&](TDS::TouchType tType) -> int {
+        for (size_t i = 0; i < priorityOrder.size(); ++i) {
+          if (priorityOrder[i] == tType) return i;
+        }
+        return INT_MAX;
+      };
+      return getPriorityIndex(a.type) < getPriorityIndex(b.type);
+    });
+  }
 
   currentProcessNameVector.clear();
-  for (auto &p : candidateProcesses) currentProcessNameVector.push_back(p.first);
+  for (auto &p : candidateProcesses) currentProcessNameVector.push_back(p.name);
   currentProcessName = currentProcessNameVector.front();
 
   // HeldやactiveButtonの更新
-  auto topType = candidateProcesses.front().second;
-  int topObjectNum = getObjectNumByProcess(getProcessNumByName(candidateProcesses.front().first));
+  auto topType = candidateProcesses.front().type;
+  int topObjectNum = candidateProcesses.front().objectNum;
   currentProcessObject.objectNum = topObjectNum;
   
   if (topType == TDS::TouchType::Press) {
@@ -846,19 +951,46 @@ bool TouchData::judgeProcess(int x, int y) {
 }
 
 
+// タッチ状態が種類の成立条件を満たしているか
+bool TouchData::isTouchTypeActive(TDS::TouchType type, const m5::touch_detail_t& t, int multiClickCount) const {
+  switch(type) {
+    case TDS::TouchType::Press:        return t.wasPressed();
+    case TDS::TouchType::Pressing:     return t.isPressed();
+    case TDS::TouchType::Pressed:      return t.wasReleased();
+    case TDS::TouchType::Release:      return t.wasReleased();
+    case TDS::TouchType::Releasing:    return t.isReleased();
+    case TDS::TouchType::Hold:         return t.wasHold();
+    case TDS::TouchType::Holding:      return t.isHolding() && !t.isDragging();
+    case TDS::TouchType::Held:         return wasHoldingOld && !t.wasDragged();
+    case TDS::TouchType::Drag:         return t.wasDragStart();
+    case TDS::TouchType::Dragging:     return t.isDragging();
+    case TDS::TouchType::Dragged:      return t.wasDragged();
+    case TDS::TouchType::Flick:        return t.wasFlickStart();
+    case TDS::TouchType::Flicking:     return t.isFlicking();
+    case TDS::TouchType::Flicked:      return t.wasFlicked();
+    case TDS::TouchType::Clicked:      return t.wasClicked();
+    case TDS::TouchType::MultiClicked: return t.getClickCount() >= multiClickCount;
+  }
+  return false;
+}
+
 
 bool TouchData::update () {
+  // 前回の update() からを 1 フレームとして締める
+  VT_PROFILE_END_FRAME();
+  TouchLatency::beginUpdate();
+
   // --- タッチセンサーの有効確認 ---
   if (!M5.Touch.isEnabled()) {
-    debugLog.printlnLog(Debug::error, "Touch sensor is disabled. Returning false.");
+    VT_LOG_ERROR(debugLog, "Touch sensor is disabled. Returning false.");
     return false;
   }
 
   // --- 描画ページの取得と設定 ---
   setProcessPage();
 
-  if (currentPageProcess.isEmpty()) {
-    debugLog.printlnLog(Debug::error, "TouchData::update - processPage is null after setProcessPage.");
+  if (currentPageProcess.isEmpty() && !vData->isStaticPageDrawing()) {
+    VT_LOG_ERROR(debugLog, "TouchData::update - processPage is null after setProcessPage.");
     return false;
   }
 
@@ -868,16 +1000,16 @@ bool TouchData::update () {
   // --- タッチ状態に基づいた有効化/無効化処理 ---
   if (t.isPressed()) {
     enableProcess(true);  // Press関連プロセスを有効化
-    debugLog.printlnLog(Debug::info, "TouchData::update - wasPressed -> enabling Press processes.");
+    VT_LOG_INFO(debugLog, "TouchData::update - wasPressed -> enabling Press processes.");
   } else if (t.wasReleased()) {
     enableProcess(false); // Release関連プロセスを有効化
-    debugLog.printlnLog(Debug::info, "TouchData::update - wasReleased -> enabling Release processes.");
+    VT_LOG_INFO(debugLog, "TouchData::update - wasReleased -> enabling Release processes.");
   }
 
   // --- 特殊イベントによるプロセス無効化 ---
   if (t.isPressed()) {  
     if (t.wasFlickStart()) {
-      debugLog.printlnLog(Debug::info, "TouchData::update - Flick start detected.");
+      VT_LOG_INFO(debugLog, "TouchData::update - Flick start detected.");
       disableProcessType(TDS::TouchType::Hold);
       disableProcessType(TDS::TouchType::Holding);
       disableProcessType(TDS::TouchType::Held);
@@ -887,7 +1019,7 @@ bool TouchData::update () {
       disableProcessType(TDS::TouchType::Clicked);
       disableProcessType(TDS::TouchType::MultiClicked);
     } else if (t.wasHold()) {
-      debugLog.printlnLog(Debug::info, "TouchData::update - Hold detected.");
+      VT_LOG_INFO(debugLog, "TouchData::update - Hold detected.");
       disableProcessType(TDS::TouchType::Flick);
       disableProcessType(TDS::TouchType::Flicking);
       disableProcessType(TDS::TouchType::Flicked);
@@ -895,7 +1027,7 @@ bool TouchData::update () {
       disableProcessType(TDS::TouchType::MultiClicked);
 
       if (t.wasDragStart()) {
-        debugLog.printlnLog(Debug::info, "TouchData::update - Drag start detected.");
+        VT_LOG_INFO(debugLog, "TouchData::update - Drag start detected.");
         disableProcessType(TDS::TouchType::Hold);
         disableProcessType(TDS::TouchType::Holding);
         disableProcessType(TDS::TouchType::Held);
@@ -905,9 +1037,9 @@ bool TouchData::update () {
 
   // --- タッチ位置による判定 ---
   bool judged = judgeProcess(t.x, t.y);
+  TouchLatency::resolve(judged);
 
-  debugLog.printlnLog(Debug::info,
-    "TouchData::update - Finished cycle. Judged=" + String(judged));
+  VT_LOG_INFO(debugLog, "TouchData::update - Finished cycle. Judged=%d", int(judged));
 
   return judged; // 判定結果を返す
 }
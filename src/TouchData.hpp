@@ -11,7 +11,12 @@ public:
   using VDS = VisualDataSet;
 
   VisualData* vData;               // VisualData への参照
+  PageCache* pageCache = nullptr;  // 遅延展開モード時のページ目録
   LGFX_Sprite judgeSprite;         // 判定用スプライト
+  VisualData::CullCounts lastCulled;  // 直前に判定用の命令列を作ったときに除いた要素の数
+  DisplayList judgeList;           // 判定用スプライトに塗る命令列
+  ClipStack judgeClip;             // 判定用スプライトに塗るときの Clip の状態
+  uint32_t colorRevision = 0;      // 判定色の割り当てや判定ページを変えるたびに増やす（命令列の作り直し用）
 
   TDS touchDataSet;
   TDS::PageData editingPage;
@@ -99,6 +104,7 @@ public:
   // 5. プロセス有効/無効
   // =========================
   bool enableProcess(bool isPress);
+  bool isEnabledType(TDS::TouchType type, bool isPress) const;
   bool disableProcessType(TDS::TouchType tType);
   void clearEnabledProcessList();
 
@@ -107,7 +113,12 @@ public:
   // =========================
   void setProcessPage();
   bool drawObjectProcess (const VDS::ObjectData &obj);
+  bool drawObjectProcess (VDS::DrawType type, const VDS::ObjectArgs &args, int objColor);
+  bool drawInstanceProcess (const VDS::InstanceData &inst);
   bool drawPageProcess();
+  void compileJudgeList();
+  bool drawStaticPageProcess();
+  bool isTouchTypeActive(TDS::TouchType type, const m5::touch_detail_t& t, int multiClickCount) const;
   bool judgeProcess(int x, int y);
 
   // =========================
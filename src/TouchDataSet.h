@@ -1,3 +1,4 @@
+#pragma once
 #include <Arduino.h>
 #include <M5GFX.h>
 #include <vector>
@@ -0,0 +1,116 @@
+#include "TouchLatency.hpp"
+
+#if VT_LATENCY
+#if defined(ESP_PLATFORM)
+#include <esp_timer.h>
+#else
+#include <chrono>
+#endif
+
+namespace {
+
+  // 1 サンプルの進み具合
+  enum class State : uint8_t {
+    Idle,       // 計測中のサンプルなし
+    Acquired,   // 取得済み、判定待ち
+    Resolved    // プロセス確定済み、受け取り待ち
+  };
+
+  LatencyStats stats;
+  State state = State::Idle;
+  uint32_t acquireUs = 0;
+  uint32_t resolveUs = 0;
+  bool fresh = false;        // acquire() 後まだ update() に使われていない
+  uint32_t dumpIntervalMs = 0;
+  uint32_t lastDumpMs = 0;
+
+  LatencyStats::Histogram& histogram(LatencyStats::Segment s) {
+    return stats.segments[size_t(s)];
+  }
+
+  void dumpIfDue() {
+    if (dumpIntervalMs && millis() - lastDumpMs >= dumpIntervalMs) {
+      lastDumpMs = millis();
+      TouchLatency::dump();
+    }
+  }
+}
+
+uint32_t TouchLatency::now() {
+#if defined(ESP_PLATFORM)
+  return uint32_t(esp_timer_get_time());
+#else
+  using Clock = std::chrono::steady_clock;
+  return uint32_t(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now().time_since_epoch()).count());
+#endif
+}
+
+void TouchLatency::acquire() {
+  if (state == State::Resolved) stats.unobserved++;
+  acquireUs = now();
+  state = State::Acquired;
+  fresh = true;
+}
+
+// アプリが acquire() を呼んでいなければここを取得時刻とする（前回の取得は使い回さない）
+void TouchLatency::beginUpdate() {
+  if (state != State::Acquired || !fresh) acquire();
+  fresh = false;
+}
+
+void TouchLatency::resolve(bool judged) {
+  if (state != State::Acquired) return;
+  if (!judged) {
+    state = State::Idle;
+    return;
+  }
+  resolveUs = now();
+  histogram(Segment::AcquireToResolve).add(resolveUs - acquireUs);
+  stats.resolved++;
+  state = State::Resolved;
+  dumpIfDue();
+}
+
+void TouchLatency::observe() {
+  if (state != State::Resolved) return;
+  uint32_t t = now();
+  histogram(Segment::ResolveToObserve).add(t - resolveUs);
+  histogram(Segment::AcquireToObserve).add(t - acquireUs);
+  state = State::Idle;
+  dumpIfDue();
+}
+
+const LatencyStats& TouchLatency::getStats() {
+  return stats;
+}
+
+void TouchLatency::reset() {
+  stats = LatencyStats();
+  state = State::Idle;
+  fresh = false;
+}
+
+void TouchLatency::setDumpInterval(uint32_t ms) {
+  dumpIntervalMs = ms;
+  lastDumpMs = millis();
+}
+
+void TouchLatency::dump() {
+  Serial.printf("[TouchLatency] resolved=%u unobserved=%u\n", unsigned(stats.resolved), unsigned(stats.unobserved));
+  for (size_t i = 0; i < LatencyStats::SEGMENT_COUNT; i++) {
+    const auto& h = stats.segments[i];
+    if (h.isEmpty()) continue;
+    Serial.printf("  %-16s n %6u min %7u avg %9.1f p50 %7u p90 %7u p99 %7u max %7u us\n",
+                  LatencyStats::segmentName(Segment(i)), unsigned(h.count), unsigned(h.minUs), h.avgUs(),
+                  unsigned(h.percentileUs(50)), unsigned(h.percentileUs(90)), unsigned(h.percentileUs(99)),
+                  unsigned(h.maxUs));
+    Serial.printf("   ");
+    for (size_t b = 0; b < LatencyStats::BUCKET_COUNT; b++) {
+      if (b == LatencyStats::BUCKET_COUNT - 1) Serial.printf(" >=%u:%u", unsigned(LatencyStats::BUCKET_UPPER_US[b - 1]), unsigned(h.buckets[b]));
+      else                                     Serial.printf(" <%u:%u", unsigned(LatencyStats::BUCKET_UPPER_US[b]), unsigned(h.buckets[b]));
+    }
+    Serial.printf("\n");
+  }
+}
+
+#endif
@@ -0,0 +1,41 @@
+#pragma once
+#include <Arduino.h>
+#include "LatencyStats.h"
+
+// タッチ 1 サンプルの取得・解決・受け取りに時刻を付け、区間ごとのヒストグラムに積む
+//
+//   M5.update();
+//   TouchLatency::acquire();          // 省略時は TouchData::update() の先頭を取得時刻とする
+//   if (vt.tData.update()) {
+//     handle(vt.tData.currentProcessName);
+//     TouchLatency::observe();        // アプリが結果を処理し終えた時点
+//   }
+//
+// 時刻は実時間（ホストで仮想時計を使うリプレイでも処理時間そのものを測る）。
+// VT_LATENCY = 0 のときはすべて空の inline 関数になる。
+class TouchLatency {
+public:
+  using Segment = LatencyStats::Segment;
+
+#if VT_LATENCY
+  static uint32_t now();                          // us
+  static void acquire();
+  static void beginUpdate();                      // TouchData::update() の先頭（未取得なら取得扱い）
+  static void resolve(bool judged);               // TouchData::update() の判定後
+  static void observe();
+  static const LatencyStats& getStats();
+  static void reset();
+  static void setDumpInterval(uint32_t ms);       // resolve() / observe() 時に Serial へ出力（0 で無効）
+  static void dump();
+#else
+  static uint32_t now() { return 0; }
+  static void acquire() {}
+  static void beginUpdate() {}
+  static void resolve(bool) {}
+  static void observe() {}
+  static const LatencyStats& getStats() { static const LatencyStats empty; return empty; }
+  static void reset() {}
+  static void setDumpInterval(uint32_t) {}
+  static void dump() {}
+#endif
+};
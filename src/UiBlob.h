@@ -0,0 +1,91 @@
+#pragma once
+
+#include <Arduino.h>
+
+// バイナリ UI ブロブ形式
+// VisualDataSet + TouchDataSet 一式をそのままメモリに置ける固定長レコードで表す。
+// tools/uiblob.py が JSON から生成し、UiBlobLoader が検証のあとレコードを VisualDataSet / TouchDataSet へ
+// 展開する（テキストの解析や setter の重複チェックはしないが、ページ・オブジェクトの配列はコピーして作る）。
+//
+//   [Header][PageRecord x pageCount][ObjectRecord x objectCount][ProcessRecord x processCount][data]
+//
+// - すべてリトルエンディアン・4 バイト境界
+// - 名前・文字列・画像パスは data 領域の NUL 終端文字列（重複は 1 つにまとめ済み）
+//   offset はブロブ先頭からのバイト位置。ページ・オブジェクト・プロセスの名前はロード時に String へ
+//   コピーするが、DrawString の文字列と画像パスはブロブ内を指したままなので、
+//   ブロブはフラッシュ等に常駐させておくこと
+// - ページ内のオブジェクトは zIndex で安定ソート済み
+// - 判定色 (hitColor) は計算済み。外接矩形は文字列の幅がフォントで決まるためロード時に求める
+// - プロセスの対象オブジェクト、子の parentNum は objectNum に解決済み
+// - 親を持つ子の座標は絶対座標・受け継ぐ色は親の色に直し済み（相対位置はロード時に求める）
+namespace UiBlob {
+
+  constexpr uint32_t MAGIC   = 0x42555456; // "VTUB"
+  constexpr uint16_t VERSION = 3;     // 2: ObjectRecord::parentNum を追加 / 3: 使っていなかった bounds を削除
+
+  // ObjectRecord::flags
+  constexpr uint8_t OBJECT_UNTOUCHABLE   = 0x01;
+  constexpr uint8_t OBJECT_INHERIT_COLOR = 0x02;   // 色を親から受け継ぐ（格納する色は受け継いだ後の色）
+
+  // ProcessRecord::flags
+  constexpr uint8_t PROCESS_ENABLE_OVER_BORDER  = 0x01;
+  constexpr uint8_t PROCESS_RETURN_CURRENT_OVER = 0x02;
+
+  struct Header {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t headerSize;      // sizeof(Header)
+    uint32_t totalSize;       // ブロブ全体のバイト数
+    uint16_t pageCount;
+    uint16_t reserved;
+    uint32_t objectCount;
+    uint32_t processCount;
+    uint32_t pageTableOffset;
+    uint32_t objectTableOffset;
+    uint32_t processTableOffset;
+    uint32_t dataOffset;
+  };
+
+  struct PageRecord {
+    int32_t  pageNum;
+    uint32_t nameOffset;
+    uint32_t firstObject;     // ObjectRecord テーブル内の先頭位置
+    uint32_t firstProcess;    // ProcessRecord テーブル内の先頭位置
+    uint16_t objectCount;
+    uint16_t processCount;
+  };
+
+  // args は DrawType ごとに VisualDataSet の *Args 構造体と同じ並びで格納する
+  //   整数のみの Args (Pixel ~ EllipseArc, Clip 系, FlexBox / TableBox) : 構造体をそのままコピー
+  //   JpgFile / PngFile : dataSource, x, y, w, h, maxWidth, maxHeight, offX, offY, scaleX(float), scaleY(float)  / dataOffset = パス
+  //   Bitmap            : x, y, w, h                                    / dataOffset = RGB565 画素列
+  //   String            : x, y, color, bgcolor, datum, textSize, textWrap / dataOffset = 文字列, fontId = フォント番号
+  struct ObjectRecord {
+    uint32_t nameOffset;
+    int32_t  objectNum;
+    uint8_t  drawType;        // VisualDataSet::DrawType
+    uint8_t  zIndex;
+    uint8_t  flags;
+    uint8_t  fontId;          // fontTable の添字（0 = 指定なし）
+    uint32_t hitColor;        // タッチ判定色（0 = プロセスなし）
+    int32_t  args[11];
+    uint32_t dataOffset;      // 0 = なし
+    int32_t  parentNum;       // 親オブジェクトの objectNum（-1 = なし）
+  };
+
+  struct ProcessRecord {
+    uint32_t nameOffset;
+    int32_t  processNum;
+    int32_t  objectNum;
+    uint8_t  touchType;       // TouchDataSet::TouchType
+    uint8_t  flags;
+    uint8_t  multiClickCount;
+    uint8_t  reserved;
+    uint32_t colorCode;
+  };
+
+  static_assert(sizeof(Header)        == 40, "UiBlob::Header layout changed");
+  static_assert(sizeof(PageRecord)    == 20, "UiBlob::PageRecord layout changed");
+  static_assert(sizeof(ObjectRecord)  == 68, "UiBlob::ObjectRecord layout changed");
+  static_assert(sizeof(ProcessRecord) == 20, "UiBlob::ProcessRecord layout changed");
+}
@@ -0,0 +1,367 @@
+#include "UiBlobLoader.hpp"
+#include <cstring>
+
+#if defined(ESP_PLATFORM)
+#include <esp_partition.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using VDS = VisualDataSet;
+using TDS = TouchDataSet;
+
+const lgfx::IFont* const UiBlobLoader::fontTable[] = {
+  nullptr,
+  &fonts::Font0,
+  &fonts::Font2,
+  &fonts::Font4,
+  &fonts::lgfxJapanGothic_12,
+  &fonts::lgfxJapanGothic_16,
+  &fonts::lgfxJapanGothic_20,
+  &fonts::lgfxJapanGothic_24,
+  &fonts::lgfxJapanGothic_28,
+  &fonts::lgfxJapanGothic_32,
+  &fonts::lgfxJapanGothic_36,
+  &fonts::lgfxJapanGothic_40,
+};
+const size_t UiBlobLoader::fontTableSize = sizeof(fontTable) / sizeof(fontTable[0]);
+
+// コンストラクタ
+UiBlobLoader::UiBlobLoader (VisualData* vData, TouchData* tData, bool enableErrorLog, bool enableInfoLog, bool enableSuccessLog){
+  this->vData = vData;
+  this->tData = tData;
+  debugLog.setDebug(enableErrorLog, enableInfoLog, enableSuccessLog);
+}
+
+
+// ヘッダとテーブル範囲、各レコードが指す文字列・データの範囲と種類の値を確認する
+// （壊れた・途中で切れたブロブをロード後に読み進めてマッピングの外へ出ないように）
+bool UiBlobLoader::validate (const uint8_t* blob, size_t size) {
+  if (!blob || size < sizeof(UiBlob::Header)) {
+    VT_LOG_ERROR(debugLog, "UiBlob: too small.");
+    return false;
+  }
+  if (reinterpret_cast<uintptr_t>(blob) % 4 != 0) {
+    VT_LOG_ERROR(debugLog, "UiBlob: not 4-byte aligned.");
+    return false;
+  }
+
+  const auto& h = *reinterpret_cast<const UiBlob::Header*>(blob);
+  if (h.magic != UiBlob::MAGIC || h.version != UiBlob::VERSION || h.headerSize != sizeof(UiBlob::Header)) {
+    VT_LOG_ERROR(debugLog, "UiBlob: bad magic or version.");
+    return false;
+  }
+  if (h.totalSize > size) {
+    VT_LOG_ERROR(debugLog, "UiBlob: truncated.");
+    return false;
+  }
+
+  auto fits = [&](uint32_t offset, uint32_t count, size_t recordSize) {
+    return offset % 4 == 0 && offset <= h.totalSize && uint64_t(count) * recordSize <= h.totalSize - offset;
+  };
+  if (!fits(h.pageTableOffset, h.pageCount, sizeof(UiBlob::PageRecord))
+      || !fits(h.objectTableOffset, h.objectCount, sizeof(UiBlob::ObjectRecord))
+      || !fits(h.processTableOffset, h.processCount, sizeof(UiBlob::ProcessRecord))
+      || h.dataOffset > h.totalSize) {
+    VT_LOG_ERROR(debugLog, "UiBlob: table out of range.");
+    return false;
+  }
+
+  // data 領域内の bytes バイト
+  auto spanFits = [&](uint32_t offset, uint64_t bytes) {
+    return offset >= h.dataOffset && offset <= h.totalSize && bytes <= h.totalSize - offset;
+  };
+  // data 領域内で NUL 終端している文字列（0 は optional のときだけ可）
+  auto stringFits = [&](uint32_t offset, bool optional) {
+    if (offset == 0) return optional;
+    return spanFits(offset, 1) && std::memchr(blob + offset, 0, h.totalSize - offset) != nullptr;
+  };
+
+  const auto* pages = reinterpret_cast<const UiBlob::PageRecord*>(blob + h.pageTableOffset);
+  for (uint16_t i = 0; i < h.pageCount; i++) {
+    if (uint64_t(pages[i].firstObject) + pages[i].objectCount > h.objectCount
+        || uint64_t(pages[i].firstProcess) + pages[i].processCount > h.processCount
+        || !stringFits(pages[i].nameOffset, false)) {
+      VT_LOG_ERROR(debugLog, "UiBlob: page record out of range.");
+      return false;
+    }
+  }
+
+  const auto* objects = reinterpret_cast<const UiBlob::ObjectRecord*>(blob + h.objectTableOffset);
+  for (uint32_t i = 0; i < h.objectCount; i++) {
+    const auto& rec = objects[i];
+    bool ok = rec.drawType <= static_cast<uint8_t>(VDS::DrawType::TableBox) && stringFits(rec.nameOffset, false);
+    if (ok) {
+      switch (static_cast<VDS::DrawType>(rec.drawType)) {
+        case VDS::DrawType::DrawJpgFile:
+        case VDS::DrawType::DrawPngFile:
+        case VDS::DrawType::DrawString:
+          ok = stringFits(rec.dataOffset, true);
+          break;
+        case VDS::DrawType::DrawBitmap:
+          // RGB565 の w x h 画素（2 バイト境界）
+          ok = rec.dataOffset == 0
+            || (rec.args[2] >= 0 && rec.args[3] >= 0 && rec.dataOffset % 2 == 0
+                && spanFits(rec.dataOffset, uint64_t(rec.args[2]) * uint64_t(rec.args[3]) * 2));
+          break;
+        default:
+          break;
+      }
+    }
+    if (!ok) {
+      VT_LOG_ERROR(debugLog, "UiBlob: object record %u is corrupt.", unsigned(i));
+      return false;
+    }
+  }
+
+  const auto* processes = reinterpret_cast<const UiBlob::ProcessRecord*>(blob + h.processTableOffset);
+  for (uint32_t i = 0; i < h.processCount; i++) {
+    if (processes[i].touchType > static_cast<uint8_t>(TDS::TouchType::MultiClicked)
+        || !stringFits(processes[i].nameOffset, false)) {
+      VT_LOG_ERROR(debugLog, "UiBlob: process record %u is corrupt.", unsigned(i));
+      return false;
+    }
+  }
+  return true;
+}
+
+// ブロブ内の文字列（offset 0 は文字列なし。範囲と終端は validate() で確認済み）
+const char* UiBlobLoader::stringAt (const uint8_t* blob, uint32_t offset) {
+  if (offset == 0) return nullptr;
+  return reinterpret_cast<const char*>(blob + offset);
+}
+
+
+// JpgFileArgs / PngFileArgs 共通
+template <typename ImageArgs>
+static void decodeImageArgs (const uint8_t* blob, const UiBlob::ObjectRecord& rec, ImageArgs& img) {
+  const int32_t* a = rec.args;
+  img.dataSource = static_cast<VDS::DataType>(a[0]);
+  img.path = UiBlobLoader::stringAt(blob, rec.dataOffset);
+  img.x = a[1];        img.y = a[2];
+  img.w = a[3];        img.h = a[4];
+  img.maxWidth = a[5]; img.maxHeight = a[6];
+  img.offX = a[7];     img.offY = a[8];
+  std::memcpy(&img.scaleX, &a[9],  sizeof(float));
+  std::memcpy(&img.scaleY, &a[10], sizeof(float));
+}
+
+void UiBlobLoader::decodeObject (const uint8_t* blob, const UiBlob::ObjectRecord& rec, VDS::ObjectData& obj) const {
+  obj.objectNum     = rec.objectNum;
+  obj.objectName    = stringAt(blob, rec.nameOffset);
+  obj.type          = static_cast<VDS::DrawType>(rec.drawType);
+  obj.zIndex        = rec.zIndex;
+  obj.isUntouchable = rec.flags & UiBlob::OBJECT_UNTOUCHABLE;
+  obj.parentNum     = rec.parentNum;
+  obj.inheritColor  = rec.flags & UiBlob::OBJECT_INHERIT_COLOR;
+
+  VDS::ObjectArgs& args = obj.objectArgs;
+  const int32_t* a = rec.args;
+
+  switch (obj.type) {
+    // 整数のみの Args はレコードと同じ並び（memcpy せずにメンバごとに代入する）
+    case VDS::DrawType::DrawPixel:      args.pixel    = VDS::PixelArgs{ a[0], a[1], a[2] }; break;
+    case VDS::DrawType::DrawLine:       args.line     = VDS::LineArgs{ a[0], a[1], a[2], a[3], a[4] }; break;
+    case VDS::DrawType::DrawBezier:     args.bezier   = VDS::BezierArgs{ a[0], a[1], a[2], a[3], a[4], a[5], a[6] }; break;
+    case VDS::DrawType::DrawWideLine:   args.wideLine = VDS::WideLineArgs{ a[0], a[1], a[2], a[3], a[4], a[5] }; break;
+    case VDS::DrawType::DrawRect:
+    case VDS::DrawType::ClipRect:
+    case VDS::DrawType::FillRect:       args.rect      = VDS::RectArgs{ a[0], a[1], a[2], a[3], a[4] }; break;
+    case VDS::DrawType::DrawRoundRect:
+    case VDS::DrawType::ClipRoundRect:
+    case VDS::DrawType::FillRoundRect:  args.roundRect = VDS::RoundRectArgs{ a[0], a[1], a[2], a[3], a[4], a[5] }; break;
+    case VDS::DrawType::DrawCircle:
+    case VDS::DrawType::ClipCircle:
+    case VDS::DrawType::FillCircle:     args.circle    = VDS::CircleArgs{ a[0], a[1], a[2], a[3] }; break;
+    case VDS::DrawType::DrawEllipse:
+    case VDS::DrawType::ClipEllipse:
+    case VDS::DrawType::FillEllipse:    args.ellipse   = VDS::EllipseArgs{ a[0], a[1], a[2], a[3], a[4] }; break;
+    case VDS::DrawType::DrawTriangle:
+    case VDS::DrawType::ClipTriangle:
+    case VDS::DrawType::FillTriangle:   args.triangle  = VDS::TriangleArgs{ a[0], a[1], a[2], a[3], a[4], a[5], a[6] }; break;
+    case VDS::DrawType::DrawArc:
+    case VDS::DrawType::ClipArc:
+    case VDS::DrawType::FillArc:        args.arc       = VDS::ArcArgs{ a[0], a[1], a[2], a[3], a[4], a[5], a[6] }; break;
+    case VDS::DrawType::DrawEllipseArc:
+    case VDS::DrawType::ClipEllipseArc:
+    case VDS::DrawType::FillEllipseArc: args.ellipseArc = VDS::EllipseArcArgs{ a[0], a[1], a[2], a[3], a[4], a[5], a[6], a[7], a[8] }; break;
+    case VDS::DrawType::FlexBox:
+    case VDS::DrawType::TableBox:
+      args.box = VDS::BoxArgs{ a[0], a[1], a[2], a[3], a[4], a[5], a[6], a[7],
+                               static_cast<VDS::BoxDirection>(a[8]), static_cast<VDS::BoxAlign>(a[9]), static_cast<VDS::BoxAlign>(a[10]) };
+      break;
+
+    // 画像はサイズ取得済みなのでファイルを開かない
+    case VDS::DrawType::DrawJpgFile: decodeImageArgs(blob, rec, args.jpg); break;
+    case VDS::DrawType::DrawPngFile: decodeImageArgs(blob, rec, args.png); break;
+
+    case VDS::DrawType::DrawBitmap:
+      args.bitmap.data = rec.dataOffset ? reinterpret_cast<const uint16_t*>(blob + rec.dataOffset) : nullptr;
+      args.bitmap.x = a[0]; args.bitmap.y = a[1];
+      args.bitmap.w = a[2]; args.bitmap.h = a[3];
+      break;
+
+    case VDS::DrawType::DrawString:
+      args.text.x = a[0]; args.text.y = a[1];
+      args.text.text = stringAt(blob, rec.dataOffset);
+      args.text.color = a[2]; args.text.bgcolor = a[3];
+      args.text.datum = static_cast<textdatum_t>(a[4]);
+      args.text.textSize = a[5];
+      args.text.textWrap = a[6] != 0;
+      args.text.font = rec.fontId < fontTableSize ? fontTable[rec.fontId] : nullptr;
+      break;
+
+    default:
+      break;
+  }
+  vData->updateBounds(obj);
+}
+
+void UiBlobLoader::decodePage (const uint8_t* blob, const UiBlob::PageRecord& rec, VDS::PageData& visualPage, TDS::PageData& touchPage, TDS::ocPageData& ocPage) const {
+  const auto& h = *reinterpret_cast<const UiBlob::Header*>(blob);
+  const auto* objects   = reinterpret_cast<const UiBlob::ObjectRecord*>(blob + h.objectTableOffset) + rec.firstObject;
+  const auto* processes = reinterpret_cast<const UiBlob::ProcessRecord*>(blob + h.processTableOffset) + rec.firstProcess;
+
+  visualPage.pageNum  = rec.pageNum;
+  visualPage.pageName = stringAt(blob, rec.nameOffset);
+  visualPage.objects.resize(rec.objectCount);
+
+  ocPage.pageNum = rec.pageNum;
+  ocPage.objectColors.clear();
+
+  for (uint16_t i = 0; i < rec.objectCount; i++) {
+    decodeObject(blob, objects[i], visualPage.objects[i]);
+    if (objects[i].hitColor != 0) {
+      TDS::objectColor oc;
+      oc.objectNum = objects[i].objectNum;
+      oc.colorCode = objects[i].hitColor;
+      ocPage.objectColors.push_back(oc);
+    }
+  }
+  vData->tree.captureLocal(visualPage);
+  vData->dataRevision++;
+  tData->colorRevision++;
+
+  touchPage.pageNum = rec.pageNum;
+  touchPage.processes.resize(rec.processCount);
+  for (uint16_t i = 0; i < rec.processCount; i++) {
+    const auto& pr = processes[i];
+    auto& proc = touchPage.processes[i];
+    proc.processNum        = pr.processNum;
+    proc.processName       = stringAt(blob, pr.nameOffset);
+    proc.objectNum         = pr.objectNum;
+    proc.type              = static_cast<TDS::TouchType>(pr.touchType);
+    proc.enableOverBorder  = pr.flags & UiBlob::PROCESS_ENABLE_OVER_BORDER;
+    proc.returnCurrentOver = pr.flags & UiBlob::PROCESS_RETURN_CURRENT_OVER;
+    proc.multiClickCount   = pr.multiClickCount;
+    proc.colorCode         = pr.colorCode;
+  }
+}
+
+// 重複チェックや setter を経由せず、レコードを直接ページとして展開する
+bool UiBlobLoader::load (const uint8_t* blob, size_t size) {
+  if (!vData || !tData || !validate(blob, size)) return false;
+
+  const auto& h = *reinterpret_cast<const UiBlob::Header*>(blob);
+  const auto* pages = reinterpret_cast<const UiBlob::PageRecord*>(blob + h.pageTableOffset);
+
+  bool replacedDrawing = false;
+  vData->visualDataSet.pages.reserve(vData->visualDataSet.pages.size() + h.pageCount);
+  tData->touchDataSet.pages.reserve(tData->touchDataSet.pages.size() + h.pageCount);
+  tData->touchDataSet.ocPages.reserve(tData->touchDataSet.ocPages.size() + h.pageCount);
+
+  for (uint16_t i = 0; i < h.pageCount; i++) {
+    const int pageNum = pages[i].pageNum;
+
+    // 同じ番号のページがあれば置き換え、なければ末尾に追加
+    VDS::PageData* visualPage = vData->getPageDataRef(pageNum);
+    if (!visualPage) {
+      vData->visualDataSet.pages.emplace_back();
+      visualPage = &vData->visualDataSet.pages.back();
+    }
+    TDS::PageData* touchPage = tData->getPageData(pageNum);
+    if (!touchPage) {
+      tData->touchDataSet.pages.emplace_back();
+      touchPage = &tData->touchDataSet.pages.back();
+    }
+    TDS::ocPageData* ocPage = nullptr;
+    for (auto& oc : tData->touchDataSet.ocPages) {
+      if (oc.pageNum == pageNum) { ocPage = &oc; break; }
+    }
+    if (!ocPage) {
+      tData->touchDataSet.ocPages.emplace_back();
+      ocPage = &tData->touchDataSet.ocPages.back();
+    }
+
+    decodePage(blob, pages[i], *visualPage, *touchPage, *ocPage);
+
+    // 置き換えたページの古い写しが残っていると、次の commit*Edit() で読み込んだ内容を上書きしてしまう
+    if (vData->editingPage.pageNum == pageNum)      vData->editingPage = *visualPage;
+    if (tData->editingPage.pageNum == pageNum)      tData->editingPage = *touchPage;
+    if (tData->currentPageProcess.pageNum == pageNum) tData->currentPageProcess = *touchPage;
+    if (vData->currentPageCopy.pageNum == pageNum)  replacedDrawing = true;
+
+    if (pageNum > vData->lastAssignedPageNum) vData->lastAssignedPageNum = pageNum;
+    for (const auto& proc : touchPage->processes) {
+      if (proc.processNum > tData->lastAssignedProcessNum) tData->lastAssignedProcessNum = proc.processNum;
+    }
+  }
+
+  // 描画中のページを置き換えたら写しを作り直し、次の redrawDirty() で全体を描き直す
+  String drawingName = vData->currentPageCopy.pageName;
+  if (replacedDrawing && vData->setDrawingPage(drawingName) && vData->display) {
+    vData->markDirty(VDS::Rect{ 0, 0, vData->display->width(), vData->display->height() });
+  }
+
+  VT_LOG_SUCCESS(debugLog, "UiBlob loaded. pages=%u objects=%u processes=%u",
+    unsigned(h.pageCount), unsigned(h.objectCount), unsigned(h.processCount));
+  return true;
+}
+
+
+// データパーティションをメモリにマップする（ラベルは partitions.csv の名前）
+const uint8_t* UiBlobLoader::mapPartition (const char* label, size_t* size) {
+#if defined(ESP_PLATFORM)
+  const esp_partition_t* part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+  if (!part) return nullptr;
+
+  const void* ptr = nullptr;
+  spi_flash_mmap_handle_t handle;
+  if (esp_partition_mmap(part, 0, part->size, SPI_FLASH_MMAP_DATA, &ptr, &handle) != ESP_OK) return nullptr;
+
+  const auto* h = static_cast<const UiBlob::Header*>(ptr);
+  if (size) *size = (h->magic == UiBlob::MAGIC && h->totalSize <= part->size) ? h->totalSize : part->size;
+  return static_cast<const uint8_t*>(ptr);
+#else
+  (void)label;
+  (void)size;
+  return nullptr;
+#endif
+}
+
+// ファイルを読み取り専用でメモリにマップする（ホスト用）
+const uint8_t* UiBlobLoader::mapFile (const char* path, size_t* size) {
+#if defined(ESP_PLATFORM)
+  (void)path;
+  (void)size;
+  return nullptr;
+#else
+  int fd = ::open(path, O_RDONLY);
+  if (fd < 0) return nullptr;
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+    ::close(fd);
+    return nullptr;
+  }
+  void* ptr = ::mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (ptr == MAP_FAILED) return nullptr;
+
+  if (size) *size = size_t(st.st_size);
+  return static_cast<const uint8_t*>(ptr);
+#endif
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include "VisualData.hpp"
+#include "TouchData.hpp"
+#include "UiBlob.h"
+
+class UiBlobLoader {
+public:
+  Debug debugLog;
+  using VDS = VisualDataSet;
+  using TDS = TouchDataSet;
+
+  VisualData* vData;
+  TouchData* tData;
+
+  // DrawString の fontId に対応するフォント（tools/uiblob.py の FONTS と同じ並び）
+  static const lgfx::IFont* const fontTable[];
+  static const size_t fontTableSize;
+
+  UiBlobLoader(VisualData* vData, TouchData* tData, bool enableErrorLog, bool enableInfoLog, bool enableSuccessLog);
+
+  // 形式チェック
+  bool validate(const uint8_t* blob, size_t size);
+
+  // ブロブ内の全ページを visualDataSet / touchDataSet に取り込む（同じ pageNum は置き換え）
+  bool load(const uint8_t* blob, size_t size);
+
+  // ブロブを読み取り専用でメモリに割り当てる（実機: データパーティション / ホスト: ファイル）
+  static const uint8_t* mapPartition(const char* label, size_t* size);
+  static const uint8_t* mapFile(const char* path, size_t* size);
+
+  // 1 ページ分のレコードを展開する
+  void decodePage(const uint8_t* blob, const UiBlob::PageRecord& rec, VDS::PageData& visualPage, TDS::PageData& touchPage, TDS::ocPageData& ocPage) const;
+  void decodeObject(const uint8_t* blob, const UiBlob::ObjectRecord& rec, VDS::ObjectData& obj) const;
+
+  static const char* stringAt(const uint8_t* blob, uint32_t offset);
+};
@@ -1,10 +1,12 @@
 #include "VisualData.hpp"
+#include "PageCache.hpp"
+#include "FrameProfiler.hpp"
 using VDS = VisualDataSet;
 
 // コンストラクタ
-VisualData::VisualData (LovyanGFX* parent, bool enableErrorLog, bool enableInfoLog, bool enableSuccessLog){
+VisualData::VisualData (LovyanGFX* parent, bool enableErrorLog, bool enableInfoLog, bool enableSuccessLog)
+  : display(parent), clipSprite(parent), clipStack(this), layout(this), tree(this){
   debugLog.setDebug(enableErrorLog, enableInfoLog, enableSuccessLog);
-  clipSprite = new LGFX_Sprite(parent);
 }
 
 
@@ -13,14 +15,15 @@ bool VisualData::isExistsPage (int pageNum) const {
   for (const auto& page : visualDataSet.pages) {
     if (!page.isEmpty() && page.pageNum == pageNum) return true;
   }
-  return false;
+  // 未展開のページも存在扱い
+  return pageCache && pageCache->hasPage(pageNum);
 }
 // ページ名の重複チェック
 bool VisualData::isExistsPageName (const String& name) const {
   for (const auto& page : visualDataSet.pages) {
     if (page.pageName == name) return true;
   }
-  return false;
+  return pageCache && pageCache->hasPageName(name);
 }
 // オブジェクト番号が編集ページ内に存在するか
 bool VisualData::isExistsObject(int objNum, int pageNum) const {
@@ -36,6 +39,9 @@ bool VisualData::isExistsObject(int objNum, int pageNum) const {
   for (const auto& obj : page->objects) {
     if (obj.objectNum == objNum) return true;
   }
+  for (const auto& inst : page->instances) {
+    if (inst.objectNum == objNum) return true;
+  }
 
   return false;
 }
@@ -55,12 +61,40 @@ bool VisualData::isExistsObjectName(const String& objectName, int pageNum) const
   for (const auto& obj : page->objects) {
     if (obj.objectName == objectName) return true;
   }
+  for (const auto& inst : page->instances) {
+    if (inst.objectName == objectName) return true;
+  }
 
   return false;
 }
 
-//bool VisualData::isExistsParent (int pageNum, int objNum) const {}
-//bool VisualData::isExistsChild (int pageNum, int objNum) const {}
+// オブジェクトが親を持ち、その親がページ内に存在するか（pageNum が -1 の場合は編集中ページ）
+bool VisualData::isExistsParent (int pageNum, int objNum) const {
+  const VDS::PageData& page = (pageNum < 0) ? editingPage : getPageData(pageNum);
+  if (page.isEmpty()) return false;
+
+  int parentNum = -1;
+  for (const auto& obj : page.objects) {
+    if (obj.objectNum == objNum) parentNum = obj.parentNum;
+  }
+  for (const auto& inst : page.instances) {
+    if (inst.objectNum == objNum) parentNum = inst.parentNum;
+  }
+  return parentNum >= 0 && isExistsObject(parentNum, page.pageNum);
+}
+// オブジェクトを親とする子がページ内に存在するか
+bool VisualData::isExistsChild (int pageNum, int objNum) const {
+  const VDS::PageData& page = (pageNum < 0) ? editingPage : getPageData(pageNum);
+  if (page.isEmpty() || objNum < 0) return false;
+
+  for (const auto& obj : page.objects) {
+    if (obj.parentNum == objNum) return true;
+  }
+  for (const auto& inst : page.instances) {
+    if (inst.parentNum == objNum) return true;
+  }
+  return false;
+}
 
 // 編集ページが存在するか（空ページでないか）
 bool VisualData::isExistsEditingPage () const {
@@ -73,7 +107,7 @@ int VisualData::getPageNumByName(const String& name) const {
   for (const auto& page : visualDataSet.pages) {
     if (page.pageName == name) return page.pageNum;
   }
-  return -1;
+  return pageCache ? pageCache->getPageNumByName(name) : -1;
 }
 
 // オブジェクト名から objectNum を取得（存在しなければ -1）
@@ -91,6 +125,9 @@ int VisualData::getObjectNumByName(const String& objectName, int pageNum) const
   for (const auto& obj : page->objects) {
     if (obj.objectName == objectName) return obj.objectNum;
   }
+  for (const auto& inst : page->instances) {
+    if (inst.objectName == objectName) return inst.objectNum;
+  }
 
   return -1;
 }
@@ -125,7 +162,9 @@ const VDS::ObjectData& VisualData::getObjectData(const VDS::PageData& page, int
   return dummyObj;
 }
 
+// 書き換えられるものとして扱う（描画中ページの命令列を次の drawPage() で作り直す）
 std::vector<VDS::PageData>& VisualData::getVisualDataRef() {
+  dataRevision++;
   return visualDataSet.pages;
 }
 VDS::PageData* VisualData::getPageDataRef(int pageNum) {
@@ -179,6 +218,7 @@ bool VisualData::addPage (const char* name, int pageNum) {
   newPage.pageName = pageNameStr;
 
   visualDataSet.pages.push_back(newPage);
+  dataRevision++;
 
   return changeEditPage(pageNum);
 }
@@ -193,6 +233,7 @@ bool VisualData::commitVisualEdit() {
   } else {
     visualDataSet.pages.push_back(editingPage);
   }
+  dataRevision++;
   return true;
 }
 
@@ -201,10 +242,14 @@ bool VisualData::changeEditPage (int pageNum) {
   // 編集中のデータを visualDataSet に同期
   commitVisualEdit();
 
+  // 未展開のページならここで展開（編集ページの間は破棄しない）
+  if (pageCache) pageCache->require(pageNum);
+
   // 指定ページが存在するかチェック
   if(isExistsPage(pageNum)){
     auto target = getPageDataRef(pageNum);
     editingPage = *target; // 編集ページを切り替え
+    if (pageCache) pageCache->evictToBudget();   // 前の編集ページが破棄可能になる
     return true;
   }
 
@@ -213,9 +258,11 @@ bool VisualData::changeEditPage (int pageNum) {
 
 // ページ削除
 bool VisualData::deletePage (int pageNum) {
+  bool forgotten = pageCache && pageCache->forgetPage(pageNum);
   for (auto it = visualDataSet.pages.begin(); it != visualDataSet.pages.end(); ++it) {
     if (it->pageNum == pageNum) {
       visualDataSet.pages.erase(it);
+      dataRevision++;
 
       // 削除したページが編集中だった場合は編集中をリセット
       if (editingPage.pageNum == pageNum) {
@@ -224,11 +271,12 @@ bool VisualData::deletePage (int pageNum) {
       return true;
     }
   }
-  return false; // ページが見つからない
+  return forgotten; // ページが見つからない
 }
 
 // 現在描画中のページ名を返す
 String VisualData::getDrawingPage () const {
+  if (!currentStaticPage.isEmpty()) return currentStaticPage.name;
   if (currentPageCopy.isEmpty()) {
     return ""; // 何も描画していない場合
   }
@@ -241,7 +289,7 @@ VDS::ObjectData VisualData::checkCreatable(const String& objectName, bool onDisp
 
   // 編集中ページが無い場合
   if (!isExistsEditingPage()) {
-    debugLog.printlnLog(debugLog.error, "No editing page available.");
+    VT_LOG_ERROR(debugLog, "No editing page available.");
     return result;  // 空データ
   }
 
@@ -250,20 +298,20 @@ VDS::ObjectData VisualData::checkCreatable(const String& objectName, bool onDisp
   // 既存オブジェクトがある場合 → 上書き用に取得して返す
   for (auto& obj : target) {
     if (obj.objectName == objectName) {
-      debugLog.printlnLog(debugLog.info, "[" + objectName + "] already exists. Will overwrite.");
+      VT_LOG_INFO(debugLog, "[%s] already exists. Will overwrite.", objectName.c_str());
       return obj;
     }
   }
 
   // 新規作成可能 → 空の ObjectData に名前をセットして返す
   result.objectName = objectName;
-  debugLog.printlnLog(debugLog.info, "[" + objectName + "] is creatable (new object).");
+  VT_LOG_INFO(debugLog, "[%s] is creatable (new object).", objectName.c_str());
   return result;
 }
 
 bool VisualData::deleteObject(const String& objectName, bool onDisplay) {
   if (!isExistsEditingPage()) {
-    debugLog.printlnLog(debugLog.error, "No editing page available.");
+    VT_LOG_ERROR(debugLog, "No editing page available.");
     return false;
   }
 
@@ -278,15 +326,26 @@ bool VisualData::deleteObject(const String& objectName, bool onDisplay) {
     }
   }
 
-  if (objIndex < 0) {
-    debugLog.printlnLog(debugLog.error, "[" + objectName + "] does not exist.");
-    return false;
+  if (objIndex >= 0) {
+    // 削除処理（順番は保たれる）
+    objs.erase(objs.begin() + objIndex);
+  } else {
+    // インスタンスも対象
+    auto& insts = onDisplay ? currentPageCopy.instances : editingPage.instances;
+    auto it = std::find_if(insts.begin(), insts.end(),
+                           [&objectName](const VDS::InstanceData& inst) { return inst.objectName == objectName; });
+    if (it == insts.end()) {
+      VT_LOG_ERROR(debugLog, "[%s] does not exist.", objectName.c_str());
+      return false;
+    }
+    insts.erase(it);
   }
 
-  // 削除処理（順番は保たれる）
-  objs.erase(objs.begin() + objIndex);
-
-  debugLog.printlnLog(debugLog.success, "[" + objectName + "] has been deleted.");
+  VT_LOG_SUCCESS(debugLog, "[%s] has been deleted.", objectName.c_str());
+  if (onDisplay) {
+    pageRevision++;
+    tree.invalidate();
+  }
 
   if (!isBatchUpdating && !onDisplay) {
     commitVisualEdit();
@@ -296,7 +355,7 @@ bool VisualData::deleteObject(const String& objectName, bool onDisplay) {
 
 bool VisualData::moveObject(const String& objectName, size_t newIndex, bool onDisplay) {
   if (!isExistsEditingPage()) {
-    debugLog.printlnLog(debugLog.error, "No editing page available.");
+    VT_LOG_ERROR(debugLog, "No editing page available.");
     return false;
   }
 
@@ -312,7 +371,7 @@ bool VisualData::moveObject(const String& objectName, size_t newIndex, bool onDi
   }
 
   if (currentIndex < 0) {
-    debugLog.printlnLog(debugLog.error, "[" + objectName + "] does not exist.");
+    VT_LOG_ERROR(debugLog, "[%s] does not exist.", objectName.c_str());
     return false;
   }
 
@@ -329,8 +388,11 @@ bool VisualData::moveObject(const String& objectName, size_t newIndex, bool onDi
   // 新しい位置に挿入
   objs.insert(objs.begin() + newIndex, obj);
 
-  debugLog.printlnLog(debugLog.info, "[" + objectName + "] moved from " +
-    String(currentIndex) + " to " + String(newIndex) + ".");
+  VT_LOG_INFO(debugLog, "[%s] moved from %u to %u.", objectName.c_str(), unsigned(currentIndex), unsigned(newIndex));
+  if (onDisplay) {
+    pageRevision++;
+    tree.invalidate();
+  }
 
   if (!isBatchUpdating && !onDisplay) {
     commitVisualEdit();
@@ -343,38 +405,71 @@ bool VisualData::moveObject(const String& objectName, size_t newIndex, bool onDi
 
 
 
+// オブジェクトとインスタンスで重複しない次の番号
+int VisualData::nextObjectNum (const VDS::PageData& page) const {
+  int num = 0;
+  for (const auto& obj : page.objects)    if (obj.objectNum >= num)  num = obj.objectNum + 1;
+  for (const auto& inst : page.instances) if (inst.objectNum >= num) num = inst.objectNum + 1;
+  return num;
+}
+
 VDS::ObjectData& VisualData::createOrUpdateObject (VDS::DrawType type, const String& objectName, const VDS::ObjectArgs& args, uint8_t zIndex, bool isUntouchable, bool onDisplay) {
   VDS::PageData* targetPage = onDisplay ? &currentPageCopy : &editingPage;
 
   if (!targetPage || targetPage->isEmpty()) {
     static VDS::ObjectData dummy;
-    debugLog.printlnLog(debugLog.error, "No target page available.");
+    VT_LOG_ERROR(debugLog, "No target page available.");
     return dummy;
   }
 
   // 既存オブジェクトがある場合 → 上書き
   for (auto& obj : targetPage->objects) {
     if (obj.objectName == objectName) {
+      if (obj.type != type) tree.invalidate();
       obj.type = type;
       obj.objectArgs = args;
       obj.zIndex = zIndex;
       obj.isUntouchable = isUntouchable;
-      debugLog.printlnLog(debugLog.info, "[" + objectName + "] updated in place.");
+
+      // コンテナ以外の親を持つ子は、親の基準座標からの相対座標として受け取る
+      const VDS::ObjectData* parent = obj.parentNum >= 0 ? getObjectDataRef(targetPage, obj.parentNum) : nullptr;
+      int32_t px, py, cx, cy;
+      if (parent && !LayoutEngine::isContainerType(parent->type)
+          && getArgsOrigin(parent->type, parent->objectArgs, px, py) && getArgsOrigin(obj.type, obj.objectArgs, cx, cy)) {
+        obj.localX = cx;
+        obj.localY = cy;
+        translateArgs(obj.type, obj.objectArgs, px, py);
+      }
+      updateBounds(obj);
+      VT_LOG_INFO(debugLog, "[%s] updated in place.", objectName.c_str());
+      if (onDisplay) {
+        pageRevision++;
+        tree.update(currentPageCopy, true);   // 子を持つなら追従させる
+      }
       return obj;
     }
   }
+  for (const auto& inst : targetPage->instances) {
+    if (inst.objectName == objectName) {
+      static VDS::ObjectData dummy;
+      VT_LOG_ERROR(debugLog, "[%s] is already used by an instance.", objectName.c_str());
+      return dummy;
+    }
+  }
 
   // 新規追加
   VDS::ObjectData newObj;
-  newObj.objectNum     = targetPage->objects.size();
+  newObj.objectNum     = nextObjectNum(*targetPage);
   newObj.objectName    = objectName;
   newObj.type          = type;
   newObj.objectArgs    = args;
   newObj.zIndex        = zIndex;
   newObj.isUntouchable = isUntouchable;
+  updateBounds(newObj);
 
   targetPage->objects.push_back(newObj);
   VDS::ObjectData& result = targetPage->objects.back();
+  if (onDisplay) pageRevision++;
 
   if (!isBatchUpdating && !onDisplay) {
     commitVisualEdit();
@@ -625,7 +720,1181 @@ VDS::ObjectData VisualData::setDrawStringObject( const String& objectName, int32
   return createOrUpdateObject(VDS::DrawType::DrawString, objectName, args, zIndex, isUntouchable, onDisplay);
 }
 
+// =========================
+// 範囲制限（Clip 系）
+// =========================
+// 何も描かず判定色も持たない（isUntouchable 固定）。color は使わないので 0 にしておく
+VDS::ObjectData VisualData::setClipRectObject (const String& objectName, int32_t x, int32_t y, int32_t w, int32_t h, uint8_t zIndex, bool onDisplay) {
+  VDS::ObjectArgs args;
+  args.rect.x = x; args.rect.y = y;
+  args.rect.w = w; args.rect.h = h;
+  args.rect.color = 0;
+  return createOrUpdateObject(VDS::DrawType::ClipRect, objectName, args, zIndex, true, onDisplay);
+}
+
+VDS::ObjectData VisualData::setClipRoundRectObject (const String& objectName, int32_t x, int32_t y, int32_t w, int32_t h, int32_t r, uint8_t zIndex, bool onDisplay) {
+  VDS::ObjectArgs args;
+  args.roundRect.x = x; args.roundRect.y = y;
+  args.roundRect.w = w; args.roundRect.h = h;
+  args.roundRect.r = r;
+  args.roundRect.color = 0;
+  return createOrUpdateObject(VDS::DrawType::ClipRoundRect, objectName, args, zIndex, true, onDisplay);
+}
+
+VDS::ObjectData VisualData::setClipCircleObject (const String& objectName, int32_t x, int32_t y, int32_t r, uint8_t zIndex, bool onDisplay) {
+  VDS::ObjectArgs args;
+  args.circle.x = x; args.circle.y = y;
+  args.circle.r = r;
+  args.circle.color = 0;
+  return createOrUpdateObject(VDS::DrawType::ClipCircle, objectName, args, zIndex, true, onDisplay);
+}
+
+VDS::ObjectData VisualData::setClipEllipseObject (const String& objectName, int32_t x, int32_t y, int32_t rx, int32_t ry, uint8_t zIndex, bool onDisplay) {
+  VDS::ObjectArgs args;
+  args.ellipse.x = x; args.ellipse.y = y;
+  args.ellipse.rx = rx; args.ellipse.ry = ry;
+  args.ellipse.color = 0;
+  return createOrUpdateObject(VDS::DrawType::ClipEllipse, objectName, args, zIndex, true, onDisplay);
+}
+
+VDS::ObjectData VisualData::setClipTriangleObject (const String& objectName, int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint8_t zIndex, bool onDisplay) {
+  VDS::ObjectArgs args;
+  args.triangle.x0 = x0; args.triangle.y0 = y0;
+  args.triangle.x1 = x1; args.triangle.y1 = y1;
+  args.triangle.x2 = x2; args.triangle.y2 = y2;
+  args.triangle.color = 0;
+  return createOrUpdateObject(VDS::DrawType::ClipTriangle, objectName, args, zIndex, true, onDisplay);
+}
+
+VDS::ObjectData VisualData::setClipArcObject (const String& objectName, int32_t x, int32_t y, int32_t r0, int32_t r1, int32_t angle0, int32_t angle1, uint8_t zIndex, bool onDisplay) {
+  VDS::ObjectArgs args;
+  args.arc.x = x; args.arc.y = y;
+  args.arc.r0 = r0; args.arc.r1 = r1;
+  args.arc.angle0 = angle0; args.arc.angle1 = angle1;
+  args.arc.color = 0;
+  return createOrUpdateObject(VDS::DrawType::ClipArc, objectName, args, zIndex, true, onDisplay);
+}
+
+VDS::ObjectData VisualData::setClipEllipseArcObject (const String& objectName, int32_t x, int32_t y, int32_t r0x, int32_t r1x, int32_t r0y, int32_t r1y, int32_t angle0, int32_t angle1, uint8_t zIndex, bool onDisplay) {
+  VDS::ObjectArgs args;
+  args.ellipseArc.x = x; args.ellipseArc.y = y;
+  args.ellipseArc.r0x = r0x; args.ellipseArc.r1x = r1x;
+  args.ellipseArc.r0y = r0y; args.ellipseArc.r1y = r1y;
+  args.ellipseArc.angle0 = angle0; args.ellipseArc.angle1 = angle1;
+  args.ellipseArc.color = 0;
+  return createOrUpdateObject(VDS::DrawType::ClipEllipseArc, objectName, args, zIndex, true, onDisplay);
+}
+
+// =========================
+// コンテナ（FlexBox / TableBox）
+// =========================
+// 何も描かず判定色も持たない（isUntouchable 固定）。子は setLayoutParent() で入れる
+VDS::ObjectData VisualData::setFlexBoxObject (const String& objectName, int32_t x, int32_t y, int32_t w, int32_t h, VDS::BoxDirection direction, int32_t gap, int32_t padding, VDS::BoxAlign justify, VDS::BoxAlign align, uint8_t zIndex, bool onDisplay) {
+  VDS::ObjectArgs args;
+  args.box = VDS::BoxArgs();
+  args.box.x = x; args.box.y = y;
+  args.box.w = w; args.box.h = h;
+  args.box.gap = gap; args.box.padding = padding;
+  args.box.direction = direction;
+  args.box.justify = justify; args.box.align = align;
+  return createOrUpdateObject(VDS::DrawType::FlexBox, objectName, args, zIndex, true, onDisplay);
+}
+
+VDS::ObjectData VisualData::setTableBoxObject (const String& objectName, int32_t x, int32_t y, int32_t w, int32_t h, int32_t columns, int32_t rows, int32_t gap, int32_t padding, VDS::BoxAlign justify, VDS::BoxAlign align, uint8_t zIndex, bool onDisplay) {
+  VDS::ObjectArgs args;
+  args.box = VDS::BoxArgs();
+  args.box.x = x; args.box.y = y;
+  args.box.w = w; args.box.h = h;
+  args.box.columns = columns; args.box.rows = rows;
+  args.box.gap = gap; args.box.padding = padding;
+  args.box.justify = justify; args.box.align = align;
+  return createOrUpdateObject(VDS::DrawType::TableBox, objectName, args, zIndex, true, onDisplay);
+}
+
+// 子をコンテナに入れる（containerName が空なら外す）。並ぶ順はページ内の並び順（moveObject で変更）
+bool VisualData::setLayoutParent (const String& objectName, const String& containerName, bool onDisplay) {
+  if (containerName.length() > 0) {
+    const VDS::ObjectData* container = nullptr;
+    for (const auto& obj : (onDisplay ? currentPageCopy : editingPage).objects) {
+      if (obj.objectName == containerName) container = &obj;
+    }
+    if (!container || !LayoutEngine::isContainerType(container->type)) {
+      VT_LOG_ERROR(debugLog, "[%s] is not a container.", containerName.c_str());
+      return false;
+    }
+  }
+  return setParent(objectName, containerName, false, onDisplay);
+}
+
+// 親を設定する（parentName が空なら外し、今の絶対座標のまま残す）
+// 親がコンテナ以外なら子の今の座標を親の基準座標からの相対位置として扱い（すでに親を持つ子は相対位置を持ち越す）、
+// 以後は親が動くと追従する。inheritColor を立てると色も親から受け継ぐ。インスタンスの親はコンテナのみ
+bool VisualData::setParent (const String& objectName, const String& parentName, bool inheritColor, bool onDisplay) {
+  VDS::PageData* targetPage = onDisplay ? &currentPageCopy : &editingPage;
+  if (targetPage->isEmpty()) {
+    VT_LOG_ERROR(debugLog, "No target page available.");
+    return false;
+  }
+
+  const VDS::ObjectData* parent = nullptr;
+  if (parentName.length() > 0) {
+    for (const auto& obj : targetPage->objects) {
+      if (obj.objectName == parentName) parent = &obj;
+    }
+    if (!parent) {
+      VT_LOG_ERROR(debugLog, "[%s] does not exist.", parentName.c_str());
+      return false;
+    }
+  }
+  int parentNum = parent ? parent->objectNum : -1;
+  bool isRelative = parent && !LayoutEngine::isContainerType(parent->type);
+
+  bool found = false;
+  for (auto& obj : targetPage->objects) {
+    if (obj.objectName != objectName) continue;
+    // 自分自身・自分の子孫は親にできない
+    for (int p = parentNum; p >= 0; ) {
+      if (p == obj.objectNum) {
+        VT_LOG_ERROR(debugLog, "[%s] cannot be placed inside itself.", objectName.c_str());
+        return false;
+      }
+      const VDS::ObjectData* ancestor = getObjectDataRef(targetPage, p);
+      p = ancestor ? ancestor->parentNum : -1;
+    }
+
+    if (isRelative) {
+      const VDS::ObjectData* current = obj.parentNum >= 0 ? getObjectDataRef(targetPage, obj.parentNum) : nullptr;
+      bool hadRelative = current && !LayoutEngine::isContainerType(current->type);
+      int32_t px, py, cx, cy;
+      if (getArgsOrigin(parent->type, parent->objectArgs, px, py) && getArgsOrigin(obj.type, obj.objectArgs, cx, cy)) {
+        if (!hadRelative) {
+          obj.localX = cx;
+          obj.localY = cy;
+        }
+        translateArgs(obj.type, obj.objectArgs, px + obj.localX - cx, py + obj.localY - cy);
+        updateBounds(obj);
+      }
+    }
+    obj.parentNum = parentNum;
+    obj.inheritColor = inheritColor;
+    found = true;
+  }
+  for (auto& inst : targetPage->instances) {
+    if (inst.objectName != objectName) continue;
+    if (isRelative) {
+      VT_LOG_ERROR(debugLog, "[%s] is an instance. Only a container can be its parent.", objectName.c_str());
+      return false;
+    }
+    inst.parentNum = parentNum;
+    found = true;
+  }
+  if (!found) {
+    VT_LOG_ERROR(debugLog, "[%s] does not exist.", objectName.c_str());
+    return false;
+  }
+
+  if (onDisplay) {
+    pageRevision++;
+    tree.invalidate();
+    tree.update(currentPageCopy, false);
+  } else if (!isBatchUpdating) {
+    commitVisualEdit();
+  }
+  return true;
+}
+
+// =========================
+// テンプレート / インスタンス
+// =========================
+// テンプレートを登録（同名があれば引数を差し替え、インスタンスにも反映される）
+bool VisualData::setObjectTemplate (const String& templateName, VDS::DrawType type, const VDS::ObjectArgs& args) {
+  for (auto& tmpl : visualDataSet.templates) {
+    if (tmpl.templateName == templateName) {
+      tmpl.type = type;
+      tmpl.objectArgs = args;
+      dataRevision++;
+      VT_LOG_INFO(debugLog, "template [%s] updated.", templateName.c_str());
+      return true;
+    }
+  }
+
+  VDS::TemplateData tmpl;
+  tmpl.templateNum  = visualDataSet.templates.size();
+  tmpl.templateName = templateName;
+  tmpl.type         = type;
+  tmpl.objectArgs   = args;
+  visualDataSet.templates.push_back(tmpl);
+  dataRevision++;
+
+  VT_LOG_SUCCESS(debugLog, "template [%s] created.", templateName.c_str());
+  return true;
+}
+
+int VisualData::getTemplateNumByName (const String& templateName) const {
+  for (const auto& tmpl : visualDataSet.templates) {
+    if (tmpl.templateName == templateName) return tmpl.templateNum;
+  }
+  return -1;
+}
+
+const VDS::TemplateData& VisualData::getTemplateData (int templateNum) const {
+  if (templateNum >= 0 && templateNum < (int)visualDataSet.templates.size()) {
+    return visualDataSet.templates[templateNum];
+  }
+  static VDS::TemplateData dummyTemplate;
+  return dummyTemplate;
+}
+
+const VDS::InstanceData* VisualData::getInstanceData (const VDS::PageData& page, int objNum) const {
+  for (const auto& inst : page.instances) {
+    if (inst.objectNum == objNum) return &inst;
+  }
+  return nullptr;
+}
+
+// インスタンスを作成・更新（text / color は指定したときだけテンプレートを上書き）
+VDS::InstanceData VisualData::setInstanceObject (const String& objectName, const String& templateName,
+                                                 int32_t dx, int32_t dy, const char* text, int color,
+                                                 uint8_t zIndex, bool isUntouchable, bool onDisplay) {
+  VDS::PageData* targetPage = onDisplay ? &currentPageCopy : &editingPage;
+
+  if (targetPage->isEmpty()) {
+    VT_LOG_ERROR(debugLog, "No target page available.");
+    return VDS::InstanceData();
+  }
+
+  int templateNum = getTemplateNumByName(templateName);
+  if (templateNum < 0) {
+    VT_LOG_ERROR(debugLog, "template [%s] does not exist.", templateName.c_str());
+    return VDS::InstanceData();
+  }
+
+  for (const auto& obj : targetPage->objects) {
+    if (obj.objectName == objectName) {
+      VT_LOG_ERROR(debugLog, "[%s] is already used by an object.", objectName.c_str());
+      return VDS::InstanceData();
+    }
+  }
+
+  VDS::InstanceData* inst = nullptr;
+  for (auto& existing : targetPage->instances) {
+    if (existing.objectName == objectName) inst = &existing;
+  }
+  if (!inst) {
+    targetPage->instances.emplace_back();
+    inst = &targetPage->instances.back();
+    inst->objectNum  = nextObjectNum(*targetPage);
+    inst->objectName = objectName;
+  }
+
+  inst->templateNum   = templateNum;
+  inst->dx            = dx;
+  inst->dy            = dy;
+  inst->text          = text;
+  inst->color         = color;
+  inst->overrides     = (text ? VDS::OverrideText : 0) | (color >= 0 ? VDS::OverrideColor : 0);
+  inst->zIndex        = zIndex;
+  inst->isUntouchable = isUntouchable;
+
+  VDS::InstanceData result = *inst;
+  if (onDisplay) pageRevision++;
+  if (!isBatchUpdating && !onDisplay) {
+    commitVisualEdit();
+  }
+  return result;
+}
+
+// テンプレートの引数にインスタンスのずれ・上書きを適用する
+VDS::ObjectArgs VisualData::resolveInstance (const VDS::TemplateData& tmpl, const VDS::InstanceData& inst) const {
+  VDS::ObjectArgs args = tmpl.objectArgs;
+  translateArgs(tmpl.type, args, inst.dx, inst.dy);
+  if (inst.overrides & VDS::OverrideColor) setArgsColor(tmpl.type, args, inst.color);
+  if ((inst.overrides & VDS::OverrideText) && tmpl.type == VDS::DrawType::DrawString) args.text.text = inst.text;
+  return args;
+}
+
+// 引数の座標を平行移動する
+void VisualData::translateArgs (VDS::DrawType type, VDS::ObjectArgs& args, int32_t dx, int32_t dy) const {
+  switch (type) {
+    case VDS::DrawType::DrawPixel:
+      args.pixel.x += dx; args.pixel.y += dy;
+      break;
+
+    case VDS::DrawType::DrawLine:
+      args.line.x0 += dx; args.line.y0 += dy;
+      args.line.x1 += dx; args.line.y1 += dy;
+      break;
+
+    case VDS::DrawType::DrawBezier:
+      args.bezier.x0 += dx; args.bezier.y0 += dy;
+      args.bezier.x1 += dx; args.bezier.y1 += dy;
+      args.bezier.x2 += dx; args.bezier.y2 += dy;
+      break;
+
+    case VDS::DrawType::DrawWideLine:
+      args.wideLine.x0 += dx; args.wideLine.y0 += dy;
+      args.wideLine.x1 += dx; args.wideLine.y1 += dy;
+      break;
+
+    case VDS::DrawType::DrawRect:
+    case VDS::DrawType::ClipRect:
+    case VDS::DrawType::FillRect:
+      args.rect.x += dx; args.rect.y += dy;
+      break;
+
+    case VDS::DrawType::DrawRoundRect:
+    case VDS::DrawType::ClipRoundRect:
+    case VDS::DrawType::FillRoundRect:
+      args.roundRect.x += dx; args.roundRect.y += dy;
+      break;
+
+    case VDS::DrawType::DrawCircle:
+    case VDS::DrawType::ClipCircle:
+    case VDS::DrawType::FillCircle:
+      args.circle.x += dx; args.circle.y += dy;
+      break;
+
+    case VDS::DrawType::DrawEllipse:
+    case VDS::DrawType::ClipEllipse:
+    case VDS::DrawType::FillEllipse:
+      args.ellipse.x += dx; args.ellipse.y += dy;
+      break;
+
+    case VDS::DrawType::DrawTriangle:
+    case VDS::DrawType::ClipTriangle:
+    case VDS::DrawType::FillTriangle:
+      args.triangle.x0 += dx; args.triangle.y0 += dy;
+      args.triangle.x1 += dx; args.triangle.y1 += dy;
+      args.triangle.x2 += dx; args.triangle.y2 += dy;
+      break;
+
+    case VDS::DrawType::DrawArc:
+    case VDS::DrawType::ClipArc:
+    case VDS::DrawType::FillArc:
+      args.arc.x += dx; args.arc.y += dy;
+      break;
+
+    case VDS::DrawType::DrawEllipseArc:
+    case VDS::DrawType::ClipEllipseArc:
+    case VDS::DrawType::FillEllipseArc:
+      args.ellipseArc.x += dx; args.ellipseArc.y += dy;
+      break;
+
+    case VDS::DrawType::DrawJpgFile:
+      args.jpg.x += dx; args.jpg.y += dy;
+      break;
+
+    case VDS::DrawType::DrawPngFile:
+      args.png.x += dx; args.png.y += dy;
+      break;
+
+    case VDS::DrawType::DrawBitmap:
+      args.bitmap.x += dx; args.bitmap.y += dy;
+      break;
+
+    case VDS::DrawType::DrawString:
+      args.text.x += dx; args.text.y += dy;
+      break;
+
+    case VDS::DrawType::FlexBox:
+    case VDS::DrawType::TableBox:
+      args.box.x += dx; args.box.y += dy;
+      break;
+
+    default:
+      break;
+  }
+}
+
+// 色を持つ種類なら色を差し替える
+bool VisualData::setArgsColor (VDS::DrawType type, VDS::ObjectArgs& args, int color) const {
+  switch (type) {
+    case VDS::DrawType::DrawPixel:      args.pixel.color = color;      return true;
+    case VDS::DrawType::DrawLine:       args.line.color = color;       return true;
+    case VDS::DrawType::DrawBezier:     args.bezier.color = color;     return true;
+    case VDS::DrawType::DrawWideLine:   args.wideLine.color = color;   return true;
+    case VDS::DrawType::DrawRect:
+    case VDS::DrawType::FillRect:       args.rect.color = color;       return true;
+    case VDS::DrawType::DrawRoundRect:
+    case VDS::DrawType::FillRoundRect:  args.roundRect.color = color;  return true;
+    case VDS::DrawType::DrawCircle:
+    case VDS::DrawType::FillCircle:     args.circle.color = color;     return true;
+    case VDS::DrawType::DrawEllipse:
+    case VDS::DrawType::FillEllipse:    args.ellipse.color = color;    return true;
+    case VDS::DrawType::DrawTriangle:
+    case VDS::DrawType::FillTriangle:   args.triangle.color = color;   return true;
+    case VDS::DrawType::DrawArc:
+    case VDS::DrawType::FillArc:        args.arc.color = color;        return true;
+    case VDS::DrawType::DrawEllipseArc:
+    case VDS::DrawType::FillEllipseArc: args.ellipseArc.color = color; return true;
+    case VDS::DrawType::DrawString:     args.text.color = color;       return true;
+    default:                            return false;
+  }
+}
+
+// 色を持つ種類なら色を取得する
+bool VisualData::getArgsColor (VDS::DrawType type, const VDS::ObjectArgs& args, int& color) const {
+  switch (type) {
+    case VDS::DrawType::DrawPixel:      color = args.pixel.color;      return true;
+    case VDS::DrawType::DrawLine:       color = args.line.color;       return true;
+    case VDS::DrawType::DrawBezier:     color = args.bezier.color;     return true;
+    case VDS::DrawType::DrawWideLine:   color = args.wideLine.color;   return true;
+    case VDS::DrawType::DrawRect:
+    case VDS::DrawType::FillRect:       color = args.rect.color;       return true;
+    case VDS::DrawType::DrawRoundRect:
+    case VDS::DrawType::FillRoundRect:  color = args.roundRect.color;  return true;
+    case VDS::DrawType::DrawCircle:
+    case VDS::DrawType::FillCircle:     color = args.circle.color;     return true;
+    case VDS::DrawType::DrawEllipse:
+    case VDS::DrawType::FillEllipse:    color = args.ellipse.color;    return true;
+    case VDS::DrawType::DrawTriangle:
+    case VDS::DrawType::FillTriangle:   color = args.triangle.color;   return true;
+    case VDS::DrawType::DrawArc:
+    case VDS::DrawType::FillArc:        color = args.arc.color;        return true;
+    case VDS::DrawType::DrawEllipseArc:
+    case VDS::DrawType::FillEllipseArc: color = args.ellipseArc.color; return true;
+    case VDS::DrawType::DrawString:     color = args.text.color;       return true;
+    default:                            return false;
+  }
+}
+
+// 基準座標（先頭の点）を取得する
+bool VisualData::getArgsOrigin (VDS::DrawType type, const VDS::ObjectArgs& args, int32_t& x, int32_t& y) const {
+  switch (type) {
+    case VDS::DrawType::DrawPixel:      x = args.pixel.x;      y = args.pixel.y;      return true;
+    case VDS::DrawType::DrawLine:       x = args.line.x0;      y = args.line.y0;      return true;
+    case VDS::DrawType::DrawBezier:     x = args.bezier.x0;    y = args.bezier.y0;    return true;
+    case VDS::DrawType::DrawWideLine:   x = args.wideLine.x0;  y = args.wideLine.y0;  return true;
+    case VDS::DrawType::DrawRect:
+    case VDS::DrawType::ClipRect:
+    case VDS::DrawType::FillRect:       x = args.rect.x;       y = args.rect.y;       return true;
+    case VDS::DrawType::DrawRoundRect:
+    case VDS::DrawType::ClipRoundRect:
+    case VDS::DrawType::FillRoundRect:  x = args.roundRect.x;  y = args.roundRect.y;  return true;
+    case VDS::DrawType::DrawCircle:
+    case VDS::DrawType::ClipCircle:
+    case VDS::DrawType::FillCircle:     x = args.circle.x;     y = args.circle.y;     return true;
+    case VDS::DrawType::DrawEllipse:
+    case VDS::DrawType::ClipEllipse:
+    case VDS::DrawType::FillEllipse:    x = args.ellipse.x;    y = args.ellipse.y;    return true;
+    case VDS::DrawType::DrawTriangle:
+    case VDS::DrawType::ClipTriangle:
+    case VDS::DrawType::FillTriangle:   x = args.triangle.x0;  y = args.triangle.y0;  return true;
+    case VDS::DrawType::DrawArc:
+    case VDS::DrawType::ClipArc:
+    case VDS::DrawType::FillArc:        x = args.arc.x;        y = args.arc.y;        return true;
+    case VDS::DrawType::DrawEllipseArc:
+    case VDS::DrawType::ClipEllipseArc:
+    case VDS::DrawType::FillEllipseArc: x = args.ellipseArc.x; y = args.ellipseArc.y; return true;
+    case VDS::DrawType::DrawJpgFile:    x = args.jpg.x;        y = args.jpg.y;        return true;
+    case VDS::DrawType::DrawPngFile:    x = args.png.x;        y = args.png.y;        return true;
+    case VDS::DrawType::DrawBitmap:     x = args.bitmap.x;     y = args.bitmap.y;     return true;
+    case VDS::DrawType::DrawString:     x = args.text.x;       y = args.text.y;       return true;
+    case VDS::DrawType::FlexBox:
+    case VDS::DrawType::TableBox:       x = args.box.x;        y = args.box.y;        return true;
+    default:                            return false;
+  }
+}
+
+// 描画範囲を求める（求められない種類は false）
+bool VisualData::getObjectBounds (LGFX_Sprite &sprite, VDS::DrawType type, const VDS::ObjectArgs& args, VDS::Rect& bounds) {
+  auto fromPoints = [&bounds](std::initializer_list<int32_t> xs, std::initializer_list<int32_t> ys, int32_t pad) {
+    int32_t x0 = *std::min_element(xs.begin(), xs.end());
+    int32_t x1 = *std::max_element(xs.begin(), xs.end());
+    int32_t y0 = *std::min_element(ys.begin(), ys.end());
+    int32_t y1 = *std::max_element(ys.begin(), ys.end());
+    bounds = VDS::Rect{ x0 - pad, y0 - pad, x1 - x0 + 1 + pad * 2, y1 - y0 + 1 + pad * 2 };
+    return true;
+  };
+  // 面積 0 のもの（何も描かれない）は空の範囲として true を返す
+  auto fromRect = [&bounds](int32_t x, int32_t y, int32_t w, int32_t h) {
+    if (w < 0) { x += w; w = -w; }
+    if (h < 0) { y += h; h = -h; }
+    bounds = VDS::Rect{ x, y, w, h };
+    return true;
+  };
+
+  switch (type) {
+    case VDS::DrawType::DrawPixel:
+      return fromRect(args.pixel.x, args.pixel.y, 1, 1);
+
+    case VDS::DrawType::DrawLine:
+      return fromPoints({ args.line.x0, args.line.x1 }, { args.line.y0, args.line.y1 }, 0);
+
+    case VDS::DrawType::DrawBezier:
+      // 曲線は制御点の凸包に収まる
+      return fromPoints({ args.bezier.x0, args.bezier.x1, args.bezier.x2 }, { args.bezier.y0, args.bezier.y1, args.bezier.y2 }, 0);
+
+    case VDS::DrawType::DrawWideLine:
+      return fromPoints({ args.wideLine.x0, args.wideLine.x1 }, { args.wideLine.y0, args.wideLine.y1 }, args.wideLine.r + 1);
+
+    case VDS::DrawType::DrawRect:
+    case VDS::DrawType::FillRect:
+      return fromRect(args.rect.x, args.rect.y, args.rect.w, args.rect.h);
+
+    case VDS::DrawType::DrawRoundRect:
+    case VDS::DrawType::FillRoundRect:
+      return fromRect(args.roundRect.x, args.roundRect.y, args.roundRect.w, args.roundRect.h);
+
+    case VDS::DrawType::DrawCircle:
+    case VDS::DrawType::FillCircle:
+      return fromPoints({ args.circle.x }, { args.circle.y }, args.circle.r + 1);
+
+    case VDS::DrawType::DrawEllipse:
+    case VDS::DrawType::FillEllipse:
+      return fromRect(args.ellipse.x - args.ellipse.rx - 1, args.ellipse.y - args.ellipse.ry - 1,
+                      args.ellipse.rx * 2 + 3, args.ellipse.ry * 2 + 3);
+
+    case VDS::DrawType::DrawTriangle:
+    case VDS::DrawType::FillTriangle:
+      return fromPoints({ args.triangle.x0, args.triangle.x1, args.triangle.x2 }, { args.triangle.y0, args.triangle.y1, args.triangle.y2 }, 0);
+
+    case VDS::DrawType::DrawArc:
+    case VDS::DrawType::FillArc:
+      return fromPoints({ args.arc.x }, { args.arc.y }, std::max(args.arc.r0, args.arc.r1) + 1);
+
+    case VDS::DrawType::DrawEllipseArc:
+    case VDS::DrawType::FillEllipseArc: {
+      int32_t rx = std::max(args.ellipseArc.r0x, args.ellipseArc.r1x) + 1;
+      int32_t ry = std::max(args.ellipseArc.r0y, args.ellipseArc.r1y) + 1;
+      return fromRect(args.ellipseArc.x - rx, args.ellipseArc.y - ry, rx * 2 + 1, ry * 2 + 1);
+    }
+
+    // サイズが取れなかった画像は読めたときに原寸で描かれるので範囲不明とする
+    case VDS::DrawType::DrawJpgFile:
+      return args.jpg.w > 0 && args.jpg.h > 0 && fromRect(args.jpg.x, args.jpg.y, args.jpg.w, args.jpg.h);
+
+    case VDS::DrawType::DrawPngFile:
+      return args.png.w > 0 && args.png.h > 0 && fromRect(args.png.x, args.png.y, args.png.w, args.png.h);
+
+    case VDS::DrawType::DrawBitmap:
+      return fromRect(args.bitmap.x, args.bitmap.y, args.bitmap.w, args.bitmap.h);
+
+    // 1 行の文字列だけ求める（改行を含むもの・画面の右端で折り返すものは範囲不明とする）
+    case VDS::DrawType::DrawString: {
+      if (!args.text.text) {
+        bounds = VDS::Rect();
+        return true;
+      }
+      if (strchr(args.text.text, '\n')) return false;
+      if (args.text.font) sprite.setFont(args.text.font);
+      sprite.setTextSize(args.text.textSize);
+      int32_t w = sprite.textWidth(args.text.text);
+      int32_t h = sprite.fontHeight();
+      int32_t x = args.text.x;
+      int32_t y = args.text.y;
+      int datum = static_cast<int>(args.text.datum);
+      if ((datum & 3) == 1) x -= w / 2;        // center
+      else if ((datum & 3) == 2) x -= w;       // right
+      if (datum & 4) {                         // middle
+        y -= h / 2;
+      } else if (datum & 8) {                  // bottom
+        y -= h;
+      } else if (datum & 16) {                 // baseline（ベースラインより下の部分も含める）
+        lgfx::FontMetrics metrics;
+        sprite.getFont()->getDefaultMetric(&metrics);
+        y -= metrics.baseline * args.text.textSize;
+      }
+      // 折り返しは画面の右端で起きる（帯・タイルに描くときも画面の座標で判定する）
+      int32_t right = (display && display->width() > 0) ? display->width() : sprite.width();
+      if (args.text.textWrap && x + w > right) return false;
+      return fromRect(x - 1, y - 1, w + 2, h + 2);
+    }
+
+    // コンテナは並べる範囲（入れ子のときの大きさに使う）
+    case VDS::DrawType::FlexBox:
+    case VDS::DrawType::TableBox:
+      return fromRect(args.box.x, args.box.y, args.box.w, args.box.h);
+
+    default:
+      return false;
+  }
+}
+
+// オブジェクトは持たせてある範囲を使う
+bool VisualData::getObjectBounds (LGFX_Sprite &sprite, const VDS::ObjectData& obj, VDS::Rect& bounds) {
+  if (obj.hasBounds) {
+    bounds = obj.bounds;
+    return true;
+  }
+  return getObjectBounds(sprite, obj.type, obj.objectArgs, bounds);
+}
+
+bool VisualData::getItemBounds (LGFX_Sprite &sprite, const DrawItem& item, VDS::Rect& bounds) {
+  if (item.object) return getObjectBounds(sprite, *item.object, bounds);
+
+  const VDS::TemplateData& tmpl = getTemplateData(item.instance->templateNum);
+  if (tmpl.isEmpty()) return false;
+  return getObjectBounds(sprite, tmpl.type, resolveInstance(tmpl, *item.instance), bounds);
+}
+
+// 引数から描画範囲を求めてオブジェクトに持たせる（引数を変えたら呼ぶ）
+// フォント未指定の文字列は描画先のフォントで幅が変わるので持たせない
+void VisualData::updateBounds (VDS::ObjectData& obj) {
+  obj.hasBounds = false;
+  if (obj.type == VDS::DrawType::DrawString && !obj.objectArgs.text.font) return;
+  obj.hasBounds = getObjectBounds(boundsSprite, obj.type, obj.objectArgs, obj.bounds);
+}
+
+// 描画先のうち実際に書き込まれる範囲（クリップ領域）
+VDS::Rect VisualData::getVisibleRect (LovyanGFX& gfx) const {
+  VDS::Rect clip;
+  gfx.getClipRect(&clip.x, &clip.y, &clip.w, &clip.h);
+  return clip.intersected(VDS::Rect{ 0, 0, gfx.width(), gfx.height() });
+}
+
+
+// =========================
+// データバインディング
+// =========================
+// オブジェクトの項目に値を反映する（その種類に無い項目なら false）
+bool VisualData::applyProperty (VDS::DrawType type, VDS::ObjectArgs& args, VDS::BindProperty property, int32_t value, const char* text) const {
+  switch (property) {
+    case VDS::BindProperty::Text:
+      if (type != VDS::DrawType::DrawString) return false;
+      args.text.text = text;
+      return true;
+
+    case VDS::BindProperty::Color:
+      return setArgsColor(type, args, value);
+
+    case VDS::BindProperty::X:
+    case VDS::BindProperty::Y: {
+      int32_t x = 0, y = 0;
+      if (!getArgsOrigin(type, args, x, y)) return false;
+      if (property == VDS::BindProperty::X) translateArgs(type, args, value - x, 0);
+      else                                  translateArgs(type, args, 0, value - y);
+      return true;
+    }
+
+    case VDS::BindProperty::W:
+    case VDS::BindProperty::H: {
+      bool isW = property == VDS::BindProperty::W;
+      switch (type) {
+        case VDS::DrawType::DrawRect:
+        case VDS::DrawType::ClipRect:
+        case VDS::DrawType::FillRect:      (isW ? args.rect.w : args.rect.h) = value;           return true;
+        case VDS::DrawType::DrawRoundRect:
+        case VDS::DrawType::ClipRoundRect:
+        case VDS::DrawType::FillRoundRect: (isW ? args.roundRect.w : args.roundRect.h) = value; return true;
+        case VDS::DrawType::DrawJpgFile:   (isW ? args.jpg.w : args.jpg.h) = value;             return true;
+        case VDS::DrawType::DrawPngFile:   (isW ? args.png.w : args.png.h) = value;             return true;
+        case VDS::DrawType::DrawBitmap:    (isW ? args.bitmap.w : args.bitmap.h) = value;       return true;
+        case VDS::DrawType::FlexBox:
+        case VDS::DrawType::TableBox:      (isW ? args.box.w : args.box.h) = value;             return true;
+        default:                           return false;
+      }
+    }
+
+    case VDS::BindProperty::R:
+      switch (type) {
+        case VDS::DrawType::DrawCircle:
+        case VDS::DrawType::ClipCircle:
+        case VDS::DrawType::FillCircle:    args.circle.r = value;    return true;
+        case VDS::DrawType::DrawRoundRect:
+        case VDS::DrawType::ClipRoundRect:
+        case VDS::DrawType::FillRoundRect: args.roundRect.r = value; return true;
+        case VDS::DrawType::DrawWideLine:  args.wideLine.r = value;  return true;
+        case VDS::DrawType::DrawArc:
+        case VDS::DrawType::ClipArc:
+        case VDS::DrawType::FillArc:       args.arc.r1 = value;      return true;
+        default:                           return false;
+      }
+
+    case VDS::BindProperty::Angle0:
+    case VDS::BindProperty::Angle1: {
+      bool is0 = property == VDS::BindProperty::Angle0;
+      switch (type) {
+        case VDS::DrawType::DrawArc:
+        case VDS::DrawType::ClipArc:
+        case VDS::DrawType::FillArc:        (is0 ? args.arc.angle0 : args.arc.angle1) = value;               return true;
+        case VDS::DrawType::DrawEllipseArc:
+        case VDS::DrawType::ClipEllipseArc:
+        case VDS::DrawType::FillEllipseArc: (is0 ? args.ellipseArc.angle0 : args.ellipseArc.angle1) = value; return true;
+        default:                            return false;
+      }
+    }
+  }
+  return false;
+}
+
+// applyProperty() で書ける項目の今の値を読む（Text は数値で読めないので false）
+bool VisualData::getProperty (VDS::DrawType type, const VDS::ObjectArgs& args, VDS::BindProperty property, int32_t& value) const {
+  switch (property) {
+    case VDS::BindProperty::Text:
+      return false;
+
+    case VDS::BindProperty::Color: {
+      int color = 0;
+      if (!getArgsColor(type, args, color)) return false;
+      value = color;
+      return true;
+    }
+
+    case VDS::BindProperty::X:
+    case VDS::BindProperty::Y: {
+      int32_t x = 0, y = 0;
+      if (!getArgsOrigin(type, args, x, y)) return false;
+      value = (property == VDS::BindProperty::X) ? x : y;
+      return true;
+    }
+
+    case VDS::BindProperty::W:
+    case VDS::BindProperty::H: {
+      bool isW = property == VDS::BindProperty::W;
+      switch (type) {
+        case VDS::DrawType::DrawRect:
+        case VDS::DrawType::ClipRect:
+        case VDS::DrawType::FillRect:      value = isW ? args.rect.w : args.rect.h;           return true;
+        case VDS::DrawType::DrawRoundRect:
+        case VDS::DrawType::ClipRoundRect:
+        case VDS::DrawType::FillRoundRect: value = isW ? args.roundRect.w : args.roundRect.h; return true;
+        case VDS::DrawType::DrawJpgFile:   value = isW ? args.jpg.w : args.jpg.h;             return true;
+        case VDS::DrawType::DrawPngFile:   value = isW ? args.png.w : args.png.h;             return true;
+        case VDS::DrawType::DrawBitmap:    value = isW ? args.bitmap.w : args.bitmap.h;       return true;
+        case VDS::DrawType::FlexBox:
+        case VDS::DrawType::TableBox:      value = isW ? args.box.w : args.box.h;             return true;
+        default:                           return false;
+      }
+    }
+
+    case VDS::BindProperty::R:
+      switch (type) {
+        case VDS::DrawType::DrawCircle:
+        case VDS::DrawType::ClipCircle:
+        case VDS::DrawType::FillCircle:    value = args.circle.r;    return true;
+        case VDS::DrawType::DrawRoundRect:
+        case VDS::DrawType::ClipRoundRect:
+        case VDS::DrawType::FillRoundRect: value = args.roundRect.r; return true;
+        case VDS::DrawType::DrawWideLine:  value = args.wideLine.r;  return true;
+        case VDS::DrawType::DrawArc:
+        case VDS::DrawType::ClipArc:
+        case VDS::DrawType::FillArc:       value = args.arc.r1;      return true;
+        default:                           return false;
+      }
+
+    case VDS::BindProperty::Angle0:
+    case VDS::BindProperty::Angle1: {
+      bool is0 = property == VDS::BindProperty::Angle0;
+      switch (type) {
+        case VDS::DrawType::DrawArc:
+        case VDS::DrawType::ClipArc:
+        case VDS::DrawType::FillArc:        value = is0 ? args.arc.angle0 : args.arc.angle1;               return true;
+        case VDS::DrawType::DrawEllipseArc:
+        case VDS::DrawType::ClipEllipseArc:
+        case VDS::DrawType::FillEllipseArc: value = is0 ? args.ellipseArc.angle0 : args.ellipseArc.angle1; return true;
+        default:                            return false;
+      }
+    }
+  }
+  return false;
+}
+
+// 文字列の変化検出用ハッシュ（FNV-1a、指すバッファが変わった場合も変化とみなす）
+uint32_t VisualData::hashText (const char* text) {
+  uint32_t hash = 2166136261u ^ static_cast<uint32_t>(reinterpret_cast<uintptr_t>(text));
+  if (!text) return hash;
+  for (const char* c = text; *c; c++) {
+    hash ^= static_cast<uint8_t>(*c);
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+// 値を取得して前回と比較する（変化があれば true）
+bool VisualData::pollBinding (VDS::BindingData& binding, int32_t& value, const char*& text) {
+  if (binding.property == VDS::BindProperty::Text) {
+    text = binding.getText ? binding.getText() : nullptr;
+    value = static_cast<int32_t>(hashText(text));
+  } else {
+    value = binding.getValue ? binding.getValue() : 0;
+  }
+
+  if (binding.hasCache && binding.cachedValue == value) return false;
+  binding.cachedValue = value;
+  binding.hasCache = true;
+  return true;
+}
+
+bool VisualData::bindValue (const String& objectName, VDS::BindProperty property, std::function<int32_t()> getter, int pageNum) {
+  if (property == VDS::BindProperty::Text) {
+    VT_LOG_ERROR(debugLog, "Use bindText() for text bindings. !%s", objectName.c_str());
+    return false;
+  }
+  VDS::BindingData binding;
+  binding.property = property;
+  binding.getValue = getter;
+  return addBinding(objectName, binding, pageNum);
+}
+
+bool VisualData::bindValue (const String& objectName, VDS::BindProperty property, const int32_t* watched, int pageNum) {
+  if (!watched) return false;
+  return bindValue(objectName, property, [watched]() { return *static_cast<const volatile int32_t*>(watched); }, pageNum);
+}
+
+bool VisualData::bindText (const String& objectName, std::function<const char*()> getter, int pageNum) {
+  VDS::BindingData binding;
+  binding.property = VDS::BindProperty::Text;
+  binding.getText = getter;
+  return addBinding(objectName, binding, pageNum);
+}
+
+bool VisualData::bindText (const String& objectName, const char* watched, int pageNum) {
+  if (!watched) return false;
+  return bindText(objectName, [watched]() { return watched; }, pageNum);
+}
+
+// 対象オブジェクトを確認して登録（同じオブジェクト・項目のバインドは置き換え）
+bool VisualData::addBinding (const String& objectName, VDS::BindingData& binding, int pageNum) {
+  const VDS::PageData& page = (pageNum < 0) ? editingPage : getPageData(pageNum);
+  if (page.isEmpty()) {
+    VT_LOG_ERROR(debugLog, "No target page available.");
+    return false;
+  }
+
+  const VDS::ObjectData* obj = nullptr;
+  for (const auto& o : page.objects) {
+    if (o.objectName == objectName) obj = &o;
+  }
+  if (!obj) {
+    VT_LOG_ERROR(debugLog, "[%s] does not exist (instances cannot be bound).", objectName.c_str());
+    return false;
+  }
+
+  // その種類に項目があるかを事前に確認
+  VDS::ObjectArgs probe = obj->objectArgs;
+  if (!applyProperty(obj->type, probe, binding.property, 0, nullptr)) {
+    VT_LOG_ERROR(debugLog, "[%s] has no such property to bind.", objectName.c_str());
+    return false;
+  }
+
+  binding.pageNum = page.pageNum;
+  binding.objectNum = obj->objectNum;
+
+  for (auto& existing : visualDataSet.bindings) {
+    if (existing.pageNum == binding.pageNum && existing.objectNum == binding.objectNum && existing.property == binding.property) {
+      existing = binding;
+      dataRevision++;
+      return true;
+    }
+  }
+  visualDataSet.bindings.push_back(binding);
+  dataRevision++;
+  VT_LOG_SUCCESS(debugLog, "[%s] bound.", objectName.c_str());
+  return true;
+}
+
+bool VisualData::unbind (const String& objectName, int pageNum) {
+  int targetPage = (pageNum < 0) ? editingPage.pageNum : pageNum;
+  int objectNum = getObjectNumByName(objectName, pageNum);
+  if (objectNum < 0) return false;
+
+  auto& bindings = visualDataSet.bindings;
+  size_t before = bindings.size();
+  bindings.erase(std::remove_if(bindings.begin(), bindings.end(),
+                 [targetPage, objectNum](const VDS::BindingData& b) { return b.pageNum == targetPage && b.objectNum == objectNum; }),
+                 bindings.end());
+  if (bindings.size() == before) return false;
+  dataRevision++;
+  return true;
+}
+
+// 描画中ページのバインドをすべて反映する（ページ全体を描き直すときに使用、再描画範囲は記録しない）
+// 戻り値は前回反映したときから値が変わったバインドがあったかどうか
+bool VisualData::applyBindings () {
+  bool changed = false;
+  for (auto& binding : visualDataSet.bindings) {
+    if (binding.pageNum != currentPageCopy.pageNum) continue;
+    int32_t value = 0;
+    const char* text = nullptr;
+    changed |= pollBinding(binding, value, text);
+    VDS::ObjectData* obj = getObjectDataRef(&currentPageCopy, binding.objectNum);
+    if (!obj) continue;
+    applyProperty(obj->type, obj->objectArgs, binding.property, binding.cachedValue, text);
+    updateBounds(*obj);
+  }
+  return changed;
+}
+
+// 値が変化したオブジェクトだけを更新し、変化前後の範囲を再描画対象にする
+// 戻り値は変化したバインドの数
+int VisualData::updateBindings (LGFX_Sprite &sprite) {
+  if (currentPageCopy.isEmpty()) return 0;
+
+  int changed = 0;
+  for (auto& binding : visualDataSet.bindings) {
+    if (binding.pageNum != currentPageCopy.pageNum) continue;
+
+    int32_t value = 0;
+    const char* text = nullptr;
+    if (!pollBinding(binding, value, text)) continue;
+
+    VDS::ObjectData* obj = getObjectDataRef(&currentPageCopy, binding.objectNum);
+    if (!obj) continue;
+
+    VDS::Rect before, after;
+    bool hasBefore = getObjectBounds(sprite, *obj, before);
+    applyProperty(obj->type, obj->objectArgs, binding.property, value, text);
+    updateBounds(*obj);
+    pageRevision++;
+    bool hasAfter = getObjectBounds(sprite, *obj, after);
+
+    if (hasBefore && hasAfter) {
+      markDirty(before);
+      markDirty(after);
+    } else {
+      markDirty(VDS::Rect{ 0, 0, sprite.width(), sprite.height() });
+    }
+    changed++;
+  }
+  // 動いた親の子・大きさや文字が変わった子のコンテナだけを追従させる
+  if (changed) tree.update(currentPageCopy, true);
+  return changed;
+}
+
+// 再描画範囲を追加（重なる範囲は結合し、数が多ければ 1 つにまとめる）
+void VisualData::markDirty (const VDS::Rect& rect) {
+  if (rect.isEmpty()) return;
+
+  VDS::Rect merged = rect;
+  bool mergedAny = true;
+  while (mergedAny) {
+    mergedAny = false;
+    for (auto it = dirtyRects.begin(); it != dirtyRects.end(); ++it) {
+      if (it->intersects(merged)) {
+        merged = merged.united(*it);
+        dirtyRects.erase(it);
+        mergedAny = true;
+        break;
+      }
+    }
+  }
+  dirtyRects.push_back(merged);
+
+  if (dirtyRects.size() > MAX_DIRTY_RECTS) {
+    VDS::Rect all;
+    for (const auto& r : dirtyRects) all = all.united(r);
+    dirtyRects.clear();
+    dirtyRects.push_back(all);
+  }
+}
+
+// 確実に塗りつぶす矩形を求める（数を返す。角丸は角を除いた十字の 2 枚）
+// forJudge では判定用スプライトの塗り方に合わせ、枠線や画像も中まで塗るものとして扱う
+int VisualData::getOpaqueRects (VDS::DrawType type, const VDS::ObjectArgs& args, bool forJudge, VDS::Rect (&rects)[2]) const {
+  // 幅・高さが負のものは描画側の扱いが実装で異なるため覆うものとしない
+  auto one = [&rects](int32_t x, int32_t y, int32_t w, int32_t h) {
+    rects[0] = VDS::Rect{ x, y, w, h };
+    return rects[0].isEmpty() ? 0 : 1;
+  };
+  auto roundRect = [&rects](const VDS::RoundRectArgs& a) {
+    int32_t radius = std::max<int32_t>(a.r, 0);
+    int n = 0;
+    VDS::Rect tall{ a.x + radius, a.y, a.w - radius * 2, a.h };
+    VDS::Rect wide{ a.x, a.y + radius, a.w, a.h - radius * 2 };
+    if (!tall.isEmpty()) rects[n++] = tall;
+    if (!wide.isEmpty()) rects[n++] = wide;
+    return n;
+  };
+
+  switch (type) {
+    case VDS::DrawType::FillRect:
+      return one(args.rect.x, args.rect.y, args.rect.w, args.rect.h);
+
+    case VDS::DrawType::FillRoundRect:
+      return roundRect(args.roundRect);
+
+    case VDS::DrawType::DrawBitmap:
+      // pushImage は透過色なしで矩形全体を書く
+      if (!forJudge && !args.bitmap.data) return 0;
+      return one(args.bitmap.x, args.bitmap.y, args.bitmap.w, args.bitmap.h);
+
+    default:
+      break;
+  }
+  if (!forJudge) return 0;
+
+  switch (type) {
+    case VDS::DrawType::DrawRect:
+      return one(args.rect.x, args.rect.y, args.rect.w, args.rect.h);
+
+    case VDS::DrawType::DrawRoundRect:
+      return roundRect(args.roundRect);
+
+    case VDS::DrawType::DrawJpgFile:
+      return one(args.jpg.x, args.jpg.y, args.jpg.w, args.jpg.h);
+
+    case VDS::DrawType::DrawPngFile:
+      return one(args.png.x, args.png.y, args.png.w, args.png.h);
+
+    default:
+      return 0;
+  }
+}
+
+// 描いても見えない要素を items から除く（描画順はそのまま）
+//   - 範囲が visible（描画先・クリップ領域）に掛からないもの、面積 0 のもの
+//   - 前面の不透明な矩形 1 枚に範囲ごと覆われるもの
+// 前面から背面へたどりながら覆う矩形を VT_OCCLUDER_MAX 枚まで覚え、溢れたら小さいものと入れ替える。
+// forJudge では判定用スプライトに塗らない isUntouchable の要素も除く（数には含めない）。
+// 範囲が分からないもの・折り返す文字列（折り返し先が範囲の外になる）は残す。
+// Clip 系の要素は常に残し、その下の要素は Clip の外接矩形も visible に含めて判定する
+// （矩形以外の Clip の下では覆う矩形として数えない）。
+VisualData::CullCounts VisualData::cullItems (LGFX_Sprite &sprite, const VDS::Rect& visible, std::vector<DrawItem>& items, bool forJudge) {
+  VDS::Rect occluders[VT_OCCLUDER_MAX > 0 ? VT_OCCLUDER_MAX : 1];
+  int occluderCount = 0;
+  auto area = [](const VDS::Rect& r) { return int64_t(r.w) * r.h; };
+  auto addOccluder = [&](const VDS::Rect& r) {
+    if (VT_OCCLUDER_MAX <= 0) return;
+    if (occluderCount < VT_OCCLUDER_MAX) {
+      occluders[occluderCount++] = r;
+      return;
+    }
+    int smallest = 0;
+    for (int k = 1; k < occluderCount; k++) {
+      if (area(occluders[k]) < area(occluders[smallest])) smallest = k;
+    }
+    if (area(r) > area(occluders[smallest])) occluders[smallest] = r;
+  };
+  auto isCovered = [&](const VDS::Rect& b) {
+    for (int k = 0; k < occluderCount; k++) {
+      if (occluders[k].contains(b)) return true;
+    }
+    return false;
+  };
+
+  // 描画順にたどって、各要素に効く Clip の範囲を先に求める（Clip の無いページでは何もしない）
+  enum ClipState : uint8_t { Unclipped, ClipItem, Clipped, Masked };
+  std::vector<ClipState> clipState;
+  std::vector<VDS::Rect> clipArea;
+  ClipStack tracker(this);
+  tracker.begin();
+  for (size_t i = 0; i < items.size(); i++) {
+    VDS::DrawType type;
+    VDS::ObjectArgs args;
+    if (!resolveItem(items[i], type, args)) continue;
+    if (ClipStack::isClipType(type)) {
+      if (clipState.empty()) {
+        clipState.assign(items.size(), Unclipped);
+        clipArea.resize(items.size());
+      }
+      clipState[i] = ClipItem;
+      tracker.push(type, args, items[i].zIndex);
+      continue;
+    }
+    if (clipState.empty()) continue;
+    tracker.enter(items[i].zIndex);
+    VDS::Rect area;
+    if (!tracker.getActiveBounds(area)) continue;
+    clipArea[i] = area.intersected(visible);
+    clipState[i] = tracker.isActiveMasked() ? Masked : Clipped;
+  }
+  tracker.end();
+
+  CullCounts counts;
+  std::vector<uint8_t> keep(items.size(), 1);
+  for (size_t i = items.size(); i-- > 0; ) {
+    const DrawItem& item = items[i];
+    ClipState state = clipState.empty() ? Unclipped : clipState[i];
+    if (state == ClipItem) continue;
+    if (forJudge && (item.object ? item.object->isUntouchable : item.instance->isUntouchable)) {
+      keep[i] = 0;
+      continue;
+    }
+
+    VDS::DrawType type;
+    VDS::ObjectArgs args;
+    if (!resolveItem(item, type, args)) continue;
+
+    const VDS::Rect& area = state == Unclipped ? visible : clipArea[i];
+    if (state != Unclipped && area.isEmpty()) {
+      keep[i] = 0;
+      counts.offscreen++;
+      continue;
+    }
+
+    // 範囲の分からないもの（折り返す文字列など）は除かない
+    VDS::Rect bounds;
+    if (getItemBounds(sprite, item, bounds)) {
+      if (!bounds.intersects(area)) {
+        keep[i] = 0;
+        counts.offscreen++;
+        continue;
+      }
+      if (isCovered(bounds.intersected(area))) {
+        keep[i] = 0;
+        counts.occluded++;
+        continue;
+      }
+    }
+
+    if (state == Masked) continue;
+    VDS::Rect rects[2];
+    int n = getOpaqueRects(type, args, forJudge, rects);
+    for (int k = 0; k < n; k++) addOccluder(rects[k].intersected(area));
+  }
+
+  size_t out = 0;
+  for (size_t i = 0; i < items.size(); i++) {
+    if (keep[i]) items[out++] = items[i];
+  }
+  items.resize(out);
+
+  if (forJudge) {
+    VT_PROFILE_COUNT(FrameStats::Counter::OffscreenJudge, counts.offscreen);
+    VT_PROFILE_COUNT(FrameStats::Counter::OccludedJudge, counts.occluded);
+  } else {
+    VT_PROFILE_COUNT(FrameStats::Counter::OffscreenDraw, counts.offscreen);
+    VT_PROFILE_COUNT(FrameStats::Counter::OccludedDraw, counts.occluded);
+  }
+  return counts;
+}
+
+// 再描画範囲だけを描き直す（範囲に掛かるオブジェクトを z 順にクリップして描画）
+bool VisualData::redrawDirty (LGFX_Sprite &sprite) {
+  flushedRects.clear();
+  if (dirtyRects.empty() || currentPageCopy.isEmpty()) return false;
+
+  std::vector<DrawItem> items;
+  collectDrawOrder(currentPageCopy, items);
+  VDS::Rect area;
+  for (const auto& rect : dirtyRects) area = area.united(rect);
+  cullItems(sprite, area.intersected(getVisibleRect(sprite)), items, false);
+
+  for (const auto& rect : dirtyRects) {
+    sprite.setClipRect(rect.x, rect.y, rect.w, rect.h);
+    sprite.fillRect(rect.x, rect.y, rect.w, rect.h, BLACK);
+
+    clipStack.begin(&sprite);
+    for (const auto& item : items) {
+      VDS::DrawType type;
+      VDS::ObjectArgs args;
+      if (!resolveItem(item, type, args)) continue;
+      if (ClipStack::isClipType(type)) {
+        clipStack.push(type, args, item.zIndex);
+        continue;
+      }
+      VDS::Rect bounds;
+      if (getItemBounds(sprite, item, bounds) && !bounds.intersects(rect)) continue;
+      if (!clipStack.enter(item.zIndex)) continue;
+      if (item.object) drawObject(sprite, *item.object);
+      else             drawInstanceRun(sprite, &item, 1);
+    }
+    clipStack.end();
+  }
+  sprite.clearClipRect();
+
+  flushedRects.swap(dirtyRects);
+  return true;
+}
+
+// 直前の redrawDirty() で描き直した範囲（部分転送用）
+const std::vector<VDS::Rect>& VisualData::getFlushedRects () const {
+  return flushedRects;
+}
+
 bool VisualData::getJpgSize (fs::FS &fs, const char* filename, int &w, int &h) {
+  VT_PROFILE_SCOPE(FrameStats::Stage::ImageDecode);
   File jpgFile = fs.open(filename);
   if (!jpgFile) return 0;
   if (!JpegDec.decodeSdFile(jpgFile)) {
@@ -639,6 +1908,9 @@ bool VisualData::getJpgSize (fs::FS &fs, const char* filename, int &w, int &h) {
   return true;
 }
 
+int VisualData::g_pngWidth  = 0;
+int VisualData::g_pngHeight = 0;
+
 // 描画しないダミーコールバック
 void VisualData::pngle_on_draw(pngle_t *png, uint32_t x, uint32_t y, uint32_t w, uint32_t h, const uint8_t *rgba) {
   // 何もしない
@@ -651,6 +1923,7 @@ void VisualData::pngle_on_header(pngle_t *png, uint32_t w, uint32_t h) {
 }
 
 bool VisualData::getPngSize(File &file, int &width, int &height) {
+  VT_PROFILE_SCOPE(FrameStats::Stage::ImageDecode);
   g_pngWidth = 0;
   g_pngHeight = 0;
 
@@ -668,7 +1941,7 @@ bool VisualData::getPngSize(File &file, int &width, int &height) {
     if (len <= 0) break;
     int fed = pngle_feed(pngle, buf, remain + len);
     if (fed < 0) {
-      Serial.printf("pngle error: %s\n", pngle_error(pngle));
+      VT_LOG_ERROR(debugLog, "pngle error: %s", pngle_error(pngle));
       pngle_destroy(pngle);
       return false;
     }
@@ -687,172 +1960,181 @@ bool VisualData::getPngSize(File &file, int &width, int &height) {
 
 
 bool VisualData::drawObject (LGFX_Sprite &sprite, const VDS::ObjectData &obj) {
-  switch (obj.type) {
+  return drawObject(sprite, obj.type, obj.objectArgs);
+}
+
+// 種類と引数だけで描画する（ObjectData / 静的テーブルの共通部分）
+bool VisualData::drawObject (LGFX_Sprite &sprite, VDS::DrawType type, const VDS::ObjectArgs &args) {
+  VT_PROFILE_DRAW_SCOPE(type);
+  switch (type) {
 
     // -------------------- 基本描画 --------------------
     case VDS::DrawType::DrawPixel:
-      sprite.drawPixel(obj.objectArgs.pixel.x, obj.objectArgs.pixel.y, obj.objectArgs.pixel.color);
+      sprite.drawPixel(args.pixel.x, args.pixel.y, args.pixel.color);
       break;
 
     case VDS::DrawType::DrawLine:
-      sprite.drawLine(obj.objectArgs.line.x0, obj.objectArgs.line.y0,
-                      obj.objectArgs.line.x1, obj.objectArgs.line.y1,
-                      obj.objectArgs.line.color);
+      sprite.drawLine(args.line.x0, args.line.y0,
+                      args.line.x1, args.line.y1,
+                      args.line.color);
       break;
 
     case VDS::DrawType::DrawBezier:
-      sprite.drawBezier(obj.objectArgs.bezier.x0, obj.objectArgs.bezier.y0,
-                        obj.objectArgs.bezier.x1, obj.objectArgs.bezier.y1,
-                        obj.objectArgs.bezier.x2, obj.objectArgs.bezier.y2,
-                        obj.objectArgs.bezier.color);
+      sprite.drawBezier(args.bezier.x0, args.bezier.y0,
+                        args.bezier.x1, args.bezier.y1,
+                        args.bezier.x2, args.bezier.y2,
+                        args.bezier.color);
       break;
 
     case VDS::DrawType::DrawWideLine:
-      sprite.drawWideLine(obj.objectArgs.wideLine.x0, obj.objectArgs.wideLine.y0,
-                          obj.objectArgs.wideLine.x1, obj.objectArgs.wideLine.y1,
-                          obj.objectArgs.wideLine.r, obj.objectArgs.wideLine.color);
+      sprite.drawWideLine(args.wideLine.x0, args.wideLine.y0,
+                          args.wideLine.x1, args.wideLine.y1,
+                          args.wideLine.r, args.wideLine.color);
       break;
 
     case VDS::DrawType::DrawRect:
-      sprite.drawRect(obj.objectArgs.rect.x, obj.objectArgs.rect.y,
-                      obj.objectArgs.rect.w, obj.objectArgs.rect.h,
-                      obj.objectArgs.rect.color);
+      sprite.drawRect(args.rect.x, args.rect.y,
+                      args.rect.w, args.rect.h,
+                      args.rect.color);
       break;
 
     case VDS::DrawType::DrawRoundRect:
-      sprite.drawRoundRect(obj.objectArgs.roundRect.x, obj.objectArgs.roundRect.y,
-                            obj.objectArgs.roundRect.w, obj.objectArgs.roundRect.h,
-                            obj.objectArgs.roundRect.r, obj.objectArgs.roundRect.color);
+      sprite.drawRoundRect(args.roundRect.x, args.roundRect.y,
+                            args.roundRect.w, args.roundRect.h,
+                            args.roundRect.r, args.roundRect.color);
       break;
 
     case VDS::DrawType::DrawCircle:
-      sprite.drawCircle(obj.objectArgs.circle.x, obj.objectArgs.circle.y,
-                        obj.objectArgs.circle.r, obj.objectArgs.circle.color);
+      sprite.drawCircle(args.circle.x, args.circle.y,
+                        args.circle.r, args.circle.color);
       break;
 
     case VDS::DrawType::DrawEllipse:
-      sprite.drawEllipse(obj.objectArgs.ellipse.x, obj.objectArgs.ellipse.y,
-                          obj.objectArgs.ellipse.rx, obj.objectArgs.ellipse.ry,
-                          obj.objectArgs.ellipse.color);
+      sprite.drawEllipse(args.ellipse.x, args.ellipse.y,
+                          args.ellipse.rx, args.ellipse.ry,
+                          args.ellipse.color);
       break;
 
     case VDS::DrawType::DrawTriangle:
-      sprite.drawTriangle(obj.objectArgs.triangle.x0, obj.objectArgs.triangle.y0,
-                          obj.objectArgs.triangle.x1, obj.objectArgs.triangle.y1,
-                          obj.objectArgs.triangle.x2, obj.objectArgs.triangle.y2,
-                          obj.objectArgs.triangle.color);
+      sprite.drawTriangle(args.triangle.x0, args.triangle.y0,
+                          args.triangle.x1, args.triangle.y1,
+                          args.triangle.x2, args.triangle.y2,
+                          args.triangle.color);
       break;
 
     // -------------------- 塗りつぶし --------------------
     case VDS::DrawType::FillRect:
-      sprite.fillRect(obj.objectArgs.rect.x, obj.objectArgs.rect.y,
-                      obj.objectArgs.rect.w, obj.objectArgs.rect.h,
-                      obj.objectArgs.rect.color);
+      sprite.fillRect(args.rect.x, args.rect.y,
+                      args.rect.w, args.rect.h,
+                      args.rect.color);
       break;
 
     case VDS::DrawType::FillRoundRect:
-      sprite.fillRoundRect(obj.objectArgs.roundRect.x, obj.objectArgs.roundRect.y,
-                            obj.objectArgs.roundRect.w, obj.objectArgs.roundRect.h,
-                            obj.objectArgs.roundRect.r, obj.objectArgs.roundRect.color);
+      sprite.fillRoundRect(args.roundRect.x, args.roundRect.y,
+                            args.roundRect.w, args.roundRect.h,
+                            args.roundRect.r, args.roundRect.color);
       break;
 
     case VDS::DrawType::FillCircle:
-      sprite.fillCircle(obj.objectArgs.circle.x, obj.objectArgs.circle.y,
-                        obj.objectArgs.circle.r, obj.objectArgs.circle.color);
+      sprite.fillCircle(args.circle.x, args.circle.y,
+                        args.circle.r, args.circle.color);
       break;
 
     case VDS::DrawType::FillTriangle:
-      sprite.fillTriangle(obj.objectArgs.triangle.x0, obj.objectArgs.triangle.y0,
-                          obj.objectArgs.triangle.x1, obj.objectArgs.triangle.y1,
-                          obj.objectArgs.triangle.x2, obj.objectArgs.triangle.y2,
-                          obj.objectArgs.triangle.color);
+      sprite.fillTriangle(args.triangle.x0, args.triangle.y0,
+                          args.triangle.x1, args.triangle.y1,
+                          args.triangle.x2, args.triangle.y2,
+                          args.triangle.color);
       break;
 
     case VDS::DrawType::FillEllipse:
-      sprite.fillEllipse(obj.objectArgs.ellipse.x, obj.objectArgs.ellipse.y,
-                          obj.objectArgs.ellipse.rx, obj.objectArgs.ellipse.ry,
-                          obj.objectArgs.ellipse.color);
+      sprite.fillEllipse(args.ellipse.x, args.ellipse.y,
+                          args.ellipse.rx, args.ellipse.ry,
+                          args.ellipse.color);
       break;
 
     case VDS::DrawType::FillArc:
-      sprite.fillArc(obj.objectArgs.arc.x, obj.objectArgs.arc.y,
-                      obj.objectArgs.arc.r0, obj.objectArgs.arc.r1,
-                      obj.objectArgs.arc.angle0, obj.objectArgs.arc.angle1,
-                      obj.objectArgs.arc.color);
+      sprite.fillArc(args.arc.x, args.arc.y,
+                      args.arc.r0, args.arc.r1,
+                      args.arc.angle0, args.arc.angle1,
+                      args.arc.color);
       break;
 
     case VDS::DrawType::FillEllipseArc:
-      sprite.fillEllipseArc(obj.objectArgs.ellipseArc.x, obj.objectArgs.ellipseArc.y,
-                            obj.objectArgs.ellipseArc.r0x, obj.objectArgs.ellipseArc.r1x,
-                            obj.objectArgs.ellipseArc.r0y, obj.objectArgs.ellipseArc.r1y,
-                            obj.objectArgs.ellipseArc.angle0, obj.objectArgs.ellipseArc.angle1,
-                            obj.objectArgs.ellipseArc.color);
+      sprite.fillEllipseArc(args.ellipseArc.x, args.ellipseArc.y,
+                            args.ellipseArc.r0x, args.ellipseArc.r1x,
+                            args.ellipseArc.r0y, args.ellipseArc.r1y,
+                            args.ellipseArc.angle0, args.ellipseArc.angle1,
+                            args.ellipseArc.color);
       break;
 
     // -------------------- 画像描画 --------------------
     case VDS::DrawType::DrawJpgFile:
-      if (obj.objectArgs.jpg.path != nullptr) {
-        if (obj.objectArgs.jpg.dataSource == VDS::DataType::SD) {
-          File f = SD.open(obj.objectArgs.jpg.path);
+      if (args.jpg.path != nullptr) {
+        VT_PROFILE_SCOPE(FrameStats::Stage::ImageDecode);
+        if (args.jpg.dataSource == VDS::DataType::SD) {
+          File f = SD.open(args.jpg.path);
           if (f) {
             sprite.drawJpg(&f,
-                          obj.objectArgs.jpg.x, obj.objectArgs.jpg.y,
-                          obj.objectArgs.jpg.maxWidth, obj.objectArgs.jpg.maxHeight,
-                          obj.objectArgs.jpg.offX, obj.objectArgs.jpg.offY,
-                          obj.objectArgs.jpg.scaleX, obj.objectArgs.jpg.scaleY);
+                          args.jpg.x, args.jpg.y,
+                          args.jpg.maxWidth, args.jpg.maxHeight,
+                          args.jpg.offX, args.jpg.offY,
+                          args.jpg.scaleX, args.jpg.scaleY);
             f.close();
           } else {
-            Serial.printf("Failed to open JPG: %s\n", obj.objectArgs.jpg.path);
+            VT_LOG_ERROR(debugLog, "Failed to open JPG: %s", args.jpg.path);
           }
         }
       }
       break;
 
     case VDS::DrawType::DrawPngFile:
-      if (obj.objectArgs.png.path != nullptr) {
-        if (obj.objectArgs.png.dataSource == VDS::DataType::SD) {
-          File f = SD.open(obj.objectArgs.png.path);
+      if (args.png.path != nullptr) {
+        VT_PROFILE_SCOPE(FrameStats::Stage::ImageDecode);
+        if (args.png.dataSource == VDS::DataType::SD) {
+          File f = SD.open(args.png.path);
           if (f) {
             sprite.drawPng(&f,
-                          obj.objectArgs.png.x, obj.objectArgs.png.y,
-                          obj.objectArgs.png.maxWidth, obj.objectArgs.png.maxHeight,
-                          obj.objectArgs.png.offX, obj.objectArgs.png.offY,
-                          obj.objectArgs.png.scaleX, obj.objectArgs.png.scaleY);
+                          args.png.x, args.png.y,
+                          args.png.maxWidth, args.png.maxHeight,
+                          args.png.offX, args.png.offY,
+                          args.png.scaleX, args.png.scaleY);
             f.close();
           } else {
-            Serial.printf("Failed to open PNG: %s\n", obj.objectArgs.png.path);
+            VT_LOG_ERROR(debugLog, "Failed to open PNG: %s", args.png.path);
           }
         }
       }
       break;
 
     case VDS::DrawType::DrawBitmap:
-      if (obj.objectArgs.bitmap.data) {
-          sprite.pushImage(obj.objectArgs.bitmap.x, obj.objectArgs.bitmap.y,
-                          obj.objectArgs.bitmap.w, obj.objectArgs.bitmap.h,
-                          obj.objectArgs.bitmap.data);
+      if (args.bitmap.data) {
+          sprite.pushImage(args.bitmap.x, args.bitmap.y,
+                          args.bitmap.w, args.bitmap.h,
+                          args.bitmap.data);
       }
       break;
 
     // -------------------- 文字描画 --------------------
     case VDS::DrawType::DrawString:
 
-      if (obj.objectArgs.text.font)
-        sprite.setFont(obj.objectArgs.text.font);
+      if (args.text.font)
+        sprite.setFont(args.text.font);
 
-      sprite.setTextDatum(obj.objectArgs.text.datum);
-      sprite.setTextColor(obj.objectArgs.text.color, obj.objectArgs.text.bgcolor);
-      sprite.setTextSize(obj.objectArgs.text.textSize);
+      sprite.setTextDatum(args.text.datum);
+      sprite.setTextColor(args.text.color, args.text.bgcolor);
+      sprite.setTextSize(args.text.textSize);
 
-      sprite.setTextWrap(obj.objectArgs.text.textWrap, false);
+      sprite.setTextWrap(args.text.textWrap, false);
 
-      sprite.drawString(obj.objectArgs.text.text,
-                        obj.objectArgs.text.x,
-                        obj.objectArgs.text.y);
+      sprite.drawString(args.text.text,
+                        args.text.x,
+                        args.text.y);
 
       break;
 
     // -------------------- Clip系（範囲制限） --------------------
+    // 単体では何も描かない（後に描く要素への制限は ClipStack が行う）
     case VDS::DrawType::ClipArc:
     case VDS::DrawType::ClipEllipseArc:
     case VDS::DrawType::ClipRect:
@@ -860,17 +2142,16 @@ bool VisualData::drawObject (LGFX_Sprite &sprite, const VDS::ObjectData &obj) {
     case VDS::DrawType::ClipCircle:
     case VDS::DrawType::ClipEllipse:
     case VDS::DrawType::ClipTriangle:
-      Serial.println(F("Clip type not implemented"));
       break;
 
     // -------------------- コンテナ系 --------------------
+    // 子の配置は LayoutEngine が行い、コンテナ自体は何も描かない
     case VDS::DrawType::FlexBox:
     case VDS::DrawType::TableBox:
-      Serial.println(F("Container type not implemented"));
       break;
 
     default:
-      Serial.println(F("Unknown DrawType"));
+      VT_LOG_ERROR(debugLog, "Unknown DrawType");
       return false;
   }
 
@@ -878,33 +2159,199 @@ bool VisualData::drawObject (LGFX_Sprite &sprite, const VDS::ObjectData &obj) {
 }
 
 
-bool VisualData::drawPage(LGFX_Sprite &sprite, const String pageName) {
-
+// 描画ページを切り替える（描画はしない。スプライトを持たない TileRenderer からも使う）
+bool VisualData::setDrawingPage(const String& pageName) {
   VDS::PageData page;
-  page = getPageData(getPageNumByName(pageName));
+  {
+    VT_PROFILE_SCOPE(FrameStats::Stage::PageResolve);
+    int pageNum = getPageNumByName(pageName);
+    if (pageCache) pageCache->require(pageNum);  // 未展開なら展開
+    page = getPageData(pageNum);
+  }
   if (page.isEmpty()) return false;
 
+  // 前回と同じページを、保存データ・バインドの値も変わらないまま描き直すなら命令列はそのまま使える
+  // （前回から currentPageCopy を直接変えていれば pageRevision が進んでいるので作り直す）
+  uint32_t revision = pageRevision;
+  bool isSame = page.pageNum == currentPageCopy.pageNum && pageRevision == drawnRevision && dataRevision == drawnDataRevision;
+
   currentPageCopy = page;
-  Serial.printf("Drawing page: %s\n", pageName.c_str());
-  Serial.printf("Number of objects: %d\n", currentPageCopy.objects.size());
+  currentStaticPage = StaticUi::Page();
+  // 保存されたページの相対位置で子を置いてからバインドを反映し、バインドで動いた親に子を追従させる
+  tree.clear();
+  tree.update(currentPageCopy, false);
+  bool bindingsChanged = applyBindings();
+  tree.update(currentPageCopy, false);
+  dirtyRects.clear();
+
+  // 追従・並べ直しは同じ入力から同じ結果になるので、それによる pageRevision の増加は数えない
+  pageRevision = (isSame && !bindingsChanged) ? revision : revision + 1;
+  drawnRevision = pageRevision;
+  drawnDataRevision = dataRevision;
+  if (pageCache) pageCache->evictToBudget();   // 前の描画ページが破棄可能になる
+  VT_LOG_INFO(debugLog, "Drawing page: %s (%u objects)", pageName.c_str(), unsigned(currentPageCopy.objects.size()));
+  return true;
+}
 
-  // Z-indexで安定ソート
-  std::vector<VDS::ObjectData> sortedObjects = currentPageCopy.objects;
-  std::stable_sort(sortedObjects.begin(), sortedObjects.end(),
-                    [](const VDS::ObjectData &a, const VDS::ObjectData &b) {
+bool VisualData::drawPage(LGFX_Sprite &sprite, const String pageName) {
+  if (!setDrawingPage(pageName)) return false;
+
+  // ページか描画範囲が変わったときだけ命令列を作り直す
+  if (!displayList.isCompiled(pageRevision, getVisibleRect(sprite))) compileDisplayList(displayList, sprite);
+
+  sprite.fillSprite(BLACK);
+  displayList.play(sprite, this, &clipStack);
+  return true;
+}
+
+// currentPageCopy を z 順に並べ、見えない要素を除いてから命令列にする
+void VisualData::compileDisplayList (DisplayList& list, LGFX_Sprite &sprite) {
+  VT_PROFILE_SCOPE(FrameStats::Stage::ListCompile);
+  VDS::Rect visible = getVisibleRect(sprite);
+  std::vector<DrawItem> items;
+  collectDrawOrder(currentPageCopy, items);
+  lastCulled = cullItems(sprite, visible, items, false);
+
+  list.clear();
+  for (const auto& item : items) {
+    VDS::DrawType type;
+    VDS::ObjectArgs args;
+    if (!resolveItem(item, type, args)) continue;
+    if (ClipStack::isClipType(type)) {
+      list.appendClip(type, args, item.zIndex);
+      continue;
+    }
+    list.setLayer(item.zIndex);
+    list.append(type, args);
+  }
+  list.setSource(pageRevision, visible);
+}
+
+// 帯（band の高さの行）ごとに描いてすぐ dst へ送る（全画面スプライトを持てない機種向け）
+// 範囲は最初に 1 回だけ求め、帯に掛からないものは描画の分岐に入る前に飛ばす
+bool VisualData::drawPageBanded(LGFX_Sprite &band, LovyanGFX* dst, const String pageName) {
+  if (!dst || band.height() <= 0) return false;
+  if (!setDrawingPage(pageName)) return false;
+
+  std::vector<DrawItem> items;
+  collectDrawOrder(currentPageCopy, items);
+  lastCulled = cullItems(band, getVisibleRect(*dst), items, false);
+
+  std::vector<VDS::Rect> bounds(items.size());
+  std::vector<uint8_t> hasBounds(items.size());
+  for (size_t i = 0; i < items.size(); i++) hasBounds[i] = getItemBounds(band, items[i], bounds[i]);
+
+  for (int32_t y0 = 0; y0 < dst->height(); y0 += band.height()) {
+    VDS::Rect strip{ 0, y0, band.width(), band.height() };
+    band.fillSprite(BLACK);
+    clipStack.begin(&band, 0, y0);
+    for (size_t i = 0; i < items.size(); i++) {
+      VDS::DrawType type;
+      VDS::ObjectArgs args;
+      if (!resolveItem(items[i], type, args)) continue;
+      if (ClipStack::isClipType(type)) {
+        clipStack.push(type, args, items[i].zIndex);
+        continue;
+      }
+      if (hasBounds[i] && !bounds[i].intersects(strip)) continue;
+      if (!clipStack.enter(items[i].zIndex)) continue;
+      translateArgs(type, args, 0, -y0);
+      drawObject(band, type, args);
+    }
+    clipStack.end();
+    band.pushSprite(dst, 0, y0);
+  }
+  return true;
+}
+
+// 描画順の要素を種類と引数にする（インスタンスはテンプレートを解決）
+bool VisualData::resolveItem (const DrawItem& item, VDS::DrawType& type, VDS::ObjectArgs& args) const {
+  if (item.object) {
+    type = item.object->type;
+    args = item.object->objectArgs;
+    return true;
+  }
+  const VDS::TemplateData& tmpl = getTemplateData(item.instance->templateNum);
+  if (tmpl.isEmpty()) return false;
+  type = tmpl.type;
+  args = resolveInstance(tmpl, *item.instance);
+  return true;
+}
+
+// オブジェクト → インスタンスの順に並べ、zIndex で安定ソートする（非表示のオブジェクト・コンテナは除く）
+void VisualData::collectDrawOrder (const VDS::PageData& page, std::vector<DrawItem>& items) const {
+  items.clear();
+  items.reserve(page.objects.size() + page.instances.size());
+  for (const auto& obj : page.objects) {
+    if (!obj.isHidden && !LayoutEngine::isContainerType(obj.type)) items.push_back({ &obj, nullptr, obj.zIndex });
+  }
+  for (const auto& inst : page.instances) items.push_back({ nullptr, &inst, inst.zIndex });
+  std::stable_sort(items.begin(), items.end(),
+                    [](const DrawItem &a, const DrawItem &b) {
                       return a.zIndex < b.zIndex;
                     });
+}
+
+// 同じテンプレートのインスタンス列を描画（文字の場合はフォント等の設定を 1 回で済ませる）
+bool VisualData::drawInstanceRun (LGFX_Sprite &sprite, const DrawItem* run, size_t count) {
+  const VDS::TemplateData& tmpl = getTemplateData(run[0].instance->templateNum);
+  if (tmpl.isEmpty()) return false;
+
+  if (tmpl.type == VDS::DrawType::DrawString) {
+    const VDS::StringArgs& base = tmpl.objectArgs.text;
+    if (base.font) sprite.setFont(base.font);
+    sprite.setTextDatum(base.datum);
+    sprite.setTextSize(base.textSize);
+    sprite.setTextWrap(base.textWrap, false);
+
+    for (size_t i = 0; i < count; i++) {
+      const VDS::InstanceData& inst = *run[i].instance;
+      const char* text = (inst.overrides & VDS::OverrideText)  ? inst.text  : base.text;
+      int color        = (inst.overrides & VDS::OverrideColor) ? inst.color : base.color;
+      if (!text) continue;
+      VT_PROFILE_DRAW_SCOPE(VDS::DrawType::DrawString);
+      sprite.setTextColor(color, base.bgcolor);
+      sprite.drawString(text, base.x + inst.dx, base.y + inst.dy);
+    }
+    return true;
+  }
+
+  for (size_t i = 0; i < count; i++) {
+    drawObject(sprite, tmpl.type, resolveInstance(tmpl, *run[i].instance));
+  }
+  return true;
+}
+
+
+// 静的ページ（StaticUi.h）をテーブルから直接描画する
+bool VisualData::drawStaticPage(LGFX_Sprite &sprite, const StaticUi::Page& page) {
+  if (page.isEmpty()) return false;
+
+  currentStaticPage = page;
+  currentPageCopy = VDS::PageData();
+  pageRevision++;
+  if (pageCache) pageCache->evictToBudget();
 
   sprite.fillSprite(BLACK);
 
-  // 描画
-  for (auto &obj : sortedObjects) {
-    drawObject(sprite, obj);
+  // drawOrder はコンパイル時に zIndex 順へ並べ替え済み
+  clipStack.begin(&sprite);
+  for (uint16_t i = 0; i < page.objectCount; i++) {
+    const StaticUi::Object& obj = page.objects[page.drawOrder[i]];
+    if (ClipStack::isClipType(obj.type)) {
+      clipStack.push(obj.type, obj.args, obj.zIndex);
+      continue;
+    }
+    if (clipStack.enter(obj.zIndex)) drawObject(sprite, obj.type, obj.args);
   }
+  clipStack.end();
 
   return true;
 }
 
+bool VisualData::isStaticPageDrawing() const {
+  return !currentStaticPage.isEmpty();
+}
 
 
 void VisualData::finalizeSetup () {
@@ -14,23 +14,68 @@
 
 #include "SerialDebug.h"
 #include "VisualDataSet.h"
+#include "StaticUi.h"
+#include "DisplayList.hpp"
+#include "ClipStack.hpp"
+#include "LayoutEngine.hpp"
+#include "SceneTree.hpp"
+
+// 遮蔽判定で覚えておく前面の不透明な矩形の数（0 で遮蔽カリングを行わない）
+#ifndef VT_OCCLUDER_MAX
+#define VT_OCCLUDER_MAX 16
+#endif
+
+class PageCache;
 
 class VisualData{
 public:
   Debug debugLog;
   using VDS = VisualDataSet;
 
-  LGFX_Sprite clipSprite;
+  LovyanGFX* display;        // 描画先の画面（文字列を折り返す右端に使う）
+  LGFX_Sprite clipSprite;    // Clip のマスクを作るときだけ確保する（1 bit）
+  LGFX_Sprite boundsSprite;  // 文字列の範囲を測るためだけに使う（バッファは確保しない）
+  ClipMaskCache clipMasks;   // 矩形以外の Clip のマスク（描画・判定で共有）
+  ClipStack clipStack;       // 描画時の Clip の状態
+  LayoutEngine layout;       // 描画中ページのコンテナの子の配置
+  SceneTree tree;            // 描画中ページの親子関係（子を親に追従させる）
 
   VDS visualDataSet;
   VDS::PageData editingPage;
 
   VDS::PageData currentPageCopy;
+  StaticUi::Page currentStaticPage;  // drawStaticPage() で描画中の静的ページ（未使用時は空）
 
   bool isBatchUpdating = false;
   int lastAssignedPageNum = 0;
   int lastAssignedObjectNum = 0;
 
+  // 描画順に並べたオブジェクト / インスタンス（どちらか一方のみ非 null）
+  struct DrawItem {
+    const VDS::ObjectData* object = nullptr;
+    const VDS::InstanceData* instance = nullptr;
+    uint8_t zIndex = 0;
+  };
+
+  static constexpr size_t MAX_DIRTY_RECTS = 8;   // これを超えたら 1 つの範囲にまとめる
+  std::vector<VDS::Rect> dirtyRects;             // 次の redrawDirty() で描き直す範囲
+  std::vector<VDS::Rect> flushedRects;           // 直前の redrawDirty() で描き直した範囲
+
+  // 描画前に除いた要素の数
+  struct CullCounts {
+    size_t offscreen = 0;   // 描画先・クリップの外、または面積 0
+    size_t occluded = 0;    // 前面の不透明な矩形に覆われる
+  };
+  CullCounts lastCulled;                         // 直前の drawPage() / drawPageBanded() の分
+
+  DisplayList displayList;                       // drawPage() が描いたページの命令列
+  uint32_t pageRevision = 0;                     // currentPageCopy を変えるたびに増やす（命令列の作り直し用）
+  uint32_t dataRevision = 0;                     // 保存済みページ・テンプレート・バインドを変えるたびに増やす
+  uint32_t drawnRevision = 0;                    // 直前の setDrawingPage() の時点の pageRevision / dataRevision
+  uint32_t drawnDataRevision = 0;                // （同じページを変わらないまま描き直すなら pageRevision を進めない）
+
+  PageCache* pageCache = nullptr;  // 遅延展開モード時のページ目録（PageCache::attach で設定）
+
   VisualData(LovyanGFX* parent, bool enableErrorLog, bool enableInfoLog, bool enableSuccessLog);
 
   bool isExistsPage(int pageNum) const;
@@ -62,6 +107,7 @@ public:
   bool deletePage(int pageNum);
   String getDrawingPage() const;
 
+  int nextObjectNum(const VDS::PageData& page) const;
   VDS::ObjectData checkCreatable(const String& objectName, bool onDisplay = false);
   bool deleteObject(const String& objectName, bool onDisplay = false);
   bool moveObject(const String& objectName, size_t newIndex, bool onDisplay = false);
@@ -96,6 +142,58 @@ public:
   VDS::ObjectData setDrawBitmapObject ( const String& objectName, const uint16_t* bitmap, int32_t x, int32_t y, int32_t w, int32_t h, uint8_t zIndex = 0, bool isUntouchable = false, bool onDisplay = false);
   // 文字
   VDS::ObjectData setDrawStringObject(const String& objectName, int32_t x, int32_t y, const char* text, int color = WHITE, int bgcolor = -1, const lgfx::IFont* font = &fonts::lgfxJapanGothic_40, textdatum_t datum = textdatum_t::top_left, int textSize = 1, bool textWrap = true, uint8_t zIndex = 0, bool isUntouchable = false, bool onDisplay = false);
+  // 範囲制限（後に描く、zIndex がより大きい要素だけに効く）
+  VDS::ObjectData setClipRectObject       (const String& objectName, int32_t x, int32_t y, int32_t w, int32_t h,                                                                 uint8_t zIndex = 0, bool onDisplay = false);
+  VDS::ObjectData setClipRoundRectObject  (const String& objectName, int32_t x, int32_t y, int32_t w, int32_t h, int32_t r,                                                      uint8_t zIndex = 0, bool onDisplay = false);
+  VDS::ObjectData setClipCircleObject     (const String& objectName, int32_t x, int32_t y, int32_t r,                                                                            uint8_t zIndex = 0, bool onDisplay = false);
+  VDS::ObjectData setClipEllipseObject    (const String& objectName, int32_t x, int32_t y, int32_t rx, int32_t ry,                                                               uint8_t zIndex = 0, bool onDisplay = false);
+  VDS::ObjectData setClipTriangleObject   (const String& objectName, int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t x2, int32_t y2,                                     uint8_t zIndex = 0, bool onDisplay = false);
+  VDS::ObjectData setClipArcObject        (const String& objectName, int32_t x, int32_t y, int32_t r0,  int32_t r1,  int32_t angle0, int32_t angle1,                             uint8_t zIndex = 0, bool onDisplay = false);
+  VDS::ObjectData setClipEllipseArcObject (const String& objectName, int32_t x, int32_t y, int32_t r0x, int32_t r1x, int32_t r0y, int32_t r1y, int32_t angle0, int32_t angle1, uint8_t zIndex = 0, bool onDisplay = false);
+  // コンテナ（子を並べるだけで何も描かない）
+  VDS::ObjectData setFlexBoxObject  (const String& objectName, int32_t x, int32_t y, int32_t w, int32_t h, VDS::BoxDirection direction, int32_t gap = 0, int32_t padding = 0, VDS::BoxAlign justify = VDS::BoxAlign::Start, VDS::BoxAlign align = VDS::BoxAlign::Start, uint8_t zIndex = 0, bool onDisplay = false);
+  VDS::ObjectData setTableBoxObject (const String& objectName, int32_t x, int32_t y, int32_t w, int32_t h, int32_t columns, int32_t rows = 0, int32_t gap = 0, int32_t padding = 0, VDS::BoxAlign justify = VDS::BoxAlign::Center, VDS::BoxAlign align = VDS::BoxAlign::Center, uint8_t zIndex = 0, bool onDisplay = false);
+  bool setLayoutParent(const String& objectName, const String& containerName, bool onDisplay = false);
+  // 親子関係（子の座標は親の基準座標からの相対。parentName が空なら外す）
+  bool setParent(const String& objectName, const String& parentName, bool inheritColor = false, bool onDisplay = false);
+
+  // テンプレート / インスタンス
+  bool setObjectTemplate(const String& templateName, VDS::DrawType type, const VDS::ObjectArgs& args);
+  int getTemplateNumByName(const String& templateName) const;
+  const VDS::TemplateData& getTemplateData(int templateNum) const;
+  const VDS::InstanceData* getInstanceData(const VDS::PageData& page, int objNum) const;
+  VDS::InstanceData setInstanceObject(const String& objectName, const String& templateName, int32_t dx, int32_t dy, const char* text = nullptr, int color = -1, uint8_t zIndex = 0, bool isUntouchable = false, bool onDisplay = false);
+  VDS::ObjectArgs resolveInstance(const VDS::TemplateData& tmpl, const VDS::InstanceData& inst) const;
+
+  // 引数の操作・描画範囲
+  void translateArgs(VDS::DrawType type, VDS::ObjectArgs& args, int32_t dx, int32_t dy) const;
+  bool setArgsColor(VDS::DrawType type, VDS::ObjectArgs& args, int color) const;
+  bool getArgsColor(VDS::DrawType type, const VDS::ObjectArgs& args, int& color) const;
+  bool getArgsOrigin(VDS::DrawType type, const VDS::ObjectArgs& args, int32_t& x, int32_t& y) const;
+  bool getObjectBounds(LGFX_Sprite &sprite, VDS::DrawType type, const VDS::ObjectArgs& args, VDS::Rect& bounds);
+  bool getObjectBounds(LGFX_Sprite &sprite, const VDS::ObjectData& obj, VDS::Rect& bounds);
+  bool getItemBounds(LGFX_Sprite &sprite, const DrawItem& item, VDS::Rect& bounds);
+  void updateBounds(VDS::ObjectData& obj);
+  VDS::Rect getVisibleRect(LovyanGFX& gfx) const;
+  int getOpaqueRects(VDS::DrawType type, const VDS::ObjectArgs& args, bool forJudge, VDS::Rect (&rects)[2]) const;
+  CullCounts cullItems(LGFX_Sprite &sprite, const VDS::Rect& visible, std::vector<DrawItem>& items, bool forJudge);
+
+  // データバインディング（値が変わったオブジェクトだけを再描画）
+  bool bindValue(const String& objectName, VDS::BindProperty property, std::function<int32_t()> getter, int pageNum = -1);
+  bool bindValue(const String& objectName, VDS::BindProperty property, const int32_t* watched, int pageNum = -1);
+  bool bindText(const String& objectName, std::function<const char*()> getter, int pageNum = -1);
+  bool bindText(const String& objectName, const char* watched, int pageNum = -1);
+  bool addBinding(const String& objectName, VDS::BindingData& binding, int pageNum);
+  bool unbind(const String& objectName, int pageNum = -1);
+  bool applyProperty(VDS::DrawType type, VDS::ObjectArgs& args, VDS::BindProperty property, int32_t value, const char* text) const;
+  bool getProperty(VDS::DrawType type, const VDS::ObjectArgs& args, VDS::BindProperty property, int32_t& value) const;
+  static uint32_t hashText(const char* text);
+  bool pollBinding(VDS::BindingData& binding, int32_t& value, const char*& text);
+  bool applyBindings();
+  int updateBindings(LGFX_Sprite &sprite);
+  void markDirty(const VDS::Rect& rect);
+  bool redrawDirty(LGFX_Sprite &sprite);
+  const std::vector<VDS::Rect>& getFlushedRects() const;
 
   bool getJpgSize(fs::FS &fs, const char* filename, int &w, int &h);
 
@@ -107,11 +205,23 @@ public:
   bool getPngSize(File &file, int &width, int &height);
 
   bool drawObject(LGFX_Sprite &sprite, const VDS::ObjectData &obj);
+  bool drawObject(LGFX_Sprite &sprite, VDS::DrawType type, const VDS::ObjectArgs &args);
+  bool drawInstanceRun(LGFX_Sprite &sprite, const DrawItem* run, size_t count);
+  void collectDrawOrder(const VDS::PageData& page, std::vector<DrawItem>& items) const;
+  bool resolveItem(const DrawItem& item, VDS::DrawType& type, VDS::ObjectArgs& args) const;
+  void compileDisplayList(DisplayList& list, LGFX_Sprite &sprite);
+  bool setDrawingPage(const String& pageName);
   bool drawPage(LGFX_Sprite &sprite, const String pageName);
+  bool drawPageBanded(LGFX_Sprite &band, LovyanGFX* dst, const String pageName);
+  bool drawStaticPage(LGFX_Sprite &sprite, const StaticUi::Page& page);
+  bool isStaticPageDrawing() const;
 
   /*
-    drawObject  // オブジェクトごとに描画
-    drawPage    // ページ単位で描画
+    drawObject      // オブジェクトごとに描画
+    drawInstanceRun // 同じテンプレートのインスタンスをまとめて描画
+    drawPage        // ページ単位で描画
+    drawPageBanded  // 数行の帯スプライトでページを上から順に描いて転送
+    drawStaticPage  // StaticUi.h の const テーブルを直接描画
   */
 
 
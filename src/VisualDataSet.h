@@ -1,6 +1,8 @@
+#pragma once
 #include <Arduino.h>
 #include <M5GFX.h>
 #include <vector>
+#include <functional>
 #include <SD.h>
 
 class VisualDataSet{
@@ -51,7 +53,6 @@ public:
   };
 
 
-
   struct PixelArgs      { int32_t x = 0;  int32_t y = 0;                                                                                                                 int color = 0; };
   struct LineArgs       { int32_t x0 = 0; int32_t y0 = 0; int32_t x1 = 0;  int32_t y1 = 0;                                                                               int color = 0; };
   struct BezierArgs     { int32_t x0 = 0; int32_t y0 = 0; int32_t x1 = 0;  int32_t y1 = 0;  int32_t x2 = 0;     int32_t y2 = 0;                                          int color = 0; };
@@ -67,6 +68,36 @@ public:
   struct ArcArgs        { int32_t x = 0;  int32_t y = 0;  int32_t r0 = 0;  int32_t r1 = 0;  int32_t angle0 = 0; int32_t angle1 = 0;                                      int color = 0; };
   struct EllipseArcArgs { int32_t x = 0;  int32_t y = 0;  int32_t r0x = 0; int32_t r1x = 0; int32_t r0y = 0;    int32_t r1y = 0; int32_t angle0 = 0; int32_t angle1 = 0; int color = 0; };
   
+  // コンテナ（FlexBox / TableBox）の並べ方
+  enum class BoxDirection : int32_t {
+    Row,            // 横並び
+    Column          // 縦並び
+  };
+  enum class BoxAlign : int32_t {
+    Start,
+    Center,
+    End,
+    SpaceBetween    // 両端に寄せて間を均等に空ける（FlexBox の主軸のみ、それ以外は Start）
+  };
+
+  // 子オブジェクト（ObjectData::parentNum がこのコンテナ）を並べる範囲と規則
+  //   FlexBox  : 子を direction の向きに 1 列に並べる。justify は主軸、align は交差軸の寄せ方
+  //   TableBox : 範囲を columns x rows のセルに等分し、子を左上から行順に 1 つずつ置く。
+  //              justify はセル内の横、align はセル内の縦の寄せ方（rows が 0 なら子の数から決める）
+  struct BoxArgs {
+    int32_t x = 0;
+    int32_t y = 0;
+    int32_t w = 0;
+    int32_t h = 0;
+    int32_t padding = 0;    // 枠の内側の余白
+    int32_t gap = 0;        // 子・セルどうしの間隔
+    int32_t columns = 0;    // TableBox の列数（FlexBox では使わない）
+    int32_t rows = 0;       // TableBox の行数
+    BoxDirection direction = BoxDirection::Row;
+    BoxAlign justify = BoxAlign::Start;
+    BoxAlign align = BoxAlign::Start;
+  };
+
   struct JpgFileArgs    {
     DataType dataSource = DataType::SD;
     const char *path = nullptr;
@@ -138,8 +169,62 @@ public:
     BitmapArgs     bitmap;
 
     StringArgs     text;
+
+    BoxArgs        box;
     
     ObjectArgs() {}
+    // 静的ページ（StaticUi.h）を constexpr で組み立てるためのコンストラクタ
+    constexpr ObjectArgs(const PixelArgs& a)      : pixel(a) {}
+    constexpr ObjectArgs(const LineArgs& a)       : line(a) {}
+    constexpr ObjectArgs(const BezierArgs& a)     : bezier(a) {}
+    constexpr ObjectArgs(const WideLineArgs& a)   : wideLine(a) {}
+    constexpr ObjectArgs(const RectArgs& a)       : rect(a) {}
+    constexpr ObjectArgs(const RoundRectArgs& a)  : roundRect(a) {}
+    constexpr ObjectArgs(const CircleArgs& a)     : circle(a) {}
+    constexpr ObjectArgs(const EllipseArgs& a)    : ellipse(a) {}
+    constexpr ObjectArgs(const TriangleArgs& a)   : triangle(a) {}
+    constexpr ObjectArgs(const ArcArgs& a)        : arc(a) {}
+    constexpr ObjectArgs(const EllipseArcArgs& a) : ellipseArc(a) {}
+    constexpr ObjectArgs(const JpgFileArgs& a)    : jpg(a) {}
+    constexpr ObjectArgs(const PngFileArgs& a)    : png(a) {}
+    constexpr ObjectArgs(const BitmapArgs& a)     : bitmap(a) {}
+    constexpr ObjectArgs(const StringArgs& a)     : text(a) {}
+    constexpr ObjectArgs(const BoxArgs& a)        : box(a) {}
+  };
+
+  // 描画範囲（再描画範囲の計算に使用）
+  struct Rect{
+    int32_t x = 0;
+    int32_t y = 0;
+    int32_t w = 0;
+    int32_t h = 0;
+
+    bool isEmpty() const {
+      return w <= 0 || h <= 0;
+    }
+    bool intersects(const Rect& o) const {
+      return x < o.x + o.w && o.x < x + w && y < o.y + o.h && o.y < y + h;
+    }
+    bool contains(const Rect& o) const {
+      return o.x >= x && o.y >= y && o.x + o.w <= x + w && o.y + o.h <= y + h;
+    }
+    Rect intersected(const Rect& o) const {
+      int32_t x0 = x > o.x ? x : o.x;
+      int32_t y0 = y > o.y ? y : o.y;
+      int32_t x1 = (x + w < o.x + o.w) ? x + w : o.x + o.w;
+      int32_t y1 = (y + h < o.y + o.h) ? y + h : o.y + o.h;
+      if (x1 <= x0 || y1 <= y0) return Rect();
+      return Rect{ x0, y0, x1 - x0, y1 - y0 };
+    }
+    Rect united(const Rect& o) const {
+      if (isEmpty()) return o;
+      if (o.isEmpty()) return *this;
+      int32_t x0 = x < o.x ? x : o.x;
+      int32_t y0 = y < o.y ? y : o.y;
+      int32_t x1 = (x + w > o.x + o.w) ? x + w : o.x + o.w;
+      int32_t y1 = (y + h > o.y + o.h) ? y + h : o.y + o.h;
+      return Rect{ x0, y0, x1 - x0, y1 - y0 };
+    }
   };
 
   struct ObjectData{
@@ -149,16 +234,85 @@ public:
     ObjectArgs objectArgs;
     uint8_t zIndex = 0;
     bool isUntouchable = false;
+    bool isHidden = false;          // 描画・タッチ判定の対象外（SceneQueue::hide）
+    int parentNum = -1;             // 親オブジェクトの objectNum（-1 はなし、コンテナなら位置は配置に任せる）
+    int32_t localX = 0;             // 親の基準座標からの位置（親がコンテナ以外のとき、SceneTree が保つ）
+    int32_t localY = 0;
+    bool inheritColor = false;      // 色を親（色を持たない親ならその先祖）から受け継ぐ
+    Rect bounds;                    // 描画範囲（引数を変えたら VisualData::updateBounds で更新）
+    bool hasBounds = false;         // false のときは使うたびに求める
 
     bool isEmpty() const {
       return objectNum == -1; // ダミーデータは pageNum = -1 として判定
     }
   };
 
+  // 値に連動させるオブジェクトの項目
+  enum class BindProperty : uint8_t {
+    Text,     // DrawString の文字列
+    Color,
+    X,        // 位置（線・三角形は全頂点を平行移動）
+    Y,
+    W,        // 矩形・画像の幅
+    H,        // 矩形・画像の高さ
+    R,        // 円の半径 / 角丸・太線の r / 円弧の外径
+    Angle0,   // 円弧の開始角
+    Angle1    // 円弧の終了角（ゲージ等）
+  };
+
+  struct BindingData{
+    int pageNum = -1;
+    int objectNum = -1;
+    BindProperty property = BindProperty::Color;
+    std::function<int32_t()> getValue;     // Text 以外
+    std::function<const char*()> getText;  // Text のみ（返す文字列は描画まで有効であること）
+    int32_t cachedValue = 0;               // Text の場合は内容のハッシュ
+    bool hasCache = false;
+  };
+
+  // 複数のインスタンスで共有する引数（キーパッドのキーやラベルなど）
+  struct TemplateData{
+    int templateNum = -1;
+    String templateName = "";
+    DrawType type = DrawType::DrawPixel;
+    ObjectArgs objectArgs;
+
+    bool isEmpty() const {
+      return templateNum == -1;
+    }
+  };
+
+  // インスタンスが上書きする項目
+  enum InstanceOverride : uint8_t {
+    OverrideNone  = 0,
+    OverrideText  = 1 << 0,
+    OverrideColor = 1 << 1
+  };
+
+  // テンプレートとの差分だけを持つオブジェクト（ObjectArgs を持たない）
+  struct InstanceData{
+    int objectNum = -1;               // ObjectData と同じ番号空間（タッチ判定で使用）
+    String objectName = "";
+    uint16_t templateNum = 0;
+    int32_t dx = 0;                   // テンプレートの座標からのずれ
+    int32_t dy = 0;
+    const char* text = nullptr;       // OverrideText のときのみ有効
+    int color = 0;                    // OverrideColor のときのみ有効
+    uint8_t overrides = OverrideNone;
+    uint8_t zIndex = 0;
+    bool isUntouchable = false;
+    int parentNum = -1;               // 並べてもらうコンテナの objectNum（-1 はなし、コンテナ以外の親は持てない）
+
+    bool isEmpty() const {
+      return objectNum == -1;
+    }
+  };
+
   struct PageData{
     int pageNum = -1;
     String pageName = "";
     std::vector<ObjectData> objects;
+    std::vector<InstanceData> instances;
 
     bool isEmpty() const {
       return pageNum == -1; // ダミーデータは pageNum = -1 として判定
@@ -166,4 +320,6 @@ public:
   };
 
   std::vector<PageData> pages;
+  std::vector<TemplateData> templates;  // 全ページ共通
+  std::vector<BindingData> bindings;
 };
\ No newline at end of file
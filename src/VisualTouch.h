@@ -3,16 +3,68 @@
 
 #include "VisualData.hpp"
 #include "TouchData.hpp"
+#include "UiBlobLoader.hpp"
+#include "PageCache.hpp"
+#include "MemoryReport.hpp"
+#include "SceneQueue.hpp"
+#include "Animator.hpp"
+#include "RenderPipeline.hpp"
+#include "TileRenderer.hpp"
+#include "FramePacer.hpp"
 
 class VisualTouch {
 public:
     VisualData vData;
     TouchData tData;
+    UiBlobLoader blobLoader;
+    PageCache pageCache;
+    MemoryReport memoryReport;
+    SceneQueue sceneQueue;     // 別タスクからの編集（描画ループで apply する）
+    Animator animator;         // 項目の時間補間（描画ループで update する）
+    RenderPipeline pipeline;   // タッチ判定と描画を別コアで回す（begin() するまで何もしない）
+    TileRenderer tileRenderer; // 全画面スプライトなしでタイルごとに描く（begin() するまで何もしない）
+    FramePacer framePacer;     // 変化のあったフレームだけを一定の間隔で描いて転送する
 
     VisualTouch(LovyanGFX* lcd, bool enableErrorLog, bool enableInfoLog, bool enableSuccessLog)
         : vData(lcd, enableErrorLog, enableInfoLog, enableSuccessLog),
-            tData(&vData, enableErrorLog, enableInfoLog, enableSuccessLog)
+            tData(&vData, enableErrorLog, enableInfoLog, enableSuccessLog),
+            blobLoader(&vData, &tData, enableErrorLog, enableInfoLog, enableSuccessLog),
+            pageCache(&vData, &tData, &blobLoader, enableErrorLog, enableInfoLog, enableSuccessLog),
+            memoryReport(&vData, &tData, &pageCache, &pipeline, &tileRenderer),
+            sceneQueue(&vData, enableErrorLog, enableInfoLog, enableSuccessLog),
+            animator(&vData, enableErrorLog, enableInfoLog, enableSuccessLog),
+            pipeline(&vData, &tData, &sceneQueue, &animator, lcd, enableErrorLog, enableInfoLog, enableSuccessLog),
+            tileRenderer(&vData, lcd, enableErrorLog, enableInfoLog, enableSuccessLog),
+            framePacer(&vData, &sceneQueue, &animator, lcd, enableErrorLog, enableInfoLog, enableSuccessLog)
     {}
+
+    // tools/uiblob.py で生成したバイナリ UI を読み込む（blob は読み込み後も保持すること）
+    bool loadUiBlob(const uint8_t* blob, size_t size) {
+        return blobLoader.load(blob, size);
+    }
+
+    // ページを必要になった時点で展開する（ramBudget バイトを超えたら古いページから破棄、0 で無制限）
+    bool attachUiBlob(const uint8_t* blob, size_t size, size_t ramBudget = 0) {
+        return pageCache.attach(blob, size, ramBudget);
+    }
+
+    // 頻繁に行き来するページを常駐させる
+    bool pinPage(const String& pageName, bool pinned = true) {
+        return pageCache.pinPage(pageCache.getPageNumByName(pageName), pinned);
+    }
+
+    // コンポーネントごとの使用メモリ（呼ぶたびに最大値も更新される）
+    const MemoryStats& getMemoryStats() {
+        return memoryReport.sample();
+    }
+
+    const MemoryStats& getMemoryPeak() const {
+        return memoryReport.getPeak();
+    }
+
+    void printMemoryReport(bool withPages = true) {
+        memoryReport.print(withPages);
+    }
 };
 
 #endif
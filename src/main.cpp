@@ -1,6 +1,8 @@
 #include <Arduino.h>
 #include <M5Unified.h>
 #include "VisualTouch.h"
+#include "FrameProfiler.hpp"
+#include "TouchLatency.hpp"
 
 // カラー深度
 const int cDepth_24 = 16;
@@ -47,6 +49,8 @@ void setup() {
   sSetup();
 
   Serial.begin(115200);
+  FrameProfiler::setDumpInterval(5000);  // -DVT_PROFILE=1 のとき 5 秒ごとに計測結果を出力
+  TouchLatency::setDumpInterval(10000);  // タッチ遅延のヒストグラムを 10 秒ごとに出力
 
   // スプライト作成
   initSprite(sprite1, cDepth_24);
@@ -101,9 +105,8 @@ void setup() {
   currentPageNum = page1;
   vt.tData.setProcessPage();
 
-  // page1 を描画
-  vt.vData.drawPage(sprite1, "page1");
-  sprite1.pushSprite(&lcd, 0, 0);
+  // page1 を描画（転送は最初の loop() のフレームで行う）
+  vt.framePacer.showPage(sprite1, "page1");
 }
 
 void test(){
@@ -188,11 +191,12 @@ void test(){
   sprite.endWrite();  // おまじない
   lcd.endWrite();     // おまじない
 
-  delay(1); // 更新間隔は1ミリ秒で設定
+  vt.framePacer.waitFrame(); // 更新間隔はフレームレートに合わせる
 }
 
 void loop() {
   M5.update();
+  TouchLatency::acquire();  // タッチ遅延の起点
 
   String currentPageName = vt.vData.getPageData().pageName;
   String pageName = currentPageName;
@@ -207,23 +211,29 @@ void loop() {
 
   if(isTester){
     test();
+    vt.framePacer.invalidate();  // 通常表示に戻ったら画面全体を送り直す
   }else{
-    sprite1.pushSprite(&lcd, 0, 0);
     if (pageName != currentPageName) {
       currentPageName = pageName;
 
-      vt.vData.drawPage(sprite1, currentPageName);
-      sprite1.pushSprite(&lcd, 0, 0);
+      vt.framePacer.showPage(sprite1, currentPageName);
       vt.tData.setProcessPage();
     }
 
+    // 別タスクからの編集・アニメーションを反映し、変わったフレームだけ描いて変わった範囲を転送する
+    vt.framePacer.update(sprite1);
+
     // タッチ処理
     if (vt.tData.update()) {
       String proc = vt.tData.currentProcessName;
       if (proc != "") {
         Serial.printf("Process: %s\n", proc.c_str());
       }
+      TouchLatency::observe();  // アプリが結果を処理し終えた時点
     }
+
+    // 次のフレームまで（何も変わっていなければしばらく）CPU を返す
+    vt.framePacer.wait();
   }
 }
 
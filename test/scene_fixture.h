@@ -0,0 +1,68 @@
+// 単体テストで共有するシーン（env:native / ホスト専用）
+//
+//   #include "../scene_fixture.h"
+//
+//   struct Scene : SceneFixture {
+//     Scene() {
+//       vt.vData.setFillRectObject("r0", 10, 10, 20, 20, RED);   // シナリオごとのオブジェクトだけ置く
+//       show();
+//     }
+//   };
+//
+// 画面と同じ大きさのスプライトと、空のページ "main" を持つ VisualTouch を用意する。
+// オブジェクトを置いたら show() で確定して描画中のページにする（FramePacer など別の経路で
+// 表示するなら finalizeSetup() だけ呼んでその経路に渡す）。
+
+#pragma once
+#include <Arduino.h>
+#include <M5Unified.h>
+#include <vector>
+#include "VisualTouch.h"
+
+const int SCREEN_W = 320;
+const int SCREEN_H = 240;
+
+struct SceneFixture {
+  using VDS = VisualDataSet;
+
+  VisualTouch vt;
+  LGFX_Sprite sprite;
+  int pageNum = -1;
+
+  SceneFixture() : vt(&M5.Display, false, false, false), sprite(&M5.Display) {
+    sprite.setColorDepth(16);
+    sprite.createSprite(SCREEN_W, SCREEN_H);
+    vt.vData.addPage("main");
+    pageNum = vt.vData.getPageNumByName("main");
+  }
+
+  ~SceneFixture() {
+    sprite.deleteSprite();
+  }
+
+  // 置いたオブジェクトを確定して描画中のページにする
+  void show() {
+    vt.vData.finalizeSetup();
+    vt.vData.drawPage(sprite, "main");
+  }
+
+  // 描画中のページの写し・保存済みのページにあるオブジェクト
+  const VDS::ObjectData* shownObject(int objectNum) {
+    return vt.vData.getObjectDataRef(&vt.vData.currentPageCopy, objectNum);
+  }
+
+  const VDS::ObjectData* shownObject(const String& name) {
+    return shownObject(vt.vData.getObjectNumByName(name, pageNum));
+  }
+
+  const VDS::ObjectData* storedObject(int objectNum) {
+    return vt.vData.getObjectDataRef(vt.vData.getPageDataRef(pageNum), objectNum);
+  }
+};
+
+inline bool hasRect(const std::vector<VisualDataSet::Rect>& rects, int32_t x, int32_t y, int32_t w, int32_t h) {
+  for (const auto& r : rects) {
+    if (r.x == x && r.y == y && r.w == w && r.h == h) return true;
+  }
+  return false;
+}
@@ -0,0 +1,236 @@
+// Animator の単体テスト（env:native / ホスト専用）
+//
+//   pio test -e native -f test_animator
+//
+// update() に決まった時刻を渡して、イージングごとの途中の値、終了後に目標の値で止まって
+// 待機状態に戻ること、開始の遅延、時間の上限を超えた分が次のフレームへ回ることを確かめる。
+
+#include <Arduino.h>
+#include <M5Unified.h>
+#include <unity.h>
+#include <vector>
+#include "../scene_fixture.h"
+
+namespace {
+
+  using VDS = VisualDataSet;
+  using Easing = Animator::Easing;
+
+  const uint32_t T0 = 5000;    // 最初の update() の時刻（開始時刻はここから数える）
+
+  // 縦に並べた 4 つの矩形と文字列を置いたページを表示中にする
+  struct Scene : SceneFixture {
+    Scene() {
+      for (int i = 0; i < 4; i++) {
+        vt.vData.setFillRectObject("r" + String(i), 0, 10 + i * 30, 20, 20, RED);
+      }
+      vt.vData.setDrawStringObject("label", 0, 150, "0", WHITE, -1, &fonts::Font0);
+      show();
+    }
+
+    int32_t x(int i) {
+      return shownObject("r" + String(i))->objectArgs.rect.x;
+    }
+  };
+
+} // namespace
+
+// -------------------- イージング --------------------
+
+// 0 → 1000 を 1000 ms で動かしたときの 1/4・1/2・3/4 の時点の値
+void test_easing_values_at_fixed_times() {
+  struct Expected {
+    Easing easing;
+    const char* name;
+    int32_t at[3];
+  };
+  const Expected table[] = {
+    { Easing::Linear,     "Linear",     {  250,  500,  750 } },
+    { Easing::InQuad,     "InQuad",     {   63,  250,  563 } },
+    { Easing::OutQuad,    "OutQuad",    {  438,  750,  938 } },
+    { Easing::InOutQuad,  "InOutQuad",  {  125,  500,  875 } },
+    { Easing::InCubic,    "InCubic",    {   16,  125,  422 } },
+    { Easing::OutCubic,   "OutCubic",   {  578,  875,  984 } },
+    { Easing::InOutCubic, "InOutCubic", {   63,  500,  938 } },
+    { Easing::OutBack,    "OutBack",    {  817, 1088, 1064 } },
+    { Easing::OutBounce,  "OutBounce",  {  473,  766,  973 } },
+  };
+
+  for (const auto& e : table) {
+    Scene scene;
+    TEST_ASSERT_TRUE_MESSAGE(scene.vt.animator.animate("r0", VDS::BindProperty::X, 0, 1000, 1000, e.easing), e.name);
+    scene.vt.animator.update(scene.sprite, T0);
+    TEST_ASSERT_EQUAL_INT32_MESSAGE(0, scene.x(0), e.name);
+    for (int i = 0; i < 3; i++) {
+      scene.vt.animator.update(scene.sprite, T0 + 250 * (i + 1));
+      // float の丸めで 1 ずれることは許す
+      TEST_ASSERT_INT_WITHIN_MESSAGE(1, e.at[i], scene.x(0), e.name);
+    }
+    scene.vt.animator.update(scene.sprite, T0 + 1000);
+    TEST_ASSERT_EQUAL_INT32_MESSAGE(1000, scene.x(0), e.name);
+  }
+}
+
+// どのイージングも 0 で始まり 1 で終わる
+void test_ease_endpoints() {
+  const Easing all[] = {
+    Easing::Linear, Easing::InQuad, Easing::OutQuad, Easing::InOutQuad,
+    Easing::InCubic, Easing::OutCubic, Easing::InOutCubic, Easing::OutBack, Easing::OutBounce
+  };
+  for (Easing e : all) {
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 0.0f, Animator::ease(e, 0.0f));
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 1.0f, Animator::ease(e, 1.0f));
+  }
+}
+
+// 色は RGB565 の成分ごとに補間する
+void test_lerp_color() {
+  TEST_ASSERT_EQUAL_HEX16(uint16_t(RED), Animator::lerpColor(RED, BLUE, 0.0f));
+  TEST_ASSERT_EQUAL_HEX16(uint16_t(BLUE), Animator::lerpColor(RED, BLUE, 1.0f));
+  int32_t mid = Animator::lerpColor(0xF800, 0x001F, 0.5f);
+  TEST_ASSERT_EQUAL(15, (mid >> 11) & 0x1F);   // 31 - 15.5 は 0 から離れる向きに丸める
+  TEST_ASSERT_EQUAL(0, (mid >> 5) & 0x3F);
+  TEST_ASSERT_EQUAL(16, mid & 0x1F);
+}
+
+// -------------------- 終了と待機 --------------------
+
+// 終了時刻で目標の値になって止まり、その後の update() は何も変えない
+void test_completes_and_goes_idle() {
+  Scene scene;
+  Animator& animator = scene.vt.animator;
+  TEST_ASSERT_TRUE(animator.isIdle());
+  TEST_ASSERT_TRUE(animator.animate("r1", VDS::BindProperty::X, 100, 100, Easing::Linear));
+  TEST_ASSERT_TRUE(animator.isAnimating("r1"));
+  TEST_ASSERT_FALSE(animator.isIdle());
+  TEST_ASSERT_EQUAL(1, int(animator.getActiveCount()));
+
+  animator.update(scene.sprite, T0);
+  scene.vt.vData.redrawDirty(scene.sprite);
+  TEST_ASSERT_EQUAL(1, animator.update(scene.sprite, T0 + 40));
+  TEST_ASSERT_EQUAL_INT32(40, scene.x(1));
+  TEST_ASSERT_TRUE(animator.isAnimating("r1"));
+  // 動いた前後の範囲だけを描き直す
+  TEST_ASSERT_EQUAL(2, int(scene.vt.vData.dirtyRects.size()));
+  TEST_ASSERT_TRUE(hasRect(scene.vt.vData.dirtyRects, 0, 40, 20, 20));
+  TEST_ASSERT_TRUE(hasRect(scene.vt.vData.dirtyRects, 40, 40, 20, 20));
+  scene.vt.vData.redrawDirty(scene.sprite);
+
+  // フレームが飛んでも終了時刻を過ぎていれば目標の値になる
+  TEST_ASSERT_EQUAL(1, animator.update(scene.sprite, T0 + 250));
+  TEST_ASSERT_EQUAL_INT32(100, scene.x(1));
+  TEST_ASSERT_FALSE(animator.isAnimating("r1"));
+  TEST_ASSERT_TRUE(animator.isIdle());
+  TEST_ASSERT_EQUAL(0, int(animator.getActiveCount()));
+  scene.vt.vData.redrawDirty(scene.sprite);
+
+  TEST_ASSERT_EQUAL(0, animator.update(scene.sprite, T0 + 500));
+  TEST_ASSERT_EQUAL(0, int(animator.getLastApplied()));
+  TEST_ASSERT_TRUE(scene.vt.vData.dirtyRects.empty());
+  TEST_ASSERT_EQUAL_INT32(100, scene.x(1));
+}
+
+// delayMs は最初に進めた update() から数え、開始までは値を変えない
+void test_delay_counts_from_first_update() {
+  Scene scene;
+  Animator& animator = scene.vt.animator;
+  TEST_ASSERT_TRUE(animator.animate("r2", VDS::BindProperty::X, 0, 100, 100, Easing::Linear, 50));
+
+  TEST_ASSERT_EQUAL(0, animator.update(scene.sprite, T0));
+  TEST_ASSERT_EQUAL(0, animator.update(scene.sprite, T0 + 49));
+  TEST_ASSERT_FALSE(animator.isIdle());
+  animator.update(scene.sprite, T0 + 100);
+  TEST_ASSERT_EQUAL_INT32(50, scene.x(2));
+  animator.update(scene.sprite, T0 + 150);
+  TEST_ASSERT_EQUAL_INT32(100, scene.x(2));
+  TEST_ASSERT_TRUE(animator.isIdle());
+}
+
+// 止めたアニメーションはその値のまま残る
+void test_stop_keeps_value() {
+  Scene scene;
+  Animator& animator = scene.vt.animator;
+  TEST_ASSERT_TRUE(animator.animate("r3", VDS::BindProperty::X, 0, 200, 200, Easing::Linear));
+  animator.update(scene.sprite, T0);
+  animator.update(scene.sprite, T0 + 50);
+  TEST_ASSERT_TRUE(animator.stop("r3"));
+  TEST_ASSERT_TRUE(animator.isIdle());
+  TEST_ASSERT_EQUAL(0, animator.update(scene.sprite, T0 + 200));
+  TEST_ASSERT_EQUAL_INT32(50, scene.x(3));
+}
+
+// 文字列は数値を書式化して書き換える
+void test_animate_text() {
+  Scene scene;
+  Animator& animator = scene.vt.animator;
+  TEST_ASSERT_TRUE(animator.animateText("label", 0, 100, 1000, "%d%%"));
+  animator.update(scene.sprite, T0);
+  animator.update(scene.sprite, T0 + 500);
+  TEST_ASSERT_EQUAL_STRING("50%", scene.shownObject("label")->objectArgs.text.text);
+  animator.update(scene.sprite, T0 + 1000);
+  TEST_ASSERT_EQUAL_STRING("100%", scene.shownObject("label")->objectArgs.text.text);
+  TEST_ASSERT_TRUE(animator.isIdle());
+}
+
+// -------------------- 時間の上限 --------------------
+
+// budgetUs を使い切ったら残りは次のフレームへ回し、次はその続きから反映する
+void test_over_budget_deferred_to_next_frame() {
+  Scene scene;
+  Animator& animator = scene.vt.animator;
+  for (int i = 0; i < 4; i++) {
+    TEST_ASSERT_TRUE(animator.animate("r" + String(i), VDS::BindProperty::X, 50, 150, 100, Easing::Linear));
+  }
+
+  // micros() を読むたびに上限の分だけ進め、1 つ反映するごとに時間切れにする
+  animator.budgetUs = 10;
+  host::setVirtualClock(true);
+  host::setMicrosPerRead(10);
+
+  animator.update(scene.sprite, T0);
+  TEST_ASSERT_EQUAL(1, int(animator.getLastApplied()));
+  TEST_ASSERT_EQUAL(3, int(animator.getLastDeferred()));
+  TEST_ASSERT_EQUAL_INT32(50, scene.x(0));
+  TEST_ASSERT_EQUAL_INT32(0, scene.x(1));
+
+  // 次のフレームは回した続き（r1）から始める
+  animator.update(scene.sprite, T0 + 20);
+  TEST_ASSERT_EQUAL(1, int(animator.getLastApplied()));
+  TEST_ASSERT_EQUAL(3, int(animator.getLastDeferred()));
+  TEST_ASSERT_EQUAL_INT32(50, scene.x(0));
+  TEST_ASSERT_EQUAL_INT32(50, scene.x(1));
+  TEST_ASSERT_EQUAL_INT32(0, scene.x(2));
+
+  // 時間が足りれば残りをすべて反映する
+  host::setMicrosPerRead(0);
+  animator.update(scene.sprite, T0 + 40);
+  TEST_ASSERT_EQUAL(4, int(animator.getLastApplied()));
+  TEST_ASSERT_EQUAL(0, int(animator.getLastDeferred()));
+  TEST_ASSERT_EQUAL_INT32(90, scene.x(0));
+  TEST_ASSERT_EQUAL_INT32(70, scene.x(1));
+  TEST_ASSERT_EQUAL_INT32(50, scene.x(2));
+  TEST_ASSERT_EQUAL_INT32(50, scene.x(3));
+  TEST_ASSERT_EQUAL(4, int(animator.getActiveCount()));
+}
+
+void setUp() {}
+
+void tearDown() {
+  host::setMicrosPerRead(0);
+  host::setVirtualClock(false);
+}
+
+int main(int, char**) {
+  M5.begin();
+
+  UNITY_BEGIN();
+  RUN_TEST(test_easing_values_at_fixed_times);
+  RUN_TEST(test_ease_endpoints);
+  RUN_TEST(test_lerp_color);
+  RUN_TEST(test_completes_and_goes_idle);
+  RUN_TEST(test_delay_counts_from_first_update);
+  RUN_TEST(test_stop_keeps_value);
+  RUN_TEST(test_animate_text);
+  RUN_TEST(test_over_budget_deferred_to_next_frame);
+  return UNITY_END();
+}
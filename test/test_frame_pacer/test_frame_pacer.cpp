@@ -0,0 +1,170 @@
+// FramePacer の単体テスト（env:native / ホスト専用）
+//
+//   pio test -e native -f test_frame_pacer
+//
+// 仮想時計で時刻を進めながら update() を呼び、変化のないフレームは描かずに数えること、
+// 再描画範囲が画面の半分未満なら範囲だけ・半分以上なら全体を送ること、
+// 1 フレーム以上遅れたときに数え直すことを確かめる。
+
+#include <Arduino.h>
+#include <M5Unified.h>
+#include <unity.h>
+#include "../scene_fixture.h"
+
+namespace {
+
+  using VDS = VisualDataSet;
+
+  const uint32_t SCREEN_PIXELS = uint32_t(SCREEN_W) * SCREEN_H;
+  const uint32_t FPS = 50;
+  const uint32_t FRAME_MS = 1000 / FPS;
+
+  // 矩形を 1 つ置いたページを仮想時計の上で表示する（最初の update() で全体を送る）
+  struct Scene : SceneFixture {
+    SceneHandle mover;
+
+    Scene() {
+      vt.vData.setFillRectObject("mover", 10, 10, 20, 20, RED);
+      vt.vData.finalizeSetup();
+      mover = vt.sceneQueue.getHandle("mover", pageNum);
+
+      host::setVirtualClock(true);
+      vt.framePacer.setTargetFps(FPS);
+      vt.framePacer.showPage(sprite, "main");
+    }
+
+    // 1 フレーム分進めて update() する
+    bool tick(uint32_t ms = FRAME_MS) {
+      host::advanceMillis(ms);
+      return vt.framePacer.update(sprite);
+    }
+
+    const PacingStats& stats() {
+      return vt.framePacer.getStats();
+    }
+  };
+
+} // namespace
+
+// 最初のフレームは全体を送り、その後は変化がなければ描かずに数えるだけ
+void test_clean_scene_counts_idle_ticks() {
+  Scene scene;
+  TEST_ASSERT_TRUE(scene.tick(0));
+  TEST_ASSERT_EQUAL_UINT32(1, scene.stats().frames);
+  TEST_ASSERT_EQUAL_UINT32(1, scene.stats().fullFrames);
+  TEST_ASSERT_EQUAL_UINT32(SCREEN_PIXELS, uint32_t(scene.stats().pushedPixels));
+
+  for (int i = 0; i < 5; i++) TEST_ASSERT_FALSE(scene.tick());
+  TEST_ASSERT_EQUAL_UINT32(5, scene.stats().idleTicks);
+  TEST_ASSERT_EQUAL_UINT32(1, scene.stats().frames);
+  TEST_ASSERT_EQUAL_UINT32(0, scene.stats().lateFrames);
+  TEST_ASSERT_TRUE(scene.vt.framePacer.isIdle());
+
+  // フレームの時刻の前は何もしない（数えもしない）
+  TEST_ASSERT_FALSE(scene.tick(FRAME_MS / 2));
+  TEST_ASSERT_EQUAL_UINT32(5, scene.stats().idleTicks);
+}
+
+// 変化のあったフレームは動いた範囲だけを送る
+void test_dirty_scene_pushes_changed_area() {
+  Scene scene;
+  TEST_ASSERT_TRUE(scene.tick(0));
+
+  TEST_ASSERT_TRUE(scene.vt.sceneQueue.move(scene.mover, 5, 0));
+  TEST_ASSERT_FALSE(scene.vt.framePacer.isIdle());
+  // 時刻の前に積んだ編集も、次のフレームの時刻まで描かない
+  TEST_ASSERT_FALSE(scene.tick(FRAME_MS / 2));
+  TEST_ASSERT_TRUE(scene.tick(FRAME_MS - FRAME_MS / 2));
+
+  // 動く前 (10, 10, 20, 20) と後 (15, 10, 20, 20) をまとめた範囲
+  TEST_ASSERT_EQUAL_UINT32(2, scene.stats().frames);
+  TEST_ASSERT_EQUAL_UINT32(1, scene.stats().fullFrames);
+  TEST_ASSERT_EQUAL_UINT32(SCREEN_PIXELS + 25 * 20, uint32_t(scene.stats().pushedPixels));
+  TEST_ASSERT_EQUAL_UINT32(FRAME_MS * 1000, scene.stats().lastIntervalUs);
+  TEST_ASSERT_EQUAL_UINT32(0, scene.stats().idleTicks);
+
+  TEST_ASSERT_FALSE(scene.tick());
+  TEST_ASSERT_EQUAL_UINT32(1, scene.stats().idleTicks);
+}
+
+// 送る画素数が画面の半分に届いたら（pixels * 2 >= screenPixels）1 回で全体を送る
+void test_partial_full_threshold() {
+  Scene scene;
+  TEST_ASSERT_TRUE(scene.tick(0));
+  scene.vt.framePacer.resetStats();
+
+  // 半分に 1 行足りない
+  scene.vt.vData.markDirty(VDS::Rect{ 0, 0, SCREEN_W, SCREEN_H / 2 - 1 });
+  TEST_ASSERT_TRUE(scene.tick());
+  TEST_ASSERT_EQUAL_UINT32(0, scene.stats().fullFrames);
+  TEST_ASSERT_EQUAL_UINT32(uint32_t(SCREEN_W) * (SCREEN_H / 2 - 1), uint32_t(scene.stats().pushedPixels));
+
+  // ちょうど半分
+  scene.vt.framePacer.resetStats();
+  scene.vt.vData.markDirty(VDS::Rect{ 0, 0, SCREEN_W, SCREEN_H / 2 });
+  TEST_ASSERT_TRUE(scene.tick());
+  TEST_ASSERT_EQUAL_UINT32(1, scene.stats().fullFrames);
+  TEST_ASSERT_EQUAL_UINT32(SCREEN_PIXELS, uint32_t(scene.stats().pushedPixels));
+
+  // 離れた 2 つの範囲の合計で半分
+  scene.vt.framePacer.resetStats();
+  scene.vt.vData.markDirty(VDS::Rect{ 0, 0, SCREEN_W, SCREEN_H / 4 });
+  scene.vt.vData.markDirty(VDS::Rect{ 0, SCREEN_H / 2, SCREEN_W, SCREEN_H / 4 });
+  TEST_ASSERT_TRUE(scene.tick());
+  TEST_ASSERT_EQUAL_UINT32(1, scene.stats().fullFrames);
+
+  // 画面の外は数えない
+  scene.vt.framePacer.resetStats();
+  scene.vt.vData.markDirty(VDS::Rect{ 0, SCREEN_H - 10, SCREEN_W, SCREEN_H });
+  TEST_ASSERT_TRUE(scene.tick());
+  TEST_ASSERT_EQUAL_UINT32(0, scene.stats().fullFrames);
+  TEST_ASSERT_EQUAL_UINT32(uint32_t(SCREEN_W) * 10, uint32_t(scene.stats().pushedPixels));
+
+  // invalidate() の後は範囲によらず全体
+  scene.vt.framePacer.resetStats();
+  scene.vt.framePacer.invalidate();
+  TEST_ASSERT_TRUE(scene.tick());
+  TEST_ASSERT_EQUAL_UINT32(1, scene.stats().frames);
+  TEST_ASSERT_EQUAL_UINT32(1, scene.stats().fullFrames);
+}
+
+// 転送を続けている間に 1 フレーム以上遅れたら数え、次の時刻を今から数え直す
+void test_late_frames() {
+  Scene scene;
+  TEST_ASSERT_TRUE(scene.tick(0));
+
+  scene.vt.sceneQueue.move(scene.mover, 1, 0);
+  TEST_ASSERT_TRUE(scene.tick(FRAME_MS * 2 + 5));
+  TEST_ASSERT_EQUAL_UINT32(1, scene.stats().lateFrames);
+
+  // 次の時刻は遅れたフレームから 1 フレーム後（詰めて描かない）
+  scene.vt.sceneQueue.move(scene.mover, 1, 0);
+  TEST_ASSERT_FALSE(scene.tick(FRAME_MS - 1));
+  TEST_ASSERT_TRUE(scene.tick(1));
+  TEST_ASSERT_EQUAL_UINT32(3, scene.stats().frames);
+  TEST_ASSERT_EQUAL_UINT32(1, scene.stats().lateFrames);
+
+  // 変化がなく描かなかった間に過ぎた時刻は遅れに数えない
+  TEST_ASSERT_FALSE(scene.tick());
+  scene.vt.sceneQueue.move(scene.mover, 1, 0);
+  TEST_ASSERT_TRUE(scene.tick(FRAME_MS * 5));
+  TEST_ASSERT_EQUAL_UINT32(1, scene.stats().lateFrames);
+  TEST_ASSERT_EQUAL_UINT32(1, scene.stats().idleTicks);
+}
+
+void setUp() {}
+
+void tearDown() {
+  host::setVirtualClock(false);
+}
+
+int main(int, char**) {
+  M5.begin();
+
+  UNITY_BEGIN();
+  RUN_TEST(test_clean_scene_counts_idle_ticks);
+  RUN_TEST(test_dirty_scene_pushes_changed_area);
+  RUN_TEST(test_partial_full_threshold);
+  RUN_TEST(test_late_frames);
+  return UNITY_END();
+}
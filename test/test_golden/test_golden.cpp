@@ -0,0 +1,520 @@
+// ゴールデン画像による描画・判定マップの回帰テスト（env:native / ホスト専用）
+//
+//   pio test -e native -f test_golden
+//
+// test/golden/fixtures/*.bin（*.json を tools/uiblob.py で変換したもの）の各ページについて
+//   - VisualData::drawPage() の描画結果      → test/golden/expected/<fixture>/<page>.visual.rle
+//   - TouchData::drawPageProcess() の判定マップ → test/golden/expected/<fixture>/<page>.judge.rle
+//   - TileRenderer::drawPage() / VisualData::drawPageBanded() でパネルに描いた結果 → visual と同じ期待画像
+// と 1 ピクセル単位で比較し、描画＋判定マップ作成の時間（中央値の合計）を fixture ごとの予算と比べる。
+// 描画の最適化（再描画範囲・カリング・キャッシュなど）は、出力が変わらないことと速くなったことをここで示す。
+// あわせて、命令列・タイルのリストの使い回しと、バインドの変化で描き直す範囲も確かめる。
+//
+// 環境変数
+//   VT_GOLDEN_DIR           : test/golden の場所（既定 "test/golden"）
+//   VT_GOLDEN_UPDATE=1      : 比較せずに期待画像を書き直す（意図した見た目の変更のときだけ）
+//   VT_GOLDEN_BUDGET_SCALE  : 予算の倍率（既定 1。遅い CI では大きく、0 で時間を検査しない）
+//
+// fixture を追加・変更したら
+//   python3 tools/uiblob.py test/golden/fixtures/<name>.json test/golden/fixtures/<name>.bin
+// のあと VT_GOLDEN_UPDATE=1 で期待画像を作り、差分を目視してからコミットする。
+// 不一致のときは test/golden/out/ に実際の画像と期待画像を PPM で書き出す。
+
+#include <Arduino.h>
+#include <M5Unified.h>
+#include <unity.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+#include "VisualTouch.h"
+
+namespace {
+
+  struct Fixture {
+    const char* name;
+    uint32_t budgetUs;    // 全ページの drawPage + drawPageProcess（各中央値）の合計
+  };
+
+  // 予算は -O0 のホストビルドで測った値のおよそ 3 倍
+  const Fixture FIXTURES[] = {
+    { "shapes", 6000 },
+    { "text",   6000 },
+    { "grid",   9000 },
+  };
+
+  const int TIMING_RUNS = 7;
+
+  std::string goldenDir;
+  bool updateMode = false;
+  float budgetScale = 1.0f;
+  const Fixture* currentFixture = nullptr;
+
+  // -------------------- 期待画像（RGB565 のランレングス） --------------------
+  // "VTG1" + 幅 + 高さ（uint16）+ [ラン長 uint16, 色 uint16] の繰り返し（すべてリトルエンディアン）
+  const char RLE_MAGIC[4] = { 'V', 'T', 'G', '1' };
+
+  void putU16(std::vector<uint8_t>& out, uint16_t v) {
+    out.push_back(uint8_t(v & 0xFF));
+    out.push_back(uint8_t(v >> 8));
+  }
+
+  uint16_t getU16(const uint8_t* p) {
+    return uint16_t(p[0] | (p[1] << 8));
+  }
+
+  bool writeRle(const std::string& path, const uint16_t* pixels, int w, int h) {
+    std::vector<uint8_t> out(RLE_MAGIC, RLE_MAGIC + 4);
+    putU16(out, uint16_t(w));
+    putU16(out, uint16_t(h));
+    size_t n = size_t(w) * h;
+    for (size_t i = 0; i < n; ) {
+      size_t run = 1;
+      while (i + run < n && run < 0xFFFF && pixels[i + run] == pixels[i]) run++;
+      putU16(out, uint16_t(run));
+      putU16(out, pixels[i]);
+      i += run;
+    }
+    FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) return false;
+    bool ok = std::fwrite(out.data(), 1, out.size(), f) == out.size();
+    std::fclose(f);
+    return ok;
+  }
+
+  bool readRle(const std::string& path, std::vector<uint16_t>& pixels, int& w, int& h) {
+    FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) return false;
+    std::vector<uint8_t> data;
+    uint8_t buf[4096];
+    size_t len;
+    while ((len = std::fread(buf, 1, sizeof(buf), f)) > 0) data.insert(data.end(), buf, buf + len);
+    std::fclose(f);
+
+    if (data.size() < 8 || !std::equal(RLE_MAGIC, RLE_MAGIC + 4, data.begin())) return false;
+    w = getU16(&data[4]);
+    h = getU16(&data[6]);
+    pixels.clear();
+    pixels.reserve(size_t(w) * h);
+    for (size_t pos = 8; pos + 4 <= data.size(); pos += 4) {
+      pixels.insert(pixels.end(), getU16(&data[pos]), getU16(&data[pos + 2]));
+    }
+    return pixels.size() == size_t(w) * h;
+  }
+
+  // 目視確認用
+  void writePpm(const std::string& path, const uint16_t* pixels, int w, int h) {
+    FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) return;
+    std::fprintf(f, "P6\n%d %d\n255\n", w, h);
+    for (size_t i = 0; i < size_t(w) * h; i++) {
+      uint16_t c = pixels[i];
+      uint8_t rgb[3] = { uint8_t((c >> 11) * 255 / 31), uint8_t(((c >> 5) & 0x3F) * 255 / 63), uint8_t((c & 0x1F) * 255 / 31) };
+      std::fwrite(rgb, 1, 3, f);
+    }
+    std::fclose(f);
+  }
+
+  // -------------------- 比較 --------------------
+  // 一致しなければメッセージを返す（空文字列で一致）
+  // label は不一致時の出力名（省略時は kind）
+  std::string compareWithGolden(const LovyanGFX& surface, const std::string& fixture,
+                                const String& page, const char* kind, const char* label = nullptr) {
+    const uint16_t* actual = surface.framebuffer();
+    int w = surface.width();
+    int h = surface.height();
+    std::string file = fixture + "/" + page.c_str() + "." + kind;
+    std::string path = goldenDir + "/expected/" + file + ".rle";
+
+    if (updateMode) {
+      ::mkdir((goldenDir + "/expected").c_str(), 0755);
+      ::mkdir((goldenDir + "/expected/" + fixture).c_str(), 0755);
+      return writeRle(path, actual, w, h) ? "" : "cannot write " + path;
+    }
+
+    std::vector<uint16_t> expected;
+    int ew = 0, eh = 0;
+    if (!readRle(path, expected, ew, eh)) return "missing or broken golden " + path;
+    if (ew != w || eh != h) {
+      char msg[160];
+      snprintf(msg, sizeof(msg), "%s: size %dx%d, golden %dx%d", file.c_str(), w, h, ew, eh);
+      return msg;
+    }
+
+    size_t diff = 0, first = 0;
+    for (size_t i = 0; i < expected.size(); i++) {
+      if (actual[i] == expected[i]) continue;
+      if (!diff) first = i;
+      diff++;
+    }
+    if (!diff) return "";
+
+    std::string out = goldenDir + "/out";
+    ::mkdir(out.c_str(), 0755);
+    std::string base = out + "/" + fixture + "_" + page.c_str() + "." + (label ? label : kind);
+    writePpm(base + ".actual.ppm", actual, w, h);
+    writePpm(base + ".expected.ppm", expected.data(), w, h);
+
+    char msg[200];
+    snprintf(msg, sizeof(msg), "%s: %u pixels differ, first (%d,%d) 0x%04X != 0x%04X (see %s.*.ppm)",
+             file.c_str(), unsigned(diff), int(first % w), int(first / w),
+             actual[first], expected[first], base.c_str());
+    return msg;
+  }
+
+  // -------------------- 計測 --------------------
+  template <typename F>
+  uint32_t medianUs(F fn) {
+    using Clock = std::chrono::steady_clock;
+    std::vector<uint32_t> samples;
+    for (int i = 0; i < TIMING_RUNS; i++) {
+      auto t0 = Clock::now();
+      fn();
+      samples.push_back(uint32_t(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - t0).count()));
+    }
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+  }
+
+  void runFixture() {
+    const Fixture& fixture = *currentFixture;
+    std::string path = goldenDir + "/fixtures/" + fixture.name + ".bin";
+    size_t size = 0;
+    const uint8_t* blob = UiBlobLoader::mapFile(path.c_str(), &size);
+    TEST_ASSERT_NOT_NULL_MESSAGE(blob, ("cannot map " + path).c_str());
+
+    VisualTouch vt(&M5.Display, true, false, false);
+    TEST_ASSERT_TRUE_MESSAGE(vt.tData.initJudgeSprite(&M5.Display), "judgeSprite");
+    TEST_ASSERT_TRUE_MESSAGE(vt.loadUiBlob(blob, size), ("invalid blob " + path).c_str());
+
+    LGFX_Sprite sprite(&M5.Display);
+    sprite.setColorDepth(16);
+    sprite.createSprite(M5.Display.width(), M5.Display.height());
+    TEST_ASSERT_TRUE_MESSAGE(vt.tileRenderer.begin(), "tileRenderer");
+    // 画面の高さで割り切れない帯（最後の帯が途中で切れる場合も確かめる）
+    LGFX_Sprite band(&M5.Display);
+    band.setColorDepth(16);
+    band.createSprite(M5.Display.width(), 28);
+
+    std::vector<String> pageNames;
+    for (const auto& page : vt.vData.visualDataSet.pages) pageNames.push_back(page.pageName);
+    TEST_ASSERT_TRUE_MESSAGE(!pageNames.empty(), "fixture has no pages");
+
+    std::vector<std::string> failures;
+    uint32_t totalUs = 0;
+    for (const auto& name : pageNames) {
+      // 描画（最後の 1 回の結果を比較）
+      bool drawn = true;
+      uint32_t drawUs = medianUs([&] { drawn = vt.vData.drawPage(sprite, name) && drawn; });
+      if (!drawn) {
+        failures.push_back(std::string("drawPage failed: ") + name.c_str());
+        continue;
+      }
+      std::string msg = compareWithGolden(sprite, fixture.name, name, "visual");
+      if (!msg.empty()) failures.push_back(msg);
+
+      // タイル描画も全画面スプライトと同じ結果になること
+      if (!updateMode) {
+        M5.Display.fillScreen(BLACK);
+        if (!vt.tileRenderer.drawPage(name)) {
+          failures.push_back(std::string("TileRenderer::drawPage failed: ") + name.c_str());
+        } else {
+          msg = compareWithGolden(M5.Display, fixture.name, name, "visual", "tile");
+          if (!msg.empty()) failures.push_back(msg);
+        }
+
+        M5.Display.fillScreen(BLACK);
+        if (!vt.vData.drawPageBanded(band, &M5.Display, name)) {
+          failures.push_back(std::string("drawPageBanded failed: ") + name.c_str());
+        } else {
+          msg = compareWithGolden(M5.Display, fixture.name, name, "visual", "banded");
+          if (!msg.empty()) failures.push_back(msg);
+        }
+      }
+
+      // 判定マップ
+      vt.tData.setProcessPage();
+      bool judged = true;
+      uint32_t judgeUs = medianUs([&] { judged = vt.tData.drawPageProcess() && judged; });
+      if (!judged) {
+        failures.push_back(std::string("drawPageProcess failed: ") + name.c_str());
+        continue;
+      }
+      msg = compareWithGolden(vt.tData.judgeSprite, fixture.name, name, "judge");
+      if (!msg.empty()) failures.push_back(msg);
+
+      std::printf("  %-8s %-12s drawPage %6u us  drawPageProcess %6u us  culled %u+%u / %u+%u\n",
+                  fixture.name, name.c_str(), unsigned(drawUs), unsigned(judgeUs),
+                  unsigned(vt.vData.lastCulled.offscreen), unsigned(vt.vData.lastCulled.occluded),
+                  unsigned(vt.tData.lastCulled.offscreen), unsigned(vt.tData.lastCulled.occluded));
+      totalUs += drawUs + judgeUs;
+    }
+
+    uint32_t budget = uint32_t(fixture.budgetUs * budgetScale);
+    std::printf("  %-8s total %u us / budget %u us%s\n", fixture.name, unsigned(totalUs), unsigned(budget),
+                updateMode ? " (updated goldens)" : "");
+    if (!updateMode && budget && totalUs > budget) {
+      char msg[120];
+      snprintf(msg, sizeof(msg), "%s: %u us exceeds budget %u us", fixture.name, unsigned(totalUs), unsigned(budget));
+      failures.push_back(msg);
+    }
+
+    if (failures.empty()) return;
+    std::string all;
+    for (const auto& f : failures) all += "\n    " + f;
+    TEST_FAIL_MESSAGE(all.c_str());
+  }
+}
+
+// 同じページを変わらないまま描き直すときは命令列を作り直さない
+// （変えたときだけ作り直す：SceneQueue の編集、バインドの値の変化）
+void test_redraw_reuses_display_list() {
+  std::string path = goldenDir + "/fixtures/shapes.bin";
+  size_t size = 0;
+  const uint8_t* blob = UiBlobLoader::mapFile(path.c_str(), &size);
+  TEST_ASSERT_NOT_NULL_MESSAGE(blob, ("cannot map " + path).c_str());
+
+  VisualTouch vt(&M5.Display, true, false, false);
+  TEST_ASSERT_TRUE(vt.tData.initJudgeSprite(&M5.Display));
+  TEST_ASSERT_TRUE(vt.loadUiBlob(blob, size));
+  LGFX_Sprite sprite(&M5.Display);
+  sprite.setColorDepth(16);
+  sprite.createSprite(M5.Display.width(), M5.Display.height());
+
+  for (const auto& page : vt.vData.visualDataSet.pages) {
+    String name = page.pageName;
+    TEST_ASSERT_TRUE(vt.vData.drawPage(sprite, name));
+    vt.tData.setProcessPage();
+    TEST_ASSERT_TRUE(vt.tData.drawPageProcess());
+    size_t compiled = vt.vData.displayList.getCompileCount();
+    size_t judged = vt.tData.judgeList.getCompileCount();
+    uint32_t revision = vt.vData.pageRevision;
+
+    TEST_ASSERT_TRUE(vt.vData.drawPage(sprite, name));
+    vt.tData.setProcessPage();   // TouchData::update() が毎フレーム呼ぶ
+    TEST_ASSERT_TRUE(vt.tData.drawPageProcess());
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(revision, vt.vData.pageRevision, name.c_str());
+    TEST_ASSERT_EQUAL_MESSAGE(compiled, vt.vData.displayList.getCompileCount(), name.c_str());
+    TEST_ASSERT_EQUAL_MESSAGE(judged, vt.tData.judgeList.getCompileCount(), name.c_str());
+  }
+
+  // 保存済みページも書き換える SceneQueue の編集の後は作り直し、その次はまた使い回す
+  int pageNum = vt.vData.getPageNumByName("primitives");
+  TEST_ASSERT_TRUE(vt.vData.drawPage(sprite, "primitives"));
+  const String objectName = vt.vData.currentPageCopy.objects.front().objectName;
+  size_t compiled = vt.vData.displayList.getCompileCount();
+  TEST_ASSERT_TRUE(vt.sceneQueue.move(vt.sceneQueue.getHandle(objectName, pageNum), 4, 0));
+  vt.sceneQueue.apply(sprite);
+  TEST_ASSERT_TRUE(vt.vData.drawPage(sprite, "primitives"));
+  TEST_ASSERT_EQUAL(compiled + 1, vt.vData.displayList.getCompileCount());
+  TEST_ASSERT_TRUE(vt.vData.drawPage(sprite, "primitives"));
+  TEST_ASSERT_EQUAL(compiled + 1, vt.vData.displayList.getCompileCount());
+
+  // バインドの値が変わっていれば作り直す
+  static int32_t boundX = 10;
+  TEST_ASSERT_TRUE(vt.vData.bindValue(objectName, VisualDataSet::BindProperty::X, &boundX, pageNum));
+  TEST_ASSERT_TRUE(vt.vData.drawPage(sprite, "primitives"));
+  compiled = vt.vData.displayList.getCompileCount();
+  TEST_ASSERT_TRUE(vt.vData.drawPage(sprite, "primitives"));
+  TEST_ASSERT_EQUAL(compiled, vt.vData.displayList.getCompileCount());
+  boundX = 20;
+  TEST_ASSERT_TRUE(vt.vData.drawPage(sprite, "primitives"));
+  TEST_ASSERT_EQUAL(compiled + 1, vt.vData.displayList.getCompileCount());
+}
+
+// TileRenderer::redrawDirty() は描画ページの版が変わったときだけタイルのリストを作り直し、
+// 作り直した後も全画面スプライトに描いたときと同じ画像になる
+void test_tile_rebin_only_on_revision_change() {
+  std::string path = goldenDir + "/fixtures/shapes.bin";
+  size_t size = 0;
+  const uint8_t* blob = UiBlobLoader::mapFile(path.c_str(), &size);
+  TEST_ASSERT_NOT_NULL_MESSAGE(blob, ("cannot map " + path).c_str());
+
+  VisualTouch vt(&M5.Display, true, false, false);
+  TEST_ASSERT_TRUE(vt.loadUiBlob(blob, size));
+  TEST_ASSERT_TRUE(vt.tileRenderer.begin());
+  TEST_ASSERT_TRUE(vt.tileRenderer.drawPage("primitives"));
+  size_t binned = vt.tileRenderer.getBinCount();
+
+  // 範囲を積んだだけなら描き直すタイルを選ぶだけ
+  vt.vData.markDirty(VisualDataSet::Rect{ 0, 0, 40, 40 });
+  TEST_ASSERT_TRUE(vt.tileRenderer.redrawDirty());
+  TEST_ASSERT_EQUAL(binned, vt.tileRenderer.getBinCount());
+  TEST_ASSERT_FALSE(vt.tileRenderer.redrawDirty());
+  TEST_ASSERT_EQUAL(binned, vt.tileRenderer.getBinCount());
+
+  // オブジェクトを動かしたら作り直す（次のフレームは作り直さない）
+  int pageNum = vt.vData.getPageNumByName("primitives");
+  TEST_ASSERT_TRUE(vt.sceneQueue.move(vt.sceneQueue.getHandle("fillRect", pageNum), 30, 100));
+  vt.sceneQueue.apply(vt.tileRenderer.tiles[0]);
+  TEST_ASSERT_TRUE(vt.tileRenderer.redrawDirty());
+  TEST_ASSERT_EQUAL(binned + 1, vt.tileRenderer.getBinCount());
+  vt.vData.markDirty(VisualDataSet::Rect{ 0, 0, 40, 40 });
+  TEST_ASSERT_TRUE(vt.tileRenderer.redrawDirty());
+  TEST_ASSERT_EQUAL(binned + 1, vt.tileRenderer.getBinCount());
+
+  LGFX_Sprite sprite(&M5.Display);
+  sprite.setColorDepth(16);
+  sprite.createSprite(M5.Display.width(), M5.Display.height());
+  TEST_ASSERT_TRUE(vt.vData.drawPage(sprite, "primitives"));
+  for (int32_t y = 0; y < sprite.height(); y++) {
+    for (int32_t x = 0; x < sprite.width(); x++) {
+      TEST_ASSERT_EQUAL_HEX16_MESSAGE(sprite.readPixel(x, y), M5.Display.readPixel(x, y), "tiles differ from a full redraw");
+    }
+  }
+  sprite.deleteSprite();
+}
+
+// バインドの値が変わったら、そのオブジェクトの変化前後の範囲だけを再描画対象にし、
+// redrawDirty() はその範囲だけを描き直して、全体を描き直したときと同じ画像になる
+void test_binding_marks_only_old_and_new_rects() {
+  std::string path = goldenDir + "/fixtures/shapes.bin";
+  size_t size = 0;
+  const uint8_t* blob = UiBlobLoader::mapFile(path.c_str(), &size);
+  TEST_ASSERT_NOT_NULL_MESSAGE(blob, ("cannot map " + path).c_str());
+
+  VisualTouch vt(&M5.Display, true, false, false);
+  TEST_ASSERT_TRUE(vt.loadUiBlob(blob, size));
+  const int32_t w = M5.Display.width();
+  const int32_t h = M5.Display.height();
+  LGFX_Sprite sprite(&M5.Display);
+  sprite.setColorDepth(16);
+  sprite.createSprite(w, h);
+
+  // fillRect は (80, 10, 60, 40)。重ならない位置へ動かす
+  static int32_t boundY = 10;
+  int pageNum = vt.vData.getPageNumByName("primitives");
+  TEST_ASSERT_TRUE(vt.vData.bindValue("fillRect", VisualDataSet::BindProperty::Y, &boundY, pageNum));
+  TEST_ASSERT_TRUE(vt.vData.drawPage(sprite, "primitives"));
+  TEST_ASSERT_EQUAL(0, vt.vData.updateBindings(sprite));
+  TEST_ASSERT_TRUE(vt.vData.dirtyRects.empty());
+
+  std::vector<uint16_t> before(size_t(w) * h);
+  for (int32_t y = 0; y < h; y++) {
+    for (int32_t x = 0; x < w; x++) before[size_t(y) * w + x] = sprite.readPixel(x, y);
+  }
+
+  boundY = 180;
+  TEST_ASSERT_EQUAL(1, vt.vData.updateBindings(sprite));
+  const std::vector<VisualDataSet::Rect> expected = { { 80, 10, 60, 40 }, { 80, 180, 60, 40 } };
+  TEST_ASSERT_EQUAL(expected.size(), vt.vData.dirtyRects.size());
+  for (size_t i = 0; i < expected.size(); i++) {
+    const auto& r = vt.vData.dirtyRects[i];
+    TEST_ASSERT_TRUE_MESSAGE(r.x == expected[i].x && r.y == expected[i].y && r.w == expected[i].w && r.h == expected[i].h, "dirty rect");
+  }
+
+  TEST_ASSERT_TRUE(vt.vData.redrawDirty(sprite));
+  TEST_ASSERT_TRUE(vt.vData.dirtyRects.empty());
+  const auto& flushed = vt.vData.getFlushedRects();
+  TEST_ASSERT_EQUAL(expected.size(), flushed.size());
+  for (size_t i = 0; i < expected.size(); i++) {
+    TEST_ASSERT_TRUE_MESSAGE(flushed[i].x == expected[i].x && flushed[i].y == expected[i].y && flushed[i].w == expected[i].w && flushed[i].h == expected[i].h, "flushed rect");
+  }
+
+  // 範囲の外は 1 ピクセルも変えず、範囲の中は全体を描き直した結果と同じ
+  std::vector<uint16_t> after(size_t(w) * h);
+  for (int32_t y = 0; y < h; y++) {
+    for (int32_t x = 0; x < w; x++) after[size_t(y) * w + x] = sprite.readPixel(x, y);
+  }
+  TEST_ASSERT_TRUE(vt.vData.drawPage(sprite, "primitives"));
+  for (int32_t y = 0; y < h; y++) {
+    for (int32_t x = 0; x < w; x++) {
+      bool inside = false;
+      for (const auto& r : expected) inside |= x >= r.x && x < r.x + r.w && y >= r.y && y < r.y + r.h;
+      size_t i = size_t(y) * w + x;
+      if (!inside) TEST_ASSERT_EQUAL_HEX16_MESSAGE(before[i], after[i], "pixel outside the dirty rects changed");
+      TEST_ASSERT_EQUAL_HEX16_MESSAGE(sprite.readPixel(x, y), after[i], "partial redraw differs from a full redraw");
+    }
+  }
+  sprite.deleteSprite();
+}
+
+// 文字列のバインドは、1 行に収まる間はその範囲だけ、画面の右端で折り返す・改行を含むようになったら
+// 画面全体を描き直す（ベースライン基準の文字列はベースラインより下も含める）
+void test_binding_wrapped_label_redraws_screen() {
+  VisualTouch vt(&M5.Display, true, false, false);
+  const int32_t w = M5.Display.width();
+  const int32_t h = M5.Display.height();
+  LGFX_Sprite sprite(&M5.Display);
+  sprite.setColorDepth(16);
+  sprite.createSprite(w, h);
+
+  // Font0 は 6 x 8（ホスト版のベースラインは上から 6）
+  static char text[32] = "ab";
+  static char baselineText[32] = "g";
+  vt.vData.addPage("labels");
+  vt.vData.setFillRectObject("bg", 0, 0, w, h, NAVY);
+  vt.vData.setDrawStringObject("label", w - 30, 20, text, WHITE, -1, &fonts::Font0);
+  vt.vData.setDrawStringObject("base", 10, 100, baselineText, WHITE, -1, &fonts::Font0, textdatum_t::baseline_left);
+  vt.vData.finalizeSetup();
+  TEST_ASSERT_TRUE(vt.vData.bindText("label", text));
+  TEST_ASSERT_TRUE(vt.vData.bindText("base", baselineText));
+  TEST_ASSERT_TRUE(vt.vData.drawPage(sprite, "labels"));
+  vt.vData.updateBindings(sprite);
+  vt.vData.redrawDirty(sprite);
+
+  auto isFullScreen = [&]() {
+    const auto& rects = vt.vData.dirtyRects;
+    return rects.size() == 1 && rects[0].x == 0 && rects[0].y == 0 && rects[0].w == w && rects[0].h == h;
+  };
+
+  // 右端に届かない間は前後の範囲だけ
+  std::strcpy(text, "abcd");
+  TEST_ASSERT_EQUAL(1, vt.vData.updateBindings(sprite));
+  TEST_ASSERT_FALSE(isFullScreen());
+  TEST_ASSERT_TRUE(vt.vData.redrawDirty(sprite));
+
+  // 右端を越えると折り返すので範囲は分からない
+  std::strcpy(text, "abcdefghij");
+  TEST_ASSERT_EQUAL(1, vt.vData.updateBindings(sprite));
+  TEST_ASSERT_TRUE(isFullScreen());
+  TEST_ASSERT_TRUE(vt.vData.redrawDirty(sprite));
+
+  // 改行を含む文字列も同じ
+  std::strcpy(text, "a");
+  vt.vData.updateBindings(sprite);
+  vt.vData.redrawDirty(sprite);
+  std::strcpy(text, "a\nb");
+  TEST_ASSERT_EQUAL(1, vt.vData.updateBindings(sprite));
+  TEST_ASSERT_TRUE(isFullScreen());
+  TEST_ASSERT_TRUE(vt.vData.redrawDirty(sprite));
+
+  // ベースライン基準：上端はベースラインの分だけ上、下端は文字の高さまで
+  std::strcpy(baselineText, "gg");
+  TEST_ASSERT_EQUAL(1, vt.vData.updateBindings(sprite));
+  TEST_ASSERT_EQUAL(1, int(vt.vData.dirtyRects.size()));
+  const VisualDataSet::Rect& r = vt.vData.dirtyRects[0];
+  TEST_ASSERT_EQUAL_INT32(100 - 6 - 1, r.y);
+  TEST_ASSERT_EQUAL_INT32(8 + 2, r.h);
+  TEST_ASSERT_EQUAL_INT32(12 + 2, r.w);
+  sprite.deleteSprite();
+}
+
+void setUp() {}
+void tearDown() {}
+
+int main(int, char**) {
+  const char* dir = std::getenv("VT_GOLDEN_DIR");
+  goldenDir = dir && *dir ? dir : "test/golden";
+  const char* update = std::getenv("VT_GOLDEN_UPDATE");
+  updateMode = update && std::atoi(update) != 0;
+  const char* scale = std::getenv("VT_GOLDEN_BUDGET_SCALE");
+  if (scale && *scale) budgetScale = float(std::atof(scale));
+
+  M5.begin();
+
+  UNITY_BEGIN();
+  for (const auto& fixture : FIXTURES) {
+    currentFixture = &fixture;
+    UnityDefaultTestRun(runFixture, fixture.name, __LINE__);
+  }
+  RUN_TEST(test_redraw_reuses_display_list);
+  RUN_TEST(test_tile_rebin_only_on_revision_change);
+  RUN_TEST(test_binding_marks_only_old_and_new_rects);
+  RUN_TEST(test_binding_wrapped_label_redraws_screen);
+  return UNITY_END();
+}
@@ -0,0 +1,184 @@
+// PageCache の単体テスト（env:native / ホスト専用）
+//
+//   pio test -e native -f test_page_cache
+//
+// test/golden/fixtures/shapes.bin を attachUiBlob() でつなぎ、require() による展開、
+// 予算を超えたときに最後に使われたのが古いページから破棄すること、
+// 編集中のページ・固定したページは破棄しないこと、編集を確定したページは破棄できることを確かめる。
+//
+// 環境変数
+//   VT_GOLDEN_DIR : test/golden の場所（既定 "test/golden"）
+
+#include <Arduino.h>
+#include <M5Unified.h>
+#include <unity.h>
+#include <cstdlib>
+#include <string>
+#include "VisualTouch.h"
+
+namespace {
+
+  std::string goldenDir;
+  const uint8_t* blob = nullptr;
+  size_t blobSize = 0;
+
+  // 目録だけを作った状態（どのページもまだ展開していない）
+  struct Cache {
+    VisualTouch vt;
+    int pages[4];
+
+    explicit Cache(size_t budget = 0) : vt(&M5.Display, false, false, false) {
+      TEST_ASSERT_TRUE(vt.attachUiBlob(blob, blobSize, budget));
+      const char* names[4] = { "primitives", "curves", "occluded", "scrolled" };
+      for (int i = 0; i < 4; i++) {
+        pages[i] = vt.pageCache.getPageNumByName(names[i]);
+        TEST_ASSERT_TRUE(pages[i] >= 0);
+      }
+    }
+
+    bool isResident(int i) {
+      const PageCache::Entry* e = vt.pageCache.findEntry(pages[i]);
+      return e && e->isResident;
+    }
+
+    bool isLoaded(int i) {
+      return vt.vData.getPageDataRef(pages[i]) != nullptr;
+    }
+
+    size_t bytes(int i) {
+      return vt.pageCache.findEntry(pages[i])->bytes;
+    }
+  };
+
+} // namespace
+
+// require() は未展開のページを 1 回だけ展開し、使用量を数える
+void test_require_loads_once() {
+  Cache cache;
+  TEST_ASSERT_EQUAL(8, int(cache.vt.pageCache.entries.size()));
+  TEST_ASSERT_EQUAL(0, int(cache.vt.pageCache.getResidentCount()));
+  TEST_ASSERT_FALSE(cache.isLoaded(0));
+  TEST_ASSERT_FALSE(cache.vt.pageCache.require(9999));
+
+  TEST_ASSERT_TRUE(cache.vt.pageCache.require(cache.pages[0]));
+  TEST_ASSERT_TRUE(cache.isResident(0));
+  TEST_ASSERT_TRUE(cache.isLoaded(0));
+  TEST_ASSERT_FALSE(cache.vt.vData.getPageDataRef(cache.pages[0])->objects.empty());
+  TEST_ASSERT_NOT_NULL(cache.vt.tData.getPageData(cache.pages[0]));
+  size_t bytes = cache.bytes(0);
+  TEST_ASSERT_TRUE(bytes > 0);
+  TEST_ASSERT_EQUAL(bytes, cache.vt.pageCache.getResidentBytes());
+
+  // 展開済みなら使用時刻を進めるだけ
+  size_t loaded = cache.vt.vData.visualDataSet.pages.size();
+  uint32_t lastUse = cache.vt.pageCache.findEntry(cache.pages[0])->lastUse;
+  TEST_ASSERT_TRUE(cache.vt.pageCache.require(cache.pages[0]));
+  TEST_ASSERT_EQUAL(loaded, cache.vt.vData.visualDataSet.pages.size());
+  TEST_ASSERT_EQUAL(bytes, cache.vt.pageCache.getResidentBytes());
+  TEST_ASSERT_GREATER_THAN(lastUse, cache.vt.pageCache.findEntry(cache.pages[0])->lastUse);
+
+  // 破棄したページは次の require() で同じ内容に展開し直す
+  size_t objects = cache.vt.vData.getPageDataRef(cache.pages[0])->objects.size();
+  TEST_ASSERT_TRUE(cache.vt.pageCache.evictPage(cache.pages[0]));
+  TEST_ASSERT_FALSE(cache.isLoaded(0));
+  TEST_ASSERT_NULL(cache.vt.tData.getPageData(cache.pages[0]));
+  TEST_ASSERT_EQUAL(0, int(cache.vt.pageCache.getResidentBytes()));
+  TEST_ASSERT_TRUE(cache.vt.pageCache.require(cache.pages[0]));
+  TEST_ASSERT_EQUAL(objects, cache.vt.vData.getPageDataRef(cache.pages[0])->objects.size());
+  TEST_ASSERT_EQUAL(bytes, cache.vt.pageCache.getResidentBytes());
+}
+
+// 予算を超えたら、最後に使われたのが最も古いページから破棄する
+void test_evicts_least_recently_used() {
+  Cache cache;
+  for (int i = 0; i < 3; i++) TEST_ASSERT_TRUE(cache.vt.pageCache.require(cache.pages[i]));
+  // 0 を使い直したので、最も古いのは 1
+  TEST_ASSERT_TRUE(cache.vt.pageCache.require(cache.pages[0]));
+  size_t total = cache.vt.pageCache.getResidentBytes();
+  size_t evicted = cache.bytes(1);
+
+  cache.vt.pageCache.setBudget(total - 1);
+  TEST_ASSERT_TRUE(cache.isResident(0));
+  TEST_ASSERT_FALSE(cache.isResident(1));
+  TEST_ASSERT_TRUE(cache.isResident(2));
+  TEST_ASSERT_FALSE(cache.isLoaded(1));
+  TEST_ASSERT_EQUAL(total - evicted, cache.vt.pageCache.getResidentBytes());
+
+  // 展開したばかりのページは予算を超えていても残し、代わりに古いものを破棄する
+  cache.vt.pageCache.setBudget(1);
+  TEST_ASSERT_TRUE(cache.vt.pageCache.require(cache.pages[3]));
+  TEST_ASSERT_TRUE(cache.isResident(3));
+  TEST_ASSERT_EQUAL(1, int(cache.vt.pageCache.getResidentCount()));
+  TEST_ASSERT_EQUAL(cache.bytes(3), cache.vt.pageCache.getResidentBytes());
+}
+
+// 編集ページの間は予算を超えても破棄せず、別のページの編集に移って確定したら破棄できる
+void test_edited_page_evictable_after_commit() {
+  Cache cache;
+  TEST_ASSERT_TRUE(cache.vt.vData.changeEditPage(cache.pages[0]));
+  TEST_ASSERT_TRUE(cache.vt.pageCache.require(cache.pages[2]));
+  TEST_ASSERT_TRUE(cache.vt.pageCache.require(cache.pages[3]));
+
+  // 0 が最も古いが編集中なので残す
+  cache.vt.pageCache.setBudget(1);
+  TEST_ASSERT_TRUE(cache.isResident(0));
+  TEST_ASSERT_TRUE(cache.isLoaded(0));
+  TEST_ASSERT_FALSE(cache.isResident(2));
+  TEST_ASSERT_FALSE(cache.isResident(3));
+  TEST_ASSERT_FALSE(cache.vt.pageCache.evictPage(cache.pages[0]));
+
+  // 1 の編集に移ると 0 は確定され、予算に収めるために破棄される
+  TEST_ASSERT_TRUE(cache.vt.vData.changeEditPage(cache.pages[1]));
+  TEST_ASSERT_FALSE(cache.isResident(0));
+  TEST_ASSERT_FALSE(cache.isLoaded(0));
+  TEST_ASSERT_TRUE(cache.isResident(1));
+  TEST_ASSERT_EQUAL(cache.bytes(1), cache.vt.pageCache.getResidentBytes());
+
+  // 判定の編集ページも同じ
+  TEST_ASSERT_TRUE(cache.vt.tData.changeEditPage(cache.pages[2]));
+  cache.vt.pageCache.evictToBudget();
+  TEST_ASSERT_TRUE(cache.isResident(1));
+  TEST_ASSERT_TRUE(cache.isResident(2));
+  TEST_ASSERT_TRUE(cache.vt.tData.changeEditPage(cache.pages[3]));
+  cache.vt.pageCache.evictToBudget();
+  TEST_ASSERT_FALSE(cache.isResident(2));
+  TEST_ASSERT_TRUE(cache.isResident(3));
+}
+
+// 固定したページは予算を超えても残し、固定を外したら破棄できる
+void test_pinned_page_survives_until_unpinned() {
+  Cache cache;
+  for (int i = 0; i < 2; i++) TEST_ASSERT_TRUE(cache.vt.pageCache.require(cache.pages[i]));
+  TEST_ASSERT_TRUE(cache.vt.pinPage("primitives"));
+
+  cache.vt.pageCache.setBudget(1);
+  TEST_ASSERT_TRUE(cache.isResident(0));
+  TEST_ASSERT_FALSE(cache.isResident(1));
+
+  TEST_ASSERT_TRUE(cache.vt.pinPage("primitives", false));
+  TEST_ASSERT_FALSE(cache.isResident(0));
+  TEST_ASSERT_EQUAL(0, int(cache.vt.pageCache.getResidentBytes()));
+}
+
+void setUp() {}
+void tearDown() {}
+
+int main(int, char**) {
+  const char* dir = std::getenv("VT_GOLDEN_DIR");
+  goldenDir = dir && *dir ? dir : "test/golden";
+  std::string path = goldenDir + "/fixtures/shapes.bin";
+  blob = UiBlobLoader::mapFile(path.c_str(), &blobSize);
+  if (!blob) {
+    std::printf("cannot map %s\n", path.c_str());
+    return 1;
+  }
+
+  M5.begin();
+
+  UNITY_BEGIN();
+  RUN_TEST(test_require_loads_once);
+  RUN_TEST(test_evicts_least_recently_used);
+  RUN_TEST(test_edited_page_evictable_after_commit);
+  RUN_TEST(test_pinned_page_survives_until_unpinned);
+  return UNITY_END();
+}
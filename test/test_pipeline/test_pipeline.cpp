@@ -0,0 +1,207 @@
+// RenderPipeline の動作テスト（env:native / ホスト専用）
+//
+//   pio test -e native -f test_pipeline
+//
+// 転送を記録する偽のパネルに対してパイプラインを回し、
+//   - 描いたフレームが編集の順にちょうど 1 回ずつ転送されること
+//   - 転送中のバッファに次のフレームを描かないこと（転送の開始から完了まで中身が変わらない）
+//   - 転送が重ならず、2 枚のバッファを交互に使うこと
+//   - 前のフレームで動かしたものの跡が残らないこと（片方のバッファにだけ描いた範囲の描き直し）
+// を確かめる。
+
+#include <Arduino.h>
+#include <M5Unified.h>
+#include <unity.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "VisualTouch.h"
+
+namespace {
+
+  using VDS = VisualDataSet;
+
+  const int SCREEN_W = 160;
+  const int SCREEN_H = 120;
+  const int RECT_Y = 50;
+  const int RECT_W = 12;
+  const int STEP = 5;
+
+  // pushImageDMA() の中身を写し取り、waitDMA() の時点でも同じかを確かめるパネル
+  class FakeLcd : public lgfx::LovyanGFX {
+  public:
+    struct Frame {
+      const uint16_t* source = nullptr;
+      std::vector<uint16_t> pixels;
+      bool changedInFlight = false;
+    };
+
+    std::vector<Frame> frames;
+    int overlapped = 0;       // 前の転送を待たずに次を始めた回数
+    int partialPushes = 0;    // 全画面以外の転送
+
+    FakeLcd() {
+      resizeBuffer(SCREEN_W, SCREEN_H);
+    }
+
+    using LovyanGFX::pushImageDMA;
+    void pushImageDMA(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data) override {
+      if (inFlight) overlapped++;
+      if (x != 0 || y != 0 || w != SCREEN_W || h != SCREEN_H) partialPushes++;
+      Frame frame;
+      frame.source = data;
+      frame.pixels.assign(data, data + size_t(w) * h);
+      frames.push_back(std::move(frame));
+      inFlight = true;
+      // 実機の転送時間の代わりに少し待ち、その間に描画側が触れば waitDMA() で見つかる
+      std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+
+    void waitDMA() override {
+      if (!inFlight) return;
+      Frame& frame = frames.back();
+      frame.changedInFlight = !std::equal(frame.pixels.begin(), frame.pixels.end(), frame.source);
+      inFlight = false;
+    }
+
+  private:
+    bool inFlight = false;
+  };
+
+  // RECT_Y 行目の赤い範囲の左端（赤い範囲がちょうど 1 つなら true）
+  bool findRect(const std::vector<uint16_t>& pixels, int32_t& x) {
+    int runs = 0;
+    x = -1;
+    for (int i = 0; i < SCREEN_W; i++) {
+      bool red = pixels[size_t(RECT_Y) * SCREEN_W + i] == uint16_t(RED);
+      bool prev = i > 0 && pixels[size_t(RECT_Y) * SCREEN_W + i - 1] == uint16_t(RED);
+      if (red && !prev) {
+        runs++;
+        x = i;
+      }
+    }
+    return runs == 1;
+  }
+
+  // 描画側が frames 枚目を描き終えるまでタッチ側を回す
+  bool pumpUntil(RenderPipeline& pipeline, uint32_t frames) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (pipeline.getStats().frames < frames) {
+      if (std::chrono::steady_clock::now() > deadline) return false;
+      pipeline.update();
+      std::this_thread::yield();
+    }
+    return true;
+  }
+
+} // namespace
+
+// 1 フレームに 1 回動かしたものが、動かした順に 1 回ずつ、破れずに転送される
+void test_frames_in_order_without_tearing() {
+  FakeLcd lcd;
+  VisualTouch vt(&lcd, false, false, false);
+  vt.vData.addPage("main");
+  vt.vData.setFillRectObject("mover", 0, RECT_Y - 5, RECT_W, 10, RED);
+  vt.vData.setFillRectObject("frame", 0, 0, SCREEN_W, 8, BLUE);
+  vt.vData.finalizeSetup();
+  SceneHandle mover = vt.sceneQueue.getHandle("mover", vt.vData.getPageNumByName("main"));
+  TEST_ASSERT_TRUE(mover.isValid());
+
+  vt.pipeline.frameIntervalUs = 0;
+  TEST_ASSERT_TRUE(vt.pipeline.begin("main", 0, false));
+  TEST_ASSERT_TRUE(pumpUntil(vt.pipeline, 1));
+
+  const int MOVES = 20;
+  for (int i = 1; i <= MOVES; i++) {
+    TEST_ASSERT_TRUE(vt.sceneQueue.move(mover, STEP, 0));
+    TEST_ASSERT_TRUE(pumpUntil(vt.pipeline, uint32_t(i + 1)));
+  }
+
+  // 動かさなければ転送しない
+  for (int i = 0; i < 50; i++) vt.pipeline.update();
+  PipelineStats stats = vt.pipeline.getStats();
+  vt.pipeline.end();
+
+  TEST_ASSERT_EQUAL_UINT32(MOVES + 1, stats.frames);
+  TEST_ASSERT_EQUAL(MOVES + 1, int(lcd.frames.size()));
+  TEST_ASSERT_EQUAL(0, lcd.overlapped);
+  TEST_ASSERT_EQUAL(0, lcd.partialPushes);
+
+  for (size_t i = 0; i < lcd.frames.size(); i++) {
+    const FakeLcd::Frame& frame = lcd.frames[i];
+    TEST_ASSERT_FALSE_MESSAGE(frame.changedInFlight, "frame buffer was drawn while it was being pushed");
+    if (i > 0) TEST_ASSERT_TRUE_MESSAGE(frame.source != lcd.frames[i - 1].source, "same buffer pushed twice in a row");
+
+    int32_t x;
+    TEST_ASSERT_TRUE_MESSAGE(findRect(frame.pixels, x), "moved object left a trail");
+    TEST_ASSERT_EQUAL_INT32(int32_t(i) * STEP, x);
+    TEST_ASSERT_EQUAL_HEX16(uint16_t(BLUE), frame.pixels[size_t(2) * SCREEN_W + 80]);
+  }
+}
+
+// 1 フレームの間に届いた編集はまとめて 1 回だけ描いて転送する
+void test_coalesced_edits_push_once() {
+  FakeLcd lcd;
+  VisualTouch vt(&lcd, false, false, false);
+  vt.vData.addPage("main");
+  vt.vData.setFillRectObject("mover", 0, RECT_Y - 5, RECT_W, 10, RED);
+  vt.vData.finalizeSetup();
+  SceneHandle mover = vt.sceneQueue.getHandle("mover", vt.vData.getPageNumByName("main"));
+
+  vt.pipeline.frameIntervalUs = 0;
+  TEST_ASSERT_TRUE(vt.pipeline.begin("main", 0, false));
+  TEST_ASSERT_TRUE(pumpUntil(vt.pipeline, 1));
+
+  // シーンを持っている間に積めば、次に描画側へ渡したときの 1 フレームに入る
+  vt.pipeline.waitScene();
+  for (int i = 0; i < 6; i++) TEST_ASSERT_TRUE(vt.sceneQueue.move(mover, STEP, 0));
+  TEST_ASSERT_TRUE(pumpUntil(vt.pipeline, 2));
+  for (int i = 0; i < 50; i++) vt.pipeline.update();
+  PipelineStats stats = vt.pipeline.getStats();
+  vt.pipeline.end();
+
+  TEST_ASSERT_EQUAL_UINT32(2, stats.frames);
+  TEST_ASSERT_EQUAL(2, int(lcd.frames.size()));
+  int32_t x;
+  TEST_ASSERT_TRUE(findRect(lcd.frames[1].pixels, x));
+  TEST_ASSERT_EQUAL_INT32(6 * STEP, x);
+  TEST_ASSERT_FALSE(lcd.frames[1].changedInFlight);
+}
+
+// ページを切り替えたら次のフレームで全体を描き直し、前のページは残らない
+void test_show_page_redraws() {
+  FakeLcd lcd;
+  VisualTouch vt(&lcd, false, false, false);
+  vt.vData.addPage("first");
+  vt.vData.setFillRectObject("a", 0, RECT_Y - 5, RECT_W, 10, RED);
+  vt.vData.addPage("second");
+  vt.vData.setFillRectObject("b", 0, 0, SCREEN_W, 8, BLUE);
+  vt.vData.finalizeSetup();
+
+  vt.pipeline.frameIntervalUs = 0;
+  TEST_ASSERT_TRUE(vt.pipeline.begin("first", 0, false));
+  TEST_ASSERT_TRUE(pumpUntil(vt.pipeline, 1));
+  vt.pipeline.showPage("second");
+  TEST_ASSERT_TRUE(pumpUntil(vt.pipeline, 2));
+  vt.pipeline.end();
+
+  TEST_ASSERT_EQUAL(2, int(lcd.frames.size()));
+  int32_t x;
+  TEST_ASSERT_TRUE(findRect(lcd.frames[0].pixels, x));
+  TEST_ASSERT_FALSE(findRect(lcd.frames[1].pixels, x));
+  TEST_ASSERT_EQUAL_HEX16(uint16_t(BLUE), lcd.frames[1].pixels[size_t(2) * SCREEN_W + 80]);
+  TEST_ASSERT_FALSE(lcd.frames[1].changedInFlight);
+}
+
+void setUp() {}
+void tearDown() {}
+
+int main(int, char**) {
+  M5.begin();
+
+  UNITY_BEGIN();
+  RUN_TEST(test_frames_in_order_without_tearing);
+  RUN_TEST(test_coalesced_edits_push_once);
+  RUN_TEST(test_show_page_redraws);
+  return UNITY_END();
+}
@@ -0,0 +1,271 @@
+// SceneQueue の単体テスト（env:native / ホスト専用）
+//
+//   pio test -e native -f test_scene_queue
+//
+// 複数スレッドからの書き込み、満杯のときの破棄、同じオブジェクトへの編集のまとめ方、
+// 表示中ページの再描画範囲を確かめる。
+
+#include <Arduino.h>
+#include <M5Unified.h>
+#include <unity.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "../scene_fixture.h"
+
+namespace {
+
+  using VDS = VisualDataSet;
+
+  // 離れた位置に 4 つの矩形を置いたページを表示中にする
+  struct Scene : SceneFixture {
+    SceneHandle handles[4];
+
+    Scene() {
+      for (int i = 0; i < 4; i++) {
+        vt.vData.setFillRectObject("r" + String(i), 10 + i * 70, 10, 20, 20, RED);
+      }
+      show();
+      for (int i = 0; i < 4; i++) handles[i] = vt.sceneQueue.getHandle("r" + String(i), pageNum);
+    }
+
+    const VDS::ObjectData* shown(int i) {
+      return shownObject(handles[i].objectNum);
+    }
+
+    const VDS::ObjectData* stored(int i) {
+      return storedObject(handles[i].objectNum);
+    }
+  };
+
+} // namespace
+
+// -------------------- 複数スレッドからの書き込み --------------------
+
+// 描画ループが空けるのを待たない書き込みは、受け付けた数と破棄した数の合計が送った数になり、
+// 受け付けた移動はすべて反映される
+void test_push_from_threads() {
+  Scene scene;
+  const int THREADS = 4;
+  const int PUSHES = 2000;
+  std::atomic<int> accepted[THREADS];
+  std::atomic<bool> done{false};
+  for (auto& a : accepted) a.store(0);
+
+  std::vector<std::thread> writers;
+  for (int t = 0; t < THREADS; t++) {
+    writers.emplace_back([&, t] {
+      for (int i = 0; i < PUSHES; i++) {
+        if (scene.vt.sceneQueue.move(scene.handles[t], 0, 1)) accepted[t]++;
+      }
+    });
+  }
+  std::thread joiner([&] {
+    for (auto& w : writers) w.join();
+    done = true;
+  });
+  while (!done) scene.vt.sceneQueue.apply(scene.sprite);
+  joiner.join();
+  while (!scene.vt.sceneQueue.isEmpty()) scene.vt.sceneQueue.apply(scene.sprite);
+
+  int total = 0;
+  for (int t = 0; t < THREADS; t++) {
+    TEST_ASSERT_EQUAL_INT32(10 + accepted[t].load(), scene.shown(t)->objectArgs.rect.y);
+    TEST_ASSERT_EQUAL_INT32(10 + accepted[t].load(), scene.stored(t)->objectArgs.rect.y);
+    total += accepted[t].load();
+  }
+  TEST_ASSERT_GREATER_THAN(0, total);
+  TEST_ASSERT_EQUAL_UINT32(uint32_t(THREADS * PUSHES - total), scene.vt.sceneQueue.getDropped());
+}
+
+// 段数以内なら別々のスレッドから書いても 1 つも落とさない
+void test_push_from_threads_within_capacity() {
+  Scene scene;
+  const int THREADS = 4;
+  std::atomic<int> accepted{0};
+  std::vector<std::thread> writers;
+  for (int t = 0; t < THREADS; t++) {
+    writers.emplace_back([&, t] {
+      for (uint32_t i = 0; i < SceneQueue::CAPACITY / THREADS; i++) {
+        if (scene.vt.sceneQueue.move(scene.handles[t], 1, 0)) accepted++;
+      }
+    });
+  }
+  for (auto& w : writers) w.join();
+  TEST_ASSERT_EQUAL(int(SceneQueue::CAPACITY), accepted.load());
+
+  TEST_ASSERT_EQUAL(THREADS, scene.vt.sceneQueue.apply(scene.sprite));
+  TEST_ASSERT_TRUE(scene.vt.sceneQueue.isEmpty());
+  TEST_ASSERT_EQUAL_UINT32(0, scene.vt.sceneQueue.getDropped());
+  for (int t = 0; t < THREADS; t++) {
+    TEST_ASSERT_EQUAL_INT32(10 + t * 70 + int32_t(SceneQueue::CAPACITY / THREADS), scene.shown(t)->objectArgs.rect.x);
+  }
+}
+
+// -------------------- 満杯 --------------------
+
+// 満杯なら待たずに false を返して数え、apply() で空いたらまた受け付ける
+void test_full_queue_drops() {
+  Scene scene;
+  SceneQueue& queue = scene.vt.sceneQueue;
+  for (uint32_t i = 0; i < SceneQueue::CAPACITY; i++) TEST_ASSERT_TRUE(queue.move(scene.handles[0], 1, 0));
+  TEST_ASSERT_FALSE(queue.move(scene.handles[0], 1, 0));
+  TEST_ASSERT_FALSE(queue.hide(scene.handles[1]));
+  TEST_ASSERT_EQUAL_UINT32(2, queue.getDropped());
+
+  // 受け付けた分だけが 1 つの編集にまとまって反映される
+  TEST_ASSERT_EQUAL(1, queue.apply(scene.sprite));
+  TEST_ASSERT_EQUAL_INT32(10 + int32_t(SceneQueue::CAPACITY), scene.shown(0)->objectArgs.rect.x);
+  TEST_ASSERT_FALSE(scene.shown(1)->isHidden);
+  TEST_ASSERT_TRUE(queue.isEmpty());
+
+  TEST_ASSERT_TRUE(queue.move(scene.handles[0], 1, 0));
+  TEST_ASSERT_EQUAL(1, queue.apply(scene.sprite));
+  TEST_ASSERT_EQUAL_UINT32(2, queue.getDropped());
+  TEST_ASSERT_EQUAL(0, queue.apply(scene.sprite));
+}
+
+// 無効なハンドルは積まない（破棄の数にも入れない）
+void test_invalid_handle_rejected() {
+  Scene scene;
+  TEST_ASSERT_FALSE(scene.vt.sceneQueue.move(SceneHandle(), 1, 1));
+  TEST_ASSERT_FALSE(scene.vt.sceneQueue.getHandle("missing", scene.pageNum).isValid());
+  TEST_ASSERT_EQUAL_UINT32(0, scene.vt.sceneQueue.getDropped());
+  TEST_ASSERT_TRUE(scene.vt.sceneQueue.isEmpty());
+}
+
+// -------------------- まとめ方 --------------------
+
+// 引数の置き換えはそれまでの移動を打ち消し、その後の移動は置き換えた引数に足される
+void test_set_args_overrides_earlier_moves() {
+  Scene scene;
+  SceneQueue& queue = scene.vt.sceneQueue;
+  TEST_ASSERT_TRUE(queue.move(scene.handles[0], 5, 7));
+  TEST_ASSERT_TRUE(queue.setProperty(scene.handles[0], VDS::BindProperty::Color, BLUE));
+  TEST_ASSERT_TRUE(queue.setArgs(scene.handles[0], VDS::RectArgs{ 100, 120, 30, 40, GREEN }));
+  TEST_ASSERT_TRUE(queue.move(scene.handles[0], 3, 0));
+  TEST_ASSERT_EQUAL(1, queue.apply(scene.sprite));
+
+  const VDS::RectArgs& rect = scene.shown(0)->objectArgs.rect;
+  TEST_ASSERT_EQUAL_INT32(103, rect.x);
+  TEST_ASSERT_EQUAL_INT32(120, rect.y);
+  TEST_ASSERT_EQUAL_INT32(30, rect.w);
+  TEST_ASSERT_EQUAL_INT32(40, rect.h);
+  TEST_ASSERT_EQUAL(GREEN, rect.color);
+  TEST_ASSERT_EQUAL_INT32(103, scene.stored(0)->objectArgs.rect.x);
+}
+
+// X・Y の指定はそれ以前のその軸の移動だけを打ち消す
+void test_position_resets_moves() {
+  Scene scene;
+  SceneQueue& queue = scene.vt.sceneQueue;
+  TEST_ASSERT_TRUE(queue.move(scene.handles[0], 7, 9));
+  TEST_ASSERT_TRUE(queue.setProperty(scene.handles[0], VDS::BindProperty::X, 50));
+  TEST_ASSERT_TRUE(queue.move(scene.handles[1], 4, 6));
+  TEST_ASSERT_TRUE(queue.setProperty(scene.handles[1], VDS::BindProperty::Y, 60));
+  TEST_ASSERT_TRUE(queue.move(scene.handles[1], 0, 2));
+  TEST_ASSERT_EQUAL(2, queue.apply(scene.sprite));
+
+  TEST_ASSERT_EQUAL_INT32(50, scene.shown(0)->objectArgs.rect.x);
+  TEST_ASSERT_EQUAL_INT32(19, scene.shown(0)->objectArgs.rect.y);
+  TEST_ASSERT_EQUAL_INT32(84, scene.shown(1)->objectArgs.rect.x);
+  TEST_ASSERT_EQUAL_INT32(62, scene.shown(1)->objectArgs.rect.y);
+}
+
+// 削除はそれ以降の編集より優先され、表示中・保存済みのどちらからも消える
+void test_delete_wins() {
+  Scene scene;
+  SceneQueue& queue = scene.vt.sceneQueue;
+  int objectNum = scene.handles[2].objectNum;
+  TEST_ASSERT_TRUE(queue.move(scene.handles[2], 5, 5));
+  TEST_ASSERT_TRUE(queue.remove(scene.handles[2]));
+  TEST_ASSERT_TRUE(queue.show(scene.handles[2]));
+  TEST_ASSERT_TRUE(queue.setArgs(scene.handles[2], VDS::RectArgs{ 0, 0, 5, 5, WHITE }));
+  TEST_ASSERT_EQUAL(1, queue.apply(scene.sprite));
+
+  TEST_ASSERT_NULL(scene.vt.vData.getObjectDataRef(&scene.vt.vData.currentPageCopy, objectNum));
+  TEST_ASSERT_NULL(scene.vt.vData.getObjectDataRef(scene.vt.vData.getPageDataRef(scene.pageNum), objectNum));
+  TEST_ASSERT_EQUAL(3, int(scene.vt.vData.currentPageCopy.objects.size()));
+
+  // 消えたオブジェクトへの編集は反映されない
+  TEST_ASSERT_TRUE(queue.move(scene.handles[2], 1, 1));
+  TEST_ASSERT_EQUAL(0, queue.apply(scene.sprite));
+}
+
+// 表示・非表示は最後の指定が残る
+void test_visibility_last_wins() {
+  Scene scene;
+  SceneQueue& queue = scene.vt.sceneQueue;
+  TEST_ASSERT_TRUE(queue.hide(scene.handles[0]));
+  TEST_ASSERT_TRUE(queue.show(scene.handles[0]));
+  TEST_ASSERT_TRUE(queue.show(scene.handles[1]));
+  TEST_ASSERT_TRUE(queue.hide(scene.handles[1]));
+  TEST_ASSERT_EQUAL(2, queue.apply(scene.sprite));
+  TEST_ASSERT_FALSE(scene.shown(0)->isHidden);
+  TEST_ASSERT_TRUE(scene.shown(1)->isHidden);
+  TEST_ASSERT_TRUE(scene.stored(1)->isHidden);
+}
+
+// -------------------- 再描画範囲 --------------------
+
+// 表示中のオブジェクトは変化前後の範囲だけを再描画対象にし、redrawDirty() はその範囲を描く
+void test_dirty_rects_from_apply() {
+  Scene scene;
+  VisualData& vData = scene.vt.vData;
+  TEST_ASSERT_TRUE(vData.dirtyRects.empty());
+
+  TEST_ASSERT_TRUE(scene.vt.sceneQueue.move(scene.handles[0], 0, 100));
+  TEST_ASSERT_EQUAL(1, scene.vt.sceneQueue.apply(scene.sprite));
+  TEST_ASSERT_EQUAL(2, int(vData.dirtyRects.size()));
+  TEST_ASSERT_TRUE(hasRect(vData.dirtyRects, 10, 10, 20, 20));
+  TEST_ASSERT_TRUE(hasRect(vData.dirtyRects, 10, 110, 20, 20));
+
+  TEST_ASSERT_TRUE(vData.redrawDirty(scene.sprite));
+  TEST_ASSERT_TRUE(vData.dirtyRects.empty());
+  TEST_ASSERT_EQUAL(2, int(vData.getFlushedRects().size()));
+  TEST_ASSERT_TRUE(hasRect(vData.getFlushedRects(), 10, 110, 20, 20));
+  TEST_ASSERT_EQUAL_HEX16(uint16_t(BLACK), scene.sprite.readPixel(15, 15));
+  TEST_ASSERT_EQUAL_HEX16(uint16_t(RED), scene.sprite.readPixel(15, 115));
+
+  // 重なる前後の範囲は 1 つにまとまる
+  TEST_ASSERT_TRUE(scene.vt.sceneQueue.move(scene.handles[1], 5, 0));
+  TEST_ASSERT_EQUAL(1, scene.vt.sceneQueue.apply(scene.sprite));
+  TEST_ASSERT_EQUAL(1, int(vData.dirtyRects.size()));
+  TEST_ASSERT_TRUE(hasRect(vData.dirtyRects, 80, 10, 25, 20));
+}
+
+// 表示中でないページの編集は保存済みページだけを変え、再描画対象を作らない
+void test_hidden_page_edit_is_not_dirty() {
+  Scene scene;
+  VisualData& vData = scene.vt.vData;
+  vData.addPage("other");
+  int otherPage = vData.getPageNumByName("other");
+  vData.setFillRectObject("x", 0, 0, 10, 10, BLUE);
+  vData.finalizeSetup();
+  SceneHandle handle = scene.vt.sceneQueue.getHandle("x", otherPage);
+
+  TEST_ASSERT_TRUE(scene.vt.sceneQueue.move(handle, 30, 0));
+  TEST_ASSERT_EQUAL(1, scene.vt.sceneQueue.apply(scene.sprite));
+  TEST_ASSERT_TRUE(vData.dirtyRects.empty());
+  TEST_ASSERT_EQUAL_INT32(30, vData.getObjectDataRef(vData.getPageDataRef(otherPage), handle.objectNum)->objectArgs.rect.x);
+}
+
+void setUp() {}
+void tearDown() {}
+
+int main(int, char**) {
+  M5.begin();
+
+  UNITY_BEGIN();
+  RUN_TEST(test_push_from_threads);
+  RUN_TEST(test_push_from_threads_within_capacity);
+  RUN_TEST(test_full_queue_drops);
+  RUN_TEST(test_invalid_handle_rejected);
+  RUN_TEST(test_set_args_overrides_earlier_moves);
+  RUN_TEST(test_position_resets_moves);
+  RUN_TEST(test_delete_wins);
+  RUN_TEST(test_visibility_last_wins);
+  RUN_TEST(test_dirty_rects_from_apply);
+  RUN_TEST(test_hidden_page_edit_is_not_dirty);
+  return UNITY_END();
+}
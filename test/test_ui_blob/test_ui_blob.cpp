@@ -0,0 +1,184 @@
+// UiBlobLoader の単体テスト（env:native / ホスト専用）
+//
+//   pio test -e native -f test_ui_blob
+//
+// test/golden/fixtures/text.bin の写しを 1 か所ずつ壊し、validate() が範囲外の文字列・データや
+// 範囲外の種類の値を持つブロブを受け付けないことを確かめる。
+// また、同じページを読み込み直したときに編集中・描画中の写しも新しい内容になることを確かめる。
+//
+// 環境変数
+//   VT_GOLDEN_DIR : test/golden の場所（既定 "test/golden"）
+
+#include <Arduino.h>
+#include <M5Unified.h>
+#include <unity.h>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "VisualTouch.h"
+
+namespace {
+
+  using VDS = VisualDataSet;
+
+  std::string goldenDir;
+  const uint8_t* fixture = nullptr;
+  size_t fixtureSize = 0;
+
+  // 書き換えられるブロブの写し（4 バイト境界）
+  struct Blob {
+    std::vector<uint32_t> words;
+    size_t size;
+
+    Blob() : words((fixtureSize + 3) / 4), size(fixtureSize) {
+      std::memcpy(words.data(), fixture, fixtureSize);
+    }
+
+    uint8_t* data() { return reinterpret_cast<uint8_t*>(words.data()); }
+    UiBlob::Header& header() { return *reinterpret_cast<UiBlob::Header*>(data()); }
+    UiBlob::PageRecord& page(size_t i) { return reinterpret_cast<UiBlob::PageRecord*>(data() + header().pageTableOffset)[i]; }
+    UiBlob::ObjectRecord& object(size_t i) { return reinterpret_cast<UiBlob::ObjectRecord*>(data() + header().objectTableOffset)[i]; }
+    UiBlob::ProcessRecord& process(size_t i) { return reinterpret_cast<UiBlob::ProcessRecord*>(data() + header().processTableOffset)[i]; }
+
+    UiBlob::ObjectRecord& findObject(VDS::DrawType type) {
+      for (uint32_t i = 0; i < header().objectCount; i++) {
+        if (object(i).drawType == static_cast<uint8_t>(type)) return object(i);
+      }
+      TEST_FAIL_MESSAGE("fixture has no object of the type");
+      return object(0);
+    }
+
+    bool validate() {
+      VisualTouch vt(&M5.Display, false, false, false);
+      return vt.blobLoader.validate(data(), size);
+    }
+  };
+
+} // namespace
+
+void test_fixture_is_valid() {
+  Blob blob;
+  TEST_ASSERT_TRUE(blob.validate());
+}
+
+// 名前の offset がブロブの外・data 領域の外
+void test_rejects_name_out_of_range() {
+  Blob a;
+  a.page(0).nameOffset = a.header().totalSize + 16;
+  TEST_ASSERT_FALSE(a.validate());
+
+  Blob b;
+  b.object(0).nameOffset = b.header().objectTableOffset;
+  TEST_ASSERT_FALSE(b.validate());
+
+  Blob c;
+  c.process(0).nameOffset = 0;
+  TEST_ASSERT_FALSE(c.validate());
+}
+
+// 末尾の文字列が NUL で終わらないまま切れている
+void test_rejects_unterminated_string() {
+  Blob blob;
+  UiBlob::ObjectRecord& text = blob.findObject(VDS::DrawType::DrawString);
+  blob.data()[blob.header().totalSize - 1] = 'x';
+  text.dataOffset = blob.header().totalSize - 1;
+  TEST_ASSERT_FALSE(blob.validate());
+}
+
+// 画素列が data 領域に収まらない
+void test_rejects_bitmap_past_end() {
+  Blob blob;
+  UiBlob::ObjectRecord& bitmap = blob.findObject(VDS::DrawType::DrawBitmap);
+  TEST_ASSERT_TRUE(blob.validate());
+  bitmap.args[3] = 100000;
+  TEST_ASSERT_FALSE(blob.validate());
+
+  Blob negative;
+  negative.findObject(VDS::DrawType::DrawBitmap).args[2] = -4;
+  TEST_ASSERT_FALSE(negative.validate());
+}
+
+// 種類の値が列挙の範囲外
+void test_rejects_unknown_types() {
+  Blob a;
+  a.object(0).drawType = static_cast<uint8_t>(VDS::DrawType::TableBox) + 1;
+  TEST_ASSERT_FALSE(a.validate());
+
+  Blob b;
+  b.process(0).touchType = static_cast<uint8_t>(TouchDataSet::TouchType::MultiClicked) + 1;
+  TEST_ASSERT_FALSE(b.validate());
+}
+
+// 編集中・描画中のページを読み込み直すと写しも置き換わり、確定しても古い内容に戻らない
+void test_reload_refreshes_editing_and_drawing_copies() {
+  Blob first;
+  VisualTouch vt(&M5.Display, false, false, false);
+  TEST_ASSERT_TRUE(vt.loadUiBlob(first.data(), first.size));
+
+  const UiBlob::ObjectRecord& rec = first.findObject(VDS::DrawType::DrawString);
+  const int objectNum = rec.objectNum;
+  const int32_t x = rec.args[0];
+  const int pageNum = first.page(0).pageNum;
+  const String pageName = UiBlobLoader::stringAt(first.data(), first.page(0).nameOffset);
+  TEST_ASSERT_EQUAL(pageNum, vt.vData.getPageNumByName(pageName));
+
+  LGFX_Sprite sprite(&M5.Display);
+  sprite.setColorDepth(16);
+  sprite.createSprite(M5.Display.width(), M5.Display.height());
+  TEST_ASSERT_TRUE(vt.vData.drawPage(sprite, pageName));
+  TEST_ASSERT_TRUE(vt.vData.changeEditPage(pageNum));
+  TEST_ASSERT_TRUE(vt.tData.changeEditPage(pageNum));
+  vt.tData.setProcessPage();
+  size_t processes = vt.tData.editingPage.processes.size();
+
+  // 文字列を動かし、末尾のプロセスを除いたブロブで置き換える
+  Blob second;
+  second.findObject(VDS::DrawType::DrawString).args[0] = x + 7;
+  second.page(0).processCount--;
+  TEST_ASSERT_TRUE(vt.loadUiBlob(second.data(), second.size));
+
+  auto textX = [&](const VDS::PageData& page) {
+    const VDS::ObjectData* obj = vt.vData.getObjectDataRef(const_cast<VDS::PageData*>(&page), objectNum);
+    TEST_ASSERT_NOT_NULL(obj);
+    return obj->objectArgs.text.x;
+  };
+  TEST_ASSERT_EQUAL_INT32(x + 7, textX(vt.vData.editingPage));
+  TEST_ASSERT_EQUAL_INT32(x + 7, textX(vt.vData.currentPageCopy));
+  TEST_ASSERT_EQUAL(processes - 1, vt.tData.editingPage.processes.size());
+  TEST_ASSERT_EQUAL(processes - 1, vt.tData.currentPageProcess.processes.size());
+  // 描画中のページは全体を描き直す
+  TEST_ASSERT_EQUAL(1, int(vt.vData.dirtyRects.size()));
+  TEST_ASSERT_EQUAL_INT32(M5.Display.width(), vt.vData.dirtyRects[0].w);
+
+  TEST_ASSERT_TRUE(vt.vData.commitVisualEdit());
+  TEST_ASSERT_TRUE(vt.tData.commitProcessEdit());
+  TEST_ASSERT_EQUAL_INT32(x + 7, textX(*vt.vData.getPageDataRef(pageNum)));
+  TEST_ASSERT_EQUAL(processes - 1, vt.tData.getPageData(pageNum)->processes.size());
+  sprite.deleteSprite();
+}
+
+void setUp() {}
+void tearDown() {}
+
+int main(int, char**) {
+  const char* dir = std::getenv("VT_GOLDEN_DIR");
+  goldenDir = dir && *dir ? dir : "test/golden";
+  std::string path = goldenDir + "/fixtures/text.bin";
+  fixture = UiBlobLoader::mapFile(path.c_str(), &fixtureSize);
+  if (!fixture) {
+    std::printf("cannot map %s\n", path.c_str());
+    return 1;
+  }
+
+  M5.begin();
+
+  UNITY_BEGIN();
+  RUN_TEST(test_fixture_is_valid);
+  RUN_TEST(test_rejects_name_out_of_range);
+  RUN_TEST(test_rejects_unterminated_string);
+  RUN_TEST(test_rejects_bitmap_past_end);
+  RUN_TEST(test_rejects_unknown_types);
+  RUN_TEST(test_reload_refreshes_editing_and_drawing_copies);
+  return UNITY_END();
+}
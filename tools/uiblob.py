@@ -0,0 +1,517 @@
+#!/usr/bin/env python3
+"""JSON で書いた UI 定義をバイナリ UI ブロブ (src/UiBlob.h) に変換する。
+
+使い方:
+    python3 tools/uiblob.py ui.json ui.bin [--fs-root DIR] [--header ui_blob.h]
+
+  --fs-root  JPG/PNG の w/h を省略したとき、画像を探すディレクトリ（SD のルートに相当）
+  --header   ブロブを alignas(4) の C 配列として書き出す（フラッシュ常駐用）
+
+入力形式:
+    {
+      "pages": [
+        {
+          "name": "page1",
+          "num": 1,                       # 省略時は 1 から自動採番
+          "objects": [
+            {"name": "obj1", "type": "FillRect", "x": 0, "y": 0, "w": 200, "h": 140,
+             "color": "BLUE", "z": 0, "untouchable": false},
+            {"name": "label", "type": "DrawString", "x": 10, "y": 10, "text": "Hello",
+             "color": "WHITE", "bgcolor": -1, "font": "lgfxJapanGothic_40", "datum": "top_left"}
+          ],
+          "processes": [
+            {"name": "press1", "object": "obj1", "type": "Press"},
+            {"name": "flick1", "object": "obj1", "type": "Flicking",
+             "enableOverBorder": true, "returnCurrentOver": false}
+          ]
+        }
+      ]
+    }
+
+各オブジェクトの引数名は VisualDataSet.h の *Args 構造体のメンバ名と同じ。
+Clip 系（ClipRect など）は同じ形の Fill 系と同じ引数名で、color は持たない。
+FlexBox / TableBox は BoxArgs のメンバ名（direction は "Row" / "Column"、justify / align は
+"Start" / "Center" / "End" / "SpaceBetween"）で、子は "parent": "<コンテナ名>" で入れる。
+子の x / y はコンテナが実行時に決めるので省略してよい。
+コンテナ以外も "parent" にでき（VisualData::setParent と同じ）、その子の座標は親の基準座標
+（x / y、線・三角形は x0 / y0）からの相対で書く。"inheritColor": true の子は色を親
+（色を持たない親ならその先祖）から受け継ぐ。どちらもここで絶対座標・色に直して格納する。
+実行時の setXxxObject / setXxxProcess と同じ検査（名前の重複、同一オブジェクトへの
+同種プロセス、isUntouchable へのプロセス登録）をここで済ませる。
+"""
+
+import argparse
+import json
+import os
+import struct
+import sys
+
+MAGIC = 0x42555456  # "VTUB"
+VERSION = 3
+
+HEADER_FMT = "<IHHIHHIIIIII"
+PAGE_FMT = "<iIIIHH"
+OBJECT_FMT = "<IiBBBBI11iIi"
+PROCESS_FMT = "<IiiBBBBI"
+
+OBJECT_UNTOUCHABLE = 0x01
+OBJECT_INHERIT_COLOR = 0x02
+PROCESS_ENABLE_OVER_BORDER = 0x01
+PROCESS_RETURN_CURRENT_OVER = 0x02
+
+# VisualDataSet::DrawType と同じ並び
+DRAW_TYPES = [
+    "DrawPixel", "DrawLine", "DrawBezier", "DrawWideLine",
+    "DrawRect", "DrawRoundRect", "DrawTriangle", "DrawCircle", "DrawEllipse", "DrawArc", "DrawEllipseArc",
+    "FillRect", "FillRoundRect", "FillTriangle", "FillCircle", "FillEllipse", "FillArc", "FillEllipseArc",
+    "DrawJpgFile", "DrawPngFile", "DrawBitmap",
+    "DrawString",
+    "ClipArc", "ClipEllipseArc", "ClipRect", "ClipRoundRect", "ClipCircle", "ClipEllipse", "ClipTriangle",
+    "FlexBox", "TableBox",
+]
+
+# TouchDataSet::TouchType と同じ並び
+TOUCH_TYPES = [
+    "Press", "Pressing", "Pressed", "Release", "Releasing",
+    "Hold", "Holding", "Held", "Drag", "Dragging", "Dragged",
+    "Flick", "Flicking", "Flicked", "Clicked", "MultiClicked",
+]
+
+# UiBlobLoader::fontTable と同じ並び（0 = 指定なし）
+FONTS = [
+    None, "Font0", "Font2", "Font4",
+    "lgfxJapanGothic_12", "lgfxJapanGothic_16", "lgfxJapanGothic_20", "lgfxJapanGothic_24",
+    "lgfxJapanGothic_28", "lgfxJapanGothic_32", "lgfxJapanGothic_36", "lgfxJapanGothic_40",
+]
+
+DATUMS = {
+    "top_left": 0x00, "top_center": 0x01, "top_right": 0x02,
+    "middle_left": 0x04, "middle_center": 0x05, "middle_right": 0x06,
+    "bottom_left": 0x08, "bottom_center": 0x09, "bottom_right": 0x0A,
+    "baseline_left": 0x10, "baseline_center": 0x11, "baseline_right": 0x12,
+}
+
+COLORS = {
+    "BLACK": 0x0000, "NAVY": 0x000F, "DARKGREEN": 0x03E0, "DARKCYAN": 0x03EF,
+    "MAROON": 0x7800, "PURPLE": 0x780F, "OLIVE": 0x7BE0, "LIGHTGREY": 0xD69A,
+    "DARKGREY": 0x7BEF, "BLUE": 0x001F, "GREEN": 0x07E0, "CYAN": 0x07FF,
+    "RED": 0xF800, "MAGENTA": 0xF81F, "YELLOW": 0xFFE0, "WHITE": 0xFFFF,
+    "ORANGE": 0xFDA0, "GREENYELLOW": 0xB7E0, "PINK": 0xFE19,
+}
+
+# 整数のみの Args（VisualDataSet.h のメンバ順）
+INT_ARGS = {
+    "DrawPixel": ["x", "y", "color"],
+    "DrawLine": ["x0", "y0", "x1", "y1", "color"],
+    "DrawBezier": ["x0", "y0", "x1", "y1", "x2", "y2", "color"],
+    "DrawWideLine": ["x0", "y0", "x1", "y1", "r", "color"],
+    "DrawRect": ["x", "y", "w", "h", "color"],
+    "FillRect": ["x", "y", "w", "h", "color"],
+    "DrawRoundRect": ["x", "y", "w", "h", "r", "color"],
+    "FillRoundRect": ["x", "y", "w", "h", "r", "color"],
+    "DrawCircle": ["x", "y", "r", "color"],
+    "FillCircle": ["x", "y", "r", "color"],
+    "DrawEllipse": ["x", "y", "rx", "ry", "color"],
+    "FillEllipse": ["x", "y", "rx", "ry", "color"],
+    "DrawTriangle": ["x0", "y0", "x1", "y1", "x2", "y2", "color"],
+    "FillTriangle": ["x0", "y0", "x1", "y1", "x2", "y2", "color"],
+    "DrawArc": ["x", "y", "r0", "r1", "angle0", "angle1", "color"],
+    "FillArc": ["x", "y", "r0", "r1", "angle0", "angle1", "color"],
+    "DrawEllipseArc": ["x", "y", "r0x", "r1x", "r0y", "r1y", "angle0", "angle1", "color"],
+    "FillEllipseArc": ["x", "y", "r0x", "r1x", "r0y", "r1y", "angle0", "angle1", "color"],
+    # 範囲制限（color は使わない）
+    "ClipRect": ["x", "y", "w", "h"],
+    "ClipRoundRect": ["x", "y", "w", "h", "r"],
+    "ClipCircle": ["x", "y", "r"],
+    "ClipEllipse": ["x", "y", "rx", "ry"],
+    "ClipTriangle": ["x0", "y0", "x1", "y1", "x2", "y2"],
+    "ClipArc": ["x", "y", "r0", "r1", "angle0", "angle1"],
+    "ClipEllipseArc": ["x", "y", "r0x", "r1x", "r0y", "r1y", "angle0", "angle1"],
+    # コンテナ（direction / justify / align は下の名前でも書ける）
+    "FlexBox": ["x", "y", "w", "h", "padding", "gap", "columns", "rows", "direction", "justify", "align"],
+    "TableBox": ["x", "y", "w", "h", "padding", "gap", "columns", "rows", "direction", "justify", "align"],
+}
+
+# VisualDataSet::BoxDirection / BoxAlign と同じ並び
+BOX_ENUMS = {
+    "direction": ["Row", "Column"],
+    "justify": ["Start", "Center", "End", "SpaceBetween"],
+    "align": ["Start", "Center", "End", "SpaceBetween"],
+}
+
+CONTAINER_TYPES = ("FlexBox", "TableBox")
+
+# 基準座標が先頭の点 (x0, y0) の種類（VisualData::getArgsOrigin と同じ）
+POINT_ORIGIN_TYPES = ("DrawLine", "DrawBezier", "DrawWideLine", "DrawTriangle", "FillTriangle", "ClipTriangle")
+
+
+class BlobError(Exception):
+    pass
+
+
+def box_value(kind, key, o):
+    # TableBox はセルの中央に置くのが既定（VisualData::setTableBoxObject と同じ）
+    default = "Center" if kind == "TableBox" and key in ("justify", "align") else 0
+    v = o.get(key, default)
+    if isinstance(v, str):
+        if v not in BOX_ENUMS[key]:
+            raise BlobError("unknown %s [%s]" % (key, v))
+        return BOX_ENUMS[key].index(v)
+    return int(v)
+
+
+def color_value(v):
+    if isinstance(v, str):
+        if v.upper() in COLORS:
+            return COLORS[v.upper()]
+        return int(v, 0)
+    return int(v)
+
+
+def float_bits(v):
+    return struct.unpack("<i", struct.pack("<f", float(v)))[0]
+
+
+def image_size(path, fs_root):
+    """JPG/PNG のヘッダから元画像のサイズを読む。"""
+    if not fs_root:
+        return None
+    full = os.path.join(fs_root, path.lstrip("/"))
+    try:
+        with open(full, "rb") as f:
+            data = f.read()
+    except OSError:
+        return None
+    if data[:8] == b"\x89PNG\r\n\x1a\n":
+        return struct.unpack(">II", data[16:24])
+    if data[:2] == b"\xff\xd8":
+        i = 2
+        while i + 9 < len(data):
+            if data[i] != 0xFF:
+                i += 1
+                continue
+            marker = data[i + 1]
+            length = struct.unpack(">H", data[i + 2:i + 4])[0]
+            if 0xC0 <= marker <= 0xC3:
+                h, w = struct.unpack(">HH", data[i + 5:i + 9])
+                return w, h
+            i += 2 + length
+    return None
+
+
+def origin_of(o):
+    if o["type"] in POINT_ORIGIN_TYPES:
+        return int(o.get("x0", 0)), int(o.get("y0", 0))
+    return int(o.get("x", 0)), int(o.get("y", 0))
+
+
+def has_color(kind):
+    return kind == "DrawString" or (kind in INT_ARGS and "color" in INT_ARGS[kind])
+
+
+class BlobWriter:
+    def __init__(self, fs_root=None, base_dir="."):
+        self.fs_root = fs_root
+        self.base_dir = base_dir
+        self.data = bytearray()
+        self.strings = {}
+        self.pages = []
+        self.objects = []
+        self.processes = []
+        self.next_process_num = 0
+
+    # data 領域（ブロブ先頭からの offset は書き出し時に確定するため、ここでは相対位置）
+    def intern(self, s):
+        if s is None:
+            return None
+        if s not in self.strings:
+            self.strings[s] = len(self.data)
+            self.data += s.encode("utf-8") + b"\0"
+        return self.strings[s]
+
+    def add_blob(self, raw):
+        while len(self.data) % 4:
+            self.data.append(0)
+        pos = len(self.data)
+        self.data += raw
+        return pos
+
+    def object_args(self, kind, o):
+        args = [0] * 11
+        data = None
+        font_id = 0
+        if kind in INT_ARGS:
+            for i, key in enumerate(INT_ARGS[kind]):
+                if key == "color":
+                    args[i] = color_value(o.get(key, 0))
+                elif key in BOX_ENUMS:
+                    args[i] = box_value(kind, key, o)
+                else:
+                    args[i] = int(o.get(key, 0))
+        elif kind in ("DrawJpgFile", "DrawPngFile"):
+            path = o["path"]
+            scale_x = float(o.get("scaleX", 1.0))
+            scale_y = float(o.get("scaleY", scale_x))
+            max_w = int(o.get("maxWidth", 0))
+            max_h = int(o.get("maxHeight", 0))
+            w, h = o.get("w"), o.get("h")
+            if w is None or h is None:
+                size = image_size(path, self.fs_root)
+                if size:
+                    w = min(int(size[0] * scale_x), max_w) if max_w else int(size[0] * scale_x)
+                    h = min(int(size[1] * scale_y), max_h) if max_h else int(size[1] * scale_y)
+                else:
+                    w, h = 0, 0
+            source = {"SD": 0, "SPIFFS": 1}[o.get("dataSource", "SD")]
+            args[:11] = [source, int(o.get("x", 0)), int(o.get("y", 0)), int(w), int(h), max_w, max_h,
+                         int(o.get("offX", 0)), int(o.get("offY", 0)), float_bits(scale_x), float_bits(scale_y)]
+            data = ("str", path)
+        elif kind == "DrawBitmap":
+            args[:4] = [int(o.get("x", 0)), int(o.get("y", 0)), int(o["w"]), int(o["h"])]
+            if "file" in o:
+                with open(os.path.join(self.base_dir, o["file"]), "rb") as f:
+                    raw = f.read()
+            else:
+                raw = struct.pack("<%dH" % len(o["pixels"]), *[color_value(p) for p in o["pixels"]])
+            if len(raw) < args[2] * args[3] * 2:
+                raise BlobError("bitmap [%s] has fewer pixels than w*h" % o["name"])
+            data = ("raw", raw)
+        elif kind == "DrawString":
+            font = o.get("font", "lgfxJapanGothic_40")
+            if font not in FONTS:
+                raise BlobError("unknown font [%s]" % font)
+            font_id = FONTS.index(font)
+            datum = o.get("datum", "top_left")
+            args[:7] = [int(o.get("x", 0)), int(o.get("y", 0)),
+                        color_value(o.get("color", "WHITE")), color_value(o.get("bgcolor", -1)),
+                        DATUMS[datum] if isinstance(datum, str) else int(datum),
+                        int(o.get("textSize", 1)), 1 if o.get("textWrap", True) else 0]
+            data = ("str", o.get("text", ""))
+        else:
+            raise BlobError("DrawType [%s] cannot be stored in a blob" % kind)
+        return args, data, font_id
+
+    def add_page(self, page, page_num):
+        name = page.get("name", "page%d" % page_num)
+        objects = page.get("objects", [])
+        processes = page.get("processes", [])
+
+        index = {}
+        for num, o in enumerate(objects):
+            if o["name"] in index:
+                raise BlobError("[%s] duplicated in page [%s]" % (o["name"], name))
+            index[o["name"]] = num
+
+        # 親子関係（VisualData::setParent と同じ検査）
+        parents = [-1] * len(objects)
+        for num, o in enumerate(objects):
+            if "parent" not in o:
+                continue
+            if o["parent"] not in index:
+                raise BlobError("[%s] does not exist" % o["parent"])
+            parents[num] = index[o["parent"]]
+        for num, o in enumerate(objects):
+            seen = set()
+            p = num
+            while parents[p] >= 0:
+                if p in seen:
+                    raise BlobError("[%s] is placed inside itself" % o["name"])
+                seen.add(p)
+                p = parents[p]
+
+        # 親から順に、相対座標を絶対座標へ・受け継ぐ色を親の色へ直す（SceneTree::update と同じ結果）
+        resolved = {}
+
+        def resolve(num):
+            if num in resolved:
+                return resolved[num]
+            o = dict(objects[num])
+            p = parents[num]
+            if p >= 0:
+                parent = resolve(p)
+                if parent["type"] not in CONTAINER_TYPES:
+                    px, py = origin_of(parent)
+                    for key in ("x", "x0", "x1", "x2"):
+                        o[key] = int(o.get(key, 0)) + px
+                    for key in ("y", "y0", "y1", "y2"):
+                        o[key] = int(o.get(key, 0)) + py
+                if o.get("inheritColor"):
+                    a = p
+                    while a >= 0 and not has_color(objects[a]["type"]):
+                        a = parents[a]
+                    if a >= 0:
+                        default = "WHITE" if objects[a]["type"] == "DrawString" else 0
+                        o["color"] = resolve(a).get("color", default)
+            resolved[num] = o
+            return o
+
+        by_name = {}
+        records = []
+        for num in range(len(objects)):
+            o = resolve(num)
+            kind = o["type"]
+            if kind not in DRAW_TYPES:
+                raise BlobError("unknown DrawType [%s]" % kind)
+            args, data, font_id = self.object_args(kind, o)
+            rec = {
+                "name": o["name"], "num": num, "type": DRAW_TYPES.index(kind),
+                "z": int(o.get("z", 0)),
+                # Clip 系・コンテナは何も塗らないので既定で isUntouchable
+                "untouchable": bool(o.get("untouchable", kind.startswith("Clip") or kind in CONTAINER_TYPES)),
+                "font": font_id, "hit": 0,
+                "args": args, "data": data, "parent": parents[num],
+                "inherit": bool(o.get("inheritColor", False)),
+            }
+            by_name[o["name"]] = rec
+            records.append(rec)
+
+        # 判定色は TouchData::createOrGetObjectColor と同じく、最初のプロセス登録順に 1 から採番
+        next_color = 1
+        seen_names = set()
+        seen_types = set()
+        proc_records = []
+        for p in processes:
+            if p["name"] in seen_names:
+                raise BlobError("processName [%s] duplicated in page [%s]" % (p["name"], name))
+            target = by_name.get(p["object"])
+            if target is None:
+                raise BlobError("process [%s] targets unknown object [%s]" % (p["name"], p["object"]))
+            if target["untouchable"]:
+                raise BlobError("object [%s] is untouchable" % p["object"])
+            ttype = TOUCH_TYPES.index(p["type"])
+            if (target["num"], ttype) in seen_types:
+                raise BlobError("object [%s] already has a %s process" % (p["object"], p["type"]))
+            seen_names.add(p["name"])
+            seen_types.add((target["num"], ttype))
+            if target["hit"] == 0:
+                target["hit"] = next_color
+                next_color += 1
+            self.next_process_num += 1
+            flags = (PROCESS_ENABLE_OVER_BORDER if p.get("enableOverBorder") else 0) \
+                  | (PROCESS_RETURN_CURRENT_OVER if p.get("returnCurrentOver") else 0)
+            proc_records.append({
+                "name": p["name"], "num": self.next_process_num, "object": target["num"],
+                "type": ttype, "flags": flags, "multi": int(p.get("multiClickCount", 0)),
+                "color": target["hit"],
+            })
+
+        # zIndex で安定ソート（VisualData::drawPage と同じ順）
+        records.sort(key=lambda r: r["z"])
+
+        self.pages.append({
+            "num": page_num, "name": name,
+            "first_object": len(self.objects), "object_count": len(records),
+            "first_process": len(self.processes), "process_count": len(proc_records),
+        })
+        self.objects += records
+        self.processes += proc_records
+
+    def build(self):
+        header_size = struct.calcsize(HEADER_FMT)
+        page_off = header_size
+        object_off = page_off + struct.calcsize(PAGE_FMT) * len(self.pages)
+        process_off = object_off + struct.calcsize(OBJECT_FMT) * len(self.objects)
+        data_off = process_off + struct.calcsize(PROCESS_FMT) * len(self.processes)
+
+        # 文字列・画像データの位置を確定
+        def locate(value):
+            return 0 if value is None else data_off + value
+
+        for rec in self.objects:
+            kind, payload = rec["data"] if rec["data"] else (None, None)
+            if kind == "str":
+                rec["data_off"] = locate(self.intern(payload))
+            elif kind == "raw":
+                rec["data_off"] = locate(self.add_blob(payload))
+            else:
+                rec["data_off"] = 0
+        for rec in self.objects:
+            rec["name_off"] = locate(self.intern(rec["name"]))
+        for rec in self.processes:
+            rec["name_off"] = locate(self.intern(rec["name"]))
+        for page in self.pages:
+            page["name_off"] = locate(self.intern(page["name"]))
+        while len(self.data) % 4:
+            self.data.append(0)
+
+        total = data_off + len(self.data)
+        out = bytearray()
+        out += struct.pack(HEADER_FMT, MAGIC, VERSION, header_size, total,
+                           len(self.pages), 0, len(self.objects), len(self.processes),
+                           page_off, object_off, process_off, data_off)
+        for p in self.pages:
+            out += struct.pack(PAGE_FMT, p["num"], p["name_off"], p["first_object"], p["first_process"],
+                               p["object_count"], p["process_count"])
+        for o in self.objects:
+            out += struct.pack(OBJECT_FMT, o["name_off"], o["num"], o["type"], o["z"],
+                               (OBJECT_UNTOUCHABLE if o["untouchable"] else 0)
+                               | (OBJECT_INHERIT_COLOR if o["inherit"] else 0), o["font"], o["hit"],
+                               *o["args"], o["data_off"], o["parent"])
+        for p in self.processes:
+            out += struct.pack(PROCESS_FMT, p["name_off"], p["num"], p["object"], p["type"],
+                               p["flags"], p["multi"], 0, p["color"])
+        out += self.data
+        assert len(out) == total
+        return bytes(out)
+
+
+def compile_ui(ui, fs_root=None, base_dir="."):
+    writer = BlobWriter(fs_root, base_dir)
+    used = set()
+    auto_num = 1
+    for page in ui.get("pages", []):
+        if "num" in page:
+            num = int(page["num"])
+        else:
+            while auto_num in used:
+                auto_num += 1
+            num = auto_num
+        if num in used:
+            raise BlobError("pageNum %d duplicated" % num)
+        used.add(num)
+        writer.add_page(page, num)
+    names = [p["name"] for p in writer.pages]
+    if len(names) != len(set(names)):
+        raise BlobError("pageName duplicated")
+    return writer.build()
+
+
+def write_header(blob, path, symbol="ui_blob"):
+    with open(path, "w") as f:
+        f.write("#pragma once\n#include <stdint.h>\n\n")
+        f.write("// tools/uiblob.py で生成\n")
+        f.write("alignas(4) static const uint8_t %s[%d] = {\n" % (symbol, len(blob)))
+        for i in range(0, len(blob), 16):
+            f.write("  " + ", ".join("0x%02x" % b for b in blob[i:i + 16]) + ",\n")
+        f.write("};\n")
+
+
+def main(argv=None):
+    ap = argparse.ArgumentParser(description="Compile a JSON UI definition into a VisualTouch UI blob.")
+    ap.add_argument("input")
+    ap.add_argument("output")
+    ap.add_argument("--fs-root", help="directory used to read JPG/PNG sizes")
+    ap.add_argument("--header", help="also write the blob as a C array header")
+    ap.add_argument("--symbol", default="ui_blob", help="array name used with --header")
+    args = ap.parse_args(argv)
+
+    with open(args.input, encoding="utf-8") as f:
+        ui = json.load(f)
+    try:
+        blob = compile_ui(ui, args.fs_root, os.path.dirname(os.path.abspath(args.input)))
+    except (BlobError, KeyError, ValueError) as e:
+        print("uiblob: %s" % e, file=sys.stderr)
+        return 1
+
+    with open(args.output, "wb") as f:
+        f.write(blob)
+    if args.header:
+        write_header(blob, args.header, args.symbol)
+    print("uiblob: %d pages, %d objects, %d processes, %d bytes" % (
+        blob and struct.unpack_from("<H", blob, 12)[0],
+        struct.unpack_from("<I", blob, 16)[0], struct.unpack_from("<I", blob, 20)[0], len(blob)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())